@@ -56,6 +56,16 @@ void define_enums(py::module &m) {
         .value("C", NameMangling::C)
         .value("CPlusPlus", NameMangling::CPlusPlus);
 
+    py::enum_<ParallelSchedule>(m, "ParallelSchedule")
+        .value("Default", ParallelSchedule::Default)
+        .value("Dynamic", ParallelSchedule::Dynamic)
+        .value("Guided", ParallelSchedule::Guided);
+
+    py::enum_<Partition>(m, "Partition")
+        .value("Auto", Partition::Auto)
+        .value("Never", Partition::Never)
+        .value("Always", Partition::Always);
+
     py::enum_<PrefetchBoundStrategy>(m, "PrefetchBoundStrategy")
         .value("Clamp", PrefetchBoundStrategy::Clamp)
         .value("GuardWithIf", PrefetchBoundStrategy::GuardWithIf)
@@ -189,6 +199,9 @@ void define_enums(py::module &m) {
         .value("VulkanV12", Target::VulkanV12)
         .value("VulkanV13", Target::VulkanV13)
         .value("Semihosting", Target::Feature::Semihosting)
+        .value("StaticMemoryPlan", Target::Feature::StaticMemoryPlan)
+        .value("ScratchArena", Target::Feature::ScratchArena)
+        .value("LazyJIT", Target::Feature::LazyJIT)
         .value("FeatureEnd", Target::Feature::FeatureEnd);
 
     py::enum_<halide_type_code_t>(m, "TypeCode")
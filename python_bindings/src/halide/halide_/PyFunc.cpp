@@ -212,11 +212,17 @@ void define_func(py::module &m) {
             .def("store_at", (Func & (Func::*)(const Func &, const RVar &)) & Func::store_at, py::arg("f"), py::arg("var"))
             .def("store_at", (Func & (Func::*)(LoopLevel)) & Func::store_at, py::arg("loop_level"))
 
+            .def("hoist_storage", (Func & (Func::*)(const Func &, const Var &)) & Func::hoist_storage, py::arg("f"), py::arg("var"))
+            .def("hoist_storage", (Func & (Func::*)(const Func &, const RVar &)) & Func::hoist_storage, py::arg("f"), py::arg("var"))
+            .def("hoist_storage", (Func & (Func::*)(LoopLevel)) & Func::hoist_storage, py::arg("loop_level"))
+
             .def("async_", &Func::async)
+            .def("ring_buffer", &Func::ring_buffer, py::arg("buffers"))
             .def("memoize", &Func::memoize)
             .def("compute_inline", &Func::compute_inline)
             .def("compute_root", &Func::compute_root)
             .def("store_root", &Func::store_root)
+            .def("hoist_storage_root", &Func::hoist_storage_root)
 
             .def("store_in", &Func::store_in, py::arg("memory_type"))
 
@@ -406,6 +412,11 @@ void define_func(py::module &m) {
 
             .def("fold_storage", &Func::fold_storage, py::arg("dim"), py::arg("extent"), py::arg("fold_forward") = true)
 
+            .def("tile_storage", (Func & (Func::*)(const Var &, const Var &, const Expr &, const Expr &)) & Func::tile_storage,
+                 py::arg("x"), py::arg("y"), py::arg("xfactor"), py::arg("yfactor"))
+            .def("tile_storage", (Func & (Func::*)(const Var &, const Expr &)) & Func::tile_storage,
+                 py::arg("dim"), py::arg("factor"))
+
             .def("infer_arguments", &Func::infer_arguments)
 
             .def("__repr__", [](const Func &func) -> std::string {
@@ -163,6 +163,10 @@ void define_generator(py::module &m) {
         for (auto &s : argv_vector) {
             argv.push_back(const_cast<char *>(s.c_str()));
         }
+        // Python Generators can only be created by the thread holding the
+        // GIL, so compile multiple targets one at a time.
+        argv.push_back(const_cast<char *>("-j"));
+        argv.push_back(const_cast<char *>("1"));
         int result = Halide::Internal::generate_filter_main((int)argv.size(), argv.data(), PyGeneratorFactoryProvider());
         if (result != 0) {
             // Some paths in generate_filter_main() will fail with user_error or similar (which throws an exception
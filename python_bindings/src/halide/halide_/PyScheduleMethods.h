@@ -27,6 +27,8 @@ HALIDE_NEVER_INLINE void add_schedule_methods(PythonClass &class_instance) {
         .def("unroll", (T & (T::*)(const VarOrRVar &, const Expr &, TailStrategy)) & T::unroll,
              py::arg("var"), py::arg("factor"), py::arg("tail") = TailStrategy::Auto)
 
+        .def("partition", &T::partition, py::arg("var"), py::arg("policy"))
+
         .def("split", (T & (T::*)(const VarOrRVar &, const VarOrRVar &, const VarOrRVar &, const Expr &, TailStrategy)) & T::split,
              py::arg("old"), py::arg("outer"), py::arg("inner"), py::arg("factor"), py::arg("tail") = TailStrategy::Auto)
 
@@ -51,6 +53,7 @@ HALIDE_NEVER_INLINE void add_schedule_methods(PythonClass &class_instance) {
 
         .def("parallel", (T & (T::*)(const VarOrRVar &)) & T::parallel, py::arg("var"))
         .def("parallel", (T & (T::*)(const VarOrRVar &, const Expr &, TailStrategy)) & T::parallel, py::arg("var"), py::arg("task_size"), py::arg("tail") = TailStrategy::Auto)
+        .def("parallel", (T & (T::*)(const VarOrRVar &, ParallelSchedule, const Expr &)) & T::parallel, py::arg("var"), py::arg("schedule"), py::arg("grain") = Expr(1))
 
         .def("vectorize", (T & (T::*)(const VarOrRVar &)) & T::vectorize, py::arg("var"))
         .def("vectorize", (T & (T::*)(const VarOrRVar &, const Expr &, TailStrategy)) & T::vectorize, py::arg("var"), py::arg("factor"), py::arg("tail") = TailStrategy::Auto)
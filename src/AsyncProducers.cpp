@@ -4,6 +4,7 @@
 #include "IREquality.h"
 #include "IRMutator.h"
 #include "IROperator.h"
+#include "Simplify.h"
 
 namespace Halide {
 namespace Internal {
@@ -35,7 +36,7 @@ protected:
         if (is_no_op(body)) {
             return body;
         } else {
-            return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+            return For::make(op->name, op->min, op->extent, op->for_type, op->partition_policy, op->device_api, body, op->parallel_schedule, op->parallel_grain);
         }
     }
 
@@ -306,10 +307,173 @@ public:
     int count = 0;
 };
 
+// The semaphore that tracks the free slots of a ring buffer. Like the
+// storage folding semaphores, it is acquired by the producer and
+// released by the consumer.
+string ring_buffer_semaphore_name(const string &func) {
+    return func + ".folding_semaphore.ring_buffer";
+}
+
+// Does a Function's storage get hoisted to the given loop, or to the
+// root level if the loop name is empty?
+bool is_hoisted_to(const Function &f, const string &loop_name) {
+    const LoopLevel &level = f.schedule().hoist_storage_level();
+    return loop_name.empty() ? level.is_root() : level.match(loop_name);
+}
+
+// Append an index to all the accesses to a Function.
+class AddRingBufferIndex : public IRMutator {
+    using IRMutator::visit;
+
+    const string &func;
+    Expr index;
+
+    Stmt visit(const Provide *op) override {
+        if (op->name == func) {
+            vector<Expr> values = mutate(op->values);
+            vector<Expr> args = mutate(op->args);
+            args.push_back(index);
+            return Provide::make(op->name, values, args, mutate(op->predicate));
+        } else {
+            return IRMutator::visit(op);
+        }
+    }
+
+    Expr visit(const Call *op) override {
+        if (op->call_type == Call::Halide && op->name == func) {
+            vector<Expr> args = mutate(op->args);
+            args.push_back(index);
+            return Call::make(op->type, op->name, args, op->call_type,
+                              op->func, op->value_index, op->image, op->param);
+        } else {
+            return IRMutator::visit(op);
+        }
+    }
+
+public:
+    AddRingBufferIndex(const string &f, Expr i)
+        : func(f), index(std::move(i)) {
+    }
+};
+
+// Give each realization of an async Function with a ring_buffer an
+// extra, outermost dimension with one slot per buffer, used in turn by
+// successive iterations of the loops between its hoist_storage level
+// and its store_at level. A semaphore initialized to the number of
+// buffers keeps the producer from overwriting a slot before the
+// consumer is done with it. ForkAsyncProducers then forks at the
+// hoist_storage level instead of at the realization, so that the
+// producer can run ahead across those loops.
+class InjectRingBuffering : public IRMutator {
+    using IRMutator::visit;
+
+    const map<string, Function> &env;
+
+    struct Loop {
+        string name;
+        Expr min, extent;
+    };
+    vector<Loop> loops;
+
+    // The ring buffered Functions whose hoist site we're inside, and
+    // the number of loops enclosing that site.
+    map<string, size_t> sites;
+
+    Stmt visit(const For *op) override {
+        loops.push_back({op->name, op->min, op->extent});
+        Stmt body = inject(op->name, op->body);
+        loops.pop_back();
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return For::make(op->name, op->min, op->extent, op->for_type, op->partition_policy, op->device_api, body, op->parallel_schedule, op->parallel_grain);
+    }
+
+    Stmt visit(const Realize *op) override {
+        auto it = sites.find(op->name);
+        if (it == sites.end()) {
+            return IRMutator::visit(op);
+        }
+        Expr buffers = env.find(op->name)->second.schedule().ring_buffer();
+
+        // Number the iterations of the loops between the hoist site
+        // and here, and use the slots in turn.
+        Expr iteration = 0;
+        for (size_t i = it->second; i < loops.size(); i++) {
+            Expr var = Variable::make(Int(32), loops[i].name);
+            iteration = iteration * loops[i].extent + (var - loops[i].min);
+        }
+        Expr slot = simplify(iteration % buffers);
+
+        Stmt body = AddRingBufferIndex(op->name, slot).mutate(mutate(op->body));
+        Expr sema = Variable::make(type_of<halide_semaphore_t *>(), ring_buffer_semaphore_name(op->name));
+        Expr release = Call::make(Int(32), "halide_semaphore_release", {sema, 1}, Call::Extern);
+        body = Block::make(Acquire::make(sema, 1, body), Evaluate::make(release));
+
+        Region bounds = op->bounds;
+        bounds.emplace_back(0, buffers);
+        ring_buffered.insert(op->name);
+        return Realize::make(op->name, op->types, op->memory_type, bounds, op->condition, body);
+    }
+
+public:
+    InjectRingBuffering(const map<string, Function> &e)
+        : env(e) {
+    }
+
+    // The Functions that were given ring buffers.
+    set<string> ring_buffered;
+
+    // Mutate the body of a loop, or the whole pipeline if the loop
+    // name is empty, and make the semaphores for any ring buffers
+    // hoisted to it.
+    Stmt inject(const string &loop_name, const Stmt &s) {
+        string hoisted;
+        for (const auto &p : env) {
+            const FuncSchedule &sched = p.second.schedule();
+            if (sched.async() &&
+                sched.ring_buffer().defined() &&
+                !sched.hoist_storage_level().match(sched.store_level()) &&
+                is_hoisted_to(p.second, loop_name)) {
+                user_assert(hoisted.empty())
+                    << "Funcs " << hoisted << " and " << p.first
+                    << " both have ring buffers hoisted to the same loop. "
+                    << "At most one ring_buffer()ed Func may be hoisted to each loop.\n";
+                hoisted = p.first;
+            }
+        }
+        if (hoisted.empty()) {
+            return mutate(s);
+        }
+
+        sites[hoisted] = loops.size();
+        Stmt body = mutate(s);
+        sites.erase(hoisted);
+        if (ring_buffered.count(hoisted)) {
+            Expr buffers = env.find(hoisted)->second.schedule().ring_buffer();
+            Expr sema_space = Call::make(type_of<halide_semaphore_t *>(), "halide_make_semaphore",
+                                         {buffers}, Call::Extern);
+            body = LetStmt::make(ring_buffer_semaphore_name(hoisted), sema_space, body);
+
+            // Func::ring_buffer checks constant numbers of buffers. With
+            // none, the producer would wait forever for a free slot.
+            Expr enough_buffers = buffers >= 1;
+            if (!can_prove(enough_buffers)) {
+                Expr error = requirement_failed_error(enough_buffers,
+                                                      {Expr("ring_buffer() of Func " + hoisted + " requires at least one buffer, but was given"),
+                                                       buffers});
+                body = Block::make(AssertStmt::make(enough_buffers, error), body);
+            }
+        }
+        return body;
+    }
+};
+
 class ForkAsyncProducers : public IRMutator {
     using IRMutator::visit;
 
     const map<string, Function> &env;
+    const set<string> &ring_buffered;
 
     map<string, vector<string>> cloned_acquires;
 
@@ -317,62 +481,97 @@ class ForkAsyncProducers : public IRMutator {
         auto it = env.find(op->name);
         internal_assert(it != env.end());
         Function f = it->second;
-        if (f.schedule().async()) {
-            Stmt body = op->body;
-
-            // Make two copies of the body, one which only does the
-            // producer, and one which only does the consumer. Inject
-            // synchronization to preserve dependencies. Put them in a
-            // task-parallel block.
+        if (f.schedule().async() && !ring_buffered.count(op->name)) {
+            return Realize::make(op->name, op->types, op->memory_type,
+                                 op->bounds, op->condition, fork(op->name, op->body));
+        } else {
+            return IRMutator::visit(op);
+        }
+    }
 
-            // Make a semaphore per consume node
-            CountConsumeNodes consumes(op->name);
-            body.accept(&consumes);
+    Stmt visit(const For *op) override {
+        Stmt body = fork_ring_buffers(op->name, op->body);
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return For::make(op->name, op->min, op->extent, op->for_type, op->partition_policy, op->device_api, body, op->parallel_schedule, op->parallel_grain);
+    }
 
-            vector<string> sema_names;
-            vector<Expr> sema_vars;
-            for (int i = 0; i < consumes.count; i++) {
-                sema_names.push_back(op->name + ".semaphore_" + std::to_string(i));
-                sema_vars.push_back(Variable::make(type_of<halide_semaphore_t *>(), sema_names.back()));
+    // Ring buffered producers fork at their hoist site, inside the
+    // semaphore that tracks the free slots.
+    Stmt fork_ring_buffers(const string &loop_name, const Stmt &s) {
+        for (const string &name : ring_buffered) {
+            if (is_hoisted_to(env.find(name)->second, loop_name)) {
+                // Check the number of buffers before forking, so that
+                // the producer never waits on a semaphore with no slots.
+                const Block *block = s.as<Block>();
+                if (block && block->first.as<AssertStmt>()) {
+                    return Block::make(block->first, fork_ring_buffers(loop_name, block->rest));
+                }
+                const LetStmt *let = s.as<LetStmt>();
+                internal_assert(let && let->name == ring_buffer_semaphore_name(name))
+                    << "Expected ring buffer semaphore at the hoist site of " << name << "\n";
+                return LetStmt::make(let->name, let->value, fork(name, let->body));
             }
+        }
+        return mutate(s);
+    }
 
-            Stmt producer = GenerateProducerBody(op->name, sema_vars, cloned_acquires).mutate(body);
-            Stmt consumer = GenerateConsumerBody(op->name, sema_vars).mutate(body);
+    // Fork a Stmt into a producer of the given Function and its consumers.
+    Stmt fork(const string &name, Stmt body) {
+        // Make two copies of the body, one which only does the
+        // producer, and one which only does the consumer. Inject
+        // synchronization to preserve dependencies. Put them in a
+        // task-parallel block.
 
-            // Recurse on both sides
-            producer = mutate(producer);
-            consumer = mutate(consumer);
+        // Make a semaphore per consume node
+        CountConsumeNodes consumes(name);
+        body.accept(&consumes);
 
-            // Run them concurrently
-            body = Fork::make(producer, consumer);
+        vector<string> sema_names;
+        vector<Expr> sema_vars;
+        for (int i = 0; i < consumes.count; i++) {
+            sema_names.push_back(name + ".semaphore_" + std::to_string(i));
+            sema_vars.push_back(Variable::make(type_of<halide_semaphore_t *>(), sema_names.back()));
+        }
 
-            for (const string &sema_name : sema_names) {
-                // Make a semaphore on the stack
-                Expr sema_space = Call::make(type_of<halide_semaphore_t *>(), "halide_make_semaphore",
-                                             {0}, Call::Extern);
+        Stmt producer = GenerateProducerBody(name, sema_vars, cloned_acquires).mutate(body);
+        Stmt consumer = GenerateConsumerBody(name, sema_vars).mutate(body);
 
-                // If there's a nested async producer, we may have
-                // recursively cloned this semaphore inside the mutation
-                // of the producer and consumer.
-                const vector<string> &clones = cloned_acquires[sema_name];
-                for (const auto &i : clones) {
-                    body = CloneAcquire(sema_name, i).mutate(body);
-                    body = LetStmt::make(i, sema_space, body);
-                }
+        // Recurse on both sides
+        producer = mutate(producer);
+        consumer = mutate(consumer);
+
+        // Run them concurrently
+        body = Fork::make(producer, consumer);
 
-                body = LetStmt::make(sema_name, sema_space, body);
+        for (const string &sema_name : sema_names) {
+            // Make a semaphore on the stack
+            Expr sema_space = Call::make(type_of<halide_semaphore_t *>(), "halide_make_semaphore",
+                                         {0}, Call::Extern);
+
+            // If there's a nested async producer, we may have
+            // recursively cloned this semaphore inside the mutation
+            // of the producer and consumer.
+            const vector<string> &clones = cloned_acquires[sema_name];
+            for (const auto &i : clones) {
+                body = CloneAcquire(sema_name, i).mutate(body);
+                body = LetStmt::make(i, sema_space, body);
             }
 
-            return Realize::make(op->name, op->types, op->memory_type,
-                                 op->bounds, op->condition, body);
-        } else {
-            return IRMutator::visit(op);
+            body = LetStmt::make(sema_name, sema_space, body);
         }
+
+        return body;
     }
 
 public:
-    ForkAsyncProducers(const map<string, Function> &e)
-        : env(e) {
+    ForkAsyncProducers(const map<string, Function> &e, const set<string> &r)
+        : env(e), ring_buffered(r) {
+    }
+
+    Stmt fork_root(const Stmt &s) {
+        return fork_ring_buffers("", s);
     }
 };
 
@@ -706,8 +905,10 @@ class TightenForkNodes : public IRMutator {
 }  // namespace
 
 Stmt fork_async_producers(Stmt s, const map<string, Function> &env) {
+    InjectRingBuffering ring_buffering(env);
+    s = ring_buffering.inject("", s);
     s = TightenProducerConsumerNodes(env).mutate(s);
-    s = ForkAsyncProducers(env).mutate(s);
+    s = ForkAsyncProducers(env, ring_buffering.ring_buffered).fork_root(s);
     s = ExpandAcquireNodes().mutate(s);
     s = TightenForkNodes().mutate(s);
     s = InitializeSemaphores().mutate(s);
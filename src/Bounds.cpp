@@ -1,4 +1,7 @@
 #include <iostream>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 #include <utility>
 
 #include "Bounds.h"
@@ -1681,8 +1684,7 @@ private:
     }
 };
 
-// Version that exposes 'indent' is for internal use only
-Interval bounds_of_expr_in_scope_with_indent(const Expr &expr, const Scope<Interval> &scope, const FuncValueBounds &fb, bool const_bound, int indent) {
+Interval compute_bounds_of_expr_in_scope(const Expr &expr, const Scope<Interval> &scope, const FuncValueBounds &fb, bool const_bound, int indent) {
 #if DO_TRACK_BOUNDS_INTERVALS
     const string spaces(indent, ' ');
     debug(0) << spaces << "BoundsOfExprInScope {\n"
@@ -1714,6 +1716,172 @@ Interval bounds_of_expr_in_scope_with_indent(const Expr &expr, const Scope<Inter
     return b.interval;
 }
 
+// The names of the variables and the Funcs an Expr refers to.
+class FindBoundsDependencies : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Variable *op) override {
+        vars.insert(op->name);
+        if (op->param.defined()) {
+            params.emplace(op->param.name(), op->param);
+        }
+    }
+
+    void visit(const Call *op) override {
+        IRGraphVisitor::visit(op);
+        if (op->call_type == Call::Halide) {
+            calls.emplace(op->name, op->value_index);
+        }
+    }
+
+public:
+    set<string> vars;
+    set<pair<string, int>> calls;
+    map<string, Parameter> params;
+};
+
+// Whether it's worth looking an Expr up in a BoundsCache rather than
+// just computing its bounds.
+bool should_cache_bounds(const Expr &e) {
+    return !(e.as<Variable>() || is_const(e) || e.as<Broadcast>());
+}
+
+bool same_bound(const Expr &a, const Expr &b) {
+    return a.same_as(b) || (a.defined() && b.defined() && equal(a, b));
+}
+
+thread_local BoundsCache *active_bounds_cache = nullptr;
+
+}  // namespace
+
+struct BoundsCache {
+    // What a name was bound to when the bounds were computed.
+    struct Binding {
+        bool bound = false;
+        bool single_point = false;
+        Interval interval;
+
+        bool operator==(const Binding &other) const {
+            return (bound == other.bound &&
+                    single_point == other.single_point &&
+                    same_bound(interval.min, other.interval.min) &&
+                    same_bound(interval.max, other.interval.max));
+        }
+    };
+
+    struct Entry {
+        bool const_bound;
+        vector<Binding> vars, calls;
+        Interval result;
+    };
+
+    struct Node {
+        // Holding the Expr keeps the node alive, so its address can't
+        // be reused for another Expr while it's in the cache.
+        Expr expr;
+        vector<string> vars;
+        vector<pair<string, int>> calls;
+        vector<Entry> entries;
+    };
+
+    // Keep the most recent results for each Expr. Queries about the
+    // same Expr in many different scopes are rarely repeated.
+    static constexpr size_t max_entries_per_node = 8;
+
+    std::unordered_map<const IRNode *, Node> nodes;
+    int hits = 0, misses = 0;
+
+    // The binding of a variable as the Bounds visitor will see it. It
+    // turns entries in the innermost scope whose min and max are equal
+    // into single points.
+    static Binding var_binding(const Scope<Interval> &scope, const string &name) {
+        Binding b;
+        b.bound = scope.contains(name);
+        if (b.bound) {
+            b.interval = scope.get(name);
+            if (!b.interval.is_single_point() &&
+                scope.count(name) &&
+                equal(b.interval.min, b.interval.max)) {
+                b.interval = Interval::single_point(b.interval.min);
+            }
+            b.single_point = b.interval.is_single_point();
+        }
+        return b;
+    }
+
+    static Binding call_binding(const FuncValueBounds &fb, const pair<string, int> &key) {
+        Binding b;
+        auto it = fb.find(key);
+        b.bound = it != fb.end();
+        if (b.bound) {
+            b.interval = it->second;
+            b.single_point = b.interval.is_single_point();
+        }
+        return b;
+    }
+
+    Interval get(const Expr &expr, const Scope<Interval> &scope, const FuncValueBounds &fb, bool const_bound, int indent) {
+        Node &node = nodes[expr.get()];
+        if (!node.expr.defined()) {
+            node.expr = expr;
+            FindBoundsDependencies deps;
+            expr.accept(&deps);
+            node.vars.assign(deps.vars.begin(), deps.vars.end());
+            node.calls.assign(deps.calls.begin(), deps.calls.end());
+        }
+
+        Entry entry;
+        entry.const_bound = const_bound;
+        for (const auto &v : node.vars) {
+            entry.vars.push_back(var_binding(scope, v));
+        }
+        for (const auto &c : node.calls) {
+            entry.calls.push_back(call_binding(fb, c));
+        }
+
+        for (const Entry &e : node.entries) {
+            if (e.const_bound == entry.const_bound &&
+                e.vars == entry.vars &&
+                e.calls == entry.calls) {
+                hits++;
+                return e.result;
+            }
+        }
+
+        misses++;
+        entry.result = compute_bounds_of_expr_in_scope(expr, scope, fb, const_bound, indent);
+        if (node.entries.size() == max_entries_per_node) {
+            node.entries.erase(node.entries.begin());
+        }
+        node.entries.push_back(entry);
+        return entry.result;
+    }
+};
+
+ScopedBoundsCache::ScopedBoundsCache() {
+    if (!active_bounds_cache && get_env_variable("HL_BOUNDS_CACHE") != "0") {
+        cache = std::make_unique<BoundsCache>();
+        active_bounds_cache = cache.get();
+    }
+}
+
+ScopedBoundsCache::~ScopedBoundsCache() {
+    if (cache) {
+        debug(2) << "Bounds cache: " << cache->hits << " hits, " << cache->misses << " misses\n";
+        active_bounds_cache = nullptr;
+    }
+}
+
+namespace {
+
+// Version that exposes 'indent' is for internal use only
+Interval bounds_of_expr_in_scope_with_indent(const Expr &expr, const Scope<Interval> &scope, const FuncValueBounds &fb, bool const_bound, int indent) {
+    if (active_bounds_cache && should_cache_bounds(expr)) {
+        return active_bounds_cache->get(expr, scope, fb, const_bound, indent);
+    }
+    return compute_bounds_of_expr_in_scope(expr, scope, fb, const_bound, indent);
+}
+
 }  // namespace
 
 Interval bounds_of_expr_in_scope(const Expr &expr, const Scope<Interval> &scope, const FuncValueBounds &fb, bool const_bound) {
@@ -3177,8 +3345,164 @@ Interval compute_pure_function_definition_value_bounds(
     return result;
 }
 
+namespace {
+
+// The values a pure definition may take for one of its outputs.
+void pure_definition_values(const Definition &def, int dim, vector<Expr> &values) {
+    values.push_back(def.values()[dim]);
+    for (const Specialization &s : def.specializations()) {
+        pure_definition_values(s.definition, dim, values);
+    }
+}
+
+// Value bounds computed by compute_function_value_bounds, saved along
+// with what they were computed from. Lowering deep-copies the Funcs of
+// a pipeline every time, so entries are found by Func name and checked
+// by comparing definitions structurally.
+class FuncValueBoundsCache {
+    // A Parameter, along with the range it had when the bounds were
+    // computed. Param::set_range changes the range of the Parameter in
+    // place, so it must be compared too.
+    struct ParamRange {
+        Parameter param;
+        Expr min, max, estimate;
+
+        explicit ParamRange(const Parameter &p)
+            : param(p) {
+            if (!p.is_buffer()) {
+                min = p.min_value();
+                max = p.max_value();
+                estimate = p.estimate();
+            }
+        }
+
+        bool same_as(const Parameter &p) const {
+            ParamRange other(p);
+            return (param.same_as(other.param) &&
+                    same_bound(min, other.min) &&
+                    same_bound(max, other.max) &&
+                    same_bound(estimate, other.estimate));
+        }
+    };
+
+    struct Entry {
+        // What the bounds were computed from. Comparing Exprs by value
+        // ignores the Parameters they refer to, so those are kept too.
+        vector<string> args;
+        vector<Expr> values;
+        map<string, ParamRange> params;
+        vector<pair<string, int>> callees;
+        vector<std::optional<Interval>> callee_bounds;
+
+        Interval result;
+    };
+
+    // Entries hold on to the Parameters they were computed from, so
+    // the cache is emptied when it grows past this many.
+    static constexpr size_t max_entries = 4096;
+
+    std::mutex mutex;
+    map<pair<string, int>, Entry> entries;
+
+    static vector<std::optional<Interval>> find_callee_bounds(const vector<pair<string, int>> &callees,
+                                                              const FuncValueBounds &fb) {
+        vector<std::optional<Interval>> result;
+        for (const auto &c : callees) {
+            auto it = fb.find(c);
+            if (it != fb.end()) {
+                result.emplace_back(it->second);
+            } else {
+                result.emplace_back();
+            }
+        }
+        return result;
+    }
+
+public:
+    // Find the saved bounds of a Func's output, if it was computed
+    // from the same things.
+    bool find(const pair<string, int> &key,
+              const vector<string> &args,
+              const vector<Expr> &values,
+              const FuncValueBounds &fb,
+              Interval &result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            return false;
+        }
+        const Entry &e = it->second;
+        if (e.args != args || e.values.size() != values.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < values.size(); i++) {
+            if (!same_bound(e.values[i], values[i])) {
+                return false;
+            }
+        }
+        FindBoundsDependencies deps;
+        for (const Expr &v : values) {
+            v.accept(&deps);
+        }
+        if (deps.params.size() != e.params.size()) {
+            return false;
+        }
+        for (const auto &p : deps.params) {
+            auto p_it = e.params.find(p.first);
+            if (p_it == e.params.end() || !p_it->second.same_as(p.second)) {
+                return false;
+            }
+        }
+        vector<std::optional<Interval>> callee_bounds = find_callee_bounds(e.callees, fb);
+        for (size_t i = 0; i < callee_bounds.size(); i++) {
+            const auto &a = callee_bounds[i];
+            const auto &b = e.callee_bounds[i];
+            if (a.has_value() != b.has_value() ||
+                (a && !(same_bound(a->min, b->min) && same_bound(a->max, b->max)))) {
+                return false;
+            }
+        }
+        result = e.result;
+        return true;
+    }
+
+    void save(const pair<string, int> &key,
+              const vector<string> &args,
+              const vector<Expr> &values,
+              const FuncValueBounds &fb,
+              const Interval &result) {
+        Entry e;
+        e.args = args;
+        e.values = values;
+        FindBoundsDependencies deps;
+        for (const Expr &v : values) {
+            v.accept(&deps);
+        }
+        for (const auto &p : deps.params) {
+            e.params.emplace(p.first, ParamRange(p.second));
+        }
+        e.callees.assign(deps.calls.begin(), deps.calls.end());
+        e.callee_bounds = find_callee_bounds(e.callees, fb);
+        e.result = result;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (entries.size() >= max_entries) {
+            entries.clear();
+        }
+        entries[key] = std::move(e);
+    }
+};
+
+FuncValueBoundsCache &func_value_bounds_cache() {
+    static FuncValueBoundsCache cache;
+    return cache;
+}
+
+}  // namespace
+
 FuncValueBounds compute_function_value_bounds(const vector<string> &order,
-                                              const map<string, Function> &env) {
+                                              const map<string, Function> &env,
+                                              bool use_cache) {
     FuncValueBounds fb;
 
     for (const auto &func_name : order) {
@@ -3189,6 +3513,16 @@ FuncValueBounds compute_function_value_bounds(const vector<string> &order,
 
             Interval result;
 
+            vector<Expr> values;
+            if (use_cache && f.is_pure()) {
+                pure_definition_values(f.definition(), j, values);
+                if (func_value_bounds_cache().find(key, f_args, values, fb, result)) {
+                    debug(2) << "Reusing bounds on value " << j << " for func " << func_name << "\n";
+                    fb[key] = result;
+                    continue;
+                }
+            }
+
             if (f.is_pure()) {
 
                 // Make a scope that says the args could be anything.
@@ -3208,6 +3542,9 @@ FuncValueBounds compute_function_value_bounds(const vector<string> &order,
                     result.max = simplify(common_subexpression_elimination(result.max));
                 }
 
+                if (use_cache) {
+                    func_value_bounds_cache().save(key, f_args, values, fb, result);
+                }
                 fb[key] = result;
             } else {
                 // If the Func is impure, we may still be able to specify a bounds-of-type here
@@ -3697,7 +4034,7 @@ void bounds_test() {
     Buffer<int32_t> in(10);
     in.set_name("input");
 
-    Stmt loop = For::make("x", 3, 10, ForType::Serial, DeviceAPI::Host,
+    Stmt loop = For::make("x", 3, 10, ForType::Serial, Partition::Auto, DeviceAPI::Host,
                           Provide::make("output",
                                         {Add::make(Call::make(in, input_site_1),
                                                    Call::make(in, input_site_2))},
@@ -3761,6 +4098,36 @@ void bounds_test() {
         internal_assert(in.is_single_point());
     }
 
+    // Cached bounds must change when the bindings they depend on do.
+    {
+        ScopedBoundsCache bounds_cache;
+        Var x("x"), y("y");
+        Expr e = x * 2 + y;
+        Scope<Interval> scope;
+        scope.push("x", {0, 10});
+        scope.push("y", {0, 1});
+        check(scope, e, 0, 21);
+        check(scope, e, 0, 21);
+        scope.push("y", {5, 5});
+        check(scope, e, 5, 25);
+        scope.pop("y");
+        scope.pop("y");
+        check(scope, e, y, y + 20);
+
+        Scope<Interval> inner;
+        inner.set_containing_scope(&scope);
+        inner.push("x", {3, 4});
+        check(inner, e, y + 6, y + 8);
+
+        FuncValueBounds fb;
+        Expr call = Call::make(Int(32), "f", {x}, Call::Halide) + 1;
+        Interval in = bounds_of_expr_in_scope(call, scope, fb);
+        internal_assert(!in.is_bounded());
+        fb[{"f", 0}] = Interval(0, 7);
+        in = bounds_of_expr_in_scope(call, scope, fb);
+        internal_assert(in.is_bounded() && equal(simplify(in.max), 8));
+    }
+
     std::cout << "Bounds test passed" << std::endl;
 }
 
@@ -6,6 +6,8 @@
  * and the regions of a function read or written by a statement.
  */
 
+#include <memory>
+
 #include "Interval.h"
 #include "Scope.h"
 
@@ -35,6 +37,27 @@ Interval bounds_of_expr_in_scope(const Expr &expr,
                                  const FuncValueBounds &func_bounds = empty_func_value_bounds(),
                                  bool const_bound = false);
 
+struct BoundsCache;
+
+/** While one of these is alive, bounds_of_expr_in_scope (and so
+ * boxes_required, boxes_provided and friends) on the current thread
+ * remembers its results, and reuses them when asked about the same Expr
+ * again with equal bindings for the variables and Funcs it refers to.
+ * Nested instances share the outermost one's cache. Results also depend
+ * on the constraints on any Parameters the Expr refers to, so an
+ * instance should not outlive a change to those (e.g. keep one per
+ * pass). Setting HL_BOUNDS_CACHE=0 disables caching. */
+class ScopedBoundsCache {
+    std::unique_ptr<BoundsCache> cache;
+
+public:
+    ScopedBoundsCache();
+    ~ScopedBoundsCache();
+
+    ScopedBoundsCache(const ScopedBoundsCache &) = delete;
+    ScopedBoundsCache &operator=(const ScopedBoundsCache &) = delete;
+};
+
 /** Given a varying expression, try to find a constant that is either:
  * An upper bound (always greater than or equal to the expression), or
  * A lower bound (always less than or equal to the expression)
@@ -167,9 +190,14 @@ Box box_touched(Stmt s, const std::string &fn,
 // @}
 
 /** Compute the maximum and minimum possible value for each function
- * in an environment. */
+ * in an environment. If use_cache is true, bounds saved by an earlier
+ * call are reused for each Func whose definition, Parameters
+ * (including their ranges), and callees' bounds are unchanged (e.g.
+ * when a pipeline is lowered again after a change to its schedule),
+ * and the bounds computed are saved. */
 FuncValueBounds compute_function_value_bounds(const std::vector<std::string> &order,
-                                              const std::map<std::string, Function> &env);
+                                              const std::map<std::string, Function> &env,
+                                              bool use_cache = false);
 
 /* Find an upper bound of bounds.max - bounds.min. */
 Expr span_of_bounds(const Interval &bounds);
@@ -1318,7 +1318,7 @@ public:
             }
         }
 
-        return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        return For::make(op->name, op->min, op->extent, op->for_type, op->partition_policy, op->device_api, body, op->parallel_schedule, op->parallel_grain);
     }
 
     Scope<> let_vars_in_scope;
@@ -1345,6 +1345,7 @@ Stmt bounds_inference(Stmt s,
                       const map<string, Function> &env,
                       const FuncValueBounds &func_bounds,
                       const Target &target) {
+    ScopedBoundsCache bounds_cache;
 
     vector<Function> funcs(order.size());
     for (size_t i = 0; i < order.size(); i++) {
@@ -1389,7 +1390,7 @@ Stmt bounds_inference(Stmt s,
     s = Block::make(Evaluate::make(marker), s);
 
     // Add a synthetic outermost loop to act as 'root'.
-    s = For::make("<outermost>", 0, 1, ForType::Serial, DeviceAPI::None, s);
+    s = For::make("<outermost>", 0, 1, ForType::Serial, Partition::Never, DeviceAPI::None, s);
 
     s = BoundsInference(funcs, fused_func_groups, fused_pairs_in_groups,
                         outputs, func_bounds, target)
@@ -39,6 +39,9 @@ void Closure::visit(const For *op) {
     ScopedBinding<> p(ignore, op->name);
     op->min.accept(this);
     op->extent.accept(this);
+    if (op->parallel_grain.defined()) {
+        op->parallel_grain.accept(this);
+    }
     op->body.accept(this);
 }
 
@@ -888,6 +888,20 @@ void CodeGen_C::emit_constexpr_function_info(const std::string &function_name,
     internal_assert(indent == 0);
 
     stream << "}\n";
+
+    // Pipelines compiled with the scratch_arena feature also report
+    // how large a scratch buffer they need.
+    for (const auto &arg : args) {
+        if (arg.name == "__scratch" && arg.is_buffer() && !arg.argument_estimates.buffer_estimates.empty()) {
+            const int64_t *bytes = as_const_int(arg.argument_estimates.buffer_estimates[0].extent);
+            internal_assert(bytes);
+            stream << "\ninline constexpr size_t " << function_name << "_scratch_bytes() {\n";
+            indent += 1;
+            stream << get_indent() << "return " << *bytes << ";\n";
+            indent -= 1;
+            stream << "}\n";
+        }
+    }
 }
 
 void CodeGen_C::emit_halide_free_helper(const std::string &alloc_name, const std::string &free_function) {
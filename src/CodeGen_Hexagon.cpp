@@ -361,8 +361,8 @@ private:
             if (uses_hvx) {
                 body = acquire_hvx_context(body, target);
                 body = substitute("uses_hvx", true, body);
-                Stmt new_for = For::make(op->name, op->min, op->extent, op->for_type,
-                                         op->device_api, body);
+                Stmt new_for = For::make(op->name, op->min, op->extent, op->for_type, op->partition_policy,
+                                         op->device_api, body, op->parallel_schedule, op->parallel_grain);
                 Stmt prolog =
                     IfThenElse::make(uses_hvx_var, call_halide_qurt_hvx_unlock());
                 Stmt epilog =
@@ -406,8 +406,8 @@ private:
                 //   vector code
                 //   halide_qurt_unlock
                 // }
-                s = For::make(op->name, op->min, op->extent, op->for_type,
-                              op->device_api, body);
+                s = For::make(op->name, op->min, op->extent, op->for_type, op->partition_policy,
+                              op->device_api, body, op->parallel_schedule, op->parallel_grain);
             }
 
             uses_hvx = old_uses_hvx;
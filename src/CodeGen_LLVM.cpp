@@ -478,8 +478,13 @@ void CodeGen_LLVM::init_codegen(const std::string &name, bool any_strict_float)
 }
 
 std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
+    auto *logger = get_compiler_logger();
+    auto time_start = std::chrono::high_resolution_clock::now();
+
     init_codegen(input.name(), input.any_strict_float());
 
+    auto time_init = std::chrono::high_resolution_clock::now();
+
     internal_assert(module && context && builder)
         << "The CodeGen_LLVM subclass should have made an initial module before calling CodeGen_LLVM::compile\n";
 
@@ -603,6 +608,13 @@ std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
 
     debug(2) << "llvm::Module pointer: " << module.get() << "\n";
 
+    if (logger) {
+        auto time_end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> init_time = time_init - time_start, codegen_time = time_end - time_init;
+        logger->record_compilation_pass(CompilerLogger::Phase::LLVM, "initializing the module", init_time.count(), -1, -1);
+        logger->record_compilation_pass(CompilerLogger::Phase::LLVM, "generating LLVM IR", codegen_time.count(), -1, -1);
+    }
+
     return finish_codegen();
 }
 
@@ -1125,17 +1137,45 @@ llvm::Type *CodeGen_LLVM::llvm_type_of(const Type &t) const {
 }
 
 void CodeGen_LLVM::optimize_module() {
+    if (!jit_compiles_lazily(target)) {
+        optimize_module(*module, target);
+        return;
+    }
+
+    // The JIT optimizes each function in a module of its own, just
+    // before it first compiles it, so nothing can be inlined into a
+    // function then. Inline the runtime's always-inline helpers now,
+    // while their bodies are still at hand.
+    debug(3) << "Inlining ahead of lazy JIT compilation\n";
+
+    llvm::PassBuilder pb;
+    llvm::LoopAnalysisManager lam;
+    llvm::FunctionAnalysisManager fam;
+    llvm::CGSCCAnalysisManager cgam;
+    llvm::ModuleAnalysisManager mam;
+    pb.registerModuleAnalyses(mam);
+    pb.registerCGSCCAnalyses(cgam);
+    pb.registerFunctionAnalyses(fam);
+    pb.registerLoopAnalyses(lam);
+    pb.crossRegisterProxies(lam, fam, cgam, mam);
+
+    ModulePassManager mpm;
+    mpm.addPass(AlwaysInlinerPass());
+    mpm.run(*module, mam);
+}
+
+void CodeGen_LLVM::optimize_module(llvm::Module &module, const Target &target) {
     debug(3) << "Optimizing module\n";
 
     auto time_start = std::chrono::high_resolution_clock::now();
 
     if (debug::debug_level() >= 3) {
-        module->print(dbgs(), nullptr, false, true);
+        module.print(dbgs(), nullptr, false, true);
     }
 
-    std::unique_ptr<TargetMachine> tm = make_target_machine(*module);
+    std::unique_ptr<TargetMachine> tm = make_target_machine(module);
 
-    const bool do_loop_opt = get_target().has_feature(Target::EnableLLVMLoopOpt);
+    const bool do_loop_opt = target.has_feature(Target::EnableLLVMLoopOpt);
 
     PipelineTuningOptions pto;
     pto.LoopInterleaving = do_loop_opt;
@@ -1149,7 +1189,45 @@ void CodeGen_LLVM::optimize_module() {
     // 21.04 -> 14.78 using current ToT release build. (See also https://reviews.llvm.org/rL358304)
     pto.ForgetAllSCEVInLoopUnroll = true;
 
-    llvm::PassBuilder pb(tm.get(), pto);
+    // If a CompilerLogger is active, time each pass. Pass managers and
+    // adaptors are passes that run other passes, so each pass is billed
+    // only for the time not spent in the passes it runs.
+    auto *logger = get_compiler_logger();
+    llvm::PassInstrumentationCallbacks pic;
+    struct RunningPass {
+        std::chrono::high_resolution_clock::time_point start;
+        double nested_time;
+    };
+    std::vector<RunningPass> running_passes;
+    const auto pass_done = [&](llvm::StringRef pass_name) {
+        if (running_passes.empty()) {
+            return;
+        }
+        RunningPass p = running_passes.back();
+        running_passes.pop_back();
+        std::chrono::duration<double> diff = std::chrono::high_resolution_clock::now() - p.start;
+        if (!running_passes.empty()) {
+            running_passes.back().nested_time += diff.count();
+        }
+        logger->record_compilation_pass(CompilerLogger::Phase::LLVM, pass_name.str(), diff.count() - p.nested_time, -1, -1);
+    };
+    if (logger) {
+        pic.registerBeforeNonSkippedPassCallback([&](llvm::StringRef, llvm::Any) {
+            running_passes.push_back({std::chrono::high_resolution_clock::now(), 0.0});
+        });
+        pic.registerAfterPassCallback([&](llvm::StringRef pass_name, llvm::Any, const llvm::PreservedAnalyses &) {
+            pass_done(pass_name);
+        });
+        pic.registerAfterPassInvalidatedCallback([&](llvm::StringRef pass_name, const llvm::PreservedAnalyses &) {
+            pass_done(pass_name);
+        });
+    }
+
+#if LLVM_VERSION >= 160
+    llvm::PassBuilder pb(tm.get(), pto, std::nullopt, &pic);
+#else
+    llvm::PassBuilder pb(tm.get(), pto, llvm::None, &pic);
+#endif
 
     bool debug_pass_manager = false;
     // These analysis managers have to be declared in this order.
@@ -1169,7 +1247,7 @@ void CodeGen_LLVM::optimize_module() {
     using OptimizationLevel = llvm::OptimizationLevel;
     OptimizationLevel level = OptimizationLevel::O3;
 
-    if (get_target().has_feature(Target::SanitizerCoverage)) {
+    if (target.has_feature(Target::SanitizerCoverage)) {
         pb.registerOptimizerLastEPCallback(
             [&](ModulePassManager &mpm, OptimizationLevel level) {
                 SanitizerCoverageOptions sanitizercoverage_options;
@@ -1181,7 +1259,7 @@ void CodeGen_LLVM::optimize_module() {
                 sanitizercoverage_options.Inline8bitCounters = true;
                 sanitizercoverage_options.PCTable = true;
                 // Due to TLS differences, stack depth tracking is only enabled on Linux
-                if (get_target().os == Target::OS::Linux) {
+                if (target.os == Target::OS::Linux) {
                     sanitizercoverage_options.StackDepth = true;
                 }
 #if LLVM_VERSION >= 160
@@ -1192,7 +1270,7 @@ void CodeGen_LLVM::optimize_module() {
             });
     }
 
-    if (get_target().has_feature(Target::ASAN)) {
+    if (target.has_feature(Target::ASAN)) {
 #if LLVM_VERSION >= 150
         // Nothing, ASanGlobalsMetadataAnalysis no longer exists
 #else
@@ -1219,7 +1297,7 @@ void CodeGen_LLVM::optimize_module() {
     // Target::MSAN handling is sprinkled throughout the codebase,
     // there is no need to run MemorySanitizerPass here.
 
-    if (get_target().has_feature(Target::TSAN)) {
+    if (target.has_feature(Target::TSAN)) {
         pb.registerOptimizerLastEPCallback(
             [](ModulePassManager &mpm, OptimizationLevel level) {
                 mpm.addPass(
@@ -1227,14 +1305,14 @@ void CodeGen_LLVM::optimize_module() {
             });
     }
 
-    for (auto &function : *module) {
-        if (get_target().has_feature(Target::ASAN)) {
+    for (auto &function : module) {
+        if (target.has_feature(Target::ASAN)) {
             function.addFnAttr(Attribute::SanitizeAddress);
         }
-        if (get_target().has_feature(Target::MSAN)) {
+        if (target.has_feature(Target::MSAN)) {
             function.addFnAttr(Attribute::SanitizeMemory);
         }
-        if (get_target().has_feature(Target::TSAN)) {
+        if (target.has_feature(Target::TSAN)) {
             // Do not annotate any of Halide's low-level synchronization code as it has
             // tsan interface calls to mark its behavior and is much faster if
             // it is not analyzed instruction by instruction.
@@ -1255,18 +1333,17 @@ void CodeGen_LLVM::optimize_module() {
     }
 
     mpm = pb.buildPerModuleDefaultPipeline(level, debug_pass_manager);
-    mpm.run(*module, mam);
+    mpm.run(module, mam);
 
-    if (llvm::verifyModule(*module, &errs())) {
+    if (llvm::verifyModule(module, &errs())) {
         report_fatal_error("Transformation resulted in an invalid module\n");
     }
 
     debug(3) << "After LLVM optimizations:\n";
     if (debug::debug_level() >= 2) {
-        module->print(dbgs(), nullptr, false, true);
+        module.print(dbgs(), nullptr, false, true);
     }
 
-    auto *logger = get_compiler_logger();
     if (logger) {
         auto time_end = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> diff = time_end - time_start;
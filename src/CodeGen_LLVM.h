@@ -85,6 +85,10 @@ public:
         return requested_alloca_total;
     }
 
+    /** Run all of llvm's optimization passes on an llvm module
+     * generated for the target. */
+    static void optimize_module(llvm::Module &module, const Target &target);
+
 protected:
     CodeGen_LLVM(const Target &t);
 
@@ -181,7 +185,10 @@ protected:
      * multiple related modules (e.g. multiple device kernels). */
     virtual void init_module();
 
-    /** Run all of llvm's optimization passes on the module. */
+    /** Run all of llvm's optimization passes on the module. If the
+     * JIT compiles it lazily, only inline what must be inlined, and
+     * leave the rest to the JIT, which optimizes each function as it
+     * compiles it. */
     void optimize_module();
 
     /** Add an entry to the symbol table, hiding previous entries with
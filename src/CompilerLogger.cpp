@@ -17,7 +17,10 @@ namespace {
 // TODO: for now we are just going to ignore potential issues with
 // static-initialization-order-fiasco, as CompilerLogger isn't currently used
 // from any static-initialization execution scope.
-std::unique_ptr<CompilerLogger> active_compiler_logger;
+//
+// Thread-local, so that compile_multitarget can compile several targets
+// at once, each with its own logger.
+thread_local std::unique_ptr<CompilerLogger> active_compiler_logger;
 
 class ObfuscateNames : public IRMutator {
     using IRMutator::visit;
@@ -116,6 +119,21 @@ void JSONCompilerLogger::record_compilation_time(Phase phase, double duration) {
     compilation_time[phase] += duration;
 }
 
+void JSONCompilerLogger::record_compilation_pass(Phase phase, const std::string &pass_name, double duration,
+                                                 int64_t ir_nodes_before, int64_t ir_nodes_after) {
+    auto it = compilation_pass_index.emplace(std::make_pair(phase, pass_name), compilation_passes.size());
+    if (it.second) {
+        compilation_passes.push_back({phase, pass_name, 0, 0.0, -1, -1});
+    }
+    PassStats &p = compilation_passes[it.first->second];
+    p.runs++;
+    p.time += duration;
+    if (ir_nodes_before >= 0 && ir_nodes_after >= 0) {
+        p.ir_nodes_before = std::max<int64_t>(p.ir_nodes_before, 0) + ir_nodes_before;
+        p.ir_nodes_after = std::max<int64_t>(p.ir_nodes_after, 0) + ir_nodes_after;
+    }
+}
+
 void JSONCompilerLogger::obfuscate() {
     {
         std::map<std::string, std::vector<Expr>> n;
@@ -278,6 +296,42 @@ std::ostream &JSONCompilerLogger::emit_to_stream(std::ostream &o) {
         emit_key_value(o, indent, "compilation_time_llvm", compilation_time[Phase::LLVM]);
     }
 
+    if (!compilation_passes.empty()) {
+        // Most expensive first, so that the list reads as a summary of
+        // where the time went. The order gives the position of each
+        // pass in the pipeline.
+        std::vector<size_t> by_time(compilation_passes.size());
+        for (size_t i = 0; i < by_time.size(); i++) {
+            by_time[i] = i;
+        }
+        std::stable_sort(by_time.begin(), by_time.end(), [&](size_t a, size_t b) {
+            return compilation_passes[a].time > compilation_passes[b].time;
+        });
+
+        const std::string spaces(indent + 1, ' ');
+        emit_key(o, indent, "compilation_passes");
+        o << "[\n";
+        int commas_to_emit = (int)by_time.size() - 1;
+        for (size_t i : by_time) {
+            const PassStats &p = compilation_passes[i];
+            const bool counted_nodes = p.ir_nodes_before >= 0;
+            o << spaces << "{\n";
+            emit_key_value(o, indent + 2, "phase", std::string(p.phase == Phase::LLVM ? "llvm" : "halide_lowering"));
+            emit_key_value(o, indent + 2, "name", p.name);
+            emit_key_value(o, indent + 2, "order", i);
+            emit_key_value(o, indent + 2, "runs", p.runs);
+            emit_key_value(o, indent + 2, "time", p.time, counted_nodes);
+            if (counted_nodes) {
+                emit_key_value(o, indent + 2, "ir_nodes_before", p.ir_nodes_before);
+                emit_key_value(o, indent + 2, "ir_nodes_after", p.ir_nodes_after, false);
+            }
+            o << spaces << "}";
+            emit_eol(o, commas_to_emit-- > 0);
+        }
+        o << std::string(indent, ' ') << "]";
+        emit_eol(o);
+    }
+
     if (!matched_simplifier_rules.empty()) {
         emit_object_key_open(o, indent, "matched_simplifier_rules");
 
@@ -15,6 +15,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "Expr.h"
 #include "Target.h"
@@ -53,15 +54,26 @@ public:
      */
     virtual void record_compilation_time(Phase phase, double duration) = 0;
 
+    /** Record the time (in seconds) taken by one run of a single pass
+     * within a phase: a Halide lowering pass, or an LLVM pass or
+     * code-generation stage. For lowering passes, the number of
+     * distinct IR nodes in the Stmt before and after the pass is also
+     * given; otherwise these are -1. Passes may run more than once.
+     * The default implementation ignores this information.
+     */
+    virtual void record_compilation_pass(Phase phase, const std::string &pass_name, double duration,
+                                         int64_t ir_nodes_before, int64_t ir_nodes_after) {
+    }
+
     /**
      * Emit all the gathered data to the given stream. This may be called multiple times.
      */
     virtual std::ostream &emit_to_stream(std::ostream &o) = 0;
 };
 
-/** Set the active CompilerLogger object, replacing any existing one.
- * It is legal to pass in a nullptr (which means "don't do any compiler logging").
- * Returns the previous CompilerLogger (if any). */
+/** Set the active CompilerLogger object for the current thread, replacing
+ * any existing one. It is legal to pass in a nullptr (which means "don't do
+ * any compiler logging"). Returns the previous CompilerLogger (if any). */
 std::unique_ptr<CompilerLogger> set_compiler_logger(std::unique_ptr<CompilerLogger> compiler_logger);
 
 /** Return the currently active CompilerLogger object. If set_compiler_logger()
@@ -90,6 +102,8 @@ public:
     void record_failed_to_prove(Expr failed_to_prove, Expr original_expr) override;
     void record_object_code_size(uint64_t bytes) override;
     void record_compilation_time(Phase phase, double duration) override;
+    void record_compilation_pass(Phase phase, const std::string &pass_name, double duration,
+                                 int64_t ir_nodes_before, int64_t ir_nodes_after) override;
 
     std::ostream &emit_to_stream(std::ostream &o) override;
 
@@ -116,6 +130,19 @@ protected:
     // Map of the time take for each phase of compilation.
     std::map<Phase, double> compilation_time;
 
+    // The runs of each pass of compilation, in the order in which each
+    // pass first ran. IR node counts are summed over all runs, and are
+    // negative if they weren't counted.
+    struct PassStats {
+        Phase phase;
+        std::string name;
+        int runs;
+        double time;
+        int64_t ir_nodes_before, ir_nodes_after;
+    };
+    std::vector<PassStats> compilation_passes;
+    std::map<std::pair<Phase, std::string>, size_t> compilation_pass_index;
+
     void obfuscate();
     void emit();
 };
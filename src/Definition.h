@@ -47,6 +47,14 @@ public:
     Definition(const std::vector<Expr> &args, const std::vector<Expr> &values,
                const ReductionDomain &rdom, bool is_init);
 
+    /** Construct a Definition from all of its fields, e.g. when
+     * deserializing a pipeline. */
+    Definition(bool is_init, const Expr &predicate,
+               const std::vector<Expr> &args, const std::vector<Expr> &values,
+               const StageSchedule &schedule,
+               const std::vector<Specialization> &specializations,
+               const std::string &source_location);
+
     /** Construct an undefined Definition object. */
     Definition();
 
@@ -386,6 +386,44 @@ enum class MemoryType {
     AMXTile,
 };
 
+/** Different ways to handle a loop whose body has boundary conditions
+ * that loop partitioning could remove (see Func::partition). */
+enum class Partition {
+    /** Let the loop partitioning pass decide whether to split the loop
+     * into a prologue, a steady state and an epilogue. */
+    Auto,
+
+    /** Never partition the loop. Use this to avoid the code size of the
+     * prologue and epilogue in loops that don't run often. */
+    Never,
+
+    /** Always partition the loop, and raise an error if it can't be
+     * done. Use this to guarantee a steady state free of boundary
+     * conditions. */
+    Always,
+};
+
+/** Different ways to divide the iterations of a parallel loop among
+ * the threads of Halide's thread pool. */
+enum class ParallelSchedule {
+    /** Each thread claims an equal share of the iterations up front,
+     * and threads that run out of work steal from the others. This has
+     * the least overhead when the iterations cost about the same. */
+    Default,
+
+    /** Threads claim chunks of a fixed number of iterations, in order,
+     * as they become idle. Good for iterations whose cost varies
+     * unpredictably. */
+    Dynamic,
+
+    /** Threads claim chunks of iterations as they become idle, sized in
+     * proportion to the number of iterations remaining divided by the
+     * number of threads, but no smaller than a minimum. The chunks get
+     * smaller towards the end of the loop, so that threads finish
+     * together without claiming every iteration separately. */
+    Guided,
+};
+
 namespace Internal {
 
 /** An enum describing a type of loop traversal. Used in schedules,
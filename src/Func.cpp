@@ -386,6 +386,11 @@ void Stage::set_dim_type(const VarOrRVar &var, ForType t) {
             found = true;
             dim.for_type = t;
 
+            // Any schedule for a parallel loop is given after its type
+            // is set, so that the last directive for the loop wins.
+            dim.parallel_schedule = ParallelSchedule::Default;
+            dim.parallel_grain = Expr();
+
             // If it's an rvar and the for type is parallel, we need to
             // validate that this doesn't introduce a race condition,
             // unless it is flagged explicitly or is a associative atomic operation.
@@ -1554,6 +1559,21 @@ Stage &Stage::unroll(const VarOrRVar &var) {
     return *this;
 }
 
+Stage &Stage::parallel(const VarOrRVar &var, ParallelSchedule schedule, const Expr &grain) {
+    user_assert(grain.defined() && grain.type().is_int() && grain.type().is_scalar())
+        << "In schedule for " << name()
+        << ", the grain of parallel loop " << var.name()
+        << " must be a scalar integer.\n";
+    set_dim_type(var, ForType::Parallel);
+    for (Dim &dim : definition.schedule().dims()) {
+        if (var_name_match(dim.var, var.name())) {
+            dim.parallel_schedule = schedule;
+            dim.parallel_grain = schedule == ParallelSchedule::Default ? Expr() : grain;
+        }
+    }
+    return *this;
+}
+
 Stage &Stage::parallel(const VarOrRVar &var, const Expr &factor, TailStrategy tail) {
     if (var.is_rvar) {
         RVar tmp;
@@ -1593,6 +1613,26 @@ Stage &Stage::unroll(const VarOrRVar &var, const Expr &factor, TailStrategy tail
     return *this;
 }
 
+Stage &Stage::partition(const VarOrRVar &var, Partition policy) {
+    definition.schedule().touched() = true;
+    bool found = false;
+    for (Dim &dim : definition.schedule().dims()) {
+        if (var_name_match(dim.var, var.name())) {
+            found = true;
+            dim.partition_policy = policy;
+        }
+    }
+
+    if (!found) {
+        user_error << "In schedule for " << name()
+                   << ", could not find dimension "
+                   << var.name()
+                   << " to set the partition policy of in vars for function\n"
+                   << dump_argument_list();
+    }
+    return *this;
+}
+
 Stage &Stage::tile(const VarOrRVar &x, const VarOrRVar &y,
                    const VarOrRVar &xo, const VarOrRVar &yo,
                    const VarOrRVar &xi, const VarOrRVar &yi,
@@ -2226,6 +2266,19 @@ Func &Func::async() {
     return *this;
 }
 
+Func &Func::ring_buffer(Expr buffers) {
+    invalidate_cache();
+    user_assert(buffers.defined() && buffers.type().is_int() && buffers.type().is_scalar())
+        << "ring_buffer() of Func " << name() << " requires a scalar integer number of buffers.\n";
+    // A number of buffers that isn't known until the pipeline runs is
+    // checked then instead.
+    user_assert(!is_const(buffers) || can_prove(buffers >= 1))
+        << "ring_buffer() of Func " << name() << " requires at least one buffer, "
+        << "but was given " << buffers << ".\n";
+    func.schedule().ring_buffer() = std::move(buffers);
+    return *this;
+}
+
 Stage Func::specialize(const Expr &c) {
     invalidate_cache();
     return Stage(func, func.definition(), 0).specialize(c);
@@ -2260,6 +2313,12 @@ Func &Func::unroll(const VarOrRVar &var) {
     return *this;
 }
 
+Func &Func::parallel(const VarOrRVar &var, ParallelSchedule schedule, const Expr &grain) {
+    invalidate_cache();
+    Stage(func, func.definition(), 0).parallel(var, schedule, grain);
+    return *this;
+}
+
 Func &Func::parallel(const VarOrRVar &var, const Expr &factor, TailStrategy tail) {
     invalidate_cache();
     Stage(func, func.definition(), 0).parallel(var, factor, tail);
@@ -2278,6 +2337,12 @@ Func &Func::unroll(const VarOrRVar &var, const Expr &factor, TailStrategy tail)
     return *this;
 }
 
+Func &Func::partition(const VarOrRVar &var, Partition policy) {
+    invalidate_cache();
+    Stage(func, func.definition(), 0).partition(var, policy);
+    return *this;
+}
+
 Func &Func::bound(const Var &var, Expr min, Expr extent) {
     user_assert(!min.defined() || Int(32).can_represent(min.type())) << "Can't represent min bound in int32\n";
     user_assert(extent.defined()) << "Extent bound of a Func can't be undefined\n";
@@ -2698,6 +2763,42 @@ Func &Func::fold_storage(const Var &dim, const Expr &factor, bool fold_forward)
     return *this;
 }
 
+Func &Func::tile_storage(const Var &dim, const Expr &factor) {
+    invalidate_cache();
+
+    user_assert(factor.defined() && factor.type().is_int() && factor.type().is_scalar())
+        << "In schedule for " << name()
+        << ", the storage tile factor for var " << dim.name()
+        << " must be a scalar integer.\n";
+    user_assert(!is_const(factor) || can_prove(factor > 0))
+        << "In schedule for " << name()
+        << ", the storage tile factor for var " << dim.name()
+        << " must be positive.\n";
+
+    vector<StorageDim> &dims = func.schedule().storage_dims();
+    for (auto &d : dims) {
+        if (var_name_match(d.var, dim.name())) {
+            d.tile_factor = is_const_one(factor) ? Expr() : cast<int>(factor);
+            return *this;
+        }
+    }
+    user_error << "In schedule for " << name()
+               << ", could not find var " << dim.name()
+               << " to tile the storage of.\n"
+               << dump_dim_list(func.schedule().storage_dims());
+    return *this;
+}
+
+Func &Func::tile_storage(const Var &x, const Var &y, const Expr &xfactor, const Expr &yfactor) {
+    user_assert(x.name() != y.name())
+        << "In schedule for " << name()
+        << ", call to tile_storage references "
+        << x.name() << " twice\n";
+    tile_storage(x, xfactor);
+    tile_storage(y, yfactor);
+    return *this;
+}
+
 Func &Func::compute_at(LoopLevel loop_level) {
     invalidate_cache();
     func.schedule().compute_level() = std::move(loop_level);
@@ -2763,6 +2864,24 @@ Func &Func::store_root() {
     return store_at(LoopLevel::root());
 }
 
+Func &Func::hoist_storage(LoopLevel loop_level) {
+    invalidate_cache();
+    func.schedule().hoist_storage_level() = std::move(loop_level);
+    return *this;
+}
+
+Func &Func::hoist_storage(const Func &f, const RVar &var) {
+    return hoist_storage(LoopLevel(f, var));
+}
+
+Func &Func::hoist_storage(const Func &f, const Var &var) {
+    return hoist_storage(LoopLevel(f, var));
+}
+
+Func &Func::hoist_storage_root() {
+    return hoist_storage(LoopLevel::root());
+}
+
 Func &Func::compute_inline() {
     return compute_at(LoopLevel::inlined());
 }
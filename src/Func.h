@@ -347,8 +347,10 @@ public:
     Stage &vectorize(const VarOrRVar &var);
     Stage &unroll(const VarOrRVar &var);
     Stage &parallel(const VarOrRVar &var, const Expr &task_size, TailStrategy tail = TailStrategy::Auto);
+    Stage &parallel(const VarOrRVar &var, ParallelSchedule schedule, const Expr &grain = 1);
     Stage &vectorize(const VarOrRVar &var, const Expr &factor, TailStrategy tail = TailStrategy::Auto);
     Stage &unroll(const VarOrRVar &var, const Expr &factor, TailStrategy tail = TailStrategy::Auto);
+    Stage &partition(const VarOrRVar &var, Partition policy);
     Stage &tile(const VarOrRVar &x, const VarOrRVar &y,
                 const VarOrRVar &xo, const VarOrRVar &yo,
                 const VarOrRVar &xi, const VarOrRVar &yi, const Expr &xfactor, const Expr &yfactor,
@@ -1453,6 +1455,20 @@ public:
      * manually. */
     Func &parallel(const VarOrRVar &var, const Expr &task_size, TailStrategy tail = TailStrategy::Auto);
 
+    /** Mark a dimension to be traversed in parallel, with its
+     * iterations divided among threads as the given ParallelSchedule
+     * says. For the Dynamic and Guided schedules, grain is the
+     * smallest number of iterations a thread claims at once. Use
+     * these for loops whose iterations vary in cost, e.g. because of
+     * data-dependent reductions, so that threads are not left idle
+     * waiting for one that claimed the expensive iterations:
+     *
+     \code
+     f.parallel(y, ParallelSchedule::Dynamic, 4);
+     \endcode
+     */
+    Func &parallel(const VarOrRVar &var, ParallelSchedule schedule, const Expr &grain = 1);
+
     /** Mark a dimension to be computed all-at-once as a single
      * vector. The dimension should have constant extent -
      * e.g. because it is the inner dimension following a split by a
@@ -1480,6 +1496,20 @@ public:
      * dimension of the split. 'factor' must be an integer. */
     Func &unroll(const VarOrRVar &var, const Expr &factor, TailStrategy tail = TailStrategy::Auto);
 
+    /** Set the loop partitioning policy of a dimension. By default,
+     * loops whose bodies contain boundary conditions (e.g. from
+     * BoundaryConditions::repeat_edge, or a GuardWithIf split) are
+     * split into a prologue, a steady state free of the boundary
+     * conditions, and an epilogue, when Halide can work out where the
+     * steady state begins and ends. Partition::Never turns this off,
+     * to avoid the extra code in loops that don't run often.
+     * Partition::Always makes it an error for the loop not to be
+     * partitioned, so that you can rely on the steady state being free
+     * of boundary conditions, e.g. in a vectorized inner loop. The
+     * outer and inner dimensions of a split inherit the policy of the
+     * dimension that was split. */
+    Func &partition(const VarOrRVar &var, Partition policy);
+
     /** Statically declare that the range over which a function should
      * be evaluated is given by the second and third arguments. This
      * can let Halide perform some optimizations. E.g. if you know
@@ -2100,6 +2130,48 @@ public:
      */
     Func &fold_storage(const Var &dim, const Expr &extent, bool fold_forward = true);
 
+    /** Store realizations of this function in a blocked layout, with
+     * the given storage dimensions divided into blocks of the given
+     * size. The parts of the coordinates within a block are stored
+     * innermost, in the storage order of their dimensions, followed by
+     * the block indices and the untiled dimensions, again in storage
+     * order. Loads and stores are re-indexed to match. Use this when
+     * a consumer walks a large intermediate in tiles, so that each
+     * tile is contiguous in memory. For example:
+     *
+     \code
+     Func f, g;
+     Var x, y, xi, yi;
+     g(x, y) = x*y;
+     f(x, y) = g(y, x);
+     f.tile(x, y, xi, yi, 8, 8);
+     g.compute_root()
+         .align_bounds(x, 8)
+         .align_bounds(y, 8)
+         .tile(x, y, xi, yi, 8, 8)
+         .tile_storage(x, y, 8, 8);
+     \endcode
+     *
+     * stores g as a grid of contiguous 8x8 blocks, which are both
+     * written and read one block at a time. The one-dimensional form
+     * blocks a single dimension, e.g. tile_storage(c, 8) on a Func
+     * of (x, y, c) stores the channels in groups of 8, interleaved
+     * within each group, with the groups stored as planes (like the
+     * NCHWc layout used by many convolution kernels).
+     *
+     * Blocks start at multiples of the block size in the Func's
+     * coordinates, and the allocation covers every block that the
+     * region computed overlaps. Use align_bounds to line the tiles of
+     * the computation up with the blocks. The Func's halide_buffer_t
+     * can't describe a blocked layout, so it can't be passed to extern
+     * stages, used inside GPU kernels unless it is also stored there,
+     * or dumped with debug_to_file.
+     */
+    // @{
+    Func &tile_storage(const Var &x, const Var &y, const Expr &xfactor, const Expr &yfactor);
+    Func &tile_storage(const Var &dim, const Expr &factor);
+    // @}
+
     /** Compute this function as needed for each unique value of the
      * given var for the given calling function f.
      *
@@ -2258,6 +2330,28 @@ public:
      */
     Func &async();
 
+    /** Give the storage of an async() producer the given number of
+     * slots, used in turn by successive iterations of the loops
+     * between its hoist_storage and store_at levels. The producer may
+     * then run ahead of its consumer by up to that many iterations,
+     * instead of one, which smooths out producers whose cost varies
+     * from one iteration to the next. The Func must be async() and
+     * have its storage hoisted with hoist_storage(), and the loops in
+     * between must be serial. For example:
+     *
+     \code
+     Func f, g;
+     Var x, y;
+     g(x, y) = sin(x) * cos(y);
+     f(x, y) = g(x, y) + g(x + 1, y);
+     g.compute_at(f, y).hoist_storage_root().async().ring_buffer(4);
+     \endcode
+     *
+     * lets g compute up to four rows ahead of f, each in its own slot
+     * of a single allocation.
+     */
+    Func &ring_buffer(Expr buffers);
+
     /** Bound the extent of a Func's storage, but not extent of its
      * compute. This can be useful for forcing a function's allocation
      * to be a fixed size, which often means it can go on the stack.
@@ -2374,6 +2468,43 @@ public:
      * outside the outermost loop. */
     Func &store_root();
 
+    /** Hoist the allocation of this Func's storage out to the given
+     * loop, without changing where it is stored. Unlike store_at,
+     * values computed in one iteration of the loops between the
+     * hoist_storage and store_at levels are not reused by the next;
+     * only the memory is. The allocation is sized to the largest
+     * region needed by any of those iterations, so the loops must be
+     * serial and Halide must be able to bound that region. This is
+     * useful to avoid repeated heap allocations when the store_at
+     * level is deep inside a loop nest. For example:
+     *
+     \code
+     Func f, g;
+     Var x, y, xo, xi;
+     g(x, y) = x*y;
+     f(x, y) = g(x - 1, y) + g(x + 1, y);
+     f.split(x, xo, xi, 16);
+     g.compute_at(f, xo).hoist_storage(f, y);
+     \endcode
+     *
+     * allocates a single 18-element buffer for g inside the loop over
+     * y, and reuses it for every tile of 16 values of x.
+     */
+    Func &hoist_storage(const Func &f, const Var &var);
+
+    /** Equivalent to the version of hoist_storage that takes a Var,
+     * but hoists storage to the loop over a dimension of a reduction
+     * domain */
+    Func &hoist_storage(const Func &f, const RVar &var);
+
+    /** Equivalent to the version of hoist_storage that takes a Var,
+     * but hoists storage to a given LoopLevel. */
+    Func &hoist_storage(LoopLevel loop_level);
+
+    /** Equivalent to \ref Func::hoist_storage, but hoists storage
+     * outside the outermost loop. */
+    Func &hoist_storage_root();
+
     /** Aggressively inline all uses of this function. This is the
      * default schedule, so you're unlikely to need to call this. For
      * a Func with an update definition, that means it gets computed
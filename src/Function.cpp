@@ -494,6 +494,50 @@ void Function::deep_copy(string name, const FunctionPtr &copy, DeepCopyMap &copi
     copy->name = std::move(name);
 }
 
+void Function::update_with_deserialization(const std::string &name,
+                                           const std::string &origin_name,
+                                           const std::vector<Type> &output_types,
+                                           const std::vector<Type> &required_types,
+                                           int required_dims,
+                                           const std::vector<std::string> &args,
+                                           const FuncSchedule &func_schedule,
+                                           const Definition &init_def,
+                                           const std::vector<Definition> &updates,
+                                           const std::string &debug_file,
+                                           const std::vector<Parameter> &output_buffers,
+                                           const std::vector<ExternFuncArgument> &extern_arguments,
+                                           const std::string &extern_function_name,
+                                           NameMangling extern_mangling,
+                                           DeviceAPI extern_function_device_api,
+                                           const Expr &extern_proxy_expr,
+                                           bool trace_loads,
+                                           bool trace_stores,
+                                           bool trace_realizations,
+                                           const std::vector<std::string> &trace_tags,
+                                           bool frozen) {
+    contents->name = name;
+    contents->origin_name = origin_name;
+    contents->output_types = output_types;
+    contents->required_types = required_types;
+    contents->required_dims = required_dims;
+    contents->args = args;
+    contents->func_schedule = func_schedule;
+    contents->init_def = init_def;
+    contents->updates = updates;
+    contents->debug_file = debug_file;
+    contents->output_buffers = output_buffers;
+    contents->extern_arguments = extern_arguments;
+    contents->extern_function_name = extern_function_name;
+    contents->extern_mangling = extern_mangling;
+    contents->extern_function_device_api = extern_function_device_api;
+    contents->extern_proxy_expr = extern_proxy_expr;
+    contents->trace_loads = trace_loads;
+    contents->trace_stores = trace_stores;
+    contents->trace_realizations = trace_realizations;
+    contents->trace_tags = trace_tags;
+    contents->frozen = frozen;
+}
+
 void Function::define(const vector<string> &args, vector<Expr> values) {
     user_assert(!frozen())
         << "Func " << name() << " cannot be given a new pure definition, "
@@ -1107,6 +1151,12 @@ void Function::lock_loop_levels() {
     if (schedule.store_level().is_inlined()) {
         schedule.store_level() = schedule.compute_level();
     }
+    // Likewise, an inlined hoist_storage_level means the allocation
+    // is not hoisted at all.
+    schedule.hoist_storage_level().lock();
+    if (schedule.hoist_storage_level().is_inlined()) {
+        schedule.hoist_storage_level() = schedule.store_level();
+    }
     if (contents->init_def.defined()) {
         contents->init_def.schedule().fuse_level().level.lock();
     }
@@ -88,6 +88,31 @@ public:
                    std::map<FunctionPtr, FunctionPtr> &copied_map) const;
     // @}
 
+    /** Overwrite every field of this Function, e.g. when deserializing
+     * a pipeline. References to other Functions in the same group,
+     * including this one, should be weak. */
+    void update_with_deserialization(const std::string &name,
+                                     const std::string &origin_name,
+                                     const std::vector<Type> &output_types,
+                                     const std::vector<Type> &required_types,
+                                     int required_dims,
+                                     const std::vector<std::string> &args,
+                                     const FuncSchedule &func_schedule,
+                                     const Definition &init_def,
+                                     const std::vector<Definition> &updates,
+                                     const std::string &debug_file,
+                                     const std::vector<Parameter> &output_buffers,
+                                     const std::vector<ExternFuncArgument> &extern_arguments,
+                                     const std::string &extern_function_name,
+                                     NameMangling extern_mangling,
+                                     DeviceAPI extern_function_device_api,
+                                     const Expr &extern_proxy_expr,
+                                     bool trace_loads,
+                                     bool trace_stores,
+                                     bool trace_realizations,
+                                     const std::vector<std::string> &trace_tags,
+                                     bool frozen);
+
     /** Add a pure definition to this function. It may not already
      * have a definition. All the free variables in 'value' must
      * appear in the args list. 'value' must not depend on any
@@ -639,8 +639,8 @@ int generate_filter_main_inner(int argc,
     static const char kUsage[] = R"INLINE_CODE(
 gengen
   [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-o OUTPUT_DIR] [-r RUNTIME_NAME]
-  [-d 1|0] [-e EMIT_OPTIONS] [-n FILE_BASE_NAME] [-p PLUGIN_NAME]
-  [-s AUTOSCHEDULER_NAME] [-t TIMEOUT]
+  [-d 1|0] [-e EMIT_OPTIONS] [-j NUM_THREADS] [-n FILE_BASE_NAME]
+  [-p PLUGIN_NAME] [-s AUTOSCHEDULER_NAME] [-t TIMEOUT]
   target=target-string[,target-string...]
   [generator_param=value [...]]
 
@@ -654,6 +654,12 @@ gengen
       schedule, static_library, stmt, stmt_html, compiler_log].
      If omitted, default value is [c_header, static_library, registration].
 
+ -j  The number of targets to compile concurrently when multiple targets are
+     specified. The output does not depend on this value. Defaults to the
+     value of the HL_COMPILE_THREADS environment variable if it is set, and
+     otherwise to the number of cores. Specify 1 to compile one target at a
+     time.
+
  -p  A comma-separated list of shared libraries that will be loaded before the
      generator is run. Useful for custom auto-schedulers. The generator must
      either be linked against a shared libHalide or compiled with -rdynamic
@@ -679,6 +685,7 @@ gengen
         {"-e", ""},
         {"-f", ""},
         {"-g", ""},
+        {"-j", "0"},
         {"-n", ""},
         {"-o", ""},
         {"-p", ""},
@@ -734,6 +741,11 @@ gengen
     user_assert(v_val == "1" || v_val == "0") << "-v must be 0 or 1\n"
                                               << kUsage;
 
+    const auto &j_val = flags_info["-j"];
+    user_assert(!j_val.empty() && j_val.find_first_not_of("0123456789") == std::string::npos)
+        << "-j must be a non-negative integer\n"
+        << kUsage;
+
     const std::vector<std::string> generator_names = generator_factory_provider.enumerate();
 
     const auto create_generator = [&](const std::string &generator_name, const Halide::GeneratorContext &context) -> AbstractGeneratorPtr {
@@ -845,6 +857,7 @@ gengen
     // args.generator_params is already set
     // If true, log the path of all output files to stdout.
     args.log_outputs = (v_val == "1");
+    args.num_threads = std::atoi(j_val.c_str());
 
     // Allow quick-n-dirty use of compiler logging via HL_DEBUG_COMPILER_LOGGER env var
     const bool do_compiler_logging = args.output_types.count(OutputFileType::compiler_log) ||
@@ -1072,7 +1085,7 @@ void execute_generator(const ExecuteGeneratorArgs &args_in) {
                            gen->build_gradient_module(function_name) :
                            gen->build_module(function_name);
             };
-            compile_multitarget(args.function_name, output_files, args.targets, args.suffixes, module_factory, args.compiler_logger_factory);
+            compile_multitarget(args.function_name, output_files, args.targets, args.suffixes, module_factory, args.compiler_logger_factory, args.num_threads);
             if (args.log_outputs) {
                 for (const auto &o : output_files) {
                     std::cout << "Generated file: " << o.second << "\n";
@@ -3943,6 +3943,12 @@ struct ExecuteGeneratorArgs {
 
     // If true, log the path of all output files to stdout.
     bool log_outputs = false;
+
+    // The number of targets to compile concurrently when producing multitarget
+    // output (see compile_multitarget()). If zero, use the HL_COMPILE_THREADS
+    // environment variable if set, otherwise the number of cores. Must be 1 if
+    // create_generator is not safe to call from several threads at once.
+    int num_threads = 0;
 };
 
 /**
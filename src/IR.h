@@ -789,10 +789,18 @@ struct For : public StmtNode<For> {
     std::string name;
     Expr min, extent;
     ForType for_type;
+    Partition partition_policy;
     DeviceAPI device_api;
     Stmt body;
 
-    static Stmt make(const std::string &name, Expr min, Expr extent, ForType for_type, DeviceAPI device_api, Stmt body);
+    /** If the loop is parallel, how its iterations are divided among
+     * threads, and the smallest number of them a thread claims at
+     * once. The grain is undefined for the default schedule. */
+    ParallelSchedule parallel_schedule;
+    Expr parallel_grain;
+
+    static Stmt make(const std::string &name, Expr min, Expr extent, ForType for_type, Partition partition_policy, DeviceAPI device_api, Stmt body,
+                     ParallelSchedule parallel_schedule = ParallelSchedule::Default, Expr parallel_grain = Expr());
 
     bool is_unordered_parallel() const {
         return Halide::Internal::is_unordered_parallel(for_type);
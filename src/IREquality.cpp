@@ -497,8 +497,11 @@ void IRComparer::visit(const For *op) {
 
     compare_names(s->name, op->name);
     compare_scalar(s->for_type, op->for_type);
+    compare_scalar(s->partition_policy, op->partition_policy);
+    compare_scalar(s->parallel_schedule, op->parallel_schedule);
     compare_expr(s->min, op->min);
     compare_expr(s->extent, op->extent);
+    compare_expr(s->parallel_grain, op->parallel_grain);
     compare_stmt(s->body, op->body);
 }
 
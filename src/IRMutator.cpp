@@ -203,14 +203,17 @@ Stmt IRMutator::visit(const ProducerConsumer *op) {
 Stmt IRMutator::visit(const For *op) {
     Expr min = mutate(op->min);
     Expr extent = mutate(op->extent);
+    Expr grain = op->parallel_grain.defined() ? mutate(op->parallel_grain) : Expr();
     Stmt body = mutate(op->body);
     if (min.same_as(op->min) &&
         extent.same_as(op->extent) &&
+        grain.same_as(op->parallel_grain) &&
         body.same_as(op->body)) {
         return op;
     }
     return For::make(op->name, std::move(min), std::move(extent),
-                     op->for_type, op->device_api, std::move(body));
+                     op->for_type, op->partition_policy, op->device_api, std::move(body),
+                     op->parallel_schedule, std::move(grain));
 }
 
 Stmt IRMutator::visit(const Store *op) {
@@ -184,6 +184,36 @@ std::ostream &operator<<(std::ostream &out, const TailStrategy &t) {
     return out;
 }
 
+std::ostream &operator<<(std::ostream &out, const Partition &p) {
+    switch (p) {
+    case Partition::Auto:
+        out << "Auto";
+        break;
+    case Partition::Never:
+        out << "Never";
+        break;
+    case Partition::Always:
+        out << "Always";
+        break;
+    }
+    return out;
+}
+
+std::ostream &operator<<(std::ostream &out, const ParallelSchedule &s) {
+    switch (s) {
+    case ParallelSchedule::Default:
+        out << "Default";
+        break;
+    case ParallelSchedule::Dynamic:
+        out << "Dynamic";
+        break;
+    case ParallelSchedule::Guided:
+        out << "Guided";
+        break;
+    }
+    return out;
+}
+
 ostream &operator<<(ostream &stream, const LoopLevel &loop_level) {
     return stream << "loop_level("
                   << (loop_level.defined() ? loop_level.to_string() : "undefined")
@@ -206,12 +236,12 @@ void IRPrinter::test() {
     internal_assert(expr_source.str() == "((x + 3)*((y/2) + 17))");
 
     Stmt store = Store::make("buf", (x * 17) / (x - 3), y - 1, Parameter(), const_true(), ModulusRemainder());
-    Stmt for_loop = For::make("x", -2, y + 2, ForType::Parallel, DeviceAPI::Host, store);
+    Stmt for_loop = For::make("x", -2, y + 2, ForType::Parallel, Partition::Auto, DeviceAPI::Host, store);
     vector<Expr> args(1);
     args[0] = x % 3;
     Expr call = Call::make(i32, "buf", args, Call::Extern);
     Stmt store2 = Store::make("out", call + 1, x, Parameter(), const_true(), ModulusRemainder(3, 5));
-    Stmt for_loop2 = For::make("x", 0, y, ForType::Vectorized, DeviceAPI::Host, store2);
+    Stmt for_loop2 = For::make("x", 0, y, ForType::Vectorized, Partition::Auto, DeviceAPI::Host, store2);
 
     Stmt producer = ProducerConsumer::make_produce("buf", for_loop);
     Stmt consumer = ProducerConsumer::make_consume("buf", for_loop2);
@@ -781,7 +811,14 @@ void IRPrinter::visit(const ProducerConsumer *op) {
 
 void IRPrinter::visit(const For *op) {
     ScopedBinding<> bind(known_type, op->name);
-    stream << get_indent() << op->for_type << op->device_api << " (" << op->name << ", ";
+    stream << get_indent() << op->for_type << op->device_api;
+    if (op->partition_policy != Partition::Auto) {
+        stream << "<partition=" << op->partition_policy << ">";
+    }
+    if (op->parallel_schedule != ParallelSchedule::Default) {
+        stream << "<schedule=" << op->parallel_schedule << ", grain=" << op->parallel_grain << ">";
+    }
+    stream << " (" << op->name << ", ";
     print_no_parens(op->min);
     stream << ", ";
     print_no_parens(op->extent);
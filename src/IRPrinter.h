@@ -43,6 +43,12 @@ std::ostream &operator<<(std::ostream &stream, const MemoryType &);
 /** Emit a halide tail strategy in human-readable form */
 std::ostream &operator<<(std::ostream &stream, const TailStrategy &t);
 
+/** Emit a halide loop partitioning policy in human-readable form */
+std::ostream &operator<<(std::ostream &stream, const Partition &p);
+
+/** Emit a halide parallel loop schedule in human-readable form */
+std::ostream &operator<<(std::ostream &stream, const ParallelSchedule &s);
+
 /** Emit a halide LoopLevel in human-readable form */
 std::ostream &operator<<(std::ostream &stream, const LoopLevel &);
 
@@ -168,6 +168,9 @@ void IRVisitor::visit(const ProducerConsumer *op) {
 void IRVisitor::visit(const For *op) {
     op->min.accept(this);
     op->extent.accept(this);
+    if (op->parallel_grain.defined()) {
+        op->parallel_grain.accept(this);
+    }
     op->body.accept(this);
 }
 
@@ -431,6 +434,9 @@ void IRGraphVisitor::visit(const ProducerConsumer *op) {
 void IRGraphVisitor::visit(const For *op) {
     include(op->min);
     include(op->extent);
+    if (op->parallel_grain.defined()) {
+        include(op->parallel_grain);
+    }
     include(op->body);
 }
 
@@ -0,0 +1,120 @@
+#include "InternedName.h"
+
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace Halide {
+namespace Internal {
+
+namespace {
+
+// The table is split into shards with their own locks, so that
+// threads lowering different pipelines at the same time rarely wait
+// on each other. Most lookups find a name that is already there, so
+// each shard has a reader-writer lock.
+class InternTable {
+    static constexpr size_t num_shards = 16;
+
+    struct Shard {
+        std::shared_mutex mutex;
+        // The elements of an unordered_map never move, so pointers to
+        // them are stable.
+        std::unordered_map<std::string, std::atomic<int>> names;
+    } shards[num_shards];
+
+    Shard &shard_for(const std::string &s) {
+        return shards[std::hash<std::string>()(s) % num_shards];
+    }
+
+public:
+    // Returns a new reference to the entry for s, or nullptr if s
+    // isn't in the table and add is false.
+    InternedName::Entry *acquire(const std::string &s, bool add) {
+        Shard &shard = shard_for(s);
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.names.find(s);
+            if (it != shard.names.end()) {
+                it->second.fetch_add(1, std::memory_order_relaxed);
+                return &*it;
+            }
+        }
+        if (!add) {
+            return nullptr;
+        }
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.names.emplace(s, 0).first;
+        it->second.fetch_add(1, std::memory_order_relaxed);
+        return &*it;
+    }
+
+    void release_last(InternedName::Entry *e) {
+        Shard &shard = shard_for(e->first);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        // Another thread may have acquired a new reference to the name
+        // since the caller saw the count at one.
+        if (e->second.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            shard.names.erase(shard.names.find(e->first));
+        }
+    }
+
+    size_t size() {
+        size_t result = 0;
+        for (Shard &shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            result += shard.names.size();
+        }
+        return result;
+    }
+};
+
+InternTable &intern_table() {
+    // Deliberately leaked, so that names can still be released while
+    // other static objects are destroyed.
+    static InternTable *table = new InternTable;
+    return *table;
+}
+
+}  // namespace
+
+InternedName::Entry *InternedName::intern(const std::string &s) {
+    if (s.empty()) {
+        return nullptr;
+    }
+    return intern_table().acquire(s, true);
+}
+
+void InternedName::release_last(Entry *e) {
+    intern_table().release_last(e);
+}
+
+const std::string &InternedName::empty_name() {
+    static const std::string *empty = new std::string;
+    return *empty;
+}
+
+bool InternedName::find(const std::string &s, InternedName *result) {
+    if (s.empty()) {
+        if (result) {
+            *result = InternedName();
+        }
+        return true;
+    }
+    InternedName n;
+    n.entry = intern_table().acquire(s, false);
+    if (!n.entry) {
+        return false;
+    }
+    if (result) {
+        *result = std::move(n);
+    }
+    return true;
+}
+
+size_t InternedName::table_size() {
+    return intern_table().size();
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,185 @@
+#ifndef HALIDE_INTERNED_NAME_H
+#define HALIDE_INTERNED_NAME_H
+
+/** \file
+ * Defines InternedName, a handle to a name that can be compared and
+ * hashed without looking at its characters.
+ */
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace Halide {
+namespace Internal {
+
+/** A name that has been stored once in a process-wide table, so that
+ * two InternedNames are equal if and only if they point to the same
+ * string. Comparing and hashing one is as cheap as doing the same to
+ * a pointer, and copying one costs an atomic increment; constructing
+ * one from a std::string costs a hash of the string and a lookup in
+ * the table. Interning is thread-safe. The table entries are
+ * reference-counted, and a name is removed from the table when the
+ * last InternedName referring to it is destroyed, so the table only
+ * holds names that are in use.
+ *
+ * InternedName converts implicitly from std::string, so that code
+ * that takes one (e.g. InternedScope) can also be handed a plain
+ * name. */
+class InternedName {
+public:
+    /** An entry in the table: the name and its reference count. */
+    using Entry = std::pair<const std::string, std::atomic<int>>;
+
+private:
+    // nullptr is the empty name, which is not in the table.
+    Entry *entry = nullptr;
+
+    static Entry *intern(const std::string &s);
+    static void release_last(Entry *e);
+    static const std::string &empty_name();
+
+    void retain() const {
+        if (entry) {
+            entry->second.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void release() {
+        if (entry) {
+            // Dropping the last reference must happen with the table
+            // locked, so that the name can't be interned again at the
+            // same time.
+            int count = entry->second.load(std::memory_order_relaxed);
+            while (count > 1) {
+                if (entry->second.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel)) {
+                    entry = nullptr;
+                    return;
+                }
+            }
+            release_last(entry);
+            entry = nullptr;
+        }
+    }
+
+public:
+    /** The empty name. */
+    InternedName() = default;
+
+    InternedName(const std::string &s)
+        : entry(intern(s)) {
+    }
+
+    InternedName(const InternedName &other)
+        : entry(other.entry) {
+        retain();
+    }
+
+    InternedName(InternedName &&other) noexcept
+        : entry(other.entry) {
+        other.entry = nullptr;
+    }
+
+    InternedName &operator=(const InternedName &other) {
+        if (entry != other.entry) {
+            other.retain();
+            release();
+            entry = other.entry;
+        }
+        return *this;
+    }
+
+    InternedName &operator=(InternedName &&other) noexcept {
+        if (this != &other) {
+            release();
+            entry = other.entry;
+            other.entry = nullptr;
+        }
+        return *this;
+    }
+
+    ~InternedName() {
+        release();
+    }
+
+    /** The name itself. The reference is valid as long as this
+     * InternedName is. */
+    const std::string &name() const {
+        return entry ? entry->first : empty_name();
+    }
+
+    operator const std::string &() const {
+        return name();
+    }
+
+    bool empty() const {
+        return entry == nullptr;
+    }
+
+    bool operator==(const InternedName &other) const {
+        return entry == other.entry;
+    }
+
+    bool operator!=(const InternedName &other) const {
+        return entry != other.entry;
+    }
+
+    /** An arbitrary order, for use in ordered containers. It is not
+     * the order of the names' characters, and it may differ between
+     * runs. */
+    bool operator<(const InternedName &other) const {
+        return entry < other.entry;
+    }
+
+    size_t hash() const {
+        return std::hash<const Entry *>()(entry);
+    }
+
+    /** Find a name in the table without adding it. Returns false if
+     * no InternedName with that name currently exists. */
+    static bool find(const std::string &s, InternedName *result);
+
+    /** The number of names in the table. For testing. */
+    static size_t table_size();
+};
+
+inline std::ostream &operator<<(std::ostream &stream, const InternedName &n) {
+    return stream << n.name();
+}
+
+/** The interned forms of the names a pass has looked up, keyed by the
+ * names themselves. A pass that looks names up in several
+ * InternedScopes can give them one of these to share, so that looking
+ * a name up again costs one hash of its characters, and no lock. Not
+ * thread-safe. */
+class InternedNameCache {
+    std::unordered_map<std::string, InternedName> names;
+
+public:
+    const InternedName &intern(const std::string &name) {
+        auto it = names.find(name);
+        if (it == names.end()) {
+            it = names.emplace(name, InternedName(name)).first;
+        }
+        return it->second;
+    }
+};
+
+}  // namespace Internal
+}  // namespace Halide
+
+namespace std {
+
+template<>
+struct hash<Halide::Internal::InternedName> {
+    size_t operator()(const Halide::Internal::InternedName &n) const {
+        return n.hash();
+    }
+};
+
+}  // namespace std
+
+#endif
@@ -32,6 +32,9 @@ public:
     bool is_const_zero() const {
         return count == 0;
     }
+    bool is_shared() const {
+        return count > 1;
+    }  // True if there is more than one reference
 };
 
 /**
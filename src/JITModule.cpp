@@ -1,6 +1,9 @@
+#include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <mutex>
 #include <set>
+#include <sstream>
 #include <string>
 
 #ifdef _WIN32
@@ -16,11 +19,13 @@
 #include "CodeGen_Internal.h"
 #include "CodeGen_LLVM.h"
 #include "Debug.h"
+#include "IRPrinter.h"
 #include "JITModule.h"
 #include "LLVM_Headers.h"
 #include "LLVM_Output.h"
 #include "LLVM_Runtime_Linker.h"
 #include "Pipeline.h"
+#include "Serialization.h"
 #include "WasmExecutor.h"
 
 namespace Halide {
@@ -293,27 +298,208 @@ public:
     }
 };
 
+// Captures the object code LLVM produces for a module, so that it can
+// be stored in the JIT code cache.
+class CapturingObjectCache : public llvm::ObjectCache {
+public:
+    std::unique_ptr<llvm::MemoryBuffer> object;
+
+    void notifyObjectCompiled(const llvm::Module *, llvm::MemoryBufferRef obj) override {
+        object = llvm::MemoryBuffer::getMemBufferCopy(obj.getBuffer(), obj.getBufferIdentifier());
+    }
+
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *) override {
+        return nullptr;
+    }
+};
+
+// An entry in the JIT code cache is this magic number, the key it was
+// stored under, the sizes of the two parts below as native-endian
+// uint64s, a bitcode module with no code in it but the triple, data
+// layout and module flags of the module that was compiled, and the
+// object code.
+const char jit_code_cache_magic[] = "HLJITC1\n";
+
+// Describe what the code compiled for a Module depends on beyond its
+// serialized form: how its embedded buffers are aligned in memory.
+// Returns false if the Module can't be serialized, because a buffer
+// has newer contents on a device.
+bool describe_buffers_for_jit_code_cache(std::ostream &key, const Module &m) {
+    for (const Module &s : m.submodules()) {
+        if (!describe_buffers_for_jit_code_cache(key, s)) {
+            return false;
+        }
+    }
+    for (const Buffer<> &b : m.buffers()) {
+        if (b.device_dirty()) {
+            return false;
+        }
+        // Loads from embedded buffers assume they are as aligned as
+        // the buffer is now, up to the widest native vector.
+        uintptr_t host = (uintptr_t)b.data();
+        key << "buffer " << b.name() << " align " << std::min<uintptr_t>(host & (0 - host), 128) << "\n";
+    }
+    return true;
+}
+
+// A digest of everything that determines the object code compiled for
+// a Module: the Module itself, serialized, and the versions and flags
+// of the compiler. Returns an empty string if the Module can't be
+// cached.
+std::string jit_code_cache_key(const Module &m) {
+    std::ostringstream key;
+#ifdef HALIDE_VERSION_MAJOR
+    key << "halide " << HALIDE_VERSION_MAJOR << "." << HALIDE_VERSION_MINOR << "." << HALIDE_VERSION_PATCH << "\n";
+#endif
+    key << "llvm " << LLVM_VERSION << " " << LLVM_VERSION_STRING << "\n"
+        << "llvm args " << get_env_variable("HL_LLVM_ARGS") << "\n"
+        << "target " << m.target().to_string() << "\n";
+    if (!describe_buffers_for_jit_code_cache(key, m)) {
+        return std::string();
+    }
+    std::vector<uint8_t> serialized;
+    serialize_module_code(m, serialized);
+    key.write((const char *)serialized.data(), serialized.size());
+    std::string text = key.str();
+    return llvm::toHex(llvm::SHA1::hash(llvm::ArrayRef<uint8_t>((const uint8_t *)text.data(), text.size())),
+                       /* LowerCase */ true);
+}
+
+// Make the bitcode of a module with no code that has the triple, data
+// layout and module flags of the given module, which is all that is
+// needed to link object code compiled from it. Returns an empty string
+// if the module can't be cached because it has global constructors or
+// destructors, which are only found by looking at the IR.
+std::string jit_target_module_bitcode(llvm::Module &m) {
+    if (!llvm::orc::getConstructors(m).empty() || !llvm::orc::getDestructors(m).empty()) {
+        return std::string();
+    }
+    llvm::Module target_module(m.getModuleIdentifier(), m.getContext());
+    target_module.setTargetTriple(m.getTargetTriple());
+    target_module.setDataLayout(m.getDataLayout());
+    llvm::SmallVector<llvm::Module::ModuleFlagEntry, 8> flags;
+    m.getModuleFlagsMetadata(flags);
+    for (const auto &flag : flags) {
+        target_module.addModuleFlag(flag.Behavior, flag.Key->getString(), flag.Val);
+    }
+    std::string bitcode;
+    llvm::raw_string_ostream out(bitcode);
+    llvm::WriteBitcodeToFile(target_module, out);
+    out.flush();
+    return bitcode;
+}
+
+// Look up an entry in the JIT code cache. On a hit, returns the object
+// code and sets target_module to the module made by
+// jit_target_module_bitcode. Entries that can't be read are misses.
+std::unique_ptr<llvm::MemoryBuffer> load_from_jit_code_cache(const std::string &path, const std::string &key,
+                                                             llvm::LLVMContext &context,
+                                                             std::unique_ptr<llvm::Module> *target_module) {
+    auto file = llvm::MemoryBuffer::getFile(path, /* IsText */ false, /* RequiresNullTerminator */ false);
+    if (!file) {
+        return nullptr;
+    }
+    llvm::StringRef entry = (*file)->getBuffer();
+    const size_t magic_size = sizeof(jit_code_cache_magic) - 1;
+    const size_t header_size = magic_size + key.size() + 2 * sizeof(uint64_t);
+    uint64_t sizes[2] = {0, 0};
+    if (entry.size() >= header_size) {
+        memcpy(sizes, entry.data() + magic_size + key.size(), sizeof(sizes));
+    }
+    if (entry.size() < header_size ||
+        entry.substr(0, magic_size) != jit_code_cache_magic ||
+        entry.substr(magic_size, key.size()) != key ||
+        sizes[0] > entry.size() - header_size ||
+        sizes[1] != entry.size() - header_size - sizes[0]) {
+        debug(1) << "Ignoring malformed JIT code cache entry " << path << "\n";
+        return nullptr;
+    }
+    llvm::StringRef bitcode = entry.substr(header_size, sizes[0]);
+    llvm::StringRef object = entry.substr(header_size + sizes[0]);
+    auto parsed = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode, path), context);
+    if (!parsed) {
+        debug(1) << "Ignoring JIT code cache entry " << path << ": " << llvm::toString(parsed.takeError()) << "\n";
+        return nullptr;
+    }
+    *target_module = std::move(*parsed);
+    // Copying the object code also aligns it as the linker expects.
+    return llvm::MemoryBuffer::getMemBufferCopy(object, path);
+}
+
+// Store an entry in the JIT code cache. Entries are written to a
+// temporary file and renamed into place, so concurrent readers never
+// see a partial entry. Concurrent writers of the same key write the
+// same thing, so it doesn't matter which rename wins. Failing to store
+// an entry is not an error.
+void store_in_jit_code_cache(const std::string &dir, const std::string &path, const std::string &key,
+                             const std::string &target_bitcode, const llvm::MemoryBuffer &object) {
+    if (std::error_code ec = llvm::sys::fs::create_directories(dir)) {
+        debug(1) << "Could not create JIT code cache directory " << dir << ": " << ec.message() << "\n";
+        return;
+    }
+    int fd = -1;
+    llvm::SmallString<256> temp_path;
+    if (std::error_code ec = llvm::sys::fs::createUniqueFile(path + ".%%%%%%%%.tmp", fd, temp_path)) {
+        debug(1) << "Could not create a temporary file for " << path << ": " << ec.message() << "\n";
+        return;
+    }
+    llvm::raw_fd_ostream out(fd, /* shouldClose */ true);
+    const uint64_t sizes[2] = {target_bitcode.size(), object.getBufferSize()};
+    out << jit_code_cache_magic << key;
+    out.write((const char *)sizes, sizeof(sizes));
+    out << target_bitcode << object.getBuffer();
+    out.close();
+    std::error_code ec = out.error();
+    if (!ec) {
+        ec = llvm::sys::fs::rename(temp_path, path);
+    }
+    if (ec) {
+        out.clear_error();
+        debug(1) << "Could not write JIT code cache entry " << path << ": " << ec.message() << "\n";
+        llvm::sys::fs::remove(temp_path);
+        return;
+    }
+    debug(1) << "Stored JIT code cache entry " << path << "\n";
+}
+
 }  // namespace
 
 JITModule::JITModule() {
     jit_module = new JITModuleContents();
 }
 
-JITModule::JITModule(const Module &m, const LoweredFunc &fn,
-                     const std::vector<JITModule> &dependencies) {
-    jit_module = new JITModuleContents();
-    std::unique_ptr<llvm::Module> llvm_module(compile_module_to_llvm_module(m, *jit_module->context));
-    std::vector<JITModule> deps_with_runtime = dependencies;
-    std::vector<JITModule> shared_runtime = JITSharedRuntime::get(llvm_module.get(), m.target());
-    deps_with_runtime.insert(deps_with_runtime.end(), shared_runtime.begin(), shared_runtime.end());
-    compile_module(std::move(llvm_module), fn.name, m.target(), deps_with_runtime);
-    // If -time-passes is in HL_LLVM_ARGS, this will print llvm passes time statstics otherwise its no-op.
-    llvm::reportAndResetTimings();
+bool jit_compiles_lazily(const Target &target) {
+    // An LLLazyJIT can only make the stubs it needs on 64-bit x86 and
+    // ARM. The sanitizers instrument whole modules, so they need the
+    // module to be optimized in one piece.
+    return target.has_feature(Target::JIT) &&
+           target.has_feature(Target::LazyJIT) &&
+           target.bits == 64 &&
+           (target.arch == Target::X86 || target.arch == Target::ARM) &&
+           !target.has_feature(Target::ASAN) &&
+           !target.has_feature(Target::MSAN) &&
+           !target.has_feature(Target::TSAN) &&
+           !target.has_feature(Target::SanitizerCoverage);
 }
 
-void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &function_name, const Target &target,
-                               const std::vector<JITModule> &dependencies,
-                               const std::vector<std::string> &requested_exports) {
+namespace {
+
+std::atomic<int> lazily_compiled_functions{0};
+
+// Make an LLJIT for either an llvm module or, if object is non-null,
+// object code compiled from a module with the same target options as
+// the (codeless) llvm module, resolve its symbols against the
+// dependencies, and look up the requested functions. If lazy is true,
+// functions in the llvm module, which must not have been optimized
+// yet, are only optimized and compiled when they are first called, or
+// looked up.
+void link_jit_module(JITModuleContents *contents,
+                     std::unique_ptr<llvm::Module> m, std::unique_ptr<llvm::MemoryBuffer> object,
+                     llvm::ObjectCache *object_cache,
+                     const string &function_name, const Target &target,
+                     const std::vector<JITModule> &dependencies,
+                     const std::vector<std::string> &requested_exports,
+                     bool lazy = false) {
 
     // Ensure that LLVM is initialized
     CodeGen_LLVM::initialize_llvm();
@@ -353,7 +539,7 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     // Create LLJIT
     const auto compilerBuilder = [&](const llvm::orc::JITTargetMachineBuilder & /*jtmb*/)
         -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
-        return std::make_unique<llvm::orc::TMOwningSimpleCompiler>(std::move(*tm));
+        return std::make_unique<llvm::orc::TMOwningSimpleCompiler>(std::move(*tm), object_cache);
     };
 
     llvm::orc::LLJITBuilderState::ObjectLinkingLayerCreator linkerBuilder;
@@ -373,11 +559,35 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
         };
     }
 
-    auto JIT = llvm::cantFail(llvm::orc::LLJITBuilder()
-                                  .setDataLayout(target_data_layout)
-                                  .setCompileFunctionCreator(compilerBuilder)
-                                  .setObjectLinkingLayerCreator(linkerBuilder)
-                                  .create());
+    const auto configure = [&](auto &&builder) -> auto & {
+        return builder.setDataLayout(target_data_layout)
+            .setCompileFunctionCreator(compilerBuilder)
+            .setObjectLinkingLayerCreator(linkerBuilder);
+    };
+
+    internal_assert(!(lazy && object)) << "Object code can't be compiled lazily\n";
+    std::unique_ptr<llvm::orc::LLJIT> JIT;
+    if (lazy) {
+        auto lazy_jit = llvm::cantFail(configure(llvm::orc::LLLazyJITBuilder()).create());
+        lazy_jit->setPartitionFunction(llvm::orc::CompileOnDemandLayer::compileRequested);
+        // Each function is handed over in a module of its own. Optimize
+        // it, and count it, before it is compiled.
+        lazy_jit->getIRTransformLayer().setTransform(
+            [target](llvm::orc::ThreadSafeModule tsm, llvm::orc::MaterializationResponsibility &) {
+                tsm.withModuleDo([&](llvm::Module &module) {
+                    for (const llvm::Function &f : module) {
+                        if (!f.isDeclaration()) {
+                            lazily_compiled_functions++;
+                        }
+                    }
+                    CodeGen_LLVM::optimize_module(module, target);
+                });
+                return llvm::Expected<llvm::orc::ThreadSafeModule>(std::move(tsm));
+            });
+        JIT = std::move(lazy_jit);
+    } else {
+        JIT = llvm::cantFail(configure(llvm::orc::LLJITBuilder()).create());
+    }
 
     auto ctors = llvm::orc::getConstructors(*m);
     llvm::orc::CtorDtorRunner ctorRunner(JIT->getMainJITDylib());
@@ -392,8 +602,22 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     internal_assert(gen) << llvm::toString(gen.takeError()) << "\n";
     JIT->getMainJITDylib().addGenerator(std::move(gen.get()));
 
-    llvm::orc::ThreadSafeModule tsm(std::move(m), std::move(jit_module->context));
-    auto err = JIT->addIRModule(std::move(tsm));
+    llvm::Error err = llvm::Error::success();
+    if (object) {
+        err = JIT->addObjectFile(std::move(object));
+    } else if (lazy) {
+        // Each function is split out into its own module, and is only
+        // optimized and compiled to machine code when it is first
+        // called (through a stub) or looked up. Besides the closures of
+        // parallel loops, lowering has outlined specializations, bounds
+        // queries and the construction of error messages for this, so
+        // they're only compiled if they run. Lowering itself has
+        // already run on the whole pipeline.
+        err = static_cast<llvm::orc::LLLazyJIT &>(*JIT).addLazyIRModule(
+            llvm::orc::ThreadSafeModule(std::move(m), std::move(contents->context)));
+    } else {
+        err = JIT->addIRModule(llvm::orc::ThreadSafeModule(std::move(m), std::move(contents->context)));
+    }
     internal_assert(!err) << llvm::toString(std::move(err)) << "\n";
 
     // Resolve symbol dependencies
@@ -428,12 +652,12 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     // Retrieve function pointers from the compiled module (which also
     // triggers compilation)
     debug(1) << "JIT compiling " << module_name
-             << " for " << target.to_string() << "\n";
+             << " for " << target.to_string() << (lazy ? " lazily" : "") << "\n";
 
-    std::map<std::string, Symbol> exports;
+    std::map<std::string, JITModule::Symbol> exports;
 
-    Symbol entrypoint;
-    Symbol argv_entrypoint;
+    JITModule::Symbol entrypoint;
+    JITModule::Symbol argv_entrypoint;
     if (!function_name.empty()) {
         entrypoint = compile_and_get_function(*JIT, function_name);
         exports[function_name] = entrypoint;
@@ -449,13 +673,71 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     internal_assert(!err) << llvm::toString(std::move(err)) << "\n";
 
     // Stash the various objects that need to stay alive behind a reference-counted pointer.
-    jit_module->exports = exports;
-    jit_module->JIT = std::move(JIT);
-    jit_module->dtorRunner = std::move(dtorRunner);
-    jit_module->dependencies = dependencies;
-    jit_module->entrypoint = entrypoint;
-    jit_module->argv_entrypoint = argv_entrypoint;
-    jit_module->name = function_name;
+    contents->exports = exports;
+    contents->JIT = std::move(JIT);
+    contents->dtorRunner = std::move(dtorRunner);
+    contents->dependencies = dependencies;
+    contents->entrypoint = entrypoint;
+    contents->argv_entrypoint = argv_entrypoint;
+    contents->name = function_name;
+}
+
+}  // namespace
+
+int JITModule::num_lazily_compiled_functions() {
+    return lazily_compiled_functions;
+}
+
+JITModule::JITModule(const Module &m, const LoweredFunc &fn,
+                     const std::vector<JITModule> &dependencies) {
+    jit_module = new JITModuleContents();
+
+    // Look for the object code in the on-disk cache, if there is one.
+    // Lazy compilation never produces the object code for the whole
+    // module, so the cache isn't used for it.
+    const bool lazy = jit_compiles_lazily(m.target());
+    std::string cache_dir = lazy ? "" : get_env_variable("HL_JIT_CACHE_DIR");
+    std::string cache_key, cache_path;
+    std::unique_ptr<llvm::Module> llvm_module;
+    std::unique_ptr<llvm::MemoryBuffer> object;
+    if (!cache_dir.empty()) {
+        cache_key = jit_code_cache_key(m);
+        if (cache_key.empty()) {
+            cache_dir.clear();
+        }
+    }
+    if (!cache_dir.empty()) {
+        cache_path = cache_dir + "/" + cache_key + ".o";
+        object = load_from_jit_code_cache(cache_path, cache_key, *jit_module->context, &llvm_module);
+        debug(1) << "JIT code cache " << (object ? "hit" : "miss") << " for " << fn.name << ": " << cache_path << "\n";
+    }
+
+    std::string target_bitcode;
+    if (!object) {
+        llvm_module = compile_module_to_llvm_module(m, *jit_module->context);
+        if (!cache_dir.empty()) {
+            target_bitcode = jit_target_module_bitcode(*llvm_module);
+        }
+    }
+
+    std::vector<JITModule> deps_with_runtime = dependencies;
+    std::vector<JITModule> shared_runtime = JITSharedRuntime::get(llvm_module.get(), m.target());
+    deps_with_runtime.insert(deps_with_runtime.end(), shared_runtime.begin(), shared_runtime.end());
+    CapturingObjectCache object_cache;
+    link_jit_module(jit_module.get(), std::move(llvm_module), std::move(object),
+                    target_bitcode.empty() ? nullptr : &object_cache,
+                    fn.name, m.target(), deps_with_runtime, {}, lazy);
+    if (object_cache.object) {
+        store_in_jit_code_cache(cache_dir, cache_path, cache_key, target_bitcode, *object_cache.object);
+    }
+    // If -time-passes is in HL_LLVM_ARGS, this will print llvm passes time statstics otherwise its no-op.
+    llvm::reportAndResetTimings();
+}
+
+void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &function_name, const Target &target,
+                               const std::vector<JITModule> &dependencies,
+                               const std::vector<std::string> &requested_exports) {
+    link_jit_module(jit_module.get(), std::move(m), nullptr, nullptr, function_name, target, dependencies, requested_exports);
 }
 
 /*static*/
@@ -465,6 +747,8 @@ JITModule JITModule::make_trampolines_module(const Target &target_arg,
                                              const std::vector<JITModule> &deps) {
     Target target = target_arg;
     target.set_feature(Target::JIT);
+    // Trampolines are compiled eagerly, so they must be optimized by codegen.
+    target.set_feature(Target::LazyJIT, false);
 
     JITModule result;
     std::vector<std::pair<std::string, ExternSignature>> extern_signatures;
@@ -569,6 +853,24 @@ void JITModule::memoization_cache_evict(uint64_t eviction_key) const {
     }
 }
 
+void JITModule::memoization_cache_set_disk_tier(const std::string &directory, uint64_t fingerprint) const {
+    std::map<std::string, Symbol>::const_iterator f =
+        exports().find("halide_memoization_cache_set_disk_tier");
+    if (f != exports().end()) {
+        const char *dir = directory.empty() ? nullptr : directory.c_str();
+        int result = (reinterpret_bits<int (*)(void *, const char *, uint64_t)>(f->second.address))(nullptr, dir, fingerprint);
+        user_assert(result == 0) << "Could not use " << directory << " for the memoization cache\n";
+    }
+}
+
+void JITModule::memoization_cache_get_stats(halide_memoization_cache_stats_t *stats) const {
+    std::map<std::string, Symbol>::const_iterator f =
+        exports().find("halide_memoization_cache_get_stats");
+    if (f != exports().end()) {
+        (reinterpret_bits<int (*)(halide_memoization_cache_stats_t *)>(f->second.address))(stats);
+    }
+}
+
 void JITModule::reuse_device_allocations(bool b) const {
     std::map<std::string, Symbol>::const_iterator f =
         exports().find("halide_reuse_device_allocations");
@@ -577,6 +879,14 @@ void JITModule::reuse_device_allocations(bool b) const {
     }
 }
 
+void JITModule::reuse_host_allocations(bool b) const {
+    std::map<std::string, Symbol>::const_iterator f =
+        exports().find("halide_reuse_host_allocations");
+    if (f != exports().end()) {
+        (reinterpret_bits<int (*)(void *, bool)>(f->second.address))(nullptr, b);
+    }
+}
+
 bool JITModule::compiled() const {
     return jit_module->JIT != nullptr;
 }
@@ -587,6 +897,8 @@ JITHandlers runtime_internal_handlers;
 JITHandlers default_handlers;
 JITHandlers active_handlers;
 int64_t default_cache_size;
+std::string default_cache_disk_directory;
+uint64_t default_cache_disk_fingerprint;
 
 void merge_handlers(JITHandlers &base, const JITHandlers &addins) {
     if (addins.custom_print) {
@@ -965,6 +1277,10 @@ JITModule &make_module(llvm::Module *for_module, Target target,
                 runtime.memoization_cache_set_size(default_cache_size);
             }
 
+            if (!default_cache_disk_directory.empty()) {
+                runtime.memoization_cache_set_disk_tier(default_cache_disk_directory, default_cache_disk_fingerprint);
+            }
+
             runtime.jit_module->name = "MainShared";
         } else {
             runtime.jit_module->name = "GPU";
@@ -1147,11 +1463,31 @@ void JITSharedRuntime::memoization_cache_evict(uint64_t eviction_key) {
     shared_runtimes(MainShared).memoization_cache_evict(eviction_key);
 }
 
+void JITSharedRuntime::memoization_cache_set_disk_tier(const std::string &directory, uint64_t fingerprint) {
+    std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+
+    default_cache_disk_directory = directory;
+    default_cache_disk_fingerprint = fingerprint;
+    shared_runtimes(MainShared).memoization_cache_set_disk_tier(directory, fingerprint);
+}
+
+halide_memoization_cache_stats_t JITSharedRuntime::memoization_cache_get_stats() {
+    std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+    halide_memoization_cache_stats_t stats = {};
+    shared_runtimes(MainShared).memoization_cache_get_stats(&stats);
+    return stats;
+}
+
 void JITSharedRuntime::reuse_device_allocations(bool b) {
     std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
     shared_runtimes(MainShared).reuse_device_allocations(b);
 }
 
+void JITSharedRuntime::reuse_host_allocations(bool b) {
+    std::lock_guard<std::mutex> lock(shared_runtimes_mutex);
+    shared_runtimes(MainShared).reuse_host_allocations(b);
+}
+
 JITCache::JITCache(Target jit_target,
                    std::vector<Argument> arguments,
                    std::map<std::string, JITExtern> jit_externs,
@@ -155,6 +155,13 @@ struct JITModule {
     };
 
     JITModule();
+
+    /** Compile a Halide Module and link it against its dependencies
+     * and the shared runtime. If the HL_JIT_CACHE_DIR environment
+     * variable names a directory, the object code is looked up there
+     * by a digest of the Module, the target, and the Halide and LLVM
+     * versions, and stored there on a miss, so that other processes
+     * can skip LLVM code generation for the same Module. */
     JITModule(const Module &m, const LoweredFunc &fn,
               const std::vector<JITModule> &dependencies = std::vector<JITModule>());
 
@@ -231,6 +238,11 @@ struct JITModule {
     /** Look up a symbol by name in this module or its dependencies. */
     Symbol find_symbol_by_name(const std::string &) const;
 
+    /** The number of functions that modules JIT-compiled lazily
+     * (see jit_compiles_lazily) have compiled so far in this
+     * process. For testing. */
+    static int num_lazily_compiled_functions();
+
     /** Take an llvm module and compile it. The requested exports will
         be available via the exports method. */
     void compile_module(std::unique_ptr<llvm::Module> mod,
@@ -244,9 +256,18 @@ struct JITModule {
     /** See JITSharedRuntime::memoization_cache_evict */
     void memoization_cache_evict(uint64_t eviction_key) const;
 
+    /** See JITSharedRuntime::memoization_cache_set_disk_tier */
+    void memoization_cache_set_disk_tier(const std::string &directory, uint64_t fingerprint) const;
+
+    /** See JITSharedRuntime::memoization_cache_get_stats */
+    void memoization_cache_get_stats(halide_memoization_cache_stats_t *stats) const;
+
     /** See JITSharedRuntime::reuse_device_allocations */
     void reuse_device_allocations(bool) const;
 
+    /** See JITSharedRuntime::reuse_host_allocations */
+    void reuse_host_allocations(bool) const;
+
     /** Return true if compile_module has been called on this module. */
     bool compiled() const;
 };
@@ -271,6 +292,23 @@ public:
      */
     static void memoization_cache_evict(uint64_t eviction_key);
 
+    /** Keep entries evicted from the memoization cache in files in
+     * the given directory, and reload them from there on a miss, so
+     * that they survive the runtime being released or the process
+     * restarting. Files written with a different fingerprint are
+     * ignored. Pass an empty directory to turn this off. If you are
+     * compiling statically, you should include HalideRuntime.h and
+     * call halide_memoization_cache_set_disk_tier() instead.
+     */
+    static void memoization_cache_set_disk_tier(const std::string &directory, uint64_t fingerprint);
+
+    /** Get the hit, miss, and eviction counters and the current
+     * occupancy of the memoization cache. If you are compiling
+     * statically, you should include HalideRuntime.h and call
+     * halide_memoization_cache_get_stats() instead.
+     */
+    static halide_memoization_cache_stats_t memoization_cache_get_stats();
+
     /** Set whether or not Halide may hold onto and reuse device
      * allocations to avoid calling expensive device API allocation
      * functions. If you are compiling statically, you should include
@@ -278,11 +316,27 @@ public:
      * instead. */
     static void reuse_device_allocations(bool);
 
+    /** Set whether or not Halide's default host allocator may hold
+     * onto and reuse freed host allocations, instead of returning
+     * them to the system each time. If you are compiling statically,
+     * you should include HalideRuntime.h and call
+     * halide_reuse_host_allocations instead. */
+    static void reuse_host_allocations(bool);
+
     static void release_all();
 };
 
 void *get_symbol_address(const char *s);
 
+/** Whether pipelines JIT-compiled for the target are compiled lazily,
+ * one function at a time as each function is first called. This is
+ * the case for JIT targets with the lazy_jit feature, on 64-bit x86
+ * and ARM, without sanitizers. Lowering moves branches that don't
+ * always run (e.g. specializations) into functions of their own for
+ * such targets, and codegen leaves the LLVM optimization of each
+ * function to the JIT. */
+bool jit_compiles_lazily(const Target &target);
+
 struct JITCache {
     Target jit_target;
     // Arguments for all inputs and outputs
@@ -8,6 +8,8 @@
 
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <set>
 
 #ifdef _WIN32
 #ifndef NOMINMAX
@@ -336,6 +338,58 @@ std::unique_ptr<llvm::Module> clone_module(const llvm::Module &module_in) {
     return std::move(cloned_module.get());
 }
 
+std::string module_to_bitcode(const llvm::Module &module) {
+    std::string bitcode;
+    llvm::raw_string_ostream out(bitcode);
+    WriteBitcodeToFile(module, out);
+    out.flush();
+    return bitcode;
+}
+
+// Add the globals that a constant refers to to result.
+void find_referenced_globals(const llvm::Constant *c,
+                             std::set<const llvm::GlobalValue *> &result,
+                             std::set<const llvm::Constant *> &visited) {
+    if (!visited.insert(c).second) {
+        return;
+    }
+    if (const auto *g = llvm::dyn_cast<llvm::GlobalValue>(c)) {
+        result.insert(g);
+        return;
+    }
+    for (const llvm::Value *op : c->operand_values()) {
+        if (const auto *op_c = llvm::dyn_cast<llvm::Constant>(op)) {
+            find_referenced_globals(op_c, result, visited);
+        }
+    }
+}
+
+// The globals that the definition of a function or global variable
+// refers to.
+std::set<const llvm::GlobalValue *> referenced_globals(const llvm::GlobalObject &g) {
+    std::set<const llvm::GlobalValue *> result;
+    std::set<const llvm::Constant *> visited;
+    if (const auto *f = llvm::dyn_cast<llvm::Function>(&g)) {
+        if (f->hasPersonalityFn()) {
+            find_referenced_globals(f->getPersonalityFn(), result, visited);
+        }
+        for (const llvm::BasicBlock &bb : *f) {
+            for (const llvm::Instruction &inst : bb) {
+                for (const llvm::Value *op : inst.operand_values()) {
+                    if (const auto *c = llvm::dyn_cast<llvm::Constant>(op)) {
+                        find_referenced_globals(c, result, visited);
+                    }
+                }
+            }
+        }
+    } else if (const auto *v = llvm::dyn_cast<llvm::GlobalVariable>(&g)) {
+        if (v->hasInitializer()) {
+            find_referenced_globals(v->getInitializer(), result, visited);
+        }
+    }
+    return result;
+}
+
 }  // namespace
 
 void emit_file(const llvm::Module &module_in, Internal::LLVMOStream &out,
@@ -410,6 +464,9 @@ void emit_file(const llvm::Module &module_in, Internal::LLVMOStream &out,
         auto time_end = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> diff = time_end - time_start;
         logger->record_compilation_time(Internal::CompilerLogger::Phase::LLVM, diff.count());
+        logger->record_compilation_pass(Internal::CompilerLogger::Phase::LLVM,
+                                        file_type == llvm::CGFT_ObjectFile ? "emitting object code" : "emitting assembly",
+                                        diff.count(), -1, -1);
     }
 
     // If -time-passes is in HL_LLVM_ARGS, this will print llvm passes time statstics otherwise its no-op.
@@ -428,6 +485,123 @@ void compile_llvm_module_to_assembly(llvm::Module &module, Internal::LLVMOStream
     emit_file(module, out, llvm::CGFT_AssemblyFile);
 }
 
+std::vector<std::string> split_llvm_module(const llvm::Module &module_in,
+                                           const std::vector<std::string> &function_names,
+                                           const std::string &symbol_prefix) {
+    // Work on a copy, as we may need to change the linkage of some globals.
+    std::unique_ptr<llvm::Module> module = clone_module(module_in);
+
+    // Each named function gets a part of its own. Part zero holds
+    // everything else.
+    std::map<const llvm::GlobalValue *, int> roots;
+    for (const auto &name : function_names) {
+        const llvm::Function *f = module->getFunction(name);
+        if (f && !f->isDeclaration() && !f->hasComdat() && !roots.count(f)) {
+            const int part = (int)roots.size() + 1;
+            roots.emplace(f, part);
+        }
+    }
+
+    // CloneModule has issues with debug info, and aliases and ifuncs
+    // would have to stay in the same part as what they refer to. Such
+    // modules are rare enough that we don't bother splitting them.
+    if (roots.empty() ||
+        module->getNamedMetadata("llvm.dbg.cu") ||
+        !module->alias_empty() ||
+        !module->ifunc_empty()) {
+        return {module_to_bitcode(*module)};
+    }
+    const int num_parts = (int)roots.size() + 1;
+
+    // Functions that may be discarded if unused (e.g. the runtime's
+    // inlinable helpers) are copied into every part that calls them, so
+    // that they can still be inlined there. Everything else is defined
+    // in exactly one part.
+    const auto is_copied = [&](const llvm::GlobalValue *g) {
+        return llvm::isa<llvm::Function>(g) && g->isDiscardableIfUnused() && !roots.count(g);
+    };
+
+    std::map<const llvm::GlobalValue *, std::set<int>> parts_of;
+    std::vector<std::set<const llvm::GlobalValue *>> used_by(num_parts);
+    std::vector<std::pair<const llvm::GlobalObject *, int>> pending;
+    for (const llvm::GlobalObject &g : module->global_objects()) {
+        if (!g.isDeclaration() && !is_copied(&g)) {
+            auto it = roots.find(&g);
+            pending.emplace_back(&g, it == roots.end() ? 0 : it->second);
+        }
+    }
+    while (!pending.empty()) {
+        const auto [g, part] = pending.back();
+        pending.pop_back();
+        if (!parts_of[g].insert(part).second) {
+            continue;
+        }
+        for (const llvm::GlobalValue *r : referenced_globals(*g)) {
+            used_by[part].insert(r);
+            if (is_copied(r) && !r->isDeclaration()) {
+                pending.emplace_back(llvm::cast<llvm::GlobalObject>(r), part);
+            }
+        }
+    }
+
+    // The linker keeps or discards all the members of a comdat
+    // together, so they must all be defined in the same parts.
+    std::map<const llvm::Comdat *, std::set<int>> parts_of_comdat;
+    for (const auto &[g, parts] : parts_of) {
+        if (const llvm::Comdat *c = llvm::cast<llvm::GlobalObject>(g)->getComdat()) {
+            auto p = parts_of_comdat.emplace(c, parts);
+            if (!p.second && p.first->second != parts) {
+                return {module_to_bitcode(*module)};
+            }
+        }
+    }
+
+    // Definitions with internal linkage that are used from another part
+    // need to be visible to the linker. Give them names that won't
+    // collide with those from other pipelines, and keep them out of
+    // the dynamic symbol table.
+    int unnamed = 0;
+    for (llvm::GlobalObject &g : module->global_objects()) {
+        auto it = parts_of.find(&g);
+        if (!g.hasLocalLinkage() || is_copied(&g) || it == parts_of.end()) {
+            continue;
+        }
+        const int owner = *it->second.begin();
+        bool used_elsewhere = false;
+        for (int part = 0; part < num_parts; part++) {
+            used_elsewhere |= (part != owner && used_by[part].count(&g));
+        }
+        if (used_elsewhere) {
+            std::string name = g.hasName() ? g.getName().str() : "unnamed." + std::to_string(unnamed++);
+            g.setName(symbol_prefix + "." + name);
+            g.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            g.setVisibility(llvm::GlobalValue::HiddenVisibility);
+        }
+    }
+
+    Internal::debug(1) << "split_llvm_module: splitting " << module->getName().str()
+                       << " into " << num_parts << " parts\n";
+    std::vector<std::string> result;
+    for (int part = 0; part < num_parts; part++) {
+        llvm::ValueToValueMapTy value_map;
+        std::unique_ptr<llvm::Module> part_module =
+            llvm::CloneModule(*module, value_map, [&](const llvm::GlobalValue *g) {
+                auto it = parts_of.find(g);
+                return it != parts_of.end() && it->second.count(part);
+            });
+        result.push_back(module_to_bitcode(*part_module));
+    }
+    return result;
+}
+
+void compile_llvm_bitcode_to_object(const std::string &bitcode, Internal::LLVMOStream &out) {
+    llvm::LLVMContext context;
+    llvm::MemoryBufferRef buffer_ref(bitcode, "split_module");
+    auto module = llvm::parseBitcodeFile(buffer_ref, context);
+    internal_assert(module);
+    emit_file(*module.get(), out, llvm::CGFT_ObjectFile);
+}
+
 void compile_llvm_module_to_llvm_bitcode(llvm::Module &module, Internal::LLVMOStream &out) {
     WriteBitcodeToFile(module, out);
 }
@@ -39,6 +39,24 @@ void compile_llvm_module_to_object(llvm::Module &module, Internal::LLVMOStream &
 void compile_llvm_module_to_assembly(llvm::Module &module, Internal::LLVMOStream &out);
 // @}
 
+/** Split an LLVM module into parts that can be compiled to objects
+ * separately and then linked together: one for each of the named
+ * functions (e.g. the closures made for parallel loops), and one for
+ * everything else. Helpers that may be discarded if unused are copied
+ * into each part that calls them. Other definitions with internal
+ * linkage that are used from another part are renamed to start with
+ * symbol_prefix and given hidden visibility. How the module is split
+ * depends only on its contents. The parts are returned as bitcode, so
+ * that each one can be compiled in its own LLVMContext on any thread.
+ * A module that can't be split is returned as a single part. */
+std::vector<std::string> split_llvm_module(const llvm::Module &module,
+                                           const std::vector<std::string> &function_names,
+                                           const std::string &symbol_prefix);
+
+/** Compile one part returned by split_llvm_module to an object. This
+ * may be called from several threads at once. */
+void compile_llvm_bitcode_to_object(const std::string &bitcode, Internal::LLVMOStream &out);
+
 /** Compile an LLVM module to LLVM targets (bitcode, LLVM assembly). */
 // @{
 void compile_llvm_module_to_llvm_bitcode(llvm::Module &module, Internal::LLVMOStream &out);
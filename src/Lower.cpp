@@ -1,8 +1,10 @@
 #include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <set>
 #include <sstream>
+#include <unordered_set>
 
 #include "Lower.h"
 
@@ -35,15 +37,18 @@
 #include "IRMutator.h"
 #include "IROperator.h"
 #include "IRPrinter.h"
+#include "IRVisitor.h"
 #include "InferArguments.h"
 #include "InjectHostDevBufferCopies.h"
 #include "Inline.h"
+#include "JITModule.h"
 #include "LICM.h"
 #include "LoopCarry.h"
 #include "LowerParallelTasks.h"
 #include "LowerWarpShuffles.h"
 #include "Memoization.h"
 #include "OffloadGPULoops.h"
+#include "OutlineBranches.h"
 #include "PartitionLoops.h"
 #include "Prefetch.h"
 #include "Profiling.h"
@@ -63,6 +68,7 @@
 #include "SlidingWindow.h"
 #include "SplitTuples.h"
 #include "StageStridedLoads.h"
+#include "StaticMemoryPlanning.h"
 #include "StorageFlattening.h"
 #include "StorageFolding.h"
 #include "StrictifyFloat.h"
@@ -86,11 +92,43 @@ using std::vector;
 
 namespace {
 
+// Counts the distinct IR nodes in a Stmt.
+class CountIRNodes : public IRGraphVisitor {
+    std::unordered_set<const IRNode *> seen;
+
+    void include(const Expr &e) override {
+        if (seen.insert(e.get()).second) {
+            e.accept(this);
+        }
+    }
+
+    void include(const Stmt &s) override {
+        if (seen.insert(s.get()).second) {
+            s.accept(this);
+        }
+    }
+
+public:
+    int64_t count(const Stmt &s) {
+        include(s);
+        return (int64_t)seen.size();
+    }
+};
+
 class LoweringLogger {
     Stmt last_written;
 
+    // If a CompilerLogger is active, the time since the previous
+    // message is recorded as the time taken by the pass the message
+    // names, along with the size of the IR before and after it.
+    CompilerLogger *compiler_logger = get_compiler_logger();
+    std::chrono::high_resolution_clock::time_point last_time = std::chrono::high_resolution_clock::now();
+    Stmt last_counted;
+    int64_t last_count = 0;
+
 public:
     void operator()(const string &message, const Stmt &s) {
+        record(message, s);
         if (!s.same_as(last_written)) {
             debug(2) << message << "\n"
                      << s << "\n";
@@ -98,6 +136,37 @@ public:
         } else {
             debug(2) << message << " (unchanged)\n\n";
         }
+        if (compiler_logger) {
+            last_time = std::chrono::high_resolution_clock::now();
+        }
+    }
+
+    // Record the pass without printing the IR. Pass an undefined Stmt
+    // for a step that doesn't change the IR.
+    void record(const string &message, const Stmt &s) {
+        if (!compiler_logger) {
+            return;
+        }
+        std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - last_time;
+        string pass_name = message;
+        if (starts_with(pass_name, "Lowering after ")) {
+            pass_name = pass_name.substr(strlen("Lowering after "));
+        }
+        if (ends_with(pass_name, ":")) {
+            pass_name.pop_back();
+        }
+        int64_t before = -1, after = -1;
+        if (s.defined()) {
+            before = last_count;
+            if (!s.same_as(last_counted)) {
+                last_count = CountIRNodes().count(s);
+                last_counted = s;
+            }
+            after = last_count;
+        }
+        compiler_logger->record_compilation_pass(CompilerLogger::Phase::HalideLowering, pass_name,
+                                                 duration.count(), before, after);
+        last_time = std::chrono::high_resolution_clock::now();
     }
 };
 
@@ -114,6 +183,8 @@ void lower_impl(const vector<Function> &output_funcs,
 
     size_t initial_lowered_function_count = result_module.functions().size();
 
+    LoweringLogger log;
+
     // Create a deep-copy of the entire graph of Funcs.
     auto [outputs, env] = deep_copy(output_funcs, build_environment(output_funcs));
 
@@ -136,13 +207,12 @@ void lower_impl(const vector<Function> &output_funcs,
     // Compute a realization order and determine group of functions which loops
     // are to be fused together
     auto [order, fused_groups] = realization_order(outputs, env);
+    log.record("Lowering after computing the realization order", Stmt());
 
     // Try to simplify the RHS/LHS of a function definition by propagating its
     // specializations' conditions
     simplify_specializations(env);
 
-    LoweringLogger log;
-
     debug(1) << "Creating initial loop nests...\n";
     bool any_memoized = false;
     Stmt s = schedule_functions(outputs, fused_groups, env, t, any_memoized);
@@ -166,7 +236,8 @@ void lower_impl(const vector<Function> &output_funcs,
     // Compute the maximum and minimum possible value of each
     // function. Used in later bounds inference passes.
     debug(1) << "Computing bounds of each function's value\n";
-    FuncValueBounds func_bounds = compute_function_value_bounds(order, env);
+    FuncValueBounds func_bounds = compute_function_value_bounds(order, env, true);
+    log.record("Lowering after computing bounds of each function's value", Stmt());
 
     // Clamp unsafe instances where a Func f accesses a Func g using
     // an index which depends on a third Func h.
@@ -349,8 +420,7 @@ void lower_impl(const vector<Function> &output_funcs,
 
     debug(1) << "Rebasing loops to zero...\n";
     s = rebase_loops_to_zero(s);
-    debug(2) << "Lowering after rebasing loops to zero:\n"
-             << s << "\n\n";
+    log("Lowering after rebasing loops to zero:", s);
 
     debug(1) << "Hoisting loop invariant if statements...\n";
     s = hoist_loop_invariant_if_statements(s);
@@ -380,6 +450,17 @@ void lower_impl(const vector<Function> &output_funcs,
         log("Lowering after injecting profiling:", s);
     }
 
+    int64_t scratch_bytes = 0;
+    if (t.has_feature(Target::StaticMemoryPlan) || t.has_feature(Target::ScratchArena)) {
+        user_assert(!(t.has_feature(Target::ScratchArena) && t.has_feature(Target::JIT)))
+            << "The scratch_arena target feature is not supported when JIT-compiling.\n";
+        // Done after profiling is injected, so that the profiler
+        // still reports the memory used by each Func.
+        debug(1) << "Planning static memory...\n";
+        s = plan_static_memory(s, t, scratch_bytes);
+        log("Lowering after planning static memory:", s);
+    }
+
     if (t.has_feature(Target::CUDA)) {
         debug(1) << "Injecting warp shuffles...\n";
         s = lower_warp_shuffles(s, t);
@@ -388,6 +469,7 @@ void lower_impl(const vector<Function> &output_funcs,
 
     debug(1) << "Simplifying...\n";
     s = common_subexpression_elimination(s);
+    log("Lowering after common subexpression elimination:", s);
 
     debug(1) << "Lowering unsafe promises...\n";
     s = lower_unsafe_promises(s, t);
@@ -427,6 +509,7 @@ void lower_impl(const vector<Function> &output_funcs,
         for (size_t i = 0; i < custom_passes.size(); i++) {
             debug(1) << "Running custom lowering pass " << i << "...\n";
             s = custom_passes[i]->mutate(s);
+            log.record("Lowering after custom pass " + std::to_string(i), s);
             debug(1) << "Lowering after custom pass " << i << ":\n"
                      << s << "\n\n";
         }
@@ -435,6 +518,7 @@ void lower_impl(const vector<Function> &output_funcs,
     if (t.arch != Target::Hexagon && t.has_feature(Target::HVX)) {
         debug(1) << "Splitting off Hexagon offload...\n";
         s = inject_hexagon_rpc(s, t, result_module);
+        log.record("Lowering after splitting off Hexagon offload", s);
         debug(2) << "Lowering after splitting off Hexagon offload:\n"
                  << s << "\n";
     } else {
@@ -444,6 +528,7 @@ void lower_impl(const vector<Function> &output_funcs,
     if (t.has_gpu_feature()) {
         debug(1) << "Offloading GPU loops...\n";
         s = inject_gpu_offload(s, t);
+        log.record("Lowering after splitting off GPU loops", s);
         debug(2) << "Lowering after splitting off GPU loops:\n"
                  << s << "\n\n";
     } else {
@@ -475,9 +560,22 @@ void lower_impl(const vector<Function> &output_funcs,
     for (auto &lowered_func : closure_implementations) {
         result_module.append(lowered_func);
     }
+    log.record("Lowering after generating parallel tasks and closures", s);
     debug(2) << "Lowering after generating parallel tasks and closures:\n"
              << s << "\n\n";
 
+    if (jit_compiles_lazily(t)) {
+        debug(1) << "Outlining branches...\n";
+        std::vector<LoweredFunc> outlined;
+        s = outline_branches(s, pipeline_name, outlined);
+        for (auto &lowered_func : outlined) {
+            result_module.append(lowered_func);
+        }
+        log.record("Lowering after outlining branches", s);
+        debug(2) << "Lowering after outlining branches:\n"
+                 << s << "\n\n";
+    }
+
     vector<Argument> public_args = args;
     for (const auto &out : outputs) {
         for (const Parameter &buf : out.output_buffers()) {
@@ -487,6 +585,14 @@ void lower_impl(const vector<Function> &output_funcs,
         }
     }
 
+    if (t.has_feature(Target::ScratchArena)) {
+        // The scratch buffer goes last. Its estimated extent is the
+        // size of arena it needs, so that it appears in the metadata.
+        ArgumentEstimates scratch_estimates;
+        scratch_estimates.buffer_estimates = {Range(0, (int)scratch_bytes)};
+        public_args.emplace_back("__scratch", Argument::InputBuffer, UInt(8), 1, scratch_estimates);
+    }
+
     for (const InferredArgument &arg : inferred_args) {
         if (arg.param.defined() && arg.param.name() == "__user_context") {
             // The user context is always in the inferred args, but is
@@ -169,6 +169,8 @@ struct LowerParallelTasks : public IRMutator {
         Expr min, extent;
         Expr serial;
         std::string name;
+        ParallelSchedule schedule = ParallelSchedule::Default;
+        Expr grain;
     };
 
     using IRMutator::visit;
@@ -212,7 +214,7 @@ struct LowerParallelTasks : public IRMutator {
 
         int num_tasks = (int)(tasks.size());
         std::vector<Expr> tasks_array_args;
-        tasks_array_args.reserve(num_tasks * 9);
+        tasks_array_args.reserve(num_tasks * 11);
 
         std::string closure_name = unique_name("parallel_closure");
         Expr closure_struct_allocation = closure.pack_into_struct();
@@ -233,6 +235,7 @@ struct LowerParallelTasks : public IRMutator {
             const bool use_parallel_for = (num_tasks == 1 &&
                                            min_threads == 0 &&
                                            t.semaphores.empty() &&
+                                           t.schedule == ParallelSchedule::Default &&
                                            !has_task_parent);
 
             Expr closure_task_parent;
@@ -272,6 +275,7 @@ struct LowerParallelTasks : public IRMutator {
                                        Variable::make(Int(32), loop_min_name),
                                        Variable::make(Int(32), loop_extent_name),
                                        ForType::Serial,
+                                       Partition::Auto,
                                        DeviceAPI::None,
                                        t.body);
                 } else {
@@ -339,6 +343,8 @@ struct LowerParallelTasks : public IRMutator {
                 tasks_array_args.emplace_back(t.extent);
                 tasks_array_args.emplace_back(min_threads);
                 tasks_array_args.emplace_back(Cast::make(Bool(), t.serial));
+                tasks_array_args.emplace_back((int)t.schedule);
+                tasks_array_args.emplace_back(t.grain.defined() ? cast<int>(t.grain) : 1);
             }
         }
 
@@ -380,7 +386,8 @@ struct LowerParallelTasks : public IRMutator {
             result.emplace_back(std::move(t));
         } else if (loop && loop->for_type == ForType::Parallel) {
             add_suffix(prefix, ".par_for." + loop->name);
-            ParallelTask t{loop->body, {}, loop->name, loop->min, loop->extent, const_false(), task_debug_name(prefix)};
+            ParallelTask t{loop->body, {}, loop->name, loop->min, loop->extent, const_false(), task_debug_name(prefix),
+                           loop->parallel_schedule, loop->parallel_grain};
             result.emplace_back(std::move(t));
         } else if (loop &&
                    loop->for_type == ForType::Serial &&
@@ -1,9 +1,10 @@
 #include "Module.h"
 
 #include <array>
+#include <atomic>
 #include <fstream>
-#include <future>
 #include <memory>
+#include <thread>
 #include <utility>
 
 #include "CodeGen_C.h"
@@ -18,6 +19,7 @@
 #include "LLVM_Runtime_Linker.h"
 #include "Pipeline.h"
 #include "PythonExtensionGen.h"
+#include "Scope.h"
 #include "StmtToViz.h"
 
 namespace Halide {
@@ -312,6 +314,81 @@ $NAMESPACECLOSE$
     stream << s;
 }
 
+// The number of threads that jobs started from inside a job of
+// run_compile_jobs may use, or zero outside of any job.
+thread_local int compile_job_threads = 0;
+
+// Run the jobs on up to num_threads threads, counting the calling
+// thread. Each job generates names with its own copy of the
+// unique_name counters, all taken before any job starts, so what a job
+// produces doesn't depend on how the jobs are scheduled. If any job
+// fails, no new jobs are started, and the error from the failed job
+// earliest in the list is rethrown once the running jobs finish. Jobs
+// may run jobs of their own (e.g. split codegen for one target of
+// compile_multitarget), which share the threads of the outer call
+// rather than each starting num_threads more.
+void run_compile_jobs(const std::vector<std::function<void()>> &jobs, int num_threads) {
+    if (compile_job_threads > 0) {
+        num_threads = std::min(num_threads, compile_job_threads);
+    }
+    const int thread_budget = std::max(1, num_threads);
+    num_threads = std::min(thread_budget, std::max(1, (int)jobs.size()));
+    const int threads_per_job = thread_budget / num_threads;
+
+    const UniqueNameCounters initial_counters;
+    std::vector<UniqueNameCounters> counters(jobs.size(), initial_counters);
+    std::atomic<size_t> next_job{0};
+    std::atomic<bool> failed{false};
+#ifdef HALIDE_WITH_EXCEPTIONS
+    std::vector<std::exception_ptr> exceptions(jobs.size());
+#endif
+
+    const auto worker = [&]() {
+        ScopedValue<int> bind_compile_job_threads(compile_job_threads, threads_per_job);
+        size_t i;
+        while (!failed && (i = next_job++) < jobs.size()) {
+            ScopedUniqueNameCounters scoped_counters(counters[i]);
+#ifdef HALIDE_WITH_EXCEPTIONS
+            try {
+#endif
+                jobs[i]();
+#ifdef HALIDE_WITH_EXCEPTIONS
+            } catch (...) {
+                exceptions[i] = std::current_exception();
+                failed = true;
+            }
+#endif
+        }
+    };
+
+    debug(1) << "run_compile_jobs: running " << jobs.size() << " jobs on " << num_threads << " threads\n";
+    std::vector<std::thread> threads;
+    for (int i = 1; i < num_threads; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    for (const auto &c : counters) {
+        c.publish();
+    }
+#ifdef HALIDE_WITH_EXCEPTIONS
+    for (const auto &e : exceptions) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+#endif
+}
+
+// The number of threads to compile on when the caller doesn't say.
+int default_compile_threads() {
+    std::string env = get_env_variable("HL_COMPILE_THREADS");
+    return env.empty() ? (int)std::thread::hardware_concurrency() : std::atoi(env.c_str());
+}
+
 }  // namespace
 
 struct ModuleContents {
@@ -584,7 +661,40 @@ void Module::compile(const std::map<OutputFileType, std::string> &output_files)
             // (Use a separate TemporaryFileDir here so we don't try to embed assembly files from
             // `temp_assembly_dir` into a static library...)
             TemporaryFileDir temp_object_dir;
-            {
+            if (get_env_variable("HL_SPLIT_CODEGEN") == "1") {
+                // Generate code for each parallel closure in its own
+                // object, on as many threads as we're allowed (a share of
+                // them inside compile_multitarget's jobs). How the
+                // module is split depends only on its contents, so the
+                // library is the same whatever the number of threads.
+                std::vector<std::string> closure_names;
+                for (const auto &f : functions()) {
+                    if (f.linkage == LinkageType::Internal) {
+                        closure_names.push_back(f.name);
+                    }
+                }
+                const std::vector<std::string> parts = split_llvm_module(*llvm_module, closure_names, c_print_name(name(), false));
+                std::vector<std::string> objects;
+                std::vector<std::function<void()>> jobs;
+                for (size_t i = 0; i < parts.size(); i++) {
+                    objects.push_back(temp_object_dir.add_temp_object_file(output_files.at(OutputFileType::static_library),
+                                                                           i == 0 ? "" : "_" + std::to_string(i), target()));
+                    jobs.emplace_back([&, i]() {
+                        debug(1) << "Module.compile(): temporary object " << objects[i] << "\n";
+                        auto out = make_raw_fd_ostream(objects[i]);
+                        compile_llvm_bitcode_to_object(parts[i], *out);
+                        out->flush();
+                    });
+                }
+                run_compile_jobs(jobs, default_compile_threads());
+                if (logger && !contains(output_files, OutputFileType::object)) {
+                    uint64_t size = 0;
+                    for (const auto &object : objects) {
+                        size += file_stat(object).file_size;
+                    }
+                    logger->record_object_code_size(size);
+                }
+            } else {
                 std::string object = temp_object_dir.add_temp_object_file(output_files.at(OutputFileType::static_library), "", target());
                 debug(1) << "Module.compile(): temporary object " << object << "\n";
                 auto out = make_raw_fd_ostream(object);
@@ -757,7 +867,8 @@ void compile_multitarget(const std::string &fn_name,
                          const std::vector<Target> &targets,
                          const std::vector<std::string> &suffixes,
                          const ModuleFactory &module_factory,
-                         const CompilerLoggerFactory &compiler_logger_factory) {
+                         const CompilerLoggerFactory &compiler_logger_factory,
+                         int num_threads) {
     validate_outputs(output_files);
 
     user_assert(!fn_name.empty()) << "Function name must be specified.\n";
@@ -835,9 +946,16 @@ void compile_multitarget(const std::string &fn_name,
     TemporaryFileDir temp_obj_dir, temp_compiler_log_dir;
     std::vector<Expr> wrapper_args;
     std::vector<LoweredArgument> base_target_args;
-    std::vector<AutoSchedulerResults> auto_scheduler_results;
+    std::vector<AutoSchedulerResults> auto_scheduler_results(targets.size());
     MetadataNameMap metadata_name_map;
 
+    // The names and output paths of all the sub-targets are worked out
+    // up front, in order, so that the temporary files (and thus the
+    // members of a static library) are ordered the same way no matter
+    // which sub-target finishes compiling first.
+    std::vector<std::string> sub_fn_names(targets.size());
+    std::vector<std::map<OutputFileType, std::string>> sub_outs(targets.size());
+
     for (size_t i = 0; i < targets.size(); ++i) {
         const Target &target = targets[i];
 
@@ -857,6 +975,7 @@ void compile_multitarget(const std::string &fn_name,
             Target::NoRuntime,
             Target::TSAN,
             Target::SanitizerCoverage,
+            Target::ScratchArena,
             Target::UserContext,
         }};
         for (auto f : must_match_features) {
@@ -869,37 +988,21 @@ void compile_multitarget(const std::string &fn_name,
         // Each sub-target has a function name that is the 'real' name plus a suffix
         std::string suffix = suffix_for_entry(i);
         std::string sub_fn_name = needs_wrapper ? (fn_name + suffix) : fn_name;
+        sub_fn_names[i] = sub_fn_name;
 
-        // We always produce the runtime separately, so add NoRuntime explicitly.
-        Target sub_fn_target = target.with_feature(Target::NoRuntime);
-
-        {
-            ScopedCompilerLogger activate(compiler_logger_factory, sub_fn_name, sub_fn_target);
-            Module sub_module = module_factory(sub_fn_name, sub_fn_target);
-            // Re-assign every time -- should be the same across all targets anyway,
-            // but base_target is always the last one we encounter.
-            base_target_args = sub_module.get_function_by_name(sub_fn_name).args;
-
-            auto sub_out = add_suffixes(output_files, suffix);
-            if (contains(output_files, OutputFileType::static_library)) {
-                sub_out[OutputFileType::object] = temp_obj_dir.add_temp_object_file(output_files.at(OutputFileType::static_library), suffix, target);
-                sub_out.erase(OutputFileType::static_library);
-            }
-            sub_out.erase(OutputFileType::registration);
-            sub_out.erase(OutputFileType::schedule);
-            sub_out.erase(OutputFileType::c_header);
-            sub_out.erase(OutputFileType::function_info_header);
-            if (contains(sub_out, OutputFileType::compiler_log)) {
-                sub_out[OutputFileType::compiler_log] = temp_compiler_log_dir.add_temp_file(output_files.at(OutputFileType::compiler_log), suffix, target);
-            }
-            debug(1) << "compile_multitarget: compile_sub_target " << sub_out[OutputFileType::object] << "\n";
-            sub_module.compile(sub_out);
-            const auto *r = sub_module.get_auto_scheduler_results();
-            auto_scheduler_results.push_back(r ? *r : AutoSchedulerResults());
-            if (target == base_target) {
-                metadata_name_map = sub_module.get_metadata_name_map();
-            }
+        auto sub_out = add_suffixes(output_files, suffix);
+        if (contains(output_files, OutputFileType::static_library)) {
+            sub_out[OutputFileType::object] = temp_obj_dir.add_temp_object_file(output_files.at(OutputFileType::static_library), suffix, target);
+            sub_out.erase(OutputFileType::static_library);
         }
+        sub_out.erase(OutputFileType::registration);
+        sub_out.erase(OutputFileType::schedule);
+        sub_out.erase(OutputFileType::c_header);
+        sub_out.erase(OutputFileType::function_info_header);
+        if (contains(sub_out, OutputFileType::compiler_log)) {
+            sub_out[OutputFileType::compiler_log] = temp_compiler_log_dir.add_temp_file(output_files.at(OutputFileType::compiler_log), suffix, target);
+        }
+        sub_outs[i] = std::move(sub_out);
 
         uint64_t cur_target_features[kFeaturesWordCount] = {0};
         for (int i = 0; i < Target::FeatureEnd; ++i) {
@@ -929,6 +1032,30 @@ void compile_multitarget(const std::string &fn_name,
         wrapper_args.emplace_back(sub_fn_name);
     }
 
+    // Each sub-target is lowered and compiled independently (each
+    // Module::compile() uses its own LLVMContext), so they can be
+    // compiled concurrently, along with the runtime.
+    std::vector<std::function<void()>> jobs;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        jobs.emplace_back([&, i]() {
+            const Target &target = targets[i];
+            // We always produce the runtime separately, so add NoRuntime explicitly.
+            Target sub_fn_target = target.with_feature(Target::NoRuntime);
+
+            ScopedCompilerLogger activate(compiler_logger_factory, sub_fn_names[i], sub_fn_target);
+            Module sub_module = module_factory(sub_fn_names[i], sub_fn_target);
+            debug(1) << "compile_multitarget: compile_sub_target " << sub_outs[i][OutputFileType::object] << "\n";
+            sub_module.compile(sub_outs[i]);
+            const auto *r = sub_module.get_auto_scheduler_results();
+            auto_scheduler_results[i] = r ? *r : AutoSchedulerResults();
+            // The base target is always the last one.
+            if (i == targets.size() - 1) {
+                base_target_args = sub_module.get_function_by_name(sub_fn_names[i]).args;
+                metadata_name_map = sub_module.get_metadata_name_map();
+            }
+        });
+    }
+
     // If we haven't specified "no runtime", build a runtime with the base target
     // and add that to the result.
     if (!base_target.has_feature(Target::NoRuntime)) {
@@ -949,11 +1076,18 @@ void compile_multitarget(const std::string &fn_name,
                                        temp_obj_dir.add_temp_object_file(output_files.at(OutputFileType::static_library), "_runtime", runtime_target) :
                                        add_suffix(output_files.at(OutputFileType::object), "_runtime");
 
-        std::map<OutputFileType, std::string> runtime_out =
-            {{OutputFileType::object, runtime_path}};
-        debug(1) << "compile_multitarget: compile_standalone_runtime " << runtime_out.at(OutputFileType::object) << "\n";
-        compile_standalone_runtime(runtime_out, runtime_target);
+        jobs.emplace_back([=]() {
+            std::map<OutputFileType, std::string> runtime_out =
+                {{OutputFileType::object, runtime_path}};
+            debug(1) << "compile_multitarget: compile_standalone_runtime " << runtime_out.at(OutputFileType::object) << "\n";
+            compile_standalone_runtime(runtime_out, runtime_target);
+        });
+    }
+
+    if (num_threads <= 0) {
+        num_threads = default_compile_threads();
     }
+    run_compile_jobs(jobs, num_threads);
 
     if (needs_wrapper) {
         Expr indirect_result = Call::make(Int(32), Call::call_cached_indirect_function, wrapper_args, Call::Intrinsic);
@@ -221,12 +221,22 @@ std::map<OutputFileType, std::string> compile_standalone_runtime(const std::map<
 using ModuleFactory = std::function<Module(const std::string &fn_name, const Target &target)>;
 using CompilerLoggerFactory = std::function<std::unique_ptr<Internal::CompilerLogger>(const std::string &fn_name, const Target &target)>;
 
+/** Compile a pipeline for several targets into a single set of outputs,
+ * with a wrapper that picks the best target the host supports at runtime.
+ * The module_factory is called once per target to produce the Module to
+ * compile; the targets are compiled concurrently on up to num_threads
+ * threads, so module_factory and compiler_logger_factory must be safe to
+ * call from several threads at once unless num_threads is 1. If
+ * num_threads is zero, the HL_COMPILE_THREADS environment variable is used
+ * if set, otherwise the number of cores. The outputs are identical for any
+ * number of threads. */
 void compile_multitarget(const std::string &fn_name,
                          const std::map<OutputFileType, std::string> &output_files,
                          const std::vector<Target> &targets,
                          const std::vector<std::string> &suffixes,
                          const ModuleFactory &module_factory,
-                         const CompilerLoggerFactory &compiler_logger_factory = nullptr);
+                         const CompilerLoggerFactory &compiler_logger_factory = nullptr,
+                         int num_threads = 0);
 
 }  // namespace Halide
 
@@ -0,0 +1,206 @@
+#include "OutlineBranches.h"
+
+#include "Argument.h"
+#include "Closure.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Module.h"
+#include "Scope.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+namespace {
+
+class ContainsLoop : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const For *op) override {
+        result = true;
+    }
+
+public:
+    bool result = false;
+};
+
+bool contains_loop(const Stmt &s) {
+    ContainsLoop c;
+    s.accept(&c);
+    return c.result;
+}
+
+class UsesBoundsQuery : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Call *op) override {
+        result = result || op->name == Call::buffer_is_bounds_query;
+        IRVisitor::visit(op);
+    }
+
+public:
+    bool result = false;
+};
+
+bool uses_bounds_query(const Expr &e) {
+    UsesBoundsQuery u;
+    e.accept(&u);
+    return u.result;
+}
+
+// Codegen frees an allocation, and runs the destructors of the
+// objects it was told about, in the function that made them. Code
+// that frees something allocated outside of it, or registers a
+// destructor for something made outside of it, can't be moved to
+// another function.
+class CleansUpEnclosingCode : public IRVisitor {
+    using IRVisitor::visit;
+
+    Scope<> inside;
+
+    void visit(const LetStmt *op) override {
+        op->value.accept(this);
+        ScopedBinding<> bind(inside, op->name);
+        op->body.accept(this);
+    }
+
+    void visit(const Allocate *op) override {
+        ScopedBinding<> bind(inside, op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Free *op) override {
+        result = result || !inside.contains(op->name);
+    }
+
+    void visit(const Call *op) override {
+        if (op->is_intrinsic(Call::register_destructor)) {
+            const Variable *obj = op->args[1].as<Variable>();
+            result = result || !obj || !inside.contains(obj->name);
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    bool result = false;
+};
+
+bool can_outline(const Stmt &s) {
+    CleansUpEnclosingCode c;
+    s.accept(&c);
+    return !c.result;
+}
+
+class OutlineBranches : public IRMutator {
+    using IRMutator::visit;
+
+    const std::string &pipeline_name;
+    std::vector<LoweredFunc> &outlined;
+
+    // Code inside loops runs many times, so calling a function for it
+    // would cost more than compiling it up front saves.
+    int loop_depth = 0;
+
+    // Move s into a function of its own, and return a call to it,
+    // which returns the function's error code.
+    Expr outline(const Stmt &s, const std::string &suffix) {
+        Closure closure;
+        closure.include(s);
+
+        // The same name can appear as a var and a buffer. Remove the
+        // var name in this case. Other functions (e.g. the closures of
+        // parallel loops) can be named anywhere, so aren't passed.
+        for (const auto &b : closure.buffers) {
+            closure.vars.erase(b.first);
+        }
+        for (auto it = closure.vars.begin(); it != closure.vars.end();) {
+            if (starts_with(it->first, "::")) {
+                it = closure.vars.erase(it);
+            } else {
+                it++;
+            }
+        }
+
+        const std::string closure_name = unique_name("outlined_closure");
+        const std::string closure_arg_name = unique_name("closure_arg");
+        Expr closure_struct_allocation = closure.pack_into_struct();
+        Expr closure_arg = Variable::make(closure_struct_allocation.type(), closure_arg_name);
+
+        std::vector<LoweredArgument> args = {
+            LoweredArgument("__user_context", Argument::Kind::InputScalar, type_of<void *>(), 0, ArgumentEstimates()),
+            LoweredArgument(closure_arg_name, Argument::Kind::InputScalar, type_of<uint8_t *>(), 0, ArgumentEstimates())};
+
+        const std::string name = c_print_name(unique_name(pipeline_name + suffix), false);
+        outlined.emplace_back(name, args, closure.unpack_from_struct(closure_arg, s),
+                              LinkageType::Internal, NameMangling::C);
+
+        Expr user_context = Call::make(type_of<void *>(), Call::get_user_context, {}, Call::PureIntrinsic);
+        Expr closure_struct = Cast::make(type_of<uint8_t *>(), Variable::make(Handle(), closure_name));
+        Expr call = Call::make(Int(32), name, {user_context, closure_struct}, Call::Extern);
+        return Let::make(closure_name, closure_struct_allocation, call);
+    }
+
+    Stmt outline_branch(const Stmt &s) {
+        Stmt body = mutate(s);
+        std::string result_name = unique_name("outlined_result");
+        Expr result = Variable::make(Int(32), result_name);
+        return LetStmt::make(result_name, outline(body, ".branch"),
+                             AssertStmt::make(result == 0, result));
+    }
+
+    bool worth_outlining(const Stmt &s, bool bounds_query) {
+        return s.defined() && (bounds_query || contains_loop(s)) && can_outline(s);
+    }
+
+    Stmt visit(const For *op) override {
+        ScopedValue<int> old_loop_depth(loop_depth, loop_depth + 1);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const IfThenElse *op) override {
+        if (loop_depth > 0) {
+            return IRMutator::visit(op);
+        }
+        const bool bounds_query = uses_bounds_query(op->condition);
+        Stmt then_case, else_case;
+        if (worth_outlining(op->then_case, bounds_query)) {
+            then_case = outline_branch(op->then_case);
+        } else {
+            then_case = mutate(op->then_case);
+        }
+        if (worth_outlining(op->else_case, bounds_query)) {
+            else_case = outline_branch(op->else_case);
+        } else if (op->else_case.defined()) {
+            else_case = mutate(op->else_case);
+        }
+        if (then_case.same_as(op->then_case) && else_case.same_as(op->else_case)) {
+            return op;
+        }
+        return IfThenElse::make(op->condition, then_case, else_case);
+    }
+
+    Stmt visit(const AssertStmt *op) override {
+        // The message is only built if the assertion fails. Build it in
+        // a function that returns the error code.
+        if (!op->message.as<Call>()) {
+            return op;
+        }
+        Stmt fail = AssertStmt::make(const_false(), op->message);
+        return AssertStmt::make(op->condition, outline(fail, ".error"));
+    }
+
+public:
+    OutlineBranches(const std::string &pipeline_name, std::vector<LoweredFunc> &outlined)
+        : pipeline_name(pipeline_name), outlined(outlined) {
+    }
+};
+
+}  // namespace
+
+Stmt outline_branches(const Stmt &s, const std::string &pipeline_name,
+                      std::vector<LoweredFunc> &outlined) {
+    return OutlineBranches(pipeline_name, outlined).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
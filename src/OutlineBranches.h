@@ -0,0 +1,32 @@
+#ifndef HALIDE_OUTLINE_BRANCHES_H
+#define HALIDE_OUTLINE_BRANCHES_H
+
+/** \file
+ * Defines a lowering pass that moves code that doesn't run on every
+ * call to a pipeline into functions of its own.
+ */
+
+#include <string>
+#include <vector>
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+struct LoweredFunc;
+
+/** Move the branches of the ifs outside of all loops that contain
+ * loops (e.g. specializations, and the body of the pipeline, which
+ * bounds queries skip) or that answer bounds queries, and the code
+ * that builds the messages of failed assertions, into functions of
+ * their own, appended to outlined. The branches are replaced with
+ * calls to those functions. A JIT that compiles functions lazily
+ * then only compiles this code if it runs. */
+Stmt outline_branches(const Stmt &s, const std::string &pipeline_name,
+                      std::vector<LoweredFunc> &outlined);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
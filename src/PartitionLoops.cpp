@@ -516,15 +516,29 @@ class PartitionLoops : public IRMutator {
 
     bool in_gpu_loop = false;
 
+    // Are we inside the prologue or epilogue of a partitioned loop? We
+    // don't partition loops in there unless their schedule says we
+    // must.
+    bool in_tail = false;
+
     Stmt visit(const For *op) override {
         Stmt body = op->body;
 
+        if (op->partition_policy == Partition::Never ||
+            (in_tail && op->partition_policy == Partition::Auto)) {
+            return IRMutator::visit(op);
+        }
+        const bool must_partition = op->partition_policy == Partition::Always;
+
         ScopedValue<bool> old_in_gpu_loop(in_gpu_loop, in_gpu_loop ||
                                                            CodeGen_GPU_Dev::is_gpu_var(op->name));
 
         // If we're inside GPU kernel, and the body contains thread
         // barriers or warp shuffles, it's not safe to partition loops.
         if (in_gpu_loop && contains_warp_synchronous_logic(op)) {
+            user_assert(!must_partition)
+                << "Loop " << op->name << " is scheduled to always be partitioned, "
+                << "but it can't be, because it contains GPU thread barriers or warp shuffles.\n";
             return IRMutator::visit(op);
         }
 
@@ -533,6 +547,9 @@ class PartitionLoops : public IRMutator {
         body.accept(&finder);
 
         if (finder.simplifications.empty()) {
+            user_assert(!must_partition)
+                << "Loop " << op->name << " is scheduled to always be partitioned, "
+                << "but it contains no boundary conditions that partitioning could remove.\n";
             return IRMutator::visit(op);
         }
 
@@ -663,6 +680,18 @@ class PartitionLoops : public IRMutator {
         // Recurse on the middle section.
         simpler_body = mutate(simpler_body);
 
+        // Loops in the prologue and epilogue only get partitioned if
+        // they must be.
+        {
+            ScopedValue<bool> old_in_tail(in_tail, true);
+            if (make_prologue) {
+                prologue = mutate(prologue);
+            }
+            if (make_epilogue) {
+                epilogue = mutate(epilogue);
+            }
+        }
+
         // Construct variables for the bounds of the simplified middle section
         Expr min_steady = op->min, max_steady = op->extent + op->min;
         Expr prologue_val, epilogue_val;
@@ -704,16 +733,16 @@ class PartitionLoops : public IRMutator {
         // Bust simple serial for loops up into three.
         if (op->for_type == ForType::Serial && !op->body.as<Acquire>()) {
             stmt = For::make(op->name, min_steady, max_steady - min_steady,
-                             op->for_type, op->device_api, simpler_body);
+                             op->for_type, op->partition_policy, op->device_api, simpler_body, op->parallel_schedule, op->parallel_grain);
 
             if (make_prologue) {
                 prologue = For::make(op->name, op->min, min_steady - op->min,
-                                     op->for_type, op->device_api, prologue);
+                                     op->for_type, op->partition_policy, op->device_api, prologue, op->parallel_schedule, op->parallel_grain);
                 stmt = Block::make(prologue, stmt);
             }
             if (make_epilogue) {
                 epilogue = For::make(op->name, max_steady, op->min + op->extent - max_steady,
-                                     op->for_type, op->device_api, epilogue);
+                                     op->for_type, op->partition_policy, op->device_api, epilogue, op->parallel_schedule, op->parallel_grain);
                 stmt = Block::make(stmt, epilogue);
             }
         } else {
@@ -741,7 +770,7 @@ class PartitionLoops : public IRMutator {
                     stmt = IfThenElse::make(loop_var < min_steady, prologue, stmt);
                 }
             }
-            stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, stmt);
+            stmt = For::make(op->name, op->min, op->extent, op->for_type, op->partition_policy, op->device_api, stmt, op->parallel_schedule, op->parallel_grain);
         }
 
         if (make_epilogue) {
@@ -760,6 +789,9 @@ class PartitionLoops : public IRMutator {
         }
 
         if (can_prove(epilogue_val <= prologue_val)) {
+            user_assert(!must_partition)
+                << "Loop " << op->name << " is scheduled to always be partitioned, "
+                << "but its steady state would be empty.\n";
             // The steady state is empty. I've made a huge
             // mistake. Try to partition a loop further in.
             return IRMutator::visit(op);
@@ -864,7 +896,7 @@ class RenormalizeGPULoops : public IRMutator {
             internal_assert(!expr_uses_var(f->min, op->name) &&
                             !expr_uses_var(f->extent, op->name));
             Stmt inner = LetStmt::make(op->name, op->value, f->body);
-            inner = For::make(f->name, f->min, f->extent, f->for_type, f->device_api, inner);
+            inner = For::make(f->name, f->min, f->extent, f->for_type, f->partition_policy, f->device_api, inner, f->parallel_schedule, f->parallel_grain);
             return mutate(inner);
         } else if (a && in_gpu_loop && !in_thread_loop) {
             internal_assert(a->extents.size() == 1);
@@ -942,7 +974,7 @@ class RenormalizeGPULoops : public IRMutator {
                    for_a->min.same_as(for_b->min) &&
                    for_a->extent.same_as(for_b->extent)) {
             Stmt inner = IfThenElse::make(op->condition, for_a->body, for_b->body);
-            inner = For::make(for_a->name, for_a->min, for_a->extent, for_a->for_type, for_a->device_api, inner);
+            inner = For::make(for_a->name, for_a->min, for_a->extent, for_a->for_type, for_a->partition_policy, for_a->device_api, inner, for_a->parallel_schedule, for_a->parallel_grain);
             return mutate(inner);
         } else {
             internal_error << "Unexpected construct inside if statement: " << Stmt(op) << "\n";
@@ -1060,7 +1092,9 @@ class LowerLikelyIfInnermost : public IRMutator {
     Stmt visit(const For *op) override {
         ContainsHotLoop c;
         op->body.accept(&c);
-        inside_innermost_loop = !c.result;
+        // Loops that must be partitioned get to use the boundary
+        // conditions in their own bodies even if they aren't innermost.
+        inside_innermost_loop = !c.result || op->partition_policy == Partition::Always;
         Stmt stmt = IRMutator::visit(op);
         inside_innermost_loop = false;
         return stmt;
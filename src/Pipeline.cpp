@@ -172,6 +172,71 @@ struct PipelineContents {
     }
 };
 
+namespace {
+
+// If the target requires a user context but it isn't among the
+// arguments, add it at the start (the jit path puts it in there
+// explicitly).
+vector<Argument> add_user_context_arg(const PipelineContents &contents,
+                                      const vector<Argument> &args,
+                                      const Target &target) {
+    vector<Argument> lowering_args(args);
+    const bool requires_user_context = target.has_feature(Target::UserContext);
+    bool has_user_context = false;
+    for (const Argument &arg : lowering_args) {
+        if (arg.name == contents.user_context_arg.arg.name) {
+            has_user_context = true;
+        }
+    }
+    if (requires_user_context && !has_user_context) {
+        lowering_args.insert(lowering_args.begin(), contents.user_context_arg.arg);
+    }
+    return lowering_args;
+}
+
+// Lower the pipeline without reading or writing the cached module, so
+// that it is safe to do for several targets at once (as long as there
+// are no custom lowering passes, which may be stateful).
+Module lower_pipeline(const PipelineContents &contents,
+                      const vector<Argument> &lowering_args,
+                      const string &fn_name,
+                      const Target &target,
+                      const LinkageType linkage_type) {
+    vector<IRMutator *> custom_passes;
+    for (const CustomLoweringPass &p : contents.custom_lowering_passes) {
+        custom_passes.push_back(p.pass);
+    }
+
+    return lower(contents.outputs, fn_name, target, lowering_args,
+                 linkage_type, contents.requirements, contents.trace_pipeline,
+                 custom_passes);
+}
+
+// Make a ModuleFactory for compile_multitarget. It doesn't go through
+// Pipeline::compile_to_module, because compile_multitarget may call it
+// from several threads at once, and the cached module is of no use for
+// multiple targets anyway.
+ModuleFactory multitarget_module_producer(const Internal::IntrusivePtr<PipelineContents> &contents,
+                                          const vector<Argument> &args) {
+    user_assert(contents.defined()) << "Can't compile undefined Pipeline.\n";
+    for (const Function &f : contents->outputs) {
+        user_assert(f.has_pure_definition() || f.has_extern_definition())
+            << "Can't compile Pipeline with undefined output Func: " << f.name() << ".\n";
+    }
+    return [contents, args](const std::string &name, const Target &target) -> Module {
+        return lower_pipeline(*contents, add_user_context_arg(*contents, args, target),
+                              name, target, LinkageType::ExternalPlusMetadata);
+    };
+}
+
+// Custom lowering passes are shared by every target and may not be
+// thread-safe, so with any installed, compile one target at a time.
+int multitarget_num_threads(const PipelineContents &contents) {
+    return contents.custom_lowering_passes.empty() ? 0 : 1;
+}
+
+}  // namespace
+
 namespace Internal {
 template<>
 RefCount &ref_count<PipelineContents>(const PipelineContents *p) noexcept {
@@ -206,6 +271,11 @@ Pipeline::Pipeline(const vector<Func> &outputs)
     }
 }
 
+Pipeline::Pipeline(const vector<Func> &outputs, const vector<Stmt> &requirements)
+    : Pipeline(outputs) {
+    contents->requirements = requirements;
+}
+
 vector<Func> Pipeline::outputs() const {
     vector<Func> funcs;
     for (const Function &f : contents->outputs) {
@@ -354,22 +424,20 @@ void Pipeline::compile_to_static_library(const string &filename_prefix,
 void Pipeline::compile_to_multitarget_static_library(const std::string &filename_prefix,
                                                      const std::vector<Argument> &args,
                                                      const std::vector<Target> &targets) {
-    auto module_producer = [this, &args](const std::string &name, const Target &target) -> Module {
-        return compile_to_module(args, name, target);
-    };
+    auto module_producer = multitarget_module_producer(contents, args);
     auto outputs = static_library_outputs(filename_prefix, targets.back());
-    compile_multitarget(generate_function_name(), outputs, targets, {}, module_producer);
+    compile_multitarget(generate_function_name(), outputs, targets, {}, module_producer,
+                        nullptr, multitarget_num_threads(*contents));
 }
 
 void Pipeline::compile_to_multitarget_object_files(const std::string &filename_prefix,
                                                    const std::vector<Argument> &args,
                                                    const std::vector<Target> &targets,
                                                    const std::vector<std::string> &suffixes) {
-    auto module_producer = [this, &args](const std::string &name, const Target &target) -> Module {
-        return compile_to_module(args, name, target);
-    };
+    auto module_producer = multitarget_module_producer(contents, args);
     auto outputs = object_file_outputs(filename_prefix, targets.back());
-    compile_multitarget(generate_function_name(), outputs, targets, suffixes, module_producer);
+    compile_multitarget(generate_function_name(), outputs, targets, suffixes, module_producer,
+                        nullptr, multitarget_num_threads(*contents));
 }
 
 void Pipeline::compile_to_file(const string &filename_prefix,
@@ -488,21 +556,7 @@ Module Pipeline::compile_to_module(const vector<Argument> &args,
     internal_assert(!new_fn_name.empty()) << "new_fn_name cannot be empty\n";
     // TODO: Assert that the function name is legal
 
-    vector<Argument> lowering_args(args);
-
-    // If the target specifies user context but it's not in the args
-    // vector, add it at the start (the jit path puts it in there
-    // explicitly).
-    const bool requires_user_context = target.has_feature(Target::UserContext);
-    bool has_user_context = false;
-    for (const Argument &arg : lowering_args) {
-        if (arg.name == contents->user_context_arg.arg.name) {
-            has_user_context = true;
-        }
-    }
-    if (requires_user_context && !has_user_context) {
-        lowering_args.insert(lowering_args.begin(), contents->user_context_arg.arg);
-    }
+    vector<Argument> lowering_args = add_user_context_arg(*contents, args, target);
 
     const Module &old_module = contents->module;
 
@@ -517,8 +571,9 @@ Module Pipeline::compile_to_module(const vector<Argument> &args,
         }
     }
     same_compile = same_compile && found_name;
-    // Number of args + number of outputs is the same as total args in existing LoweredFunc
-    same_compile = same_compile && (lowering_args.size() + outputs().size()) == old_module.functions().front().args.size();
+    // Number of args + number of outputs (+ the scratch buffer) is the same as total args in existing LoweredFunc
+    const size_t scratch_args = target.has_feature(Target::ScratchArena) ? 1 : 0;
+    same_compile = same_compile && (lowering_args.size() + outputs().size() + scratch_args) == old_module.functions().front().args.size();
     // The initial args are the same.
     same_compile = same_compile && std::equal(lowering_args.begin(), lowering_args.end(), old_module.functions().front().args.begin());
     // Linkage is the same.
@@ -529,14 +584,7 @@ Module Pipeline::compile_to_module(const vector<Argument> &args,
         // We can avoid relowering and just reuse the existing module.
         debug(2) << "Reusing old module\n";
     } else {
-        vector<IRMutator *> custom_passes;
-        for (const CustomLoweringPass &p : contents->custom_lowering_passes) {
-            custom_passes.push_back(p.pass);
-        }
-
-        contents->module = lower(contents->outputs, new_fn_name, target, lowering_args,
-                                 linkage_type, contents->requirements, contents->trace_pipeline,
-                                 custom_passes);
+        contents->module = lower_pipeline(*contents, lowering_args, new_fn_name, target, linkage_type);
     }
 
     return contents->module;
@@ -785,6 +833,10 @@ void Pipeline::add_requirement(const Expr &condition, const std::vector<Expr> &e
     contents->requirements.emplace_back(Internal::AssertStmt::make(condition, error));
 }
 
+const std::vector<Stmt> &Pipeline::requirements() const {
+    return contents->requirements;
+}
+
 void Pipeline::trace_pipeline() {
     user_assert(defined()) << "Pipeline is undefined\n";
     contents->trace_pipeline = true;
@@ -185,6 +185,12 @@ public:
      * outputs. Schedules the Funcs compute_root(). */
     Pipeline(const std::vector<Func> &outputs);
 
+    /** Make a pipeline that computes the given Funcs as outputs, with
+     * the given requirements (see add_requirement) already added. Used
+     * when deserializing a pipeline. */
+    Pipeline(const std::vector<Func> &outputs,
+             const std::vector<Internal::Stmt> &requirements);
+
     std::vector<Argument> infer_arguments(const Internal::Stmt &body);
 
     /** Get the Funcs this pipeline outputs. */
@@ -488,6 +494,9 @@ public:
     }
     // @}
 
+    /** Get the requirements added to this pipeline, as AssertStmts. */
+    const std::vector<Internal::Stmt> &requirements() const;
+
     /** Generate begin_pipeline and end_pipeline tracing calls for this pipeline. */
     void trace_pipeline();
 
@@ -63,6 +63,24 @@ Stmt claim_sampling_token(const Stmt &s, const Expr &shared_token, const Expr &l
                                       release_sampling_token(shared_token, local_token)}));
 }
 
+Stmt set_thread_func(const Expr &profiler_token, int id) {
+    Expr thread_func = Variable::make(Handle(), "profiler_thread_func");
+    // This call gets inlined and becomes a single store instruction.
+    return Evaluate::make(Call::make(Int(32), "halide_profiler_set_thread_func",
+                                     {profiler_token, id, thread_func}, Call::Extern));
+}
+
+// Find where the thread running s records its current func, for billing
+// the thread's hardware performance counters, and mark the thread idle
+// when s is done.
+Stmt track_thread_func(const Stmt &s, const Expr &profiler_state, const Expr &profiler_token, int id) {
+    Expr thread_func = Call::make(Handle(), "halide_profiler_thread_func", {profiler_state}, Call::Extern);
+    return LetStmt::make("profiler_thread_func", thread_func,
+                         Block::make({set_thread_func(profiler_token, id),
+                                      s,
+                                      set_thread_func(profiler_token, halide_profiler_outside_of_halide)}));
+}
+
 class InjectProfiling : public IRMutator {
 
 public:
@@ -118,6 +136,10 @@ private:
 
     bool profiling_memory = true;
 
+    // Whether we're on a host thread that tracks its current func in
+    // profiler_thread_func.
+    bool profiling_threads = true;
+
     // Strip down the tuple name, e.g. f.0 into f
     string normalize_name(const string &name) {
         vector<string> v = split_string(name, ".");
@@ -147,10 +169,38 @@ private:
         // This call gets inlined and becomes a single store instruction.
         Stmt s = Evaluate::make(Call::make(Int(32), "halide_profiler_set_current_func",
                                            {profiler_state, profiler_token, id, last_arg}, Call::Extern));
+        if (profiling_threads) {
+            s = Block::make(s, set_thread_func(profiler_token, id));
+        }
 
         return s;
     }
 
+    // The func this thread is running at this point, as far as we know.
+    int current_func() const {
+        return most_recently_set_func >= 0 ? most_recently_set_func : stack.back();
+    }
+
+    // A task runs on some thread of the thread pool, which should bill
+    // its counters to the func the task is part of.
+    Stmt track_task_thread(const Stmt &s, int id) {
+        if (!profiling_threads) {
+            return s;
+        }
+        return track_thread_func(s, profiler_state, profiler_token, id);
+    }
+
+    // While this thread waits for other tasks it runs other tasks or
+    // does nothing, so afterwards it's back to running the given func.
+    Stmt suspend_task_thread(const Stmt &s, int id) {
+        if (!profiling_threads) {
+            return s;
+        }
+        return Block::make({set_thread_func(profiler_token, halide_profiler_outside_of_halide),
+                            s,
+                            set_thread_func(profiler_token, id)});
+    }
+
     Expr compute_allocation_size(const vector<Expr> &extents,
                                  const Expr &condition,
                                  const Type &type,
@@ -305,7 +355,9 @@ private:
         } else if (const Acquire *a = s.as<Acquire>()) {
             s = Acquire::make(a->semaphore, a->count, visit_parallel_task(a->body));
         } else {
+            int task_func = current_func();
             s = activate_thread(mutate(s), profiler_state);
+            s = track_task_thread(s, task_func);
         }
         if (most_recently_set_func != old) {
             most_recently_set_func = -1;
@@ -314,14 +366,16 @@ private:
     }
 
     Stmt visit(const Acquire *op) override {
+        int outer_func = current_func();
         Stmt s = visit_parallel_task(op);
-        return suspend_thread(s, profiler_state);
+        return suspend_task_thread(suspend_thread(s, profiler_state), outer_func);
     }
 
     Stmt visit(const Fork *op) override {
         ScopedValue<bool> bind(in_fork, true);
+        int outer_func = current_func();
         Stmt s = visit_parallel_task(op);
-        return suspend_thread(s, profiler_state);
+        return suspend_task_thread(suspend_thread(s, profiler_state), outer_func);
     }
 
     Stmt visit(const For *op) override {
@@ -368,6 +422,7 @@ private:
         ScopedValue<bool> bind_leaf_task(in_leaf_task, in_leaf_task || leaf_task);
 
         int old = most_recently_set_func;
+        int outer_func = current_func();
 
         // We profile by storing a token to global memory, so don't enter GPU loops
         if (op->device_api == DeviceAPI::Hexagon) {
@@ -377,6 +432,7 @@ private:
             // which means we can't do memory accounting.
             bool old_profiling_memory = profiling_memory;
             profiling_memory = false;
+            ScopedValue<bool> bind_profiling_threads(profiling_threads, false);
             body = mutate(body);
             profiling_memory = old_profiling_memory;
 
@@ -389,6 +445,9 @@ private:
         } else if (op->device_api == DeviceAPI::None ||
                    op->device_api == DeviceAPI::Host) {
             body = mutate(body);
+            if (update_active_threads) {
+                body = track_task_thread(body, outer_func);
+            }
         } else {
             body = op->body;
         }
@@ -397,10 +456,11 @@ private:
             most_recently_set_func = -1;
         }
 
-        Stmt stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        Stmt stmt = For::make(op->name, op->min, op->extent, op->for_type, op->partition_policy, op->device_api, body, op->parallel_schedule, op->parallel_grain);
 
         if (update_active_threads) {
             stmt = suspend_thread(stmt, profiler_state);
+            stmt = suspend_task_thread(stmt, outer_func);
         }
 
         return stmt;
@@ -460,6 +520,7 @@ Stmt inject_profiling(Stmt s, const string &pipeline_name) {
     Expr profiler_state = Variable::make(Handle(), "profiler_state");
 
     s = activate_thread(s, profiler_state);
+    s = track_thread_func(s, profiler_state, profiler_token, 0);
 
     // Initialize the shared sampling token
     Expr shared_sampling_token_var = Variable::make(Handle(), "profiler_shared_sampling_token");
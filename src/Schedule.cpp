@@ -1,4 +1,7 @@
 #include "Schedule.h"
+
+#include <atomic>
+
 #include "Func.h"
 #include "Function.h"
 #include "IR.h"
@@ -29,7 +32,10 @@ struct LoopLevelContents {
     // but cyclical include dependencies make this challenging.
     std::string var_name;
     bool is_rvar;
-    bool locked;
+    // Atomic because lowering the same Funcs for several targets at
+    // once (see compile_multitarget) locks the same LoopLevels
+    // concurrently.
+    std::atomic<bool> locked;
 
     LoopLevelContents(const std::string &func_name,
                       const std::string &var_name,
@@ -126,6 +132,26 @@ bool LoopLevel::defined() const {
     return contents->var_name != undefined_looplevel_name;
 }
 
+const std::string &LoopLevel::func_name() const {
+    return contents->func_name;
+}
+
+const std::string &LoopLevel::var_name() const {
+    return contents->var_name;
+}
+
+bool LoopLevel::is_rvar() const {
+    return contents->is_rvar;
+}
+
+int LoopLevel::raw_stage_index() const {
+    return contents->stage_index;
+}
+
+bool LoopLevel::locked() const {
+    return contents->locked;
+}
+
 std::string LoopLevel::func() const {
     check_defined_and_locked();
     return contents->func_name;
@@ -213,7 +239,7 @@ typedef std::map<FunctionPtr, FunctionPtr> DeepCopyMap;
 struct FuncScheduleContents {
     mutable RefCount ref_count;
 
-    LoopLevel store_level, compute_level;
+    LoopLevel store_level, compute_level, hoist_storage_level;
     std::vector<StorageDim> storage_dims;
     std::vector<Bound> bounds;
     std::vector<Bound> estimates;
@@ -222,9 +248,11 @@ struct FuncScheduleContents {
     bool memoized = false;
     bool async = false;
     Expr memoize_eviction_key;
+    Expr ring_buffer;
 
     FuncScheduleContents()
-        : store_level(LoopLevel::inlined()), compute_level(LoopLevel::inlined()) {
+        : store_level(LoopLevel::inlined()), compute_level(LoopLevel::inlined()),
+          hoist_storage_level(LoopLevel::inlined()) {
     }
 
     // Pass an IRMutator through to all Exprs referenced in the FuncScheduleContents
@@ -257,6 +285,9 @@ struct FuncScheduleContents {
                 b.remainder = mutator->mutate(b.remainder);
             }
         }
+        if (ring_buffer.defined()) {
+            ring_buffer = mutator->mutate(ring_buffer);
+        }
     }
 };
 
@@ -310,6 +341,11 @@ struct StageScheduleContents {
                 p.offset = mutator->mutate(p.offset);
             }
         }
+        for (Dim &d : dims) {
+            if (d.parallel_grain.defined()) {
+                d.parallel_grain = mutator->mutate(d.parallel_grain);
+            }
+        }
     }
 };
 
@@ -334,6 +370,7 @@ FuncSchedule FuncSchedule::deep_copy(
     FuncSchedule copy;
     copy.contents->store_level = contents->store_level;
     copy.contents->compute_level = contents->compute_level;
+    copy.contents->hoist_storage_level = contents->hoist_storage_level;
     copy.contents->storage_dims = contents->storage_dims;
     copy.contents->bounds = contents->bounds;
     copy.contents->estimates = contents->estimates;
@@ -341,6 +378,7 @@ FuncSchedule FuncSchedule::deep_copy(
     copy.contents->memoized = contents->memoized;
     copy.contents->memoize_eviction_key = contents->memoize_eviction_key;
     copy.contents->async = contents->async;
+    copy.contents->ring_buffer = contents->ring_buffer;
 
     // Deep-copy wrapper functions.
     for (const auto &iter : contents->wrappers) {
@@ -384,6 +422,14 @@ bool FuncSchedule::async() const {
     return contents->async;
 }
 
+Expr &FuncSchedule::ring_buffer() {
+    return contents->ring_buffer;
+}
+
+Expr FuncSchedule::ring_buffer() const {
+    return contents->ring_buffer;
+}
+
 std::vector<StorageDim> &FuncSchedule::storage_dims() {
     return contents->storage_dims;
 }
@@ -445,6 +491,14 @@ const LoopLevel &FuncSchedule::compute_level() const {
     return contents->compute_level;
 }
 
+LoopLevel &FuncSchedule::hoist_storage_level() {
+    return contents->hoist_storage_level;
+}
+
+const LoopLevel &FuncSchedule::hoist_storage_level() const {
+    return contents->hoist_storage_level;
+}
+
 void FuncSchedule::accept(IRVisitor *visitor) const {
     for (const Bound &b : bounds()) {
         if (b.min.defined()) {
@@ -477,6 +531,9 @@ void FuncSchedule::accept(IRVisitor *visitor) const {
     if (memoize_eviction_key().defined()) {
         memoize_eviction_key().accept(visitor);
     }
+    if (ring_buffer().defined()) {
+        ring_buffer().accept(visitor);
+    }
 }
 
 void FuncSchedule::mutate(IRMutator *mutator) {
@@ -604,6 +661,11 @@ void StageSchedule::accept(IRVisitor *visitor) const {
             p.offset.accept(visitor);
         }
     }
+    for (const Dim &d : dims()) {
+        if (d.parallel_grain.defined()) {
+            d.parallel_grain.accept(visitor);
+        }
+    }
 }
 
 void StageSchedule::mutate(IRMutator *mutator) {
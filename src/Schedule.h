@@ -179,8 +179,6 @@ class LoopLevel {
     explicit LoopLevel(Internal::IntrusivePtr<Internal::LoopLevelContents> c)
         : contents(std::move(c)) {
     }
-    LoopLevel(const std::string &func_name, const std::string &var_name,
-              bool is_rvar, int stage_index, bool locked = false);
 
 public:
     /** Return the index of the function stage associated with this loop level.
@@ -213,9 +211,24 @@ public:
     // documented with plain comments (rather than Doxygen) to avoid being
     // present in user documentation.
 
+    // Construct a LoopLevel directly from its fields. Used when
+    // deserializing a schedule.
+    LoopLevel(const std::string &func_name, const std::string &var_name,
+              bool is_rvar, int stage_index, bool locked = false);
+
     // Lock this LoopLevel.
     LoopLevel &lock();
 
+    // Return the fields of this LoopLevel as passed to the constructor
+    // above. Unlike the accessors below, these never assert, so they
+    // work on unlocked, root, inlined and undefined LoopLevels. Used
+    // when serializing a schedule.
+    const std::string &func_name() const;
+    const std::string &var_name() const;
+    bool is_rvar() const;
+    int raw_stage_index() const;
+    bool locked() const;
+
     // Return the Func name. Asserts if the LoopLevel is_root() or is_inlined() or !defined().
     std::string func() const;
 
@@ -424,6 +437,17 @@ struct Dim {
      * loop (see the DimType enum above). */
     DimType dim_type;
 
+    /** If the loop is parallel, how are its iterations divided among
+     * threads, and what is the smallest number of them a thread
+     * claims at once? The grain is undefined for the default
+     * schedule. */
+    ParallelSchedule parallel_schedule = ParallelSchedule::Default;
+    Expr parallel_grain;
+
+    /** Should loop partitioning split this loop into a prologue, a
+     * steady state and an epilogue (see the Partition enum)? */
+    Partition partition_policy = Partition::Auto;
+
     /** Can this loop be evaluated in any order (including in
      * parallel)? Equivalently, are there no data hazards between
      * evaluations of the Func at distinct values of this var? */
@@ -489,6 +513,10 @@ struct StorageDim {
      * false). */
     Expr fold_factor;
     bool fold_forward;
+
+    /** If the storage of the Func is blocked along this axis (with
+     * Func::tile_storage), this gives the size of the blocks. */
+    Expr tile_factor;
 };
 
 /** This represents two stages with fused loop nests from outermost to
@@ -577,6 +605,11 @@ public:
     bool &async();
     bool async() const;
 
+    /** The number of slots in the circular buffer an async producer
+     * writes into, if any. See \ref Func::ring_buffer */
+    Expr &ring_buffer();
+    Expr ring_buffer() const;
+
     /** The list and order of dimensions used to store this
      * function. The first dimension in the vector corresponds to the
      * innermost dimension for storage (i.e. which dimension is
@@ -631,6 +664,16 @@ public:
     LoopLevel &compute_level();
     // @}
 
+    /** At what site should we inject the allocation of this function,
+     * if it is outside of the store_level? The allocation is made large
+     * enough for every iteration of the loops between the
+     * hoist_storage_level and the store_level. If inlined, it is the
+     * same as the store_level. See \ref Func::hoist_storage */
+    // @{
+    const LoopLevel &hoist_storage_level() const;
+    LoopLevel &hoist_storage_level();
+    // @}
+
     /** Pass an IRVisitor through to all Exprs referenced in the
      * Schedule. */
     void accept(IRVisitor *) const;
@@ -398,7 +398,7 @@ Stmt build_loop_nest(
             const Dim &dim = stage_s.dims()[nest[i].dim_idx];
             Expr min = Variable::make(Int(32), nest[i].name + ".loop_min");
             Expr extent = Variable::make(Int(32), nest[i].name + ".loop_extent");
-            stmt = For::make(nest[i].name, min, extent, dim.for_type, dim.device_api, stmt);
+            stmt = For::make(nest[i].name, min, extent, dim.for_type, dim.partition_policy, dim.device_api, stmt, dim.parallel_schedule, dim.parallel_grain);
         }
     }
 
@@ -966,9 +966,9 @@ private:
             return For::make(for_loop->name,
                              for_loop->min,
                              for_loop->extent,
-                             for_loop->for_type,
+                             for_loop->for_type, for_loop->partition_policy,
                              for_loop->device_api,
-                             body);
+                             body, for_loop->parallel_schedule, for_loop->parallel_grain);
         }
     }
 };
@@ -1054,6 +1054,8 @@ private:
 
             ForType for_type = op->for_type;
             DeviceAPI device_api = op->device_api;
+            ParallelSchedule parallel_schedule = op->parallel_schedule;
+            Expr parallel_grain = op->parallel_grain;
             if (is_const_one(extent_val)) {
                 // This is the child loop of a fused group. The real loop of the
                 // fused group is the loop of the parent function of the fused
@@ -1062,11 +1064,14 @@ private:
                 // serial loop of extent 1."
                 for_type = ForType::Serial;
                 device_api = DeviceAPI::None;
+                parallel_schedule = ParallelSchedule::Default;
+                parallel_grain = Expr();
             }
 
             Stmt stmt = For::make(new_var, Variable::make(Int(32), new_var + ".loop_min"),
                                   Variable::make(Int(32), new_var + ".loop_extent"),
-                                  for_type, device_api, body);
+                                  for_type, op->partition_policy, device_api, body,
+                                  parallel_schedule, parallel_grain);
 
             // Add let stmts defining the bound of the renamed for-loop.
             stmt = LetStmt::make(new_var + ".loop_min", min_val, stmt);
@@ -1107,7 +1112,7 @@ class ShiftLoopNest : public IRMutator {
             internal_assert(op);
             Expr adjusted = Variable::make(Int(32), op->name) + iter->second;
             Stmt body = substitute(op->name, adjusted, op->body);
-            stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+            stmt = For::make(op->name, op->min, op->extent, op->for_type, op->partition_policy, op->device_api, body, op->parallel_schedule, op->parallel_grain);
         }
         return stmt;
     }
@@ -1270,9 +1275,9 @@ protected:
             return For::make(for_loop->name,
                              for_loop->min,
                              for_loop->extent,
-                             for_loop->for_type,
+                             for_loop->for_type, for_loop->partition_policy,
                              for_loop->device_api,
-                             body);
+                             body, for_loop->parallel_schedule, for_loop->parallel_grain);
         }
     }
 
@@ -2022,6 +2027,83 @@ public:
     }
 };
 
+// Find a loop between the site a Func's storage is hoisted to and its
+// store_at site whose bounds depend on a let that isn't an integer,
+// directly or through other lets. Storage flattening sizes the hoisted
+// allocation to cover every iteration of those loops, and can't bound
+// a let that isn't an integer.
+class FindUnboundedHoistedLoop : public IRVisitor {
+    using IRVisitor::visit;
+
+    const LoopLevel &hoist_level, &store_level;
+    bool in_range;
+
+    // The lets that can't be bounded, each mapped to the let that isn't
+    // an integer it depends on.
+    Scope<string> unbounded;
+
+    // The loops in range with bounds that can't be bounded, and the
+    // lets responsible, outermost first.
+    vector<pair<string, string>> suspects;
+
+    string unbounded_let_used(const Expr &e) {
+        for (auto it = unbounded.cbegin(); it != unbounded.cend(); ++it) {
+            if (expr_uses_var(e, it.name())) {
+                return it.value();
+            }
+        }
+        return "";
+    }
+
+    void visit(const LetStmt *op) override {
+        op->value.accept(this);
+        string let;
+        if (in_range) {
+            if (!op->value.type().is_int() && !op->value.type().is_uint()) {
+                let = op->name;
+            } else {
+                let = unbounded_let_used(op->value);
+            }
+        }
+        ScopedBinding<string> bind(!let.empty(), unbounded, op->name, let);
+        op->body.accept(this);
+    }
+
+    void visit(const For *op) override {
+        size_t old_suspects = suspects.size();
+        if (in_range) {
+            string let = unbounded_let_used(op->min);
+            if (let.empty()) {
+                let = unbounded_let_used(op->extent);
+            }
+            if (!let.empty()) {
+                suspects.emplace_back(op->name, let);
+            }
+        }
+        bool old_in_range = in_range;
+        if (hoist_level.match(op->name)) {
+            in_range = true;
+        } else if (store_level.match(op->name)) {
+            // The store site is the body of this loop.
+            if (in_range && !suspects.empty() && loop.empty()) {
+                loop = suspects.front().first;
+                let = suspects.front().second;
+            }
+            in_range = false;
+        }
+        op->body.accept(this);
+        in_range = old_in_range;
+        suspects.resize(old_suspects);
+    }
+
+public:
+    string loop, let;
+
+    FindUnboundedHoistedLoop(const LoopLevel &hoist_level, const LoopLevel &store_level)
+        : hoist_level(hoist_level), store_level(store_level), in_range(hoist_level.is_root()) {
+    }
+};
+
 // Check a schedule is legal, throwing an error if it is not. Returns
 // whether or not a realization of the Func should be injected. Unused
 // intermediate Funcs that somehow made it into the Func DAG can be
@@ -2281,6 +2363,49 @@ bool validate_schedule(Function f, const Stmt &s, const Target &target, bool is_
         }
     }
 
+    // The hoisted allocation must be at or outside the store_at, and
+    // there can't be a parallel loop between the two.
+    LoopLevel hoist_storage_at = f.schedule().hoist_storage_level();
+    if (both_ok() && !hoist_storage_at.match(store_at)) {
+        int hoist_storage_idx = -1;
+        for (int i = 0; i <= store_idx; i++) {
+            if (sites[i].loop_level.match(hoist_storage_at)) {
+                hoist_storage_idx = i;
+            }
+        }
+        user_assert(hoist_storage_idx >= 0)
+            << "Func \"" << f.name() << "\" has its storage hoisted to "
+            << hoist_storage_at.to_string()
+            << ", which is not a loop outside of its store_at location "
+            << store_at.to_string() << ".\n";
+        for (int i = hoist_storage_idx + 1; i <= store_idx; i++) {
+            user_assert(!sites[i].is_parallel)
+                << "Func \"" << f.name()
+                << "\" has its storage hoisted outside the parallel loop over "
+                << sites[i].loop_level.to_string()
+                << " but stored within it. This is a potential race condition.\n";
+        }
+        FindUnboundedHoistedLoop unbounded(hoist_storage_at, store_at);
+        s.accept(&unbounded);
+        user_assert(unbounded.loop.empty())
+            << "Func \"" << f.name() << "\" has its storage hoisted to "
+            << hoist_storage_at.to_string()
+            << ", but the bounds of the loop " << unbounded.loop
+            << " between there and its store_at location " << store_at.to_string()
+            << " depend on " << unbounded.let << ", which is not an integer, "
+            << "so the size of the hoisted allocation can't be bounded.\n";
+    }
+
+    // A ring buffer is only useful to an async producer whose storage
+    // is hoisted outside of its store_at.
+    if (both_ok() && f.schedule().ring_buffer().defined()) {
+        user_assert(f.schedule().async())
+            << "Func \"" << f.name() << "\" has a ring_buffer() but is not async().\n";
+        user_assert(!hoist_storage_at.match(store_at))
+            << "Func \"" << f.name() << "\" has a ring_buffer() but its storage is not "
+            << "hoisted outside of its store_at location with hoist_storage().\n";
+    }
+
     if (!both_ok()) {
         err << "Func \"" << f.name() << "\" is computed at the following invalid location:\n"
             << "  " << schedule_to_source(f, store_at, compute_at) << "\n"
@@ -2479,7 +2604,7 @@ Stmt schedule_functions(const vector<Function> &outputs,
                         const Target &target,
                         bool &any_memoized) {
     string root_var = LoopLevel::root().lock().to_string();
-    Stmt s = For::make(root_var, 0, 1, ForType::Serial, DeviceAPI::Host, Evaluate::make(0));
+    Stmt s = For::make(root_var, 0, 1, ForType::Serial, Partition::Never, DeviceAPI::Host, Evaluate::make(0));
 
     any_memoized = false;
 
@@ -5,11 +5,13 @@
 #include <map>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "Debug.h"
 #include "Error.h"
+#include "InternedName.h"
 
 /** \file
  * Defines the Scope class, which is used for keeping track of names in a scope while traversing IR
@@ -98,6 +100,9 @@ private:
     const Scope<T> *containing_scope = nullptr;
 
 public:
+    /** The type used to name things in this scope. */
+    using name_type = std::string;
+
     Scope() = default;
     Scope(Scope &&that) noexcept = default;
     Scope &operator=(Scope &&that) noexcept = default;
@@ -260,6 +265,212 @@ std::ostream &operator<<(std::ostream &stream, const Scope<T> &s) {
     return stream;
 }
 
+/** A Scope keyed by InternedName. Lookups hash and compare pointers
+ * rather than strings, so they take constant time regardless of the
+ * length of the names or the number of names in scope. Anything that
+ * converts to an InternedName (e.g. a std::string) can be used as a
+ * name too, so a pass can be moved over from Scope piecemeal. Looking
+ * up a std::string interns it, unless the scope has an
+ * InternedNameCache, in which case it's looked up there. A pass that
+ * keeps several InternedScopes should give them a shared cache.
+ *
+ * An InternedScope can instead be made keyed by std::string, in which
+ * case it behaves exactly like a Scope and interns nothing. This is
+ * for comparing the two.
+ *
+ * An InternedScope can have a containing Scope keyed by std::string,
+ * so that a pass handed a Scope by its caller can use an
+ * InternedScope for its own bindings. Iteration is in no particular
+ * order. */
+template<typename T = void>
+class InternedScope {
+private:
+    // Entries are left in the table when their stack becomes empty, so
+    // that binding the same name repeatedly doesn't allocate.
+    std::unordered_map<InternedName, SmallStack<T>> table;
+
+    const Scope<T> *containing_scope = nullptr;
+
+    InternedNameCache *name_cache = nullptr;
+
+    bool by_string = false;
+    Scope<T> strings;
+
+    const SmallStack<T> *find(const InternedName &name) const {
+        auto iter = table.find(name);
+        if (iter == table.end() || iter->second.empty()) {
+            return nullptr;
+        }
+        return &iter->second;
+    }
+
+public:
+    /** The type used to name things in this scope. */
+    using name_type = InternedName;
+
+    InternedScope() = default;
+    InternedScope(InternedScope &&that) noexcept = default;
+    InternedScope &operator=(InternedScope &&that) noexcept = default;
+
+    /** Make a scope keyed by std::string if by_string is true. If not,
+     * std::string names are interned through name_cache, if given,
+     * which must outlive the scope. */
+    explicit InternedScope(bool by_string, InternedNameCache *name_cache = nullptr)
+        : name_cache(name_cache), by_string(by_string) {
+    }
+
+    InternedScope(const InternedScope<T> &) = delete;
+    InternedScope<T> &operator=(const InternedScope<T> &) = delete;
+
+    /** Set the parent scope. If lookups fail in this scope, they
+     * check the containing scope before returning an error. Caller is
+     * responsible for managing the memory of the containing scope. */
+    void set_containing_scope(const Scope<T> *s) {
+        containing_scope = s;
+        strings.set_containing_scope(s);
+    }
+
+    /** Retrieve the value referred to by a name */
+    template<typename T2 = T,
+             typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
+    T2 get(const InternedName &name) const {
+        if (by_string) {
+            return strings.get(name.name());
+        }
+        const SmallStack<T> *stack = find(name);
+        if (!stack) {
+            if (containing_scope) {
+                return containing_scope->get(name.name());
+            } else {
+                internal_error << "Name not in Scope: " << name << "\n";
+            }
+        }
+        return stack->top();
+    }
+
+    template<typename T2 = T,
+             typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
+    T2 get(const std::string &name) const {
+        if (by_string) {
+            return strings.get(name);
+        }
+        return name_cache ? get(name_cache->intern(name)) : get(InternedName(name));
+    }
+
+    /** Return a reference to an entry. Does not consider the containing scope. */
+    template<typename T2 = T,
+             typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
+    T2 &ref(const InternedName &name) {
+        if (by_string) {
+            return strings.ref(name.name());
+        }
+        auto iter = table.find(name);
+        if (iter == table.end() || iter->second.empty()) {
+            internal_error << "Name not in Scope: " << name << "\n";
+        }
+        return iter->second.top_ref();
+    }
+
+    template<typename T2 = T,
+             typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
+    T2 &ref(const std::string &name) {
+        if (by_string) {
+            return strings.ref(name);
+        }
+        return name_cache ? ref(name_cache->intern(name)) : ref(InternedName(name));
+    }
+
+    /** Tests if a name is in scope */
+    bool contains(const InternedName &name) const {
+        if (by_string) {
+            return strings.contains(name.name());
+        }
+        return find(name) || (containing_scope && containing_scope->contains(name.name()));
+    }
+
+    /** Tests if a name is in scope. Without a cache, this doesn't
+     * intern the name if it has never been seen before. */
+    bool contains(const std::string &name) const {
+        InternedName n;
+        if (by_string) {
+            return strings.contains(name);
+        } else if (name_cache) {
+            return contains(name_cache->intern(name));
+        } else if (InternedName::find(name, &n)) {
+            return contains(n);
+        } else {
+            return containing_scope && containing_scope->contains(name);
+        }
+    }
+
+    /** How many nested definitions of a single name exist? */
+    size_t count(const InternedName &name) const {
+        if (by_string) {
+            return strings.count(name.name());
+        }
+        const SmallStack<T> *stack = find(name);
+        return stack ? stack->size() : 0;
+    }
+
+    /** Add a new (name, value) pair to the current scope. Hide old
+     * values that have this name until we pop this name.
+     */
+    template<typename T2 = T,
+             typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
+    void push(const InternedName &name, T2 &&value) {
+        if (by_string) {
+            strings.push(name.name(), std::forward<T2>(value));
+        } else {
+            table[name].push(std::forward<T2>(value));
+        }
+    }
+
+    template<typename T2 = T,
+             typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
+    void push(const std::string &name, T2 &&value) {
+        if (by_string) {
+            strings.push(name, std::forward<T2>(value));
+        } else if (name_cache) {
+            table[name_cache->intern(name)].push(std::forward<T2>(value));
+        } else {
+            table[InternedName(name)].push(std::forward<T2>(value));
+        }
+    }
+
+    template<typename T2 = T,
+             typename = typename std::enable_if<std::is_same<T2, void>::value>::type>
+    void push(const InternedName &name) {
+        if (by_string) {
+            strings.push(name.name());
+        } else {
+            table[name].push();
+        }
+    }
+
+    /** A name goes out of scope. Restore whatever its old value
+     * was. */
+    void pop(const InternedName &name) {
+        if (by_string) {
+            strings.pop(name.name());
+            return;
+        }
+        auto iter = table.find(name);
+        internal_assert(iter != table.end() && !iter->second.empty())
+            << "Name not in Scope: " << name << "\n";
+        iter->second.pop();
+    }
+
+    void pop(const std::string &name) {
+        if (by_string) {
+            strings.pop(name);
+        } else if (name_cache) {
+            pop(name_cache->intern(name));
+        } else {
+            pop(InternedName(name));
+        }
+    }
+};
+
 /** Helper class for pushing/popping Scope<> values, to allow
  * for early-exit in Visitor/Mutators that preserves correctness.
  * Note that this name can be a bit confusing, since there are two "scopes"
@@ -268,19 +479,19 @@ std::ostream &operator<<(std::ostream &stream, const Scope<T> &s) {
  * - the lifetime of this helper object
  * The "Scoped" in this class name refers to the latter, as it temporarily binds
  * a name within the scope of this helper's lifetime. */
-template<typename T = void>
+template<typename T = void, typename ScopeT = Scope<T>>
 struct ScopedBinding {
-    Scope<T> *scope = nullptr;
-    std::string name;
+    ScopeT *scope = nullptr;
+    typename ScopeT::name_type name;
 
     ScopedBinding() = default;
 
-    ScopedBinding(Scope<T> &s, const std::string &n, T value)
+    ScopedBinding(ScopeT &s, const typename ScopeT::name_type &n, T value)
         : scope(&s), name(n) {
         scope->push(name, std::move(value));
     }
 
-    ScopedBinding(bool condition, Scope<T> &s, const std::string &n, const T &value)
+    ScopedBinding(bool condition, ScopeT &s, const typename ScopeT::name_type &n, const T &value)
         : scope(condition ? &s : nullptr), name(n) {
         if (condition) {
             scope->push(name, value);
@@ -310,15 +521,15 @@ struct ScopedBinding {
     void operator=(ScopedBinding &&that) = delete;
 };
 
-template<>
-struct ScopedBinding<void> {
-    Scope<> *scope;
-    std::string name;
-    ScopedBinding(Scope<> &s, const std::string &n)
+template<typename ScopeT>
+struct ScopedBinding<void, ScopeT> {
+    ScopeT *scope;
+    typename ScopeT::name_type name;
+    ScopedBinding(ScopeT &s, const typename ScopeT::name_type &n)
         : scope(&s), name(n) {
         scope->push(name);
     }
-    ScopedBinding(bool condition, Scope<> &s, const std::string &n)
+    ScopedBinding(bool condition, ScopeT &s, const typename ScopeT::name_type &n)
         : scope(condition ? &s : nullptr), name(n) {
         if (condition) {
             scope->push(name);
@@ -0,0 +1,1758 @@
+#include "Serialization.h"
+
+#include <cstring>
+#include <unordered_map>
+
+#include "ExternFuncArgument.h"
+#include "FindCalls.h"
+#include "Func.h"
+#include "Function.h"
+#include "IR.h"
+#include "Util.h"
+
+namespace Halide {
+
+using namespace Halide::Internal;
+
+namespace {
+
+// The data starts with a magic number, the format version and what kind
+// of object follows. Everything after that is a sequence of unsigned
+// LEB128 varints (signed values are zigzag-encoded first), except for
+// doubles and Buffer contents, which are written as raw little-endian
+// bytes.
+//
+// Strings, Exprs, Stmts, Parameters, Buffers and ReductionDomains are
+// written inline the first time they are referred to, and by index into
+// a table of those already written after that, so that a DAG of IR is
+// written in time and space proportional to its number of unique
+// nodes. A reference is 0 for an undefined object, 1 for a new object
+// that follows immediately, and 2 + the table index otherwise. Strings
+// are never undefined, so for them 0 is a new string. Exprs and Stmts
+// are added to their tables after their children; Parameters and
+// ReductionDomains before their constraints and predicates, which may
+// refer back to them.
+//
+// A serialized Pipeline starts with the names of all of the Functions
+// in it, so that Calls, wrappers and extern arguments can refer to
+// Functions by index before their definitions have been read.
+
+const uint8_t serialization_magic[4] = {'H', 'L', 'S', 'Z'};
+const uint64_t serialization_version = 7;
+
+enum class SerializedKind {
+    Pipeline,
+    Module,
+};
+
+class Serializer {
+    std::vector<uint8_t> &out;
+
+    std::unordered_map<std::string, uint64_t> strings;
+    std::unordered_map<const IRNode *, uint64_t> exprs, stmts;
+    std::map<Parameter, uint64_t> parameters;
+    std::unordered_map<const void *, uint64_t> buffers;
+    std::map<ReductionDomain, uint64_t, ReductionDomain::Compare> reduction_domains;
+    std::map<FunctionPtr, uint64_t> functions;
+
+    // Write a reference to an object already in a table, or a marker
+    // that a new one follows. Returns true in the latter case.
+    template<typename Table, typename Key>
+    bool write_reference(const Table &table, const Key &key) {
+        auto it = table.find(key);
+        if (it != table.end()) {
+            write_uint(it->second + 2);
+            return false;
+        }
+        write_uint(1);
+        return true;
+    }
+
+public:
+    // Whether to write the current values of scalar Parameters.
+    bool write_param_values = true;
+
+    Serializer(std::vector<uint8_t> &out)
+        : out(out) {
+    }
+
+    void write_uint(uint64_t x) {
+        while (x >= 0x80) {
+            out.push_back((uint8_t)(x | 0x80));
+            x >>= 7;
+        }
+        out.push_back((uint8_t)x);
+    }
+
+    void write_int(int64_t x) {
+        write_uint(((uint64_t)x << 1) ^ (uint64_t)(x >> 63));
+    }
+
+    void write_bool(bool b) {
+        out.push_back(b ? 1 : 0);
+    }
+
+    template<typename T>
+    void write_enum(T e) {
+        write_uint((uint64_t)e);
+    }
+
+    void write_double(double d) {
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        for (int i = 0; i < 8; i++) {
+            out.push_back((uint8_t)(bits >> (i * 8)));
+        }
+    }
+
+    void write_bytes(const void *data, size_t size) {
+        const uint8_t *bytes = (const uint8_t *)data;
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    void write_header(SerializedKind kind) {
+        write_bytes(serialization_magic, sizeof(serialization_magic));
+        write_uint(serialization_version);
+        write_enum(kind);
+    }
+
+    void write_string(const std::string &s) {
+        auto it = strings.find(s);
+        if (it != strings.end()) {
+            write_uint(it->second + 1);
+            return;
+        }
+        write_uint(0);
+        write_uint(s.size());
+        write_bytes(s.data(), s.size());
+        strings.emplace(s, strings.size());
+    }
+
+    void write_strings(const std::vector<std::string> &v) {
+        write_uint(v.size());
+        for (const std::string &s : v) {
+            write_string(s);
+        }
+    }
+
+    void write_type(const Type &t) {
+        write_enum(t.code());
+        write_uint(t.bits());
+        write_uint(t.lanes());
+    }
+
+    void write_types(const std::vector<Type> &v) {
+        write_uint(v.size());
+        for (const Type &t : v) {
+            write_type(t);
+        }
+    }
+
+    void write_alignment(const ModulusRemainder &m) {
+        write_int(m.modulus);
+        write_int(m.remainder);
+    }
+
+    template<typename T>
+    void write_binary_op(const Expr &e) {
+        const T *op = e.as<T>();
+        write_expr(op->a);
+        write_expr(op->b);
+    }
+
+    void write_expr(const Expr &e) {
+        if (!e.defined()) {
+            write_uint(0);
+            return;
+        }
+        if (!write_reference(exprs, e.get())) {
+            return;
+        }
+        write_enum(e->node_type);
+        switch (e->node_type) {
+        case IRNodeType::IntImm:
+            write_type(e.type());
+            write_int(e.as<IntImm>()->value);
+            break;
+        case IRNodeType::UIntImm:
+            write_type(e.type());
+            write_uint(e.as<UIntImm>()->value);
+            break;
+        case IRNodeType::FloatImm:
+            write_type(e.type());
+            write_double(e.as<FloatImm>()->value);
+            break;
+        case IRNodeType::StringImm:
+            write_string(e.as<StringImm>()->value);
+            break;
+        case IRNodeType::Broadcast: {
+            const Broadcast *op = e.as<Broadcast>();
+            write_expr(op->value);
+            write_uint(op->lanes);
+            break;
+        }
+        case IRNodeType::Cast:
+            write_type(e.type());
+            write_expr(e.as<Cast>()->value);
+            break;
+        case IRNodeType::Reinterpret:
+            write_type(e.type());
+            write_expr(e.as<Reinterpret>()->value);
+            break;
+        case IRNodeType::Variable: {
+            const Variable *op = e.as<Variable>();
+            write_type(op->type);
+            write_string(op->name);
+            write_parameter(op->param);
+            write_buffer(op->image);
+            write_reduction_domain(op->reduction_domain);
+            break;
+        }
+        case IRNodeType::Add:
+            write_binary_op<Add>(e);
+            break;
+        case IRNodeType::Sub:
+            write_binary_op<Sub>(e);
+            break;
+        case IRNodeType::Mod:
+            write_binary_op<Mod>(e);
+            break;
+        case IRNodeType::Mul:
+            write_binary_op<Mul>(e);
+            break;
+        case IRNodeType::Div:
+            write_binary_op<Div>(e);
+            break;
+        case IRNodeType::Min:
+            write_binary_op<Min>(e);
+            break;
+        case IRNodeType::Max:
+            write_binary_op<Max>(e);
+            break;
+        case IRNodeType::EQ:
+            write_binary_op<EQ>(e);
+            break;
+        case IRNodeType::NE:
+            write_binary_op<NE>(e);
+            break;
+        case IRNodeType::LT:
+            write_binary_op<LT>(e);
+            break;
+        case IRNodeType::LE:
+            write_binary_op<LE>(e);
+            break;
+        case IRNodeType::GT:
+            write_binary_op<GT>(e);
+            break;
+        case IRNodeType::GE:
+            write_binary_op<GE>(e);
+            break;
+        case IRNodeType::And:
+            write_binary_op<And>(e);
+            break;
+        case IRNodeType::Or:
+            write_binary_op<Or>(e);
+            break;
+        case IRNodeType::Not:
+            write_expr(e.as<Not>()->a);
+            break;
+        case IRNodeType::Select: {
+            const Select *op = e.as<Select>();
+            write_expr(op->condition);
+            write_expr(op->true_value);
+            write_expr(op->false_value);
+            break;
+        }
+        case IRNodeType::Load: {
+            const Load *op = e.as<Load>();
+            write_type(op->type);
+            write_string(op->name);
+            write_expr(op->index);
+            write_buffer(op->image);
+            write_parameter(op->param);
+            write_expr(op->predicate);
+            write_alignment(op->alignment);
+            break;
+        }
+        case IRNodeType::Ramp: {
+            const Ramp *op = e.as<Ramp>();
+            write_expr(op->base);
+            write_expr(op->stride);
+            write_uint(op->lanes);
+            break;
+        }
+        case IRNodeType::Call: {
+            const Call *op = e.as<Call>();
+            write_type(op->type);
+            write_string(op->name);
+            write_exprs(op->args);
+            write_enum(op->call_type);
+            write_function_reference(op->func);
+            write_int(op->value_index);
+            write_buffer(op->image);
+            write_parameter(op->param);
+            break;
+        }
+        case IRNodeType::Let: {
+            const Let *op = e.as<Let>();
+            write_string(op->name);
+            write_expr(op->value);
+            write_expr(op->body);
+            break;
+        }
+        case IRNodeType::Shuffle: {
+            const Shuffle *op = e.as<Shuffle>();
+            write_exprs(op->vectors);
+            write_uint(op->indices.size());
+            for (int i : op->indices) {
+                write_int(i);
+            }
+            break;
+        }
+        case IRNodeType::VectorReduce: {
+            const VectorReduce *op = e.as<VectorReduce>();
+            write_enum(op->op);
+            write_expr(op->value);
+            write_uint(op->type.lanes());
+            break;
+        }
+        default:
+            internal_error << "Unexpected Expr node type in serialization: " << e << "\n";
+        }
+        exprs.emplace(e.get(), exprs.size());
+    }
+
+    void write_exprs(const std::vector<Expr> &v) {
+        write_uint(v.size());
+        for (const Expr &e : v) {
+            write_expr(e);
+        }
+    }
+
+    void write_region(const Region &r) {
+        write_uint(r.size());
+        for (const Range &range : r) {
+            write_expr(range.min);
+            write_expr(range.extent);
+        }
+    }
+
+    void write_stmt(const Stmt &s) {
+        if (!s.defined()) {
+            write_uint(0);
+            return;
+        }
+        if (!write_reference(stmts, s.get())) {
+            return;
+        }
+        write_enum(s->node_type);
+        switch (s->node_type) {
+        case IRNodeType::LetStmt: {
+            const LetStmt *op = s.as<LetStmt>();
+            write_string(op->name);
+            write_expr(op->value);
+            write_stmt(op->body);
+            break;
+        }
+        case IRNodeType::AssertStmt: {
+            const AssertStmt *op = s.as<AssertStmt>();
+            write_expr(op->condition);
+            write_expr(op->message);
+            break;
+        }
+        case IRNodeType::ProducerConsumer: {
+            const ProducerConsumer *op = s.as<ProducerConsumer>();
+            write_string(op->name);
+            write_bool(op->is_producer);
+            write_stmt(op->body);
+            break;
+        }
+        case IRNodeType::For: {
+            const For *op = s.as<For>();
+            write_string(op->name);
+            write_expr(op->min);
+            write_expr(op->extent);
+            write_enum(op->for_type);
+            write_enum(op->partition_policy);
+            write_enum(op->device_api);
+            write_stmt(op->body);
+            write_enum(op->parallel_schedule);
+            write_expr(op->parallel_grain);
+            break;
+        }
+        case IRNodeType::Acquire: {
+            const Acquire *op = s.as<Acquire>();
+            write_expr(op->semaphore);
+            write_expr(op->count);
+            write_stmt(op->body);
+            break;
+        }
+        case IRNodeType::Store: {
+            const Store *op = s.as<Store>();
+            write_string(op->name);
+            write_expr(op->value);
+            write_expr(op->index);
+            write_parameter(op->param);
+            write_expr(op->predicate);
+            write_alignment(op->alignment);
+            break;
+        }
+        case IRNodeType::Provide: {
+            const Provide *op = s.as<Provide>();
+            write_string(op->name);
+            write_exprs(op->values);
+            write_exprs(op->args);
+            write_expr(op->predicate);
+            break;
+        }
+        case IRNodeType::Allocate: {
+            const Allocate *op = s.as<Allocate>();
+            write_string(op->name);
+            write_type(op->type);
+            write_enum(op->memory_type);
+            write_exprs(op->extents);
+            write_expr(op->condition);
+            write_expr(op->new_expr);
+            write_string(op->free_function);
+            write_int(op->padding);
+            write_stmt(op->body);
+            break;
+        }
+        case IRNodeType::Free:
+            write_string(s.as<Free>()->name);
+            break;
+        case IRNodeType::Realize: {
+            const Realize *op = s.as<Realize>();
+            write_string(op->name);
+            write_types(op->types);
+            write_enum(op->memory_type);
+            write_region(op->bounds);
+            write_expr(op->condition);
+            write_stmt(op->body);
+            break;
+        }
+        case IRNodeType::Block: {
+            const Block *op = s.as<Block>();
+            write_stmt(op->first);
+            write_stmt(op->rest);
+            break;
+        }
+        case IRNodeType::Fork: {
+            const Fork *op = s.as<Fork>();
+            write_stmt(op->first);
+            write_stmt(op->rest);
+            break;
+        }
+        case IRNodeType::IfThenElse: {
+            const IfThenElse *op = s.as<IfThenElse>();
+            write_expr(op->condition);
+            write_stmt(op->then_case);
+            write_stmt(op->else_case);
+            break;
+        }
+        case IRNodeType::Evaluate:
+            write_expr(s.as<Evaluate>()->value);
+            break;
+        case IRNodeType::Prefetch: {
+            const Prefetch *op = s.as<Prefetch>();
+            write_string(op->name);
+            write_types(op->types);
+            write_region(op->bounds);
+            write_prefetch_directive(op->prefetch);
+            write_expr(op->condition);
+            write_stmt(op->body);
+            break;
+        }
+        case IRNodeType::Atomic: {
+            const Atomic *op = s.as<Atomic>();
+            write_string(op->producer_name);
+            write_string(op->mutex_name);
+            write_stmt(op->body);
+            break;
+        }
+        default:
+            internal_error << "Unexpected Stmt node type in serialization: " << s << "\n";
+        }
+        stmts.emplace(s.get(), stmts.size());
+    }
+
+    void write_stmts(const std::vector<Stmt> &v) {
+        write_uint(v.size());
+        for (const Stmt &s : v) {
+            write_stmt(s);
+        }
+    }
+
+    void write_parameter(const Parameter &p) {
+        if (!p.defined()) {
+            write_uint(0);
+            return;
+        }
+        if (!write_reference(parameters, p)) {
+            return;
+        }
+        write_type(p.type());
+        write_bool(p.is_buffer());
+        write_int(p.dimensions());
+        write_string(p.name());
+        parameters.emplace(p, parameters.size());
+        if (p.is_buffer()) {
+            for (int i = 0; i < p.dimensions(); i++) {
+                write_expr(p.min_constraint(i));
+                write_expr(p.extent_constraint(i));
+                write_expr(p.stride_constraint(i));
+                write_expr(p.min_constraint_estimate(i));
+                write_expr(p.extent_constraint_estimate(i));
+            }
+            write_int(p.host_alignment());
+            write_enum(p.memory_type());
+        } else {
+            write_expr(p.min_value());
+            write_expr(p.max_value());
+            write_expr(p.estimate());
+            write_expr(p.default_value());
+            if (write_param_values) {
+                write_bytes(p.scalar_address(), sizeof(halide_scalar_value_t));
+            } else {
+                const halide_scalar_value_t zero = {};
+                write_bytes(&zero, sizeof(zero));
+            }
+        }
+    }
+
+    void write_parameters(const std::vector<Parameter> &v) {
+        write_uint(v.size());
+        for (const Parameter &p : v) {
+            write_parameter(p);
+        }
+    }
+
+    void write_buffer(const Buffer<> &b) {
+        if (!b.defined()) {
+            write_uint(0);
+            return;
+        }
+        if (!write_reference(buffers, b.get())) {
+            return;
+        }
+        write_string(b.name());
+        write_type(b.type());
+        write_int(b.dimensions());
+        buffers.emplace(b.get(), buffers.size());
+
+        // Write the contents of buffers with gaps or negative strides
+        // via a dense copy, so that the reader can allocate exactly
+        // size_in_bytes() bytes starting at the host pointer.
+        Buffer<> dense = b;
+        if (b.data()) {
+            user_assert(!b.device_dirty())
+                << "Can't serialize Buffer " << b.name()
+                << " because it has newer contents on the device than on the host.\n";
+            bool positive_strides = true;
+            for (int i = 0; i < b.dimensions(); i++) {
+                positive_strides &= b.dim(i).stride() > 0;
+            }
+            if (!positive_strides ||
+                b.size_in_bytes() != b.number_of_elements() * b.type().bytes()) {
+                dense = b.copy();
+            }
+        }
+        for (int i = 0; i < dense.dimensions(); i++) {
+            write_int(dense.dim(i).min());
+            write_int(dense.dim(i).extent());
+            write_int(dense.dim(i).stride());
+        }
+        write_bool(dense.data() != nullptr);
+        if (dense.data()) {
+            write_uint(dense.size_in_bytes());
+            write_bytes(dense.data(), dense.size_in_bytes());
+        }
+    }
+
+    void write_reduction_domain(const ReductionDomain &r) {
+        if (!r.defined()) {
+            write_uint(0);
+            return;
+        }
+        if (!write_reference(reduction_domains, r)) {
+            return;
+        }
+        write_reduction_variables(r.domain());
+        reduction_domains.emplace(r, reduction_domains.size());
+        write_expr(r.predicate());
+        write_bool(r.frozen());
+    }
+
+    void write_reduction_variables(const std::vector<ReductionVariable> &v) {
+        write_uint(v.size());
+        for (const ReductionVariable &rv : v) {
+            write_string(rv.var);
+            write_expr(rv.min);
+            write_expr(rv.extent);
+        }
+    }
+
+    void add_function(const Function &f) {
+        functions.emplace(f.get_contents(), functions.size());
+    }
+
+    // Calls to Funcs are lowered away, so the IR in a Module has no
+    // Functions to refer to and this writes an undefined reference.
+    void write_function_reference(const FunctionPtr &f) {
+        auto it = f.defined() ? functions.find(f) : functions.end();
+        write_uint(it == functions.end() ? 0 : it->second + 1);
+    }
+
+    void write_loop_level(const LoopLevel &l) {
+        write_string(l.func_name());
+        write_string(l.var_name());
+        write_bool(l.is_rvar());
+        write_int(l.raw_stage_index());
+        write_bool(l.locked());
+    }
+
+    void write_bounds(const std::vector<Bound> &v) {
+        write_uint(v.size());
+        for (const Bound &b : v) {
+            write_string(b.var);
+            write_expr(b.min);
+            write_expr(b.extent);
+            write_expr(b.modulus);
+            write_expr(b.remainder);
+        }
+    }
+
+    void write_func_schedule(const FuncSchedule &s) {
+        write_loop_level(s.store_level());
+        write_loop_level(s.compute_level());
+        write_loop_level(s.hoist_storage_level());
+        write_uint(s.storage_dims().size());
+        for (const StorageDim &d : s.storage_dims()) {
+            write_string(d.var);
+            write_expr(d.alignment);
+            write_expr(d.bound);
+            write_expr(d.fold_factor);
+            write_bool(d.fold_forward);
+            write_expr(d.tile_factor);
+        }
+        write_bounds(s.bounds());
+        write_bounds(s.estimates());
+        write_uint(s.wrappers().size());
+        for (const auto &it : s.wrappers()) {
+            write_string(it.first);
+            write_function_reference(it.second);
+        }
+        write_enum(s.memory_type());
+        write_bool(s.memoized());
+        write_bool(s.async());
+        write_expr(s.memoize_eviction_key());
+        write_expr(s.ring_buffer());
+    }
+
+    void write_prefetch_directive(const PrefetchDirective &p) {
+        write_string(p.name);
+        write_string(p.at);
+        write_string(p.from);
+        write_expr(p.offset);
+        write_enum(p.strategy);
+        write_parameter(p.param);
+    }
+
+    void write_stage_schedule(const StageSchedule &s) {
+        write_reduction_variables(s.rvars());
+        write_uint(s.splits().size());
+        for (const Split &split : s.splits()) {
+            write_string(split.old_var);
+            write_string(split.outer);
+            write_string(split.inner);
+            write_expr(split.factor);
+            write_bool(split.exact);
+            write_enum(split.tail);
+            write_enum(split.split_type);
+        }
+        write_uint(s.dims().size());
+        for (const Dim &d : s.dims()) {
+            write_string(d.var);
+            write_enum(d.for_type);
+            write_enum(d.device_api);
+            write_enum(d.dim_type);
+            write_enum(d.parallel_schedule);
+            write_expr(d.parallel_grain);
+            write_enum(d.partition_policy);
+        }
+        write_uint(s.prefetches().size());
+        for (const PrefetchDirective &p : s.prefetches()) {
+            write_prefetch_directive(p);
+        }
+        write_loop_level(s.fuse_level().level);
+        write_uint(s.fuse_level().align.size());
+        for (const auto &it : s.fuse_level().align) {
+            write_string(it.first);
+            write_enum(it.second);
+        }
+        write_uint(s.fused_pairs().size());
+        for (const FusedPair &p : s.fused_pairs()) {
+            write_string(p.func_1);
+            write_string(p.func_2);
+            write_uint(p.stage_1);
+            write_uint(p.stage_2);
+            write_string(p.var_name);
+        }
+        write_bool(s.touched());
+        write_bool(s.allow_race_conditions());
+        write_bool(s.atomic());
+        write_bool(s.override_atomic_associativity_test());
+    }
+
+    void write_definition(const Definition &d) {
+        write_bool(d.defined());
+        if (!d.defined()) {
+            return;
+        }
+        write_bool(d.is_init());
+        write_expr(d.predicate());
+        write_exprs(d.args());
+        write_exprs(d.values());
+        write_stage_schedule(d.schedule());
+        write_uint(d.specializations().size());
+        for (const Specialization &s : d.specializations()) {
+            write_expr(s.condition);
+            write_definition(s.definition);
+            write_string(s.failure_message);
+        }
+        write_string(d.source_location());
+    }
+
+    void write_extern_argument(const ExternFuncArgument &a) {
+        write_enum(a.arg_type);
+        write_function_reference(a.func);
+        write_buffer(a.buffer);
+        write_expr(a.expr);
+        write_parameter(a.image_param);
+    }
+
+    void write_function(const Function &f) {
+        write_string(f.origin_name());
+        write_types(f.output_types());
+        write_types(f.required_types());
+        write_int(f.required_dimensions());
+        write_strings(f.args());
+        write_func_schedule(f.schedule());
+        write_definition(f.has_pure_definition() ? f.definition() : Definition());
+        write_uint(f.updates().size());
+        for (const Definition &d : f.updates()) {
+            write_definition(d);
+        }
+        write_string(f.debug_file());
+        write_parameters(f.output_buffers());
+        write_uint(f.extern_arguments().size());
+        for (const ExternFuncArgument &a : f.extern_arguments()) {
+            write_extern_argument(a);
+        }
+        write_string(f.extern_function_name());
+        write_enum(f.extern_definition_name_mangling());
+        write_enum(f.extern_function_device_api());
+        write_expr(f.extern_definition_proxy_expr());
+        write_bool(f.is_tracing_loads());
+        write_bool(f.is_tracing_stores());
+        write_bool(f.is_tracing_realizations());
+        write_strings(f.get_trace_tags());
+        write_bool(f.frozen());
+    }
+
+    void write_argument(const LoweredArgument &a) {
+        write_string(a.name);
+        write_enum(a.kind);
+        write_uint(a.dimensions);
+        write_type(a.type);
+        write_expr(a.argument_estimates.scalar_def);
+        write_expr(a.argument_estimates.scalar_min);
+        write_expr(a.argument_estimates.scalar_max);
+        write_expr(a.argument_estimates.scalar_estimate);
+        write_region(a.argument_estimates.buffer_estimates);
+        write_alignment(a.alignment);
+    }
+
+    void write_module(const Module &m) {
+        write_string(m.name());
+        write_string(m.target().to_string());
+        write_bool(m.any_strict_float());
+        MetadataNameMap names = m.get_metadata_name_map();
+        write_uint(names.size());
+        for (const auto &it : names) {
+            write_string(it.first);
+            write_string(it.second);
+        }
+        write_uint(m.functions().size());
+        for (const LoweredFunc &f : m.functions()) {
+            write_string(f.name);
+            write_uint(f.args.size());
+            for (const LoweredArgument &a : f.args) {
+                write_argument(a);
+            }
+            write_stmt(f.body);
+            write_enum(f.linkage);
+            write_enum(f.name_mangling);
+        }
+        write_uint(m.buffers().size());
+        for (const Buffer<> &b : m.buffers()) {
+            write_buffer(b);
+        }
+        write_uint(m.submodules().size());
+        for (const Module &sub : m.submodules()) {
+            write_module(sub);
+        }
+    }
+};
+
+class Deserializer {
+    const uint8_t *pos, *end;
+    const std::map<std::string, Parameter> &user_params;
+
+    std::vector<std::string> strings;
+    std::vector<Expr> exprs;
+    std::vector<Stmt> stmts;
+    std::vector<Parameter> parameters;
+    std::vector<Buffer<>> buffers;
+    std::vector<ReductionDomain> reduction_domains;
+
+    template<typename T>
+    const T &lookup(const std::vector<T> &table, uint64_t ref) {
+        user_assert(ref - 2 < table.size())
+            << "Corrupt serialized Halide data: reference out of range\n";
+        return table[ref - 2];
+    }
+
+public:
+    std::vector<Function> functions;
+
+    Deserializer(const std::vector<uint8_t> &data,
+                 const std::map<std::string, Parameter> &user_params)
+        : pos(data.data()), end(data.data() + data.size()), user_params(user_params) {
+    }
+
+    uint8_t read_byte() {
+        user_assert(pos < end) << "Unexpected end of serialized Halide data\n";
+        return *pos++;
+    }
+
+    uint64_t read_uint() {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = read_byte();
+            result |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                break;
+            }
+        }
+        return result;
+    }
+
+    int64_t read_int() {
+        uint64_t x = read_uint();
+        return (int64_t)(x >> 1) ^ -(int64_t)(x & 1);
+    }
+
+    bool read_bool() {
+        return read_byte() != 0;
+    }
+
+    template<typename T>
+    T read_enum() {
+        return (T)read_uint();
+    }
+
+    double read_double() {
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; i++) {
+            bits |= (uint64_t)read_byte() << (i * 8);
+        }
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+
+    void read_bytes(void *data, size_t size) {
+        user_assert(size <= (size_t)(end - pos)) << "Unexpected end of serialized Halide data\n";
+        memcpy(data, pos, size);
+        pos += size;
+    }
+
+    void read_header(SerializedKind expected) {
+        uint8_t magic[sizeof(serialization_magic)];
+        read_bytes(magic, sizeof(magic));
+        user_assert(memcmp(magic, serialization_magic, sizeof(magic)) == 0)
+            << "Data is not a serialized Halide Pipeline or Module\n";
+        uint64_t version = read_uint();
+        user_assert(version == serialization_version)
+            << "Serialized Halide data has format version " << version
+            << ", but this version of Halide reads version " << serialization_version << "\n";
+        SerializedKind kind = read_enum<SerializedKind>();
+        user_assert(kind == expected)
+            << "Serialized Halide data contains a "
+            << (kind == SerializedKind::Pipeline ? "Pipeline" : "Module")
+            << ", not a " << (expected == SerializedKind::Pipeline ? "Pipeline" : "Module") << "\n";
+    }
+
+    std::string read_string() {
+        uint64_t ref = read_uint();
+        if (ref > 0) {
+            user_assert(ref - 1 < strings.size())
+                << "Corrupt serialized Halide data: reference out of range\n";
+            return strings[ref - 1];
+        }
+        size_t size = read_uint();
+        user_assert(size <= (size_t)(end - pos)) << "Unexpected end of serialized Halide data\n";
+        strings.emplace_back((const char *)pos, size);
+        pos += size;
+        return strings.back();
+    }
+
+    std::vector<std::string> read_strings() {
+        std::vector<std::string> v(read_uint());
+        for (std::string &s : v) {
+            s = read_string();
+        }
+        return v;
+    }
+
+    Type read_type() {
+        halide_type_code_t code = read_enum<halide_type_code_t>();
+        int bits = (int)read_uint();
+        int lanes = (int)read_uint();
+        return Type(code, bits, lanes);
+    }
+
+    std::vector<Type> read_types() {
+        std::vector<Type> v(read_uint());
+        for (Type &t : v) {
+            t = read_type();
+        }
+        return v;
+    }
+
+    ModulusRemainder read_alignment() {
+        int64_t modulus = read_int();
+        int64_t remainder = read_int();
+        return ModulusRemainder(modulus, remainder);
+    }
+
+    template<typename T>
+    Expr read_binary_op() {
+        Expr a = read_expr();
+        Expr b = read_expr();
+        return T::make(std::move(a), std::move(b));
+    }
+
+    Expr read_expr() {
+        uint64_t ref = read_uint();
+        if (ref == 0) {
+            return Expr();
+        } else if (ref > 1) {
+            return lookup(exprs, ref);
+        }
+        Expr e;
+        IRNodeType node_type = read_enum<IRNodeType>();
+        switch (node_type) {
+        case IRNodeType::IntImm: {
+            Type t = read_type();
+            e = IntImm::make(t, read_int());
+            break;
+        }
+        case IRNodeType::UIntImm: {
+            Type t = read_type();
+            e = UIntImm::make(t, read_uint());
+            break;
+        }
+        case IRNodeType::FloatImm: {
+            Type t = read_type();
+            e = FloatImm::make(t, read_double());
+            break;
+        }
+        case IRNodeType::StringImm:
+            e = StringImm::make(read_string());
+            break;
+        case IRNodeType::Broadcast: {
+            Expr value = read_expr();
+            int lanes = (int)read_uint();
+            e = Broadcast::make(std::move(value), lanes);
+            break;
+        }
+        case IRNodeType::Cast: {
+            Type t = read_type();
+            e = Cast::make(t, read_expr());
+            break;
+        }
+        case IRNodeType::Reinterpret: {
+            Type t = read_type();
+            e = Reinterpret::make(t, read_expr());
+            break;
+        }
+        case IRNodeType::Variable: {
+            Type t = read_type();
+            std::string name = read_string();
+            Parameter param = read_parameter();
+            Buffer<> image = read_buffer();
+            ReductionDomain rdom = read_reduction_domain();
+            e = Variable::make(t, name, image, param, rdom);
+            break;
+        }
+        case IRNodeType::Add:
+            e = read_binary_op<Add>();
+            break;
+        case IRNodeType::Sub:
+            e = read_binary_op<Sub>();
+            break;
+        case IRNodeType::Mod:
+            e = read_binary_op<Mod>();
+            break;
+        case IRNodeType::Mul:
+            e = read_binary_op<Mul>();
+            break;
+        case IRNodeType::Div:
+            e = read_binary_op<Div>();
+            break;
+        case IRNodeType::Min:
+            e = read_binary_op<Min>();
+            break;
+        case IRNodeType::Max:
+            e = read_binary_op<Max>();
+            break;
+        case IRNodeType::EQ:
+            e = read_binary_op<EQ>();
+            break;
+        case IRNodeType::NE:
+            e = read_binary_op<NE>();
+            break;
+        case IRNodeType::LT:
+            e = read_binary_op<LT>();
+            break;
+        case IRNodeType::LE:
+            e = read_binary_op<LE>();
+            break;
+        case IRNodeType::GT:
+            e = read_binary_op<GT>();
+            break;
+        case IRNodeType::GE:
+            e = read_binary_op<GE>();
+            break;
+        case IRNodeType::And:
+            e = read_binary_op<And>();
+            break;
+        case IRNodeType::Or:
+            e = read_binary_op<Or>();
+            break;
+        case IRNodeType::Not:
+            e = Not::make(read_expr());
+            break;
+        case IRNodeType::Select: {
+            Expr condition = read_expr();
+            Expr true_value = read_expr();
+            Expr false_value = read_expr();
+            e = Select::make(std::move(condition), std::move(true_value), std::move(false_value));
+            break;
+        }
+        case IRNodeType::Load: {
+            Type t = read_type();
+            std::string name = read_string();
+            Expr index = read_expr();
+            Buffer<> image = read_buffer();
+            Parameter param = read_parameter();
+            Expr predicate = read_expr();
+            ModulusRemainder alignment = read_alignment();
+            e = Load::make(t, name, std::move(index), image, param, std::move(predicate), alignment);
+            break;
+        }
+        case IRNodeType::Ramp: {
+            Expr base = read_expr();
+            Expr stride = read_expr();
+            int lanes = (int)read_uint();
+            e = Ramp::make(std::move(base), std::move(stride), lanes);
+            break;
+        }
+        case IRNodeType::Call: {
+            Type t = read_type();
+            std::string name = read_string();
+            std::vector<Expr> args = read_exprs();
+            Call::CallType call_type = read_enum<Call::CallType>();
+            FunctionPtr func = read_function_reference();
+            int value_index = (int)read_int();
+            Buffer<> image = read_buffer();
+            Parameter param = read_parameter();
+            e = Call::make(t, name, args, call_type, func, value_index, image, param);
+            break;
+        }
+        case IRNodeType::Let: {
+            std::string name = read_string();
+            Expr value = read_expr();
+            Expr body = read_expr();
+            e = Let::make(name, std::move(value), std::move(body));
+            break;
+        }
+        case IRNodeType::Shuffle: {
+            std::vector<Expr> vectors = read_exprs();
+            std::vector<int> indices(read_uint());
+            for (int &i : indices) {
+                i = (int)read_int();
+            }
+            e = Shuffle::make(vectors, indices);
+            break;
+        }
+        case IRNodeType::VectorReduce: {
+            VectorReduce::Operator op = read_enum<VectorReduce::Operator>();
+            Expr value = read_expr();
+            int lanes = (int)read_uint();
+            e = VectorReduce::make(op, std::move(value), lanes);
+            break;
+        }
+        default:
+            user_error << "Corrupt serialized Halide data: unknown Expr node type "
+                       << (int)node_type << "\n";
+        }
+        exprs.push_back(e);
+        return e;
+    }
+
+    std::vector<Expr> read_exprs() {
+        std::vector<Expr> v(read_uint());
+        for (Expr &e : v) {
+            e = read_expr();
+        }
+        return v;
+    }
+
+    Region read_region() {
+        Region r(read_uint());
+        for (Range &range : r) {
+            range.min = read_expr();
+            range.extent = read_expr();
+        }
+        return r;
+    }
+
+    Stmt read_stmt() {
+        uint64_t ref = read_uint();
+        if (ref == 0) {
+            return Stmt();
+        } else if (ref > 1) {
+            return lookup(stmts, ref);
+        }
+        Stmt s;
+        IRNodeType node_type = read_enum<IRNodeType>();
+        switch (node_type) {
+        case IRNodeType::LetStmt: {
+            std::string name = read_string();
+            Expr value = read_expr();
+            Stmt body = read_stmt();
+            s = LetStmt::make(name, std::move(value), std::move(body));
+            break;
+        }
+        case IRNodeType::AssertStmt: {
+            Expr condition = read_expr();
+            Expr message = read_expr();
+            s = AssertStmt::make(std::move(condition), std::move(message));
+            break;
+        }
+        case IRNodeType::ProducerConsumer: {
+            std::string name = read_string();
+            bool is_producer = read_bool();
+            Stmt body = read_stmt();
+            s = ProducerConsumer::make(name, is_producer, std::move(body));
+            break;
+        }
+        case IRNodeType::For: {
+            std::string name = read_string();
+            Expr min = read_expr();
+            Expr extent = read_expr();
+            ForType for_type = read_enum<ForType>();
+            Partition partition_policy = read_enum<Partition>();
+            DeviceAPI device_api = read_enum<DeviceAPI>();
+            Stmt body = read_stmt();
+            ParallelSchedule parallel_schedule = read_enum<ParallelSchedule>();
+            Expr parallel_grain = read_expr();
+            s = For::make(name, std::move(min), std::move(extent), for_type, partition_policy, device_api, std::move(body),
+                          parallel_schedule, std::move(parallel_grain));
+            break;
+        }
+        case IRNodeType::Acquire: {
+            Expr semaphore = read_expr();
+            Expr count = read_expr();
+            Stmt body = read_stmt();
+            s = Acquire::make(std::move(semaphore), std::move(count), std::move(body));
+            break;
+        }
+        case IRNodeType::Store: {
+            std::string name = read_string();
+            Expr value = read_expr();
+            Expr index = read_expr();
+            Parameter param = read_parameter();
+            Expr predicate = read_expr();
+            ModulusRemainder alignment = read_alignment();
+            s = Store::make(name, std::move(value), std::move(index), param, std::move(predicate), alignment);
+            break;
+        }
+        case IRNodeType::Provide: {
+            std::string name = read_string();
+            std::vector<Expr> values = read_exprs();
+            std::vector<Expr> args = read_exprs();
+            Expr predicate = read_expr();
+            s = Provide::make(name, values, args, predicate);
+            break;
+        }
+        case IRNodeType::Allocate: {
+            std::string name = read_string();
+            Type t = read_type();
+            MemoryType memory_type = read_enum<MemoryType>();
+            std::vector<Expr> extents = read_exprs();
+            Expr condition = read_expr();
+            Expr new_expr = read_expr();
+            std::string free_function = read_string();
+            int padding = (int)read_int();
+            Stmt body = read_stmt();
+            s = Allocate::make(name, t, memory_type, extents, std::move(condition), std::move(body),
+                               std::move(new_expr), free_function, padding);
+            break;
+        }
+        case IRNodeType::Free:
+            s = Free::make(read_string());
+            break;
+        case IRNodeType::Realize: {
+            std::string name = read_string();
+            std::vector<Type> types = read_types();
+            MemoryType memory_type = read_enum<MemoryType>();
+            Region bounds = read_region();
+            Expr condition = read_expr();
+            Stmt body = read_stmt();
+            s = Realize::make(name, types, memory_type, bounds, std::move(condition), std::move(body));
+            break;
+        }
+        case IRNodeType::Block: {
+            Stmt first = read_stmt();
+            Stmt rest = read_stmt();
+            s = Block::make(std::move(first), std::move(rest));
+            break;
+        }
+        case IRNodeType::Fork: {
+            Stmt first = read_stmt();
+            Stmt rest = read_stmt();
+            s = Fork::make(std::move(first), std::move(rest));
+            break;
+        }
+        case IRNodeType::IfThenElse: {
+            Expr condition = read_expr();
+            Stmt then_case = read_stmt();
+            Stmt else_case = read_stmt();
+            s = IfThenElse::make(std::move(condition), std::move(then_case), std::move(else_case));
+            break;
+        }
+        case IRNodeType::Evaluate:
+            s = Evaluate::make(read_expr());
+            break;
+        case IRNodeType::Prefetch: {
+            std::string name = read_string();
+            std::vector<Type> types = read_types();
+            Region bounds = read_region();
+            PrefetchDirective prefetch = read_prefetch_directive();
+            Expr condition = read_expr();
+            Stmt body = read_stmt();
+            s = Prefetch::make(name, types, bounds, prefetch, std::move(condition), std::move(body));
+            break;
+        }
+        case IRNodeType::Atomic: {
+            std::string producer_name = read_string();
+            std::string mutex_name = read_string();
+            Stmt body = read_stmt();
+            s = Atomic::make(producer_name, mutex_name, std::move(body));
+            break;
+        }
+        default:
+            user_error << "Corrupt serialized Halide data: unknown Stmt node type "
+                       << (int)node_type << "\n";
+        }
+        stmts.push_back(s);
+        return s;
+    }
+
+    std::vector<Stmt> read_stmts() {
+        std::vector<Stmt> v(read_uint());
+        for (Stmt &s : v) {
+            s = read_stmt();
+        }
+        return v;
+    }
+
+    Parameter read_parameter() {
+        uint64_t ref = read_uint();
+        if (ref == 0) {
+            return Parameter();
+        } else if (ref > 1) {
+            return lookup(parameters, ref);
+        }
+        Type t = read_type();
+        bool is_buffer = read_bool();
+        int dimensions = (int)read_int();
+        std::string name = read_string();
+
+        // Parameters the caller passed in are used as they are; we
+        // still have to read past the constraints serialized with them.
+        auto it = user_params.find(name);
+        const bool from_user = it != user_params.end();
+        Parameter p;
+        if (from_user) {
+            p = it->second;
+            user_assert(p.type() == t && p.is_buffer() == is_buffer && p.dimensions() == dimensions)
+                << "Parameter " << name << " passed to deserialize_pipeline does not match the "
+                << "serialized Parameter of the same name, which is a "
+                << (is_buffer ? std::to_string(dimensions) + "-dimensional buffer" : "scalar")
+                << " of type " << t << "\n";
+        } else {
+            p = Parameter(t, is_buffer, dimensions, name);
+        }
+        parameters.push_back(p);
+
+        if (is_buffer) {
+            for (int i = 0; i < dimensions; i++) {
+                Expr min = read_expr();
+                Expr extent = read_expr();
+                Expr stride = read_expr();
+                Expr min_estimate = read_expr();
+                Expr extent_estimate = read_expr();
+                if (!from_user) {
+                    p.set_min_constraint(i, min);
+                    p.set_extent_constraint(i, extent);
+                    p.set_stride_constraint(i, stride);
+                    p.set_min_constraint_estimate(i, min_estimate);
+                    p.set_extent_constraint_estimate(i, extent_estimate);
+                }
+            }
+            int host_alignment = (int)read_int();
+            MemoryType memory_type = read_enum<MemoryType>();
+            if (!from_user) {
+                p.set_host_alignment(host_alignment);
+                p.store_in(memory_type);
+            }
+        } else {
+            Expr min_value = read_expr();
+            Expr max_value = read_expr();
+            Expr estimate = read_expr();
+            Expr default_value = read_expr();
+            halide_scalar_value_t value;
+            read_bytes(&value, sizeof(value));
+            if (!from_user) {
+                p.set_min_value(min_value);
+                p.set_max_value(max_value);
+                p.set_estimate(estimate);
+                p.set_default_value(default_value);
+                memcpy(p.scalar_address(), &value, sizeof(value));
+            }
+        }
+        return p;
+    }
+
+    std::vector<Parameter> read_parameters() {
+        std::vector<Parameter> v(read_uint());
+        for (Parameter &p : v) {
+            p = read_parameter();
+        }
+        return v;
+    }
+
+    Buffer<> read_buffer() {
+        uint64_t ref = read_uint();
+        if (ref == 0) {
+            return Buffer<>();
+        } else if (ref > 1) {
+            return lookup(buffers, ref);
+        }
+        std::string name = read_string();
+        Type t = read_type();
+        int dimensions = (int)read_int();
+        std::vector<halide_dimension_t> shape(dimensions);
+        for (halide_dimension_t &d : shape) {
+            d.min = (int32_t)read_int();
+            d.extent = (int32_t)read_int();
+            d.stride = (int32_t)read_int();
+        }
+        Buffer<> b(t, nullptr, dimensions, shape.data(), name);
+        if (read_bool()) {
+            b.allocate();
+            size_t size = read_uint();
+            user_assert(size == b.size_in_bytes())
+                << "Corrupt serialized Halide data: wrong size for Buffer " << name << "\n";
+            read_bytes(b.data(), size);
+        }
+        buffers.push_back(b);
+        return b;
+    }
+
+    ReductionDomain read_reduction_domain() {
+        uint64_t ref = read_uint();
+        if (ref == 0) {
+            return ReductionDomain();
+        } else if (ref > 1) {
+            return lookup(reduction_domains, ref);
+        }
+        ReductionDomain r(read_reduction_variables());
+        reduction_domains.push_back(r);
+        r.set_predicate(read_expr());
+        if (read_bool()) {
+            r.freeze();
+        }
+        return r;
+    }
+
+    std::vector<ReductionVariable> read_reduction_variables() {
+        std::vector<ReductionVariable> v(read_uint());
+        for (ReductionVariable &rv : v) {
+            rv.var = read_string();
+            rv.min = read_expr();
+            rv.extent = read_expr();
+        }
+        return v;
+    }
+
+    // All of the Functions in a serialized pipeline are in one group,
+    // so references between them are weak.
+    FunctionPtr read_function_reference() {
+        uint64_t ref = read_uint();
+        if (ref == 0) {
+            return FunctionPtr();
+        }
+        user_assert(ref - 1 < functions.size())
+            << "Corrupt serialized Halide data: reference out of range\n";
+        FunctionPtr ptr = functions[ref - 1].get_contents();
+        ptr.weaken();
+        return ptr;
+    }
+
+    LoopLevel read_loop_level() {
+        std::string func_name = read_string();
+        std::string var_name = read_string();
+        bool is_rvar = read_bool();
+        int stage_index = (int)read_int();
+        bool locked = read_bool();
+        return LoopLevel(func_name, var_name, is_rvar, stage_index, locked);
+    }
+
+    std::vector<Bound> read_bounds() {
+        std::vector<Bound> v(read_uint());
+        for (Bound &b : v) {
+            b.var = read_string();
+            b.min = read_expr();
+            b.extent = read_expr();
+            b.modulus = read_expr();
+            b.remainder = read_expr();
+        }
+        return v;
+    }
+
+    FuncSchedule read_func_schedule() {
+        FuncSchedule s;
+        s.store_level() = read_loop_level();
+        s.compute_level() = read_loop_level();
+        s.hoist_storage_level() = read_loop_level();
+        s.storage_dims().resize(read_uint());
+        for (StorageDim &d : s.storage_dims()) {
+            d.var = read_string();
+            d.alignment = read_expr();
+            d.bound = read_expr();
+            d.fold_factor = read_expr();
+            d.fold_forward = read_bool();
+            d.tile_factor = read_expr();
+        }
+        s.bounds() = read_bounds();
+        s.estimates() = read_bounds();
+        size_t wrappers = read_uint();
+        for (size_t i = 0; i < wrappers; i++) {
+            std::string name = read_string();
+            s.wrappers()[name] = read_function_reference();
+        }
+        s.memory_type() = read_enum<MemoryType>();
+        s.memoized() = read_bool();
+        s.async() = read_bool();
+        s.memoize_eviction_key() = read_expr();
+        s.ring_buffer() = read_expr();
+        return s;
+    }
+
+    PrefetchDirective read_prefetch_directive() {
+        PrefetchDirective p;
+        p.name = read_string();
+        p.at = read_string();
+        p.from = read_string();
+        p.offset = read_expr();
+        p.strategy = read_enum<PrefetchBoundStrategy>();
+        p.param = read_parameter();
+        return p;
+    }
+
+    StageSchedule read_stage_schedule() {
+        StageSchedule s;
+        s.rvars() = read_reduction_variables();
+        s.splits().resize(read_uint());
+        for (Split &split : s.splits()) {
+            split.old_var = read_string();
+            split.outer = read_string();
+            split.inner = read_string();
+            split.factor = read_expr();
+            split.exact = read_bool();
+            split.tail = read_enum<TailStrategy>();
+            split.split_type = read_enum<Split::SplitType>();
+        }
+        s.dims().resize(read_uint());
+        for (Dim &d : s.dims()) {
+            d.var = read_string();
+            d.for_type = read_enum<ForType>();
+            d.device_api = read_enum<DeviceAPI>();
+            d.dim_type = read_enum<DimType>();
+            d.parallel_schedule = read_enum<ParallelSchedule>();
+            d.parallel_grain = read_expr();
+            d.partition_policy = read_enum<Partition>();
+        }
+        s.prefetches().resize(read_uint());
+        for (PrefetchDirective &p : s.prefetches()) {
+            p = read_prefetch_directive();
+        }
+        s.fuse_level().level = read_loop_level();
+        size_t aligns = read_uint();
+        for (size_t i = 0; i < aligns; i++) {
+            std::string var = read_string();
+            s.fuse_level().align[var] = read_enum<LoopAlignStrategy>();
+        }
+        s.fused_pairs().resize(read_uint());
+        for (FusedPair &p : s.fused_pairs()) {
+            p.func_1 = read_string();
+            p.func_2 = read_string();
+            p.stage_1 = read_uint();
+            p.stage_2 = read_uint();
+            p.var_name = read_string();
+        }
+        s.touched() = read_bool();
+        s.allow_race_conditions() = read_bool();
+        s.atomic() = read_bool();
+        s.override_atomic_associativity_test() = read_bool();
+        return s;
+    }
+
+    Definition read_definition() {
+        if (!read_bool()) {
+            return Definition();
+        }
+        bool is_init = read_bool();
+        Expr predicate = read_expr();
+        std::vector<Expr> args = read_exprs();
+        std::vector<Expr> values = read_exprs();
+        StageSchedule schedule = read_stage_schedule();
+        std::vector<Specialization> specializations(read_uint());
+        for (Specialization &s : specializations) {
+            s.condition = read_expr();
+            s.definition = read_definition();
+            s.failure_message = read_string();
+        }
+        std::string source_location = read_string();
+        return Definition(is_init, predicate, args, values, schedule, specializations, source_location);
+    }
+
+    ExternFuncArgument read_extern_argument() {
+        ExternFuncArgument a;
+        a.arg_type = read_enum<ExternFuncArgument::ArgType>();
+        a.func = read_function_reference();
+        a.buffer = read_buffer();
+        a.expr = read_expr();
+        a.image_param = read_parameter();
+        return a;
+    }
+
+    void read_function(Function &f) {
+        std::string origin_name = read_string();
+        std::vector<Type> output_types = read_types();
+        std::vector<Type> required_types = read_types();
+        int required_dims = (int)read_int();
+        std::vector<std::string> args = read_strings();
+        FuncSchedule func_schedule = read_func_schedule();
+        Definition init_def = read_definition();
+        std::vector<Definition> updates(read_uint());
+        for (Definition &d : updates) {
+            d = read_definition();
+        }
+        std::string debug_file = read_string();
+        std::vector<Parameter> output_buffers = read_parameters();
+        std::vector<ExternFuncArgument> extern_arguments(read_uint());
+        for (ExternFuncArgument &a : extern_arguments) {
+            a = read_extern_argument();
+        }
+        std::string extern_function_name = read_string();
+        NameMangling extern_mangling = read_enum<NameMangling>();
+        DeviceAPI extern_device_api = read_enum<DeviceAPI>();
+        Expr extern_proxy_expr = read_expr();
+        bool trace_loads = read_bool();
+        bool trace_stores = read_bool();
+        bool trace_realizations = read_bool();
+        std::vector<std::string> trace_tags = read_strings();
+        bool frozen = read_bool();
+        f.update_with_deserialization(f.name(), origin_name, output_types, required_types,
+                                      required_dims, args, func_schedule, init_def, updates,
+                                      debug_file, output_buffers, extern_arguments,
+                                      extern_function_name, extern_mangling, extern_device_api,
+                                      extern_proxy_expr, trace_loads, trace_stores,
+                                      trace_realizations, trace_tags, frozen);
+    }
+
+    LoweredArgument read_argument() {
+        std::string name = read_string();
+        Argument::Kind kind = read_enum<Argument::Kind>();
+        uint8_t dimensions = (uint8_t)read_uint();
+        Type t = read_type();
+        ArgumentEstimates estimates;
+        estimates.scalar_def = read_expr();
+        estimates.scalar_min = read_expr();
+        estimates.scalar_max = read_expr();
+        estimates.scalar_estimate = read_expr();
+        estimates.buffer_estimates = read_region();
+        LoweredArgument a(name, kind, t, dimensions, estimates);
+        a.alignment = read_alignment();
+        return a;
+    }
+
+    Module read_module() {
+        std::string name = read_string();
+        Target target(read_string());
+        bool any_strict_float = read_bool();
+        MetadataNameMap names;
+        size_t num_names = read_uint();
+        for (size_t i = 0; i < num_names; i++) {
+            std::string from = read_string();
+            names[from] = read_string();
+        }
+        Module m(name, target, names);
+        m.set_any_strict_float(any_strict_float);
+        size_t num_functions = read_uint();
+        for (size_t i = 0; i < num_functions; i++) {
+            std::string function_name = read_string();
+            std::vector<LoweredArgument> args(read_uint());
+            for (LoweredArgument &a : args) {
+                a = read_argument();
+            }
+            Stmt body = read_stmt();
+            LinkageType linkage = read_enum<LinkageType>();
+            NameMangling name_mangling = read_enum<NameMangling>();
+            m.append(LoweredFunc(function_name, args, body, linkage, name_mangling));
+        }
+        size_t num_buffers = read_uint();
+        for (size_t i = 0; i < num_buffers; i++) {
+            m.append(read_buffer());
+        }
+        size_t num_submodules = read_uint();
+        for (size_t i = 0; i < num_submodules; i++) {
+            m.append(read_module());
+        }
+        return m;
+    }
+
+    void check_at_end() {
+        user_assert(pos == end) << "Unexpected trailing bytes in serialized Halide data\n";
+    }
+};
+
+}  // namespace
+
+void serialize_pipeline(const Pipeline &pipeline, std::vector<uint8_t> &result) {
+    user_assert(pipeline.defined()) << "Can't serialize an undefined Pipeline\n";
+    result.clear();
+    Serializer s(result);
+    s.write_header(SerializedKind::Pipeline);
+
+    std::vector<Function> outputs;
+    for (const Func &f : pipeline.outputs()) {
+        outputs.push_back(f.function());
+    }
+    std::map<std::string, Function> env = build_environment(outputs);
+    s.write_uint(env.size());
+    for (const auto &it : env) {
+        s.write_string(it.first);
+        s.add_function(it.second);
+    }
+    for (const auto &it : env) {
+        s.write_function(it.second);
+    }
+    s.write_uint(outputs.size());
+    for (const Function &f : outputs) {
+        s.write_function_reference(f.get_contents());
+    }
+    s.write_stmts(pipeline.requirements());
+}
+
+void serialize_pipeline(const Pipeline &pipeline, const std::string &filename) {
+    std::vector<uint8_t> data;
+    serialize_pipeline(pipeline, data);
+    write_entire_file(filename, data.data(), data.size());
+}
+
+Pipeline deserialize_pipeline(const std::vector<uint8_t> &data,
+                              const std::map<std::string, Parameter> &user_params) {
+    Deserializer d(data, user_params);
+    d.read_header(SerializedKind::Pipeline);
+
+    // Make all of the Functions up front, so that they can refer to
+    // each other before their definitions have been read.
+    size_t num_functions = d.read_uint();
+    user_assert(num_functions > 0) << "Corrupt serialized Halide data: no Funcs in Pipeline\n";
+    for (size_t i = 0; i < num_functions; i++) {
+        std::string name = d.read_string();
+        if (i == 0) {
+            d.functions.emplace_back(name);
+        } else {
+            d.functions.push_back(d.functions[0].new_function_in_same_group(name));
+        }
+    }
+    for (Function &f : d.functions) {
+        d.read_function(f);
+    }
+
+    std::vector<Func> outputs(d.read_uint());
+    for (Func &f : outputs) {
+        FunctionPtr ptr = d.read_function_reference();
+        user_assert(ptr.defined()) << "Corrupt serialized Halide data: undefined output Func\n";
+        f = Func(Function(ptr));
+    }
+    std::vector<Stmt> requirements = d.read_stmts();
+    d.check_at_end();
+    return Pipeline(outputs, requirements);
+}
+
+Pipeline deserialize_pipeline(const std::string &filename,
+                              const std::map<std::string, Parameter> &user_params) {
+    std::vector<char> contents = read_entire_file(filename);
+    std::vector<uint8_t> data(contents.begin(), contents.end());
+    return deserialize_pipeline(data, user_params);
+}
+
+void serialize_module(const Module &module, std::vector<uint8_t> &result) {
+    result.clear();
+    Serializer s(result);
+    s.write_header(SerializedKind::Module);
+    s.write_module(module);
+}
+
+namespace Internal {
+
+void serialize_module_code(const Module &module, std::vector<uint8_t> &result) {
+    result.clear();
+    Serializer s(result);
+    s.write_param_values = false;
+    s.write_header(SerializedKind::Module);
+    s.write_module(module);
+}
+
+}  // namespace Internal
+
+Module deserialize_module(const std::vector<uint8_t> &data) {
+    const std::map<std::string, Parameter> no_user_params;
+    Deserializer d(data, no_user_params);
+    d.read_header(SerializedKind::Module);
+    Module m = d.read_module();
+    d.check_at_end();
+    return m;
+}
+
+}  // namespace Halide
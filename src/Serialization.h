@@ -0,0 +1,65 @@
+#ifndef HALIDE_SERIALIZATION_H
+#define HALIDE_SERIALIZATION_H
+
+/** \file
+ *
+ * Defines a compact binary format for saving and loading Pipelines
+ * and lowered Modules, so that they can be cached or sent between
+ * machines without re-running the code that built them.
+ */
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Module.h"
+#include "Parameter.h"
+#include "Pipeline.h"
+
+namespace Halide {
+
+/** Serialize a Pipeline: the definitions and schedules of all of the
+ * Funcs it computes, and the Parameters, Buffers and reduction domains
+ * they refer to. The format is versioned, and shared subexpressions
+ * are written only once. The values bound to Params and the contents of
+ * ImageParams are not included. Neither are JIT externs, custom
+ * lowering passes and other JIT-only state, nor the C++ names of handle
+ * types. */
+// @{
+void serialize_pipeline(const Pipeline &pipeline, std::vector<uint8_t> &result);
+void serialize_pipeline(const Pipeline &pipeline, const std::string &filename);
+// @}
+
+/** Deserialize a Pipeline written by serialize_pipeline. The Parameters
+ * it refers to are made afresh, except for those whose names appear in
+ * user_params, which are used instead so that the caller can bind
+ * values to them (e.g. pass {{"input", input.parameter()}} for an
+ * ImageParam called "input"). */
+// @{
+Pipeline deserialize_pipeline(const std::vector<uint8_t> &data,
+                              const std::map<std::string, Internal::Parameter> &user_params = {});
+Pipeline deserialize_pipeline(const std::string &filename,
+                              const std::map<std::string, Internal::Parameter> &user_params = {});
+// @}
+
+/** Serialize a lowered Module, including its Buffers and submodules,
+ * in the same format as serialize_pipeline. The auto-scheduler results
+ * attached to it are not included. */
+void serialize_module(const Module &module, std::vector<uint8_t> &result);
+
+/** Deserialize a Module written by serialize_module. */
+Module deserialize_module(const std::vector<uint8_t> &data);
+
+namespace Internal {
+
+/** Serialize a Module as serialize_module does, but without the
+ * current values of its scalar Parameters, which don't affect the code
+ * compiled from it. For keys of caches of compiled code. */
+void serialize_module_code(const Module &module, std::vector<uint8_t> &result);
+
+}  // namespace Internal
+
+}  // namespace Halide
+
+#endif
@@ -5,6 +5,7 @@
 #include "CompilerLogger.h"
 #include "IRMutator.h"
 #include "Substitute.h"
+#include "Util.h"
 
 namespace Halide {
 namespace Internal {
@@ -19,8 +20,40 @@ using std::vector;
 int Simplify::debug_indent = 0;
 #endif
 
+namespace {
+
+bool hash_cons_enabled() {
+    static const bool enabled = get_env_variable("HL_SIMPLIFY_HASH_CONS") == "1";
+    return enabled;
+}
+
+// Read each time, so that lowering with and without the memo can be
+// compared in one process.
+bool memo_enabled() {
+    return get_env_variable("HL_SIMPLIFY_MEMO") != "0";
+}
+
+// The simplifier's scopes are keyed by interned names unless
+// HL_INTERN_NAMES=0, in which case they're keyed by std::string. Read
+// each time, so that the two can be compared in one process.
+bool intern_names_enabled() {
+    return get_env_variable("HL_INTERN_NAMES") != "0";
+}
+
+// The memo is cleared when it grows past this many entries, to bound
+// the memory it uses (and the IR it keeps alive) on huge Stmts.
+constexpr size_t max_memo_entries = 1 << 14;
+
+// Likewise for the table of canonical Exprs used for hash-consing.
+constexpr size_t max_hash_cons_entries = 1 << 14;
+
+}  // namespace
+
 Simplify::Simplify(bool r, const Scope<Interval> *bi, const Scope<ModulusRemainder> *ai)
-    : remove_dead_code(r), no_float_simplify(false) {
+    : remove_dead_code(r), no_float_simplify(false),
+      use_memo(memo_enabled()), hash_cons(hash_cons_enabled()), hash_cons_cache(hash_cons ? 8 : 0),
+      var_info(!intern_names_enabled(), &interned_names),
+      bounds_and_alignment_info(!intern_names_enabled(), &interned_names) {
 
     // Only respect the constant bounds from the containing scope.
     for (auto iter = bi->cbegin(); iter != bi->cend(); ++iter) {
@@ -71,21 +104,88 @@ std::pair<std::vector<Expr>, bool> Simplify::mutate_with_changes(const std::vect
     return {std::move(new_exprs), changed};
 }
 
+Expr Simplify::mutate_memoized(const BaseExprNode *op, ExprInfo *b) {
+    // Simplifying an Expr in unreachable code can give a different
+    // answer, so don't memoize there.
+    const bool memoize = use_memo && !in_unreachable && op->ref_count.is_shared();
+    if (memoize) {
+        auto it = memo.find(op);
+        if (it != memo.end()) {
+            const MemoEntry &entry = it->second;
+            if (entry.context == memo_context &&
+                entry.in_vector_loop == in_vector_loop &&
+                entry.no_float_simplify == no_float_simplify &&
+                (entry.info_valid || !b)) {
+                if (b) {
+                    *b = entry.info;
+                }
+                return entry.result;
+            }
+        }
+    }
+
+    // Not every visitor sets every field of the ExprInfo, so simplify
+    // into a fresh one rather than memoizing whatever the caller had
+    // left in theirs.
+    const uint64_t old_context = memo_context;
+    const uint64_t old_first_uses = first_uses;
+    const Expr e(op);
+    ExprInfo info;
+    memo_in_progress = op;
+    Expr result = Super::dispatch(e, b ? &info : nullptr);
+    if (b) {
+        *b = info;
+    }
+
+    if (should_hash_cons(result)) {
+        if (hash_cons_table.size() >= max_hash_cons_entries) {
+            hash_cons_table.clear();
+            hash_cons_cache.clear();
+        }
+        result = hash_cons_table.insert(ExprWithCompareCache(result, &hash_cons_cache)).first->expr;
+    }
+
+    if (memoize &&
+        !in_unreachable &&
+        memo_context == old_context &&
+        first_uses == old_first_uses) {
+        if (memo.size() >= max_memo_entries) {
+            memo.clear();
+        }
+        MemoEntry &entry = memo[op];
+        entry.key = e;
+        entry.result = result;
+        entry.info = info;
+        entry.info_valid = (b != nullptr);
+        entry.in_vector_loop = in_vector_loop;
+        entry.no_float_simplify = no_float_simplify;
+        entry.context = memo_context;
+    }
+
+    return result;
+}
+
 void Simplify::found_buffer_reference(const string &name, size_t dimensions) {
     for (size_t i = 0; i < dimensions; i++) {
         string stride = name + ".stride." + std::to_string(i);
         if (var_info.contains(stride)) {
-            var_info.ref(stride).old_uses++;
+            if (var_info.ref(stride).old_uses++ == 0) {
+                first_uses++;
+            }
         }
 
         string min = name + ".min." + std::to_string(i);
         if (var_info.contains(min)) {
-            var_info.ref(min).old_uses++;
+            if (var_info.ref(min).old_uses++ == 0) {
+                first_uses++;
+            }
         }
     }
 
     if (var_info.contains(name)) {
-        var_info.ref(name).old_uses++;
+        if (var_info.ref(name).old_uses++ == 0) {
+            first_uses++;
+        }
     }
 }
 
@@ -181,6 +281,7 @@ void Simplify::ScopedFact::learn_false(const Expr &fact) {
     if (simplify->falsehoods.insert(fact).second) {
         falsehoods.push_back(fact);
     }
+    simplify->context_changed();
 }
 
 void Simplify::ScopedFact::learn_upper_bound(const Variable *v, int64_t val) {
@@ -192,6 +293,7 @@ void Simplify::ScopedFact::learn_upper_bound(const Variable *v, int64_t val) {
     }
     simplify->bounds_and_alignment_info.push(v->name, b);
     bounds_pop_list.push_back(v);
+    simplify->context_changed();
 }
 
 void Simplify::ScopedFact::learn_lower_bound(const Variable *v, int64_t val) {
@@ -203,6 +305,7 @@ void Simplify::ScopedFact::learn_lower_bound(const Variable *v, int64_t val) {
     }
     simplify->bounds_and_alignment_info.push(v->name, b);
     bounds_pop_list.push_back(v);
+    simplify->context_changed();
 }
 
 void Simplify::ScopedFact::learn_true(const Expr &fact) {
@@ -316,6 +419,7 @@ void Simplify::ScopedFact::learn_true(const Expr &fact) {
     if (simplify->truths.insert(fact).second) {
         truths.push_back(fact);
     }
+    simplify->context_changed();
 }
 
 template<class T>
@@ -351,6 +455,7 @@ Simplify::ScopedFact::~ScopedFact() {
     for (const auto &e : falsehoods) {
         simplify->falsehoods.erase(e);
     }
+    simplify->context_changed();
 }
 
 Expr simplify(const Expr &e, bool remove_dead_let_stmts,
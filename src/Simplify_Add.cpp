@@ -4,6 +4,10 @@ namespace Halide {
 namespace Internal {
 
 Expr Simplify::visit(const Add *op, ExprInfo *bounds) {
+    if (should_memoize(op)) {
+        return mutate_memoized(op, bounds);
+    }
+
     ExprInfo a_bounds, b_bounds;
     Expr a = mutate(op->a, &a_bounds);
     Expr b = mutate(op->b, &b_bounds);
@@ -241,7 +241,9 @@ Expr Simplify::visit(const Variable *op, ExprInfo *bounds) {
                 << "Cannot replace variable " << op->name
                 << " of type " << op->type
                 << " with expression of type " << info.replacement.type() << "\n";
-            info.new_uses++;
+            if (info.new_uses++ == 0) {
+                first_uses++;
+            }
             // We want to remutate the replacement, because we may be
             // injecting it into a context where it is known to be a
             // constant (e.g. due to an if).
@@ -249,7 +251,9 @@ Expr Simplify::visit(const Variable *op, ExprInfo *bounds) {
         } else {
             // This expression was not something deemed
             // substitutable - no replacement is defined.
-            info.old_uses++;
+            if (info.old_uses++ == 0) {
+                first_uses++;
+            }
             return op;
         }
     } else {
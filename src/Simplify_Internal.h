@@ -6,7 +6,10 @@
  * this single shared header to speed up the build. This file is not
  * exported in Halide.h. */
 
+#include <unordered_map>
+
 #include "Bounds.h"
+#include "IREquality.h"
 #include "IRMatch.h"
 #include "IRVisitor.h"
 #include "Scope.h"
@@ -143,6 +146,7 @@ public:
         debug(1) << spaces << "Simplifying Stmt: " << s << "\n";
         debug_indent++;
         Stmt new_s = Super::dispatch(s);
+        context_changed();
         debug_indent--;
         if (!new_s.same_as(s)) {
             debug(1)
@@ -153,13 +157,80 @@ public:
     }
 #else
     Stmt mutate(const Stmt &s) {
-        return Super::dispatch(s);
+        Stmt new_s = Super::dispatch(s);
+        // Anything the visitor put into scope is gone now.
+        context_changed();
+        return new_s;
     }
 #endif
 
     bool remove_dead_code;
     bool no_float_simplify;
 
+    // Exprs built by bounds inference and substitution are often
+    // graphs with many paths to the same node. To avoid simplifying a
+    // shared node once per path, we memoize the results of simplifying
+    // shared non-leaf Exprs. The result of simplifying an Expr depends
+    // on the let bindings, bounds, and facts in scope, so each entry
+    // records the context it was made in, and every change to that
+    // state must call context_changed(). Simplifying an Expr can also
+    // mark lets as used, so an entry is only made if simplifying the
+    // Expr marked nothing as used for the first time; marking it again
+    // on a hit would not change anything.
+    //
+    // Only the visitors for the node types that bounds inference builds
+    // shared graphs of (Add, Sub, Mul, Div, Min, Max, Select and Let)
+    // check the memo, so that mutate itself stays a plain dispatch.
+    // Set HL_SIMPLIFY_MEMO=0 to turn it off.
+    struct MemoEntry {
+        // Holding the Expr keeps its address from being reused.
+        Expr key, result;
+        ExprInfo info;
+        bool info_valid;
+        bool in_vector_loop, no_float_simplify;
+        uint64_t context;
+    };
+    bool use_memo;
+    std::unordered_map<const IRNode *, MemoEntry> memo;
+    uint64_t memo_context = 0;
+    uint64_t first_uses = 0;
+
+    // The node mutate_memoized is simplifying, so that the visitor it
+    // dispatches to doesn't check the memo again.
+    const IRNode *memo_in_progress = nullptr;
+
+    // If set, the results of simplifying non-leaf Exprs are
+    // canonicalized so that Exprs that are equal by value are also
+    // equal by identity, which increases sharing and the hit rate of
+    // the memo above. Off by default. Set HL_SIMPLIFY_HASH_CONS=1 to
+    // turn it on.
+    bool hash_cons;
+    IRCompareCache hash_cons_cache;
+    std::set<ExprWithCompareCache> hash_cons_table;
+
+    HALIDE_ALWAYS_INLINE
+    void context_changed() {
+        memo_context++;
+    }
+
+    // Called at the top of the visitors that use the memo.
+    HALIDE_ALWAYS_INLINE
+    bool should_memoize(const BaseExprNode *op) {
+        if (op == memo_in_progress) {
+            memo_in_progress = nullptr;
+            return false;
+        }
+        return hash_cons || (use_memo && op->ref_count.is_shared());
+    }
+
+    HALIDE_ALWAYS_INLINE
+    bool should_hash_cons(const Expr &e) const {
+        const IRNodeType t = e.node_type();
+        return hash_cons && t > IRNodeType::StringImm && t != IRNodeType::Variable;
+    }
+
+    Expr mutate_memoized(const BaseExprNode *op, ExprInfo *b);
+
     HALIDE_ALWAYS_INLINE
     bool may_simplify(const Type &t) const {
         return !no_float_simplify || !t.is_float();
@@ -187,11 +258,17 @@ public:
         int old_uses, new_uses;
     };
 
-    // Tracked for all let vars
-    Scope<VarInfo> var_info;
+    // The interned forms of the names looked up in the two scopes
+    // below. They share it, so a name looked up again in either scope
+    // costs a string hash, and no lock on the intern table.
+    InternedNameCache interned_names;
+
+    // Tracked for all let vars. Both this and the scope below are
+    // keyed by interned names unless HL_INTERN_NAMES=0.
+    InternedScope<VarInfo> var_info;
 
     // Only tracked for integer let vars
-    Scope<ExprInfo> bounds_and_alignment_info;
+    InternedScope<ExprInfo> bounds_and_alignment_info;
 
     // Symbols used by rewrite rules
     IRMatcher::Wild<0> x;
@@ -199,6 +199,7 @@ Body Simplify::simplify_let(const LetOrLetStmt *op, ExprInfo *bounds) {
         info.replacement = replacement;
 
         var_info.push(op->name, info);
+        context_changed();
 
         // Before we enter the body, track the alignment info
 
@@ -219,6 +220,7 @@ Body Simplify::simplify_let(const LetOrLetStmt *op, ExprInfo *bounds) {
                 f.value_bounds_tracked = true;
             }
         }
+        context_changed();
 
         result = op->body;
         op = result.template as<LetOrLetStmt>();
@@ -245,6 +247,7 @@ Body Simplify::simplify_let(const LetOrLetStmt *op, ExprInfo *bounds) {
 
         VarInfo info = var_info.get(it->op->name);
         var_info.pop(it->op->name);
+        context_changed();
 
         if (it->new_value.defined() && (info.new_uses > 0 && vars_used.count(it->new_name) > 0)) {
             // The new name/value may be used
@@ -272,6 +275,10 @@ Body Simplify::simplify_let(const LetOrLetStmt *op, ExprInfo *bounds) {
 }
 
 Expr Simplify::visit(const Let *op, ExprInfo *bounds) {
+    if (should_memoize(op)) {
+        return mutate_memoized(op, bounds);
+    }
+
     return simplify_let<Let, Expr>(op, bounds);
 }
 
@@ -4,6 +4,9 @@ namespace Halide {
 namespace Internal {
 
 Expr Simplify::visit(const Select *op, ExprInfo *bounds) {
+    if (should_memoize(op)) {
+        return mutate_memoized(op, bounds);
+    }
 
     ExprInfo t_bounds, f_bounds;
     Expr condition = mutate(op->condition, nullptr);
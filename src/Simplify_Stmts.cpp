@@ -221,6 +221,7 @@ Stmt Simplify::visit(const For *op) {
         bounds_tracked = true;
         bounds_and_alignment_info.push(op->name, min_bounds);
     }
+    context_changed();
 
     Stmt new_body;
     {
@@ -239,6 +240,7 @@ Stmt Simplify::visit(const For *op) {
 
     if (bounds_tracked) {
         bounds_and_alignment_info.pop(op->name);
+        context_changed();
     }
 
     if (const Acquire *acquire = new_body.as<Acquire>()) {
@@ -262,13 +264,13 @@ Stmt Simplify::visit(const For *op) {
         }
         return mutate(s);
     } else if (!stmt_uses_var(new_body, op->name) && !is_const_zero(op->min)) {
-        return For::make(op->name, make_zero(Int(32)), new_extent, op->for_type, op->device_api, new_body);
+        return For::make(op->name, make_zero(Int(32)), new_extent, op->for_type, op->partition_policy, op->device_api, new_body, op->parallel_schedule, op->parallel_grain);
     } else if (op->min.same_as(new_min) &&
                op->extent.same_as(new_extent) &&
                op->body.same_as(new_body)) {
         return op;
     } else {
-        return For::make(op->name, new_min, new_extent, op->for_type, op->device_api, new_body);
+        return For::make(op->name, new_min, new_extent, op->for_type, op->partition_policy, op->device_api, new_body, op->parallel_schedule, op->parallel_grain);
     }
 }
 
@@ -375,7 +377,8 @@ Stmt Simplify::visit(const Allocate *op) {
         total_extent_info.max -= 1;
     }
 
-    ScopedBinding<ExprInfo> b(bounds_and_alignment_info, op->name + ".total_extent_bytes", total_extent_info);
+    ScopedBinding<ExprInfo, InternedScope<ExprInfo>> b(bounds_and_alignment_info, op->name + ".total_extent_bytes", total_extent_info);
+    context_changed();
 
     Stmt body = mutate(op->body);
     Expr condition = mutate(op->condition, nullptr);
@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <map>
+
+#include "Bounds.h"
+#include "CodeGen_Internal.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Scope.h"
+#include "StaticMemoryPlanning.h"
+#include "Target.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+namespace {
+
+// halide_malloc never returns memory aligned to more than this on any
+// target, so offsets that are a multiple of it leave each planned
+// allocation at least as aligned as it would have been on its own.
+constexpr int64_t arena_alignment = 128;
+
+int64_t align_up(int64_t x) {
+    return (x + arena_alignment - 1) & ~(arena_alignment - 1);
+}
+
+struct PlannedAllocation {
+    std::string name;
+    // Upper bound on the size in bytes, including padding.
+    int64_t size;
+    // The lifetime of the allocation, in program order.
+    int first_use, last_use;
+    // The number of enclosing if statements. A Free only ends the
+    // lifetime if it's not conditional relative to the Allocate.
+    int control_depth;
+    // The statements enclosing the allocation, outermost first,
+    // ending with the Allocate node itself.
+    std::vector<const IRNode *> path;
+    int64_t offset;
+};
+
+// Find heap allocations outside of any loop with a constant upper
+// bound on their size, and the program-order interval over which
+// each one is live.
+class FindPlannableAllocations : public IRVisitor {
+public:
+    std::vector<PlannedAllocation> allocations;
+
+private:
+    using IRVisitor::visit;
+
+    // Track constant bounds
+    Scope<Interval> scope;
+
+    // The index into allocations of each planned allocation in scope.
+    Scope<size_t> planned;
+
+    std::vector<const IRNode *> path;
+    int time = 0;
+    int control_depth = 0;
+    bool in_loop = false;
+
+    int64_t plannable_size(const Allocate *op) const {
+        if (in_loop ||
+            (op->memory_type != MemoryType::Heap &&
+             op->memory_type != MemoryType::Auto) ||
+            op->new_expr.defined() ||
+            !op->free_function.empty() ||
+            op->extents.empty()) {
+            return 0;
+        }
+
+        Expr total_extent = make_const(Int(64), 1);
+        for (const Expr &e : op->extents) {
+            total_extent *= e;
+        }
+        Expr bound = find_constant_bound(total_extent, Direction::Upper, scope);
+        const int64_t *extent = bound.defined() ? as_const_int(bound) : nullptr;
+        if (!extent || *extent <= 0 || *extent >= ((int64_t)1 << 31)) {
+            return 0;
+        }
+        int64_t size = (*extent + op->padding) * op->type.bytes();
+
+        if (op->memory_type == MemoryType::Auto &&
+            op->constant_allocation_size() > 0 &&
+            can_allocation_fit_on_stack(size)) {
+            // This one is going on the stack anyway.
+            return 0;
+        }
+        return size;
+    }
+
+    void visit(const LetStmt *op) override {
+        // Visit an entire chain of lets in a single method to conserve stack space.
+        std::vector<ScopedBinding<Interval>> bindings;
+        size_t old_path_size = path.size();
+        Stmt body;
+        do {
+            bindings.emplace_back(scope, op->name, find_constant_bounds(op->value, scope));
+            path.push_back(op);
+            body = op->body;
+        } while ((op = body.as<LetStmt>()));
+        body.accept(this);
+        path.resize(old_path_size);
+    }
+
+    void visit(const Block *op) override {
+        path.push_back(op);
+        op->first.accept(this);
+        op->rest.accept(this);
+        path.pop_back();
+    }
+
+    void visit(const ProducerConsumer *op) override {
+        path.push_back(op);
+        op->body.accept(this);
+        path.pop_back();
+    }
+
+    void visit(const Atomic *op) override {
+        path.push_back(op);
+        op->body.accept(this);
+        path.pop_back();
+    }
+
+    void visit(const IfThenElse *op) override {
+        path.push_back(op);
+        ScopedValue<int> old_control_depth(control_depth, control_depth + 1);
+        op->then_case.accept(this);
+        if (op->else_case.defined()) {
+            op->else_case.accept(this);
+        }
+        path.pop_back();
+    }
+
+    // Anything inside a loop or a concurrent task may be live more
+    // than once at the same time, so we don't plan allocations there.
+    void visit(const For *op) override {
+        ScopedValue<bool> old_in_loop(in_loop, true);
+        ScopedValue<int> old_control_depth(control_depth, control_depth + 1);
+        op->body.accept(this);
+    }
+
+    void visit(const Fork *op) override {
+        ScopedValue<bool> old_in_loop(in_loop, true);
+        ScopedValue<int> old_control_depth(control_depth, control_depth + 1);
+        op->first.accept(this);
+        op->rest.accept(this);
+    }
+
+    void visit(const Acquire *op) override {
+        ScopedValue<bool> old_in_loop(in_loop, true);
+        ScopedValue<int> old_control_depth(control_depth, control_depth + 1);
+        op->body.accept(this);
+    }
+
+    void visit(const Allocate *op) override {
+        path.push_back(op);
+        int64_t size = plannable_size(op);
+        if (size > 0) {
+            size_t idx = allocations.size();
+            allocations.push_back({op->name, size, ++time, -1, control_depth, path, 0});
+            ScopedBinding<size_t> bind(planned, op->name, idx);
+            op->body.accept(this);
+            if (allocations[idx].last_use < 0) {
+                allocations[idx].last_use = ++time;
+            }
+        } else {
+            op->body.accept(this);
+        }
+        path.pop_back();
+    }
+
+    void visit(const Free *op) override {
+        if (planned.contains(op->name)) {
+            PlannedAllocation &alloc = allocations[planned.get(op->name)];
+            if (alloc.control_depth == control_depth && alloc.last_use < 0) {
+                alloc.last_use = ++time;
+            }
+        }
+    }
+};
+
+// Assign offsets using a greedy algorithm: place the allocations
+// from largest to smallest, each in the first gap that is large
+// enough between the already-placed allocations that are live at the
+// same time. This is the same approach as the hannk allocation
+// planner. Returns the size of the arena.
+int64_t assign_offsets(std::vector<PlannedAllocation> &allocations) {
+    std::vector<PlannedAllocation *> order;
+    order.reserve(allocations.size());
+    for (PlannedAllocation &a : allocations) {
+        order.push_back(&a);
+    }
+    std::sort(order.begin(), order.end(),
+              [](const PlannedAllocation *a, const PlannedAllocation *b) {
+                  if (a->size != b->size) {
+                      return a->size > b->size;
+                  }
+                  return a->first_use < b->first_use;
+              });
+
+    int64_t arena_size = 0;
+    std::vector<const PlannedAllocation *> placed, overlapping;
+    for (PlannedAllocation *a : order) {
+        overlapping.clear();
+        for (const PlannedAllocation *p : placed) {
+            if (p->first_use <= a->last_use && a->first_use <= p->last_use) {
+                overlapping.push_back(p);
+            }
+        }
+        std::sort(overlapping.begin(), overlapping.end(),
+                  [](const PlannedAllocation *a, const PlannedAllocation *b) {
+                      return a->offset < b->offset;
+                  });
+
+        int64_t offset = 0;
+        for (const PlannedAllocation *p : overlapping) {
+            if (p->offset >= offset + a->size) {
+                break;
+            }
+            offset = std::max(offset, align_up(p->offset + p->size));
+        }
+        a->offset = offset;
+        arena_size = std::max(arena_size, offset + a->size);
+        placed.push_back(a);
+    }
+    return arena_size;
+}
+
+// Rewrite the planned allocations to point into the arena, and wrap
+// the given statement in the allocation of the arena itself.
+class UseArena : public IRMutator {
+    const std::map<std::string, int64_t> &offsets;
+    const IRNode *wrap;
+    std::string arena_name;
+    int64_t arena_size;
+    const Target &target;
+
+    using IRMutator::visit;
+
+    Stmt visit(const Allocate *op) override {
+        auto it = offsets.find(op->name);
+        if (it == offsets.end()) {
+            return IRMutator::visit(op);
+        }
+        Expr base = reinterpret<uint64_t>(Variable::make(Handle(), arena_name));
+        Expr new_expr = reinterpret(Handle(), base + make_const(UInt(64), it->second));
+        // The arena owns the memory, so freeing a planned allocation is a no-op.
+        return Allocate::make(op->name, op->type, op->memory_type, op->extents, op->condition,
+                              mutate(op->body), new_expr, "halide_device_host_nop_free", op->padding);
+    }
+
+    Stmt make_arena(const Stmt &body) const {
+        if (!target.has_feature(Target::ScratchArena)) {
+            return Allocate::make(arena_name, UInt(8), MemoryType::Heap, {(int32_t)arena_size},
+                                  const_true(), body);
+        }
+
+        // Use the scratch buffer if it has room for the arena after
+        // aligning its host pointer. None of its fields may be read
+        // unless it is non-null and has at least one dimension.
+        Expr buf = Variable::make(type_of<struct halide_buffer_t *>(), "__scratch.buffer");
+        Expr host = reinterpret<uint64_t>(Call::make(Handle(), Call::buffer_get_host, {buf}, Call::Extern));
+        Expr aligned_host = (host + make_const(UInt(64), arena_alignment - 1)) &
+                            make_const(UInt(64), ~(uint64_t)(arena_alignment - 1));
+        Expr extent = Call::make(Int(32), Call::buffer_get_extent, {buf, 0}, Call::Extern);
+        Expr dimensions = Call::make(Int(32), Call::buffer_get_dimensions, {buf}, Call::Extern);
+        Expr room = cast<int64_t>(extent) - cast<int64_t>(aligned_host - host);
+        Expr fits_value = (host != make_zero(UInt(64))) && (room >= make_const(Int(64), arena_size));
+        fits_value = Call::make(Bool(), Call::if_then_else, {dimensions > 0, fits_value, const_false()},
+                                Call::PureIntrinsic);
+        fits_value = Call::make(Bool(), Call::if_then_else,
+                                {reinterpret<uint64_t>(buf) != make_zero(UInt(64)), fits_value, const_false()},
+                                Call::PureIntrinsic);
+
+        std::string fits_name = arena_name + ".fits";
+        std::string heap_name = arena_name + ".heap";
+        Expr fits = Variable::make(Bool(), fits_name);
+        Expr null_handle = reinterpret(Handle(), make_zero(UInt(64)));
+
+        // Otherwise fall back to the heap. The new_expr is null when
+        // the scratch buffer is used, so nothing is freed either.
+        Type size_type = target.bits == 64 ? UInt(64) : UInt(32);
+        Expr heap_alloc = Call::make(Handle(), "halide_malloc", {make_const(size_type, arena_size)}, Call::Extern);
+        heap_alloc = Call::make(Handle(), Call::if_then_else, {fits, null_handle, heap_alloc}, Call::PureIntrinsic);
+
+        Expr arena = Call::make(Handle(), Call::if_then_else,
+                                {fits, reinterpret(Handle(), aligned_host), Variable::make(Handle(), heap_name)},
+                                Call::PureIntrinsic);
+
+        Stmt result = LetStmt::make(arena_name, arena, body);
+        result = Allocate::make(heap_name, UInt(8), MemoryType::Heap, {(int32_t)arena_size}, !fits,
+                                result, heap_alloc, "halide_free");
+        return LetStmt::make(fits_name, fits_value, result);
+    }
+
+public:
+    UseArena(const std::map<std::string, int64_t> &offsets, const IRNode *wrap,
+             const std::string &arena_name, int64_t arena_size, const Target &target)
+        : offsets(offsets), wrap(wrap), arena_name(arena_name), arena_size(arena_size), target(target) {
+    }
+
+    using IRMutator::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        Stmt result = IRMutator::mutate(s);
+        if (s.get() == wrap) {
+            result = make_arena(result);
+        }
+        return result;
+    }
+};
+
+}  // namespace
+
+Stmt plan_static_memory(const Stmt &s, const Target &t, int64_t &arena_size) {
+    arena_size = 0;
+
+    FindPlannableAllocations finder;
+    s.accept(&finder);
+    std::vector<PlannedAllocation> &allocations = finder.allocations;
+    if (allocations.empty() ||
+        (allocations.size() < 2 && !t.has_feature(Target::ScratchArena))) {
+        // Nothing to gain.
+        return s;
+    }
+
+    int64_t size = assign_offsets(allocations);
+    if (size >= ((int64_t)1 << 31)) {
+        return s;
+    }
+
+    // The arena goes around the innermost statement that encloses
+    // all of the planned allocations.
+    size_t common = allocations[0].path.size();
+    for (const PlannedAllocation &a : allocations) {
+        size_t i = 0;
+        while (i < common && i < a.path.size() && a.path[i] == allocations[0].path[i]) {
+            i++;
+        }
+        common = i;
+    }
+    const IRNode *wrap = common > 0 ? allocations[0].path[common - 1] : s.get();
+
+    std::map<std::string, int64_t> offsets;
+    int64_t total_size = 0;
+    for (const PlannedAllocation &a : allocations) {
+        offsets[a.name] = a.offset;
+        total_size += a.size;
+        debug(3) << "Placing " << a.name << " at offset " << a.offset
+                 << " (" << a.size << " bytes, live over [" << a.first_use
+                 << ", " << a.last_use << "])\n";
+    }
+    debug(2) << "Planned " << allocations.size() << " allocations totalling "
+             << total_size << " bytes into an arena of " << size << " bytes\n";
+
+    // Report the worst case, in which the caller's scratch buffer is
+    // misaligned and some of it must be skipped.
+    arena_size = t.has_feature(Target::ScratchArena) ? size + arena_alignment - 1 : size;
+    return UseArena(offsets, wrap, unique_name("static_arena"), size, t).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,34 @@
+#ifndef HALIDE_STATIC_MEMORY_PLANNING_H
+#define HALIDE_STATIC_MEMORY_PLANNING_H
+
+/** \file
+ * Defines the lowering pass that packs heap allocations with
+ * compile-time bounded sizes into a single arena.
+ */
+
+#include "Expr.h"
+
+namespace Halide {
+
+struct Target;
+
+namespace Internal {
+
+/** Find the heap allocations that occur outside of any loop and have
+ * a constant upper bound on their size, compute their lifetimes from
+ * the Free nodes injected by inject_early_frees, and assign each one
+ * an offset into a single arena such that allocations with
+ * overlapping lifetimes never overlap in memory. The arena is
+ * allocated once, around the smallest statement that encloses all of
+ * the planned allocations, and the planned allocations become views
+ * into it. If the target has the ScratchArena feature, the arena is
+ * instead carved from the caller-provided __scratch buffer argument
+ * when it is large enough, with a fallback to halide_malloc. The
+ * number of bytes of scratch required (zero if nothing was planned) is
+ * returned in arena_size. */
+Stmt plan_static_memory(const Stmt &s, const Target &t, int64_t &arena_size);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -33,6 +33,20 @@ public:
         for (const auto &f : o) {
             outputs.insert(f.name());
         }
+        for (const auto &p : env) {
+            const FuncSchedule &s = p.second.first.schedule();
+            if (!s.hoist_storage_level().match(s.store_level())) {
+                hoisted.push_back(p.second.first);
+            }
+        }
+    }
+
+    Stmt flatten(const Stmt &s) {
+        // The root site holds the allocations hoisted out of all loops.
+        hoist_sites.emplace_back();
+        Stmt result = make_hoisted_allocations(mutate(s));
+        hoist_sites.pop_back();
+        return result;
     }
 
 private:
@@ -43,6 +57,159 @@ private:
     Scope<> realizations;
     bool in_gpu = false;
 
+    // The realizations stored in a blocked layout (see
+    // Func::tile_storage). For each dimension, the size of its blocks,
+    // or undefined if it isn't tiled, and the stride of the position
+    // within a block. The stride of the block index is the dimension's
+    // usual stride.
+    struct TiledStorage {
+        vector<Expr> factors, inner_strides;
+        bool realized_in_gpu;
+    };
+    Scope<TiledStorage> tiled;
+
+    // Get the blocked layout of a Function's storage, or return false
+    // if its storage isn't tiled.
+    bool get_tiled_storage(const Function &f, size_t dims, TiledStorage &result) {
+        const vector<StorageDim> &storage_dims = f.schedule().storage_dims();
+        const vector<string> &args = f.args();
+        result.factors.assign(dims, Expr());
+        result.inner_strides.assign(dims, Expr());
+        result.realized_in_gpu = in_gpu;
+        Expr inner_stride = 1;
+        bool any_tiled = false;
+        for (const StorageDim &d : storage_dims) {
+            if (!d.tile_factor.defined()) {
+                continue;
+            }
+            for (size_t j = 0; j < args.size(); j++) {
+                if (args[j] == d.var) {
+                    result.factors[j] = d.tile_factor;
+                    result.inner_strides[j] = inner_stride;
+                    inner_stride = simplify(inner_stride * d.tile_factor);
+                    any_tiled = true;
+                }
+            }
+        }
+        return any_tiled;
+    }
+
+    // Functions with a hoist_storage level outside of their store level.
+    vector<Function> hoisted;
+
+    // The loop variables and lets enclosing the current node, outermost
+    // first. Loops are bound to the range of values they take, and lets
+    // to their value.
+    struct Binding {
+        string name;
+        Interval range;
+    };
+    vector<Binding> bindings;
+
+    struct HoistedAllocation {
+        string name;
+        Type type;
+        MemoryType memory_type;
+        vector<Expr> extents;
+        // Whether any of the realizations hoisted here are needed.
+        Expr condition;
+    };
+
+    // The enclosing loops that some Function has its storage hoisted
+    // to, outermost first. The root site has an empty loop name.
+    struct HoistSite {
+        string loop_name;
+        size_t first_binding = 0;
+        vector<HoistedAllocation> allocations;
+    };
+    vector<HoistSite> hoist_sites;
+
+    Stmt make_hoisted_allocations(Stmt body) {
+        for (const HoistedAllocation &a : hoist_sites.back().allocations) {
+            body = Allocate::make(a.name, a.type, a.memory_type, a.extents, a.condition, body);
+        }
+        return body;
+    }
+
+    // Find the site that the storage of the given Function is hoisted
+    // to, or return nullptr if it isn't hoisted.
+    HoistSite *find_hoist_site(const Function &f) {
+        const FuncSchedule &s = f.schedule();
+        const LoopLevel &level = s.hoist_storage_level();
+        if (level.match(s.store_level())) {
+            return nullptr;
+        }
+        for (size_t i = hoist_sites.size(); i > 0; i--) {
+            HoistSite &site = hoist_sites[i - 1];
+            if (site.loop_name.empty() ? level.is_root() : level.match(site.loop_name)) {
+                return &site;
+            }
+        }
+        return nullptr;
+    }
+
+    // Record an allocation at a hoist site, sized to cover every
+    // iteration of the loops between the site and here, and made if
+    // the realization's condition holds on any of them. Returns its
+    // extents.
+    vector<Expr> hoist_allocation(HoistSite *site, const string &name, Type type,
+                                  MemoryType memory_type, const vector<Expr> &extents,
+                                  const Expr &condition, const vector<Expr> &tile_factors) {
+        Scope<Interval> scope;
+        for (size_t i = site->first_binding; i < bindings.size(); i++) {
+            const Interval &r = bindings[i].range;
+            Interval b;
+            if (r.is_single_point()) {
+                b = bounds_of_expr_in_scope(r.min, scope);
+            } else if (r.is_bounded()) {
+                b = Interval(bounds_of_expr_in_scope(r.min, scope).min,
+                             bounds_of_expr_in_scope(r.max, scope).max);
+            }
+            scope.push(bindings[i].name, b);
+        }
+
+        vector<Expr> max_extents(extents.size());
+        for (size_t i = 0; i < extents.size(); i++) {
+            Interval b = bounds_of_expr_in_scope(extents[i], scope);
+            user_assert(b.has_upper_bound())
+                << "Cannot hoist the storage of " << name
+                << " to " << (site->loop_name.empty() ? "the root" : "the loop " + site->loop_name)
+                << " because the extent of dimension " << i
+                << " (" << extents[i] << ") has no upper bound "
+                << "over the loops it is hoisted out of.\n";
+            max_extents[i] = b.max;
+            if (tile_factors[i].defined()) {
+                // Blocked dimensions stay a whole number of blocks.
+                const Expr &f = tile_factors[i];
+                max_extents[i] = ((max_extents[i] + f - 1) / f) * f;
+            }
+            max_extents[i] = simplify(max_extents[i]);
+        }
+
+        Expr any_condition = const_true();
+        if (!is_const_one(condition)) {
+            Interval b = bounds_of_expr_in_scope(condition, scope);
+            if (b.has_upper_bound()) {
+                any_condition = simplify(b.max);
+            }
+        }
+
+        for (HoistedAllocation &a : site->allocations) {
+            if (a.name == name) {
+                // The Function is realized more than once within the
+                // site, e.g. in different specializations.
+                internal_assert(a.extents.size() == max_extents.size());
+                for (size_t i = 0; i < max_extents.size(); i++) {
+                    a.extents[i] = simplify(max(a.extents[i], max_extents[i]));
+                }
+                a.condition = simplify(a.condition || any_condition);
+                return max_extents;
+            }
+        }
+        site->allocations.push_back({name, type, memory_type, max_extents, any_condition});
+        return max_extents;
+    }
+
     Expr make_shape_var(string name, const string &field, size_t dim,
                         const Buffer<> &buf, const Parameter &param) {
         ReductionDomain rdom;
@@ -53,6 +220,12 @@ private:
     Expr flatten_args(const string &name, vector<Expr> args,
                       const Buffer<> &buf, const Parameter &param) {
         bool internal = realizations.contains(name);
+        const TiledStorage *tiles = internal && tiled.contains(name) ? &tiled.ref(name) : nullptr;
+        if (tiles) {
+            user_assert(!in_gpu || tiles->realized_in_gpu)
+                << "The storage of " << name << " is tiled, so it can't be "
+                << "accessed inside a GPU kernel unless it is stored there.\n";
+        }
         Expr idx = target.has_large_buffers() ? make_zero(Int(64)) : 0;
         vector<Expr> mins(args.size()), strides(args.size());
 
@@ -70,6 +243,11 @@ private:
         // taps can share the same base address.
         Expr constant_term = zero;
         for (size_t i = 0; i < args.size(); i++) {
+            if (tiles && tiles->factors[i].defined()) {
+                // Offsets don't distribute over the split into a block
+                // and a position within it.
+                continue;
+            }
             const Add *add = args[i].as<Add>();
             if (add && is_const(add->b)) {
                 constant_term += strides[i] * add->b;
@@ -82,7 +260,21 @@ private:
             // strategy makes sense when we expect x to cancel with
             // something in xmin.  We use this for internal allocations.
             for (size_t i = 0; i < args.size(); i++) {
-                idx += (args[i] - mins[i]) * strides[i];
+                if (tiles && tiles->factors[i].defined()) {
+                    // Blocks start at multiples of the factor, so that
+                    // aligned accesses stay within a block:
+                    // f(x) -> f[(x%factor)*inner_stride + (x/factor - xmin/factor)*stride]
+                    const Expr &factor = tiles->factors[i];
+                    Expr inner = (args[i] % factor) * tiles->inner_strides[i];
+                    Expr outer = args[i] / factor - mins[i] / factor;
+                    if (target.has_large_buffers()) {
+                        inner = cast<int64_t>(inner);
+                        outer = cast<int64_t>(outer);
+                    }
+                    idx += inner + outer * strides[i];
+                } else {
+                    idx += (args[i] - mins[i]) * strides[i];
+                }
             }
         } else {
             // f(x, y) -> f[x*stride + y*ystride - (xstride*xmin +
@@ -110,6 +302,20 @@ private:
     Stmt visit(const Realize *op) override {
         realizations.push(op->name);
 
+        TiledStorage tiles;
+        bool is_tiled = false;
+        {
+            auto iter = env.find(op->name);
+            internal_assert(iter != env.end()) << "Realize node refers to function not in environment.\n";
+            const Function &f = iter->second.first;
+            is_tiled = get_tiled_storage(f, op->bounds.size(), tiles);
+            if (is_tiled) {
+                user_assert(!f.schedule().memoized())
+                    << "The storage of " << op->name << " is tiled, so it can't be memoized.\n";
+                tiled.push(op->name, tiles);
+            }
+        }
+
         if (op->memory_type == MemoryType::GPUTexture) {
             textures.insert(op->name);
             debug(2) << "found texture " << op->name << "\n";
@@ -125,6 +331,9 @@ private:
         Expr condition = mutate(op->condition);
 
         realizations.pop(op->name);
+        if (is_tiled) {
+            tiled.pop(op->name);
+        }
 
         // The allocation extents of the function taken into account of
         // the align_storage directives. It is only used to determine the
@@ -167,6 +376,22 @@ private:
                 }
                 internal_assert(storage_permutation.size() == i + 1);
             }
+            // Any dimensions beyond the Function's own were added for
+            // ring buffering, and are stored outermost.
+            for (size_t j = args.size(); j < extents.size(); j++) {
+                storage_permutation.push_back((int)j);
+                allocation_extents[j] = extents[j];
+            }
+            // Blocked dimensions are allocated the whole blocks that
+            // they overlap.
+            for (size_t j = 0; j < extents.size(); j++) {
+                const Expr &factor = tiles.factors[j];
+                if (factor.defined()) {
+                    Expr min = op->bounds[j].min;
+                    Expr blocks = (min + allocation_extents[j] - 1) / factor - min / factor + 1;
+                    allocation_extents[j] = simplify(blocks * factor);
+                }
+            }
         }
 
         internal_assert(storage_permutation.size() == op->bounds.size());
@@ -202,26 +427,45 @@ private:
         }
         stmt = LetStmt::make(op->name + ".buffer", builder.build(), stmt);
 
-        // Make the allocation node
-        stmt = Allocate::make(op->name, op->types[0], op->memory_type, allocation_extents, condition, stmt);
+        // Make the allocation node, or hoist it out to an enclosing
+        // loop. Hoisted storage has the same strides on every
+        // iteration, so that any ring buffer slots don't overlap.
+        HoistSite *site = find_hoist_site(env.find(op->name)->second.first);
+        if (site) {
+            allocation_extents = hoist_allocation(site, op->name, op->types[0], op->memory_type,
+                                                  allocation_extents, condition, tiles.factors);
+        } else {
+            stmt = Allocate::make(op->name, op->types[0], op->memory_type, allocation_extents, condition, stmt);
+        }
 
         // Wrap it into storage bound asserts.
         if (!bound_asserts.empty()) {
             stmt = Block::make(Block::make(bound_asserts), stmt);
         }
 
-        // Compute the strides
+        // Compute the strides. In a blocked layout, these are the
+        // strides of the block indices, which come after the positions
+        // within a block.
+        Expr block_size = 1;
+        vector<Expr> outer_extents = allocation_extents;
+        for (int i = 0; i < dims; i++) {
+            const Expr &factor = tiles.factors[i];
+            if (factor.defined()) {
+                block_size *= factor;
+                outer_extents[i] = allocation_extents[i] / factor;
+            }
+        }
         for (int i = (int)op->bounds.size() - 1; i > 0; i--) {
             int prev_j = storage_permutation[i - 1];
             int j = storage_permutation[i];
-            Expr stride = stride_var[prev_j] * allocation_extents[prev_j];
+            Expr stride = stride_var[prev_j] * outer_extents[prev_j];
             stmt = LetStmt::make(stride_name[j], stride, stmt);
         }
 
-        // Innermost stride is one
+        // Innermost stride is one, or the size of a block
         if (dims > 0) {
             int innermost = storage_permutation.empty() ? 0 : storage_permutation[0];
-            stmt = LetStmt::make(stride_name[innermost], 1, stmt);
+            stmt = LetStmt::make(stride_name[innermost], simplify(block_size), stmt);
         }
 
         // Assign the mins and extents stored
@@ -399,15 +643,69 @@ private:
         return Block::make(prefetch_call, body);
     }
 
+    Expr visit(const Variable *op) override {
+        if (ends_with(op->name, ".buffer")) {
+            string name = op->name.substr(0, op->name.size() - 7);
+            user_assert(!tiled.contains(name))
+                << "The storage of " << name << " is tiled, so it can't be "
+                << "passed to an extern stage or dumped with debug_to_file.\n";
+        }
+        return op;
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        Expr value = mutate(op->value);
+        // Only integer lets can matter to the size of an allocation.
+        if (value.type().is_int() || value.type().is_uint()) {
+            bindings.push_back({op->name, Interval::single_point(value)});
+        } else {
+            bindings.push_back({op->name, Interval::everything()});
+        }
+        Stmt body = mutate(op->body);
+        bindings.pop_back();
+        if (value.same_as(op->value) &&
+            body.same_as(op->body)) {
+            return op;
+        }
+        return LetStmt::make(op->name, value, body);
+    }
+
     Stmt visit(const For *op) override {
         bool old_in_gpu = in_gpu;
         if (op->for_type == ForType::GPUBlock ||
             op->for_type == ForType::GPUThread) {
             in_gpu = true;
         }
-        Stmt stmt = IRMutator::visit(op);
+        Expr min = mutate(op->min);
+        Expr extent = mutate(op->extent);
+        bindings.push_back({op->name, Interval(min, simplify(min + extent - 1))});
+
+        bool is_hoist_site = false;
+        for (const Function &f : hoisted) {
+            if (f.schedule().hoist_storage_level().match(op->name)) {
+                is_hoist_site = true;
+                break;
+            }
+        }
+        if (is_hoist_site) {
+            hoist_sites.push_back({op->name, bindings.size(), {}});
+        }
+
+        Stmt body = mutate(op->body);
+
+        if (is_hoist_site) {
+            body = make_hoisted_allocations(body);
+            hoist_sites.pop_back();
+        }
+        bindings.pop_back();
         in_gpu = old_in_gpu;
-        return stmt;
+
+        if (min.same_as(op->min) &&
+            extent.same_as(op->extent) &&
+            body.same_as(op->body)) {
+            return op;
+        }
+        return For::make(op->name, min, extent, op->for_type, op->partition_policy, op->device_api, body, op->parallel_schedule, op->parallel_grain);
     }
 };
 
@@ -476,7 +774,7 @@ Stmt storage_flattening(Stmt s,
         }
     }
 
-    s = FlattenDimensions(tuple_env, outputs, target).mutate(s);
+    s = FlattenDimensions(tuple_env, outputs, target).flatten(s);
     s = PromoteToMemoryType().mutate(s);
     return s;
 }
@@ -167,6 +167,9 @@ struct Target {
         VulkanV12 = halide_target_feature_vulkan_version12,
         VulkanV13 = halide_target_feature_vulkan_version13,
         Semihosting = halide_target_feature_semihosting,
+        StaticMemoryPlan = halide_target_feature_static_memory_plan,
+        ScratchArena = halide_target_feature_scratch_arena,
+        LazyJIT = halide_target_feature_lazy_jit,
         FeatureEnd = halide_target_feature_end
     };
     Target() = default;
@@ -172,12 +172,58 @@ const int num_unique_name_counters = (1 << 14);
 // this is a global, which is always zero-initialized.
 std::atomic<int> unique_name_counters[num_unique_name_counters] = {};
 
+// Set by ScopedUniqueNameCounters.
+thread_local UniqueNameCounters *thread_unique_name_counters = nullptr;
+
 int unique_count(size_t h) {
     h = h & (num_unique_name_counters - 1);
+    if (thread_unique_name_counters) {
+        return thread_unique_name_counters->next(h);
+    }
     return unique_name_counters[h]++;
 }
 }  // namespace
 
+UniqueNameCounters::UniqueNameCounters() {
+    if (thread_unique_name_counters) {
+        counts = thread_unique_name_counters->counts;
+        return;
+    }
+    counts.resize(num_unique_name_counters);
+    for (int i = 0; i < num_unique_name_counters; i++) {
+        counts[i] = unique_name_counters[i];
+    }
+}
+
+void UniqueNameCounters::publish() const {
+    if (thread_unique_name_counters) {
+        std::vector<int> &dst = thread_unique_name_counters->counts;
+        for (int i = 0; i < num_unique_name_counters; i++) {
+            dst[i] = std::max(dst[i], counts[i]);
+        }
+        return;
+    }
+    for (int i = 0; i < num_unique_name_counters; i++) {
+        int current = unique_name_counters[i];
+        while (current < counts[i] &&
+               !unique_name_counters[i].compare_exchange_weak(current, counts[i])) {
+        }
+    }
+}
+
+int UniqueNameCounters::next(size_t h) {
+    return counts[h & (num_unique_name_counters - 1)]++;
+}
+
+ScopedUniqueNameCounters::ScopedUniqueNameCounters(UniqueNameCounters &counters)
+    : old(thread_unique_name_counters) {
+    thread_unique_name_counters = &counters;
+}
+
+ScopedUniqueNameCounters::~ScopedUniqueNameCounters() {
+    thread_unique_name_counters = old;
+}
+
 // There are three possible families of names returned by the methods below:
 // 1) char pattern: (char that isn't '$') + number (e.g. v234)
 // 2) string pattern: (string without '$') + '$' + number (e.g. fr#nk82$42)
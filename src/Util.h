@@ -173,6 +173,44 @@ std::string unique_name(char prefix);
 std::string unique_name(const std::string &prefix);
 // @}
 
+/** A private copy of the counters used by unique_name. While a
+ * ScopedUniqueNameCounters referring to it is live on a thread,
+ * unique_name on that thread counts from this copy instead of the
+ * process-wide counters. The names generated by a computation on that
+ * thread then depend only on the counters at the time the copy was
+ * made, and not on what other threads are doing concurrently. */
+class UniqueNameCounters {
+    std::vector<int> counts;
+
+public:
+    /** Copy the counters unique_name currently uses on this thread:
+     * the process-wide counters, or those of an enclosing
+     * ScopedUniqueNameCounters. */
+    UniqueNameCounters();
+
+    /** Raise each counter that unique_name currently uses on this
+     * thread to at least the value of the corresponding counter in this
+     * copy, so that names generated later don't collide with names
+     * generated using this copy. */
+    void publish() const;
+
+    /** Return the count for a hash and advance it. */
+    int next(size_t h);
+};
+
+/** Make unique_name on the current thread use the given counters
+ * until this object is destroyed. */
+class ScopedUniqueNameCounters {
+    UniqueNameCounters *old;
+
+public:
+    explicit ScopedUniqueNameCounters(UniqueNameCounters &counters);
+    ~ScopedUniqueNameCounters();
+
+    ScopedUniqueNameCounters(const ScopedUniqueNameCounters &) = delete;
+    ScopedUniqueNameCounters &operator=(const ScopedUniqueNameCounters &) = delete;
+};
+
 /** Test if the first string starts with the second string */
 bool starts_with(const std::string &str, const std::string &prefix);
 
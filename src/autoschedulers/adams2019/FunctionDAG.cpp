@@ -573,6 +573,10 @@ bool depends_on_estimate(const Expr &expr) {
 }
 
 FunctionDAG::FunctionDAG(const vector<Function> &outputs, const Target &target) {
+    // Stages often ask for the bounds of the same Exprs in equivalent
+    // scopes, e.g. when computing the value bounds of every Func.
+    ScopedBoundsCache bounds_cache;
+
     map<string, Function> env = build_environment(outputs);
 
     // A mutator to apply parameter estimates to the expressions
@@ -0,0 +1,76 @@
+#include "FunctionDAG.h"
+#include "Halide.h"
+#include "halide_benchmark.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+using namespace Halide;
+
+// Measure how long it takes to build the FunctionDAG of a pipeline with
+// many stages, with and without caching the bounds queries made while
+// building it.
+
+// A chain of stencils, with a histogram-like reduction every so often,
+// similar in shape to large camera and vision pipelines.
+Func make_pipeline(int stages) {
+    ImageParam input(Float(32), 2, "input");
+    Var x("x"), y("y");
+
+    Func f = BoundaryConditions::repeat_edge(input);
+    for (int i = 0; i < stages; i++) {
+        Func g("stage_" + std::to_string(i));
+        if (i % 16 == 15) {
+            RDom r(-2, 5);
+            g(x, y) = 0.0f;
+            g(x, y) += f(x + r, y) * 0.2f;
+        } else if (i % 2) {
+            g(x, y) = (f(x - 1, y) + f(x, y) + f(x + 1, y)) / 3;
+        } else {
+            g(x, y) = (f(x, y - 1) + f(x, y) + f(x, y + 1)) / 3;
+        }
+        f = g;
+    }
+    input.set_estimates({{0, 2048}, {0, 2048}});
+    f.set_estimate(x, 0, 2048).set_estimate(y, 0, 2048);
+    return f;
+}
+
+double time_build(const Func &output, const Target &target, std::string *dump) {
+    std::vector<Internal::Function> outputs = {output.function()};
+    double t = Tools::benchmark(3, 1, [&]() {
+        Internal::Autoscheduler::FunctionDAG dag(outputs, target);
+        std::ostringstream s;
+        dag.dump(s);
+        *dump = s.str();
+    });
+    return t;
+}
+
+int main(int argc, char **argv) {
+    // Use a fixed target to get consistent results.
+    Target target("x86-64-linux-sse41-avx-avx2");
+
+    static std::string uncached = "HL_BOUNDS_CACHE=0";
+    static std::string cached = "HL_BOUNDS_CACHE=1";
+
+    for (int stages : {32, 64, 128}) {
+        Func output = make_pipeline(stages);
+        std::string dump_uncached, dump_cached;
+        putenv(&uncached[0]);
+        double t_uncached = time_build(output, target, &dump_uncached);
+        putenv(&cached[0]);
+        double t_cached = time_build(output, target, &dump_cached);
+
+        if (dump_uncached != dump_cached) {
+            printf("FunctionDAG for %d stages differs when bounds are cached\n", stages);
+            return 1;
+        }
+        printf("%3d stages: %10.3f ms uncached, %10.3f ms cached (%.2fx)\n",
+               stages, t_uncached * 1e3, t_cached * 1e3, t_uncached / t_cached);
+    }
+
+    printf("Success!\n");
+    return 0;
+}
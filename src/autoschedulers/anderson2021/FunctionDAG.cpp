@@ -562,6 +562,10 @@ void FunctionDAG::Edge::expand_footprint(const Span *consumer_loop, Span *produc
 }
 
 FunctionDAG::FunctionDAG(const vector<Function> &outputs, const Target &target) {
+    // Stages often ask for the bounds of the same Exprs in equivalent
+    // scopes, e.g. when computing the value bounds of every Func.
+    ScopedBoundsCache bounds_cache;
+
     map<string, Function> env = build_environment(outputs);
 
     // A mutator to apply parameter estimates to the expressions
@@ -238,6 +238,23 @@ typedef bool (*halide_semaphore_try_acquire_t)(struct halide_semaphore_t *, int)
 typedef int (*halide_loop_task_t)(void *user_context, int min, int extent,
                                   uint8_t *closure, void *task_parent);
 
+/** Ways to divide the iterations of a parallel task among threads. */
+typedef enum halide_parallel_schedule_t {
+    /** Each thread claims an equal share of the iterations, and
+     * threads that run out of work steal from the others. */
+    halide_parallel_schedule_default = 0,
+
+    /** Threads claim chunks of a fixed number of iterations, in order,
+     * as they become idle. */
+    halide_parallel_schedule_dynamic = 1,
+
+    /** Threads claim chunks of iterations as they become idle, sized in
+     * proportion to the number of iterations remaining divided by the
+     * number of threads, so that the chunks get smaller towards the
+     * end of the task. */
+    halide_parallel_schedule_guided = 2,
+} halide_parallel_schedule_t;
+
 /** A parallel task to be passed to halide_do_parallel_tasks. This
  * task may recursively call halide_do_parallel_tasks, and there may
  * be complex dependencies between seemingly unrelated tasks expressed
@@ -287,6 +304,13 @@ struct halide_parallel_task_t {
     // one executing at a time. If false, any order is fine, and
     // concurrency is fine.
     bool serial;
+
+    // How the calls are divided among threads when serial is false, and
+    // the smallest number of iterations to pass to a single call to the
+    // function when the schedule is dynamic or guided. These are hints
+    // that a custom task system may ignore.
+    halide_parallel_schedule_t schedule;
+    int grain;
 };
 
 /** Enqueue some number of the tasks described above and wait for them
@@ -379,6 +403,37 @@ extern void halide_join_thread(struct halide_thread *);
  */
 extern int halide_set_num_threads(int n);
 
+/** Policies for placing the workers of Halide's thread pool, and the
+ * memory they touch, on the nodes of a NUMA machine. */
+typedef enum halide_numa_policy_t {
+    /** Workers may migrate freely between nodes. This is the default. */
+    halide_numa_policy_none = 0,
+
+    /** Workers are pinned to NUMA nodes round-robin. Each loop run
+     * through halide_do_par_for() is split into one contiguous slice of
+     * iterations per node, which the workers of that node prefer over
+     * other work, so that loops over the same range touch the same
+     * memory from the same node. The default allocator gives large
+     * host allocations fresh pages instead of recycling them, so they
+     * are placed by first touch on the node that produces (and later
+     * consumes) them. Only
+     * implemented on Linux; elsewhere this behaves like
+     * halide_numa_policy_none. */
+    halide_numa_policy_local = 1,
+} halide_numa_policy_t;
+
+/** Set the NUMA policy used by Halide's thread pool. Returns the old
+ * policy. If never called, the policy is read from the environment
+ * variable HL_NUMA_POLICY ("local" or "none") when the thread pool
+ * starts. The policy takes effect the next time the thread pool
+ * starts, so to change it for a running thread pool, call
+ * halide_shutdown_thread_pool() first.
+ *
+ * (As with halide_set_num_threads(), this only affects the default
+ * implementation of halide_do_par_for().)
+ */
+extern halide_numa_policy_t halide_set_numa_policy(halide_numa_policy_t policy);
+
 /** Halide calls these functions to allocate and free memory. To
  * replace in AOT code, use the halide_set_custom_malloc and
  * halide_set_custom_free, or (on platforms that support weak
@@ -407,6 +462,29 @@ extern halide_malloc_t halide_set_custom_malloc(halide_malloc_t user_malloc);
 extern halide_free_t halide_set_custom_free(halide_free_t user_free);
 //@}
 
+/** Determines whether halide_default_free places host allocations on
+ * a free list for reuse by future calls to halide_default_malloc,
+ * instead of returning them to the system. Pooled allocations are
+ * bucketed into power-of-two size classes of up to 1MB, with free
+ * lists per thread, and honor the same alignment as
+ * halide_default_malloc. Larger allocations are never pooled. This is
+ * useful for pipelines that make many short-lived heap allocations,
+ * e.g. a compute_at Func with a dynamically sized allocation. If the
+ * memory held on the free lists grows past a high-water mark, it is
+ * trimmed. Defaults to false.
+ *
+ * If set to false, releases all unused pooled allocations back to the
+ * system. This has no effect on allocations made through a custom
+ * allocator set with halide_set_custom_malloc. */
+extern int halide_reuse_host_allocations(void *user_context, bool);
+
+/** Determines whether on halide_default_free the memory is returned
+ * immediately to the system, or placed on a free list for future
+ * use. Override and switch based on the user_context for
+ * finer-grained control. By default just returns the value most
+ * recently set by the method above. */
+extern bool halide_can_reuse_host_allocations(void *user_context);
+
 /** Halide calls these functions to interact with the underlying
  * system runtime functions. To replace in AOT code on platforms that
  * support weak linking, define these functions yourself, or use
@@ -613,6 +691,13 @@ struct halide_trace_event_t {
  * below. If the trace is going to be large, you may want to make the
  * file a named pipe, and then read from that pipe into gzip.
  *
+ * If HL_TRACE_MODE is also set to "ring", events are instead appended
+ * without locking to per-thread buffers in a delta-compressed format,
+ * and written to the file by a background thread. HL_TRACE_SAMPLE=n
+ * additionally records only one in every n loads and stores. The
+ * tools in util/ read either format. Call halide_shutdown_trace to
+ * make sure everything buffered has been written.
+ *
  * halide_trace returns a unique ID which will be passed to future
  * events that "belong" to the earlier event as the parent id. The
  * ownership hierarchy looks like:
@@ -989,6 +1074,48 @@ extern void halide_memoization_cache_release(void *user_context, void *host);
  */
 extern void halide_memoization_cache_cleanup();
 
+/** Counters describing the behavior of the memoization cache since
+ * it was last cleaned up. */
+struct halide_memoization_cache_stats_t {
+    uint64_t hits, misses, evictions;
+    /** The number of entries and bytes of buffer storage currently
+     * held by the cache. */
+    uint64_t entries, bytes_held;
+    /** The size limit set by halide_memoization_cache_set_size. */
+    uint64_t max_bytes;
+    /** The number of misses satisfied from the disk tier, and the
+     * number of entries written to it. See
+     * halide_memoization_cache_set_disk_tier. */
+    uint64_t disk_hits, disk_writes;
+};
+
+/** Fill in the counters for the memoization cache. The default
+ * implementation keeps the counters per cache shard and sums them
+ * here, so the result is not an atomic snapshot when other threads
+ * are using the cache. Returns zero on success. */
+extern int halide_memoization_cache_get_stats(struct halide_memoization_cache_stats_t *stats);
+
+/** Enable a persistent second tier for the memoization cache. Entries
+ * evicted from memory, and entries still held when the cache is
+ * cleaned up, are written to files in the given directory, which
+ * must already exist. A lookup that misses in memory maps the file
+ * for its key, if there is one, and reloads the entry from it.
+ *
+ * The fingerprint is stored with each entry, and entries written with
+ * a different fingerprint are ignored. It should identify everything
+ * besides the parameters in the cache key that can change what a
+ * memoized Func computes, e.g. a hash of the version of the pipeline
+ * and the target it was compiled for. Entries with an eviction key
+ * are never written to disk. Halide never deletes files in the
+ * directory; remove it to clear the disk tier.
+ *
+ * The default implementation relies on the layout of the cache keys
+ * generated by Halide, and can only reload entries on platforms with
+ * memory-mapped files. Pass a null directory to disable the disk
+ * tier. Returns zero on success.
+ */
+extern int halide_memoization_cache_set_disk_tier(void *user_context, const char *directory, uint64_t fingerprint);
+
 /** Verify that a given range of memory has been initialized; only used when Target::MSAN is enabled.
  *
  * The default implementation simply calls the LLVM-provided __msan_check_mem_is_initialized() function.
@@ -1403,6 +1530,9 @@ typedef enum halide_target_feature_t {
     halide_target_feature_vulkan_version12,       ///< Enable Vulkan v1.2 runtime target support.
     halide_target_feature_vulkan_version13,       ///< Enable Vulkan v1.3 runtime target support.
     halide_target_feature_semihosting,            ///< Used together with Target::NoOS for the baremetal target built with semihosting library and run with semihosting mode where minimum I/O communication with a host PC is available.
+    halide_target_feature_static_memory_plan,     ///< Pack heap allocations with bounded sizes and disjoint lifetimes into a single arena.
+    halide_target_feature_scratch_arena,          ///< Add a trailing __scratch buffer argument from which the arena of halide_target_feature_static_memory_plan is carved.
+    halide_target_feature_lazy_jit,               ///< When JIT-compiling, compile each function of a pipeline the first time it is called.
     halide_target_feature_end                     ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
@@ -1800,6 +1930,14 @@ struct HALIDE_ATTRIBUTE_ALIGN(8) halide_profiler_func_stats {
 
     /** The total number of memory allocation of this Func. */
     int num_allocs;
+
+    /** Hardware performance counters billed to this Func: CPU cycles,
+     * instructions retired, last-level cache misses, and branch
+     * mispredictions, counted on each thread while it was computing
+     * this Func. Only gathered if the HL_PROFILER_COUNTERS environment
+     * variable is set to 1 on a platform that supports them (currently
+     * Linux on x86), and otherwise zero. */
+    uint64_t cycles, instructions, cache_misses, branch_misses;
 };
 
 /** Per-pipeline state tracked by the sampling profiler. These exist
@@ -1845,6 +1983,10 @@ struct HALIDE_ATTRIBUTE_ALIGN(8) halide_profiler_pipeline_stats {
 
     /** The total number of memory allocation of funcs in this pipeline. */
     int num_allocs;
+
+    /** Hardware performance counters billed to this pipeline. See
+     * halide_profiler_func_stats. */
+    uint64_t cycles, instructions, cache_misses, branch_misses;
 };
 
 /** The global state of the profiler. */
@@ -1922,9 +2064,37 @@ extern void halide_profiler_reset();
 void halide_profiler_shutdown();
 
 /** Print out timing statistics for everything run since the last
- * reset. Also happens at process exit. */
+ * reset. Also happens at process exit. The format is chosen by the
+ * HL_PROFILER_REPORT_FORMAT environment variable (see
+ * halide_profiler_report_as), and if HL_PROFILER_REPORT_FILE is set
+ * the report is appended to that file instead of being printed. */
 extern void halide_profiler_report(void *user_context);
 
+/** The formats in which the profiler can report. */
+typedef enum halide_profiler_report_format_t {
+    /** A human-readable table. The default. */
+    halide_profiler_report_text = 0,
+
+    /** A single line containing a JSON object with a "pipelines" array.
+     * Each pipeline object has the fields of
+     * halide_profiler_pipeline_stats, with time in "time_ns" and the
+     * active thread average in "active_threads", plus a "funcs" array
+     * of objects with the fields of halide_profiler_func_stats. A file
+     * of appended reports is valid JSON Lines, which is what the
+     * aggregator in util/HalideProfileAggregate.cpp reads. Selected
+     * with HL_PROFILER_REPORT_FORMAT=json. */
+    halide_profiler_report_json = 1,
+
+    /** CSV with a header row, then for each pipeline a row with an
+     * empty func column followed by a row per func. Selected with
+     * HL_PROFILER_REPORT_FORMAT=csv. */
+    halide_profiler_report_csv = 2,
+} halide_profiler_report_format_t;
+
+/** Like halide_profiler_report, but in the given format regardless of
+ * HL_PROFILER_REPORT_FORMAT. */
+extern void halide_profiler_report_as(void *user_context, halide_profiler_report_format_t format);
+
 /** For timer based profiling, this routine starts the timer chain running.
  * halide_get_profiler_state can be called to get the current timer interval.
  */
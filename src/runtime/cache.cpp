@@ -1,8 +1,15 @@
 #include "HalideRuntime.h"
 #include "device_buffer_utils.h"
 #include "printer.h"
+#include "runtime_atomics.h"
 #include "scoped_mutex_lock.h"
 
+extern "C" {
+
+extern int rename(const char *oldpath, const char *newpath);
+
+}  // extern "C"
+
 namespace Halide {
 namespace Runtime {
 namespace Internal {
@@ -84,6 +91,10 @@ struct CacheEntry {
     halide_buffer_t *buf;
     uint64_t eviction_key;
     bool has_eviction_key;
+    // The key to write this entry to the disk tier under, or null if
+    // it should not be written. See make_disk_key.
+    uint8_t *disk_key;
+    size_t disk_key_size;
 
     bool init(const uint8_t *cache_key, size_t cache_key_size,
               uint32_t key_hash,
@@ -174,6 +185,8 @@ WEAK bool CacheEntry::init(const uint8_t *cache_key, size_t cache_key_size,
 
     has_eviction_key = has_eviction_key_arg;
     eviction_key = eviction_key_arg;
+    disk_key = nullptr;
+    disk_key_size = 0;
     return true;
 }
 
@@ -185,6 +198,9 @@ WEAK void CacheEntry::destroy() {
         }
         halide_free(nullptr, get_pointer_to_header(buf[i].host));
     }
+    if (disk_key) {
+        halide_free(nullptr, disk_key);
+    }
     halide_free(nullptr, metadata_storage);
 }
 
@@ -196,34 +212,360 @@ WEAK uint32_t djb_hash(const uint8_t *key, size_t key_size) {
     return h;
 }
 
-WEAK halide_mutex memoization_lock = {{0}};
+// An optional second tier keeps entries in files in a directory, so
+// that they survive the process restarting. Entries are written out
+// when they are evicted from memory or when the cache is cleaned up,
+// and a lookup that misses in memory maps the file for its key, if
+// there is one, and reloads the entry from it.
+const size_t kMaxDiskPathSize = 1024;
+
+struct DiskTier {
+    halide_mutex lock;
+    bool enabled;
+    uint64_t fingerprint;
+    // Leaves room in a path of kMaxDiskPathSize for the file name.
+    char directory[kMaxDiskPathSize - 64];
+};
+
+WEAK DiskTier disk_tier;
+
+// Statistics, reported by halide_memoization_cache_get_stats.
+WEAK uint64_t disk_hits = 0;
+WEAK uint64_t disk_writes = 0;
+
+const uint32_t kDiskMagic = 0x4d454d48;  // "HMEM" when read in the right byte order
+const uint32_t kDiskFormatVersion = 1;
+
+// The layout of an entry on disk is a DiskEntryHeader, the key padded
+// to a multiple of eight bytes, the computed bounds, and then a
+// DiskBufferHeader followed by the shape of each tuple element. The
+// data of each tuple element is at the offset given in its header.
+struct DiskEntryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t fingerprint;
+    uint32_t pointer_size;
+    uint32_t key_size;
+    int32_t dimensions;
+    uint32_t tuple_count;
+};
+
+struct DiskBufferHeader {
+    halide_type_t type;
+    int32_t dimensions;
+    uint64_t offset;
+    uint64_t size;
+};
+
+ALWAYS_INLINE uint64_t align_up(uint64_t x, uint64_t alignment) {
+    return (x + alignment - 1) & ~(alignment - 1);
+}
+
+ALWAYS_INLINE bool disk_tier_enabled() {
+    bool enabled;
+    Synchronization::atomic_load_relaxed(&disk_tier.enabled, &enabled);
+    return enabled;
+}
+
+// Keys made by Memoization.cpp start with a pointer to a string naming
+// the pipeline and the Func, which is not stable across processes. The
+// key used on disk replaces that pointer with the string itself. This
+// must be done while the pipeline that made the key is still loaded.
+WEAK uint8_t *make_disk_key(const uint8_t *cache_key, size_t key_size, size_t *disk_key_size) {
+    const char *name;
+    if (key_size < sizeof(name)) {
+        return nullptr;
+    }
+    memcpy(&name, cache_key, sizeof(name));
+    size_t name_size = strlen(name);
+    *disk_key_size = name_size + key_size - sizeof(name);
+    uint8_t *disk_key = (uint8_t *)halide_malloc(nullptr, *disk_key_size);
+    if (disk_key) {
+        memcpy(disk_key, name, name_size);
+        memcpy(disk_key + name_size, cache_key + sizeof(name), key_size - sizeof(name));
+    }
+    return disk_key;
+}
+
+// Get the path of the file for a key. The fingerprint is not part of
+// the name, so entries written by a newer version of a pipeline
+// replace the stale ones. Returns false if the disk tier is disabled.
+WEAK bool disk_entry_path(const uint8_t *disk_key, size_t disk_key_size,
+                          char path[kMaxDiskPathSize], uint64_t *fingerprint) {
+    ScopedMutexLock lock(&disk_tier.lock);
+    if (!disk_tier.enabled) {
+        return false;
+    }
+    // FNV-1a
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < disk_key_size; i++) {
+        h = (h ^ disk_key[i]) * 0x100000001b3ULL;
+    }
+    char *dst = path, *end = path + kMaxDiskPathSize;
+    dst = halide_string_to_string(dst, end, disk_tier.directory);
+    dst = halide_string_to_string(dst, end, "/halide_memo_");
+    dst = halide_uint64_to_string(dst, end, h, 1);
+    halide_string_to_string(dst, end, ".bin");
+    *fingerprint = disk_tier.fingerprint;
+    return true;
+}
+
+struct DiskWriter {
+    void *file;
+    bool ok;
+
+    void write(const void *data, size_t size) {
+        ok = ok && fwrite(data, 1, size, file) == size;
+    }
+
+    void pad_to(uint64_t *pos, uint64_t alignment) {
+        static const uint8_t zeros[64] = {0};
+        uint64_t padding = align_up(*pos, alignment) - *pos;
+        write(zeros, padding);
+        *pos += padding;
+    }
+};
+
+// Write an entry to the disk tier, if it is enabled and the entry has
+// a disk key. The entry must not be reachable from the cache.
+WEAK void spill_to_disk(CacheEntry *entry) {
+    if (entry->disk_key == nullptr) {
+        return;
+    }
+    for (uint32_t i = 0; i < entry->tuple_count; i++) {
+        if (entry->buf[i].host == nullptr || entry->buf[i].device_dirty()) {
+            return;
+        }
+    }
+
+    const uint8_t *disk_key = entry->disk_key;
+    size_t disk_key_size = entry->disk_key_size;
+    char path[kMaxDiskPathSize];
+    uint64_t fingerprint;
+    if (!disk_entry_path(disk_key, disk_key_size, path, &fingerprint)) {
+        return;
+    }
+
+    // Write to a temporary file and rename it into place, so that a
+    // concurrent reader in another process never sees a partial entry.
+    char temp_path[kMaxDiskPathSize + 64];
+    char *dst = temp_path, *end = temp_path + sizeof(temp_path);
+    dst = halide_string_to_string(dst, end, path);
+    dst = halide_string_to_string(dst, end, ".");
+    dst = halide_uint64_to_string(dst, end, (uint64_t)(uintptr_t)entry, 1);
+    dst = halide_string_to_string(dst, end, ".");
+    dst = halide_int64_to_string(dst, end, halide_current_time_ns(nullptr), 1);
+    halide_string_to_string(dst, end, ".tmp");
+
+    DiskWriter writer = {halide_fopen(temp_path, "wb"), true};
+    if (writer.file) {
+        DiskEntryHeader header = {kDiskMagic, kDiskFormatVersion, fingerprint, (uint32_t)sizeof(void *),
+                                  (uint32_t)disk_key_size, entry->dimensions, entry->tuple_count};
+        uint64_t pos = sizeof(header);
+        writer.write(&header, sizeof(header));
+        writer.write(disk_key, disk_key_size);
+        pos += disk_key_size;
+        writer.pad_to(&pos, 8);
+        writer.write(entry->computed_bounds, sizeof(halide_dimension_t) * entry->dimensions);
+        pos += sizeof(halide_dimension_t) * entry->dimensions;
+
+        uint64_t data_offset = align_up(pos + entry->tuple_count * (sizeof(DiskBufferHeader) + sizeof(halide_dimension_t) * entry->dimensions), 64);
+        for (uint32_t i = 0; i < entry->tuple_count; i++) {
+            const halide_buffer_t &buf = entry->buf[i];
+            DiskBufferHeader buf_header = {buf.type, buf.dimensions, data_offset, buf.size_in_bytes()};
+            writer.write(&buf_header, sizeof(buf_header));
+            writer.write(buf.dim, sizeof(halide_dimension_t) * buf.dimensions);
+            pos += sizeof(buf_header) + sizeof(halide_dimension_t) * buf.dimensions;
+            data_offset = align_up(data_offset + buf_header.size, 64);
+        }
+        for (uint32_t i = 0; i < entry->tuple_count; i++) {
+            const halide_buffer_t &buf = entry->buf[i];
+            writer.pad_to(&pos, 64);
+            writer.write(buf.begin(), buf.size_in_bytes());
+            pos += buf.size_in_bytes();
+        }
+        writer.ok = (fclose(writer.file) == 0) && writer.ok;
+        if (writer.ok && rename(temp_path, path) == 0) {
+            Synchronization::atomic_fetch_add_sequentially_consistent(&disk_writes, (uint64_t)1);
+        } else {
+            debug(nullptr) << "Could not write memoization cache entry " << path << "\n";
+            remove(temp_path);
+        }
+    }
+}
+
+struct DiskReader {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+
+    bool read(void *dst, size_t n) {
+        if (n > size - pos) {
+            return false;
+        }
+        memcpy(dst, data + pos, n);
+        pos += n;
+        return true;
+    }
+};
+
+// Check that a mapped file holds the entry for the given key and
+// shape, and if so, copy its contents into the tuple buffers.
+WEAK bool read_disk_entry(const uint8_t *file, size_t file_size,
+                          const uint8_t *disk_key, size_t disk_key_size, uint64_t fingerprint,
+                          const halide_buffer_t *computed_bounds,
+                          int32_t tuple_count, halide_buffer_t **tuple_buffers) {
+    DiskReader reader = {file, file_size, 0};
+    DiskEntryHeader header;
+    if (!reader.read(&header, sizeof(header)) ||
+        header.magic != kDiskMagic ||
+        header.version != kDiskFormatVersion ||
+        header.fingerprint != fingerprint ||
+        header.pointer_size != sizeof(void *) ||
+        header.key_size != disk_key_size ||
+        header.dimensions != computed_bounds->dimensions ||
+        header.tuple_count != (uint32_t)tuple_count ||
+        disk_key_size > file_size - reader.pos ||
+        !keys_equal(file + reader.pos, disk_key, disk_key_size)) {
+        return false;
+    }
+    reader.pos = align_up(reader.pos + disk_key_size, 8);
+
+    halide_dimension_t dim;
+    for (int i = 0; i < header.dimensions; i++) {
+        if (!reader.read(&dim, sizeof(dim)) || dim != computed_bounds->dim[i]) {
+            return false;
+        }
+    }
+
+    // Validate all the tuple elements before copying any data.
+    size_t buffers_pos = reader.pos;
+    DiskBufferHeader buf_header;
+    for (int32_t i = 0; i < tuple_count; i++) {
+        halide_buffer_t *buf = tuple_buffers[i];
+        if (!reader.read(&buf_header, sizeof(buf_header)) ||
+            buf_header.type != buf->type ||
+            buf_header.dimensions != buf->dimensions ||
+            buf_header.size != buf->size_in_bytes() ||
+            buf_header.offset > file_size ||
+            buf_header.size > file_size - buf_header.offset) {
+            return false;
+        }
+        for (int j = 0; j < buf->dimensions; j++) {
+            if (!reader.read(&dim, sizeof(dim)) || dim != buf->dim[j]) {
+                return false;
+            }
+        }
+    }
+
+    reader.pos = buffers_pos;
+    for (int32_t i = 0; i < tuple_count; i++) {
+        halide_buffer_t *buf = tuple_buffers[i];
+        reader.read(&buf_header, sizeof(buf_header));
+        reader.pos += sizeof(halide_dimension_t) * buf->dimensions;
+        memcpy(buf->begin(), file + buf_header.offset, buf_header.size);
+    }
+    return true;
+}
+
+// Try to fill in the tuple buffers from the disk tier.
+WEAK bool load_from_disk(void *user_context, const uint8_t *cache_key, int32_t size,
+                         const halide_buffer_t *computed_bounds,
+                         int32_t tuple_count, halide_buffer_t **tuple_buffers) {
+    if (!disk_tier_enabled()) {
+        return false;
+    }
+
+    size_t disk_key_size;
+    uint8_t *disk_key = make_disk_key(cache_key, size, &disk_key_size);
+    if (!disk_key) {
+        return false;
+    }
+
+    bool found = false;
+    char path[kMaxDiskPathSize];
+    uint64_t fingerprint;
+    if (disk_entry_path(disk_key, disk_key_size, path, &fingerprint)) {
+        size_t file_size = 0;
+        void *file = halide_map_file(user_context, path, &file_size);
+        if (file) {
+            found = read_disk_entry((const uint8_t *)file, file_size, disk_key, disk_key_size, fingerprint,
+                                    computed_bounds, tuple_count, tuple_buffers);
+            halide_unmap_file(user_context, file, file_size);
+        }
+    }
+    halide_free(nullptr, disk_key);
+    return found;
+}
+
+// The cache is split into independently locked shards, selected by
+// key hash, so that concurrent lookups of different keys rarely
+// contend. Each shard has its own hash table and LRU list. The size
+// budget is global: whichever thread pushes the total over the
+// maximum evicts entries, least recently used first within each shard.
+const size_t kCacheShards = 16;
+const size_t kHashTableSize = 64;
+
+struct CacheShard {
+    halide_mutex lock;
 
-const size_t kHashTableSize = 256;
+    CacheEntry *entries[kHashTableSize];
 
-WEAK CacheEntry *cache_entries[kHashTableSize];
+    CacheEntry *most_recently_used;
+    CacheEntry *least_recently_used;
 
-WEAK CacheEntry *most_recently_used = nullptr;
-WEAK CacheEntry *least_recently_used = nullptr;
+    // Bytes of buffer data held by entries in this shard.
+    int64_t size;
+
+    // Statistics, reported by halide_memoization_cache_get_stats.
+    uint64_t hits, misses, evictions, num_entries;
+};
+
+WEAK CacheShard cache_shards[kCacheShards];
+
+ALWAYS_INLINE CacheShard &shard_for_hash(uint32_t h) {
+    return cache_shards[h % kCacheShards];
+}
+
+ALWAYS_INLINE uint32_t bucket_for_hash(uint32_t h) {
+    return (h / kCacheShards) % kHashTableSize;
+}
 
 const uint64_t kDefaultCacheSize = 1 << 20;
 WEAK int64_t max_cache_size = kDefaultCacheSize;
+
+// The total of the sizes of all shards. Modified atomically while
+// holding the lock of the shard whose size changes.
 WEAK int64_t current_cache_size = 0;
 
+ALWAYS_INLINE void adjust_cache_size(CacheShard &shard, int64_t delta) {
+    shard.size += delta;
+    Synchronization::atomic_fetch_add_sequentially_consistent(&current_cache_size, delta);
+}
+
+ALWAYS_INLINE bool cache_over_budget() {
+    int64_t current, max;
+    Synchronization::atomic_load_relaxed(&current_cache_size, &current);
+    Synchronization::atomic_load_relaxed(&max_cache_size, &max);
+    return current > max;
+}
+
 #if CACHE_DEBUGGING
-WEAK void validate_cache() {
-    print(nullptr) << "validating cache, "
-                   << "current size " << current_cache_size
+WEAK void validate_cache(CacheShard &shard) {
+    print(nullptr) << "validating cache shard, "
+                   << "current size " << shard.size
+                   << " of total " << current_cache_size
                    << " of maximum " << max_cache_size << "\n";
     int entries_in_hash_table = 0;
     for (size_t i = 0; i < kHashTableSize; i++) {
-        CacheEntry *entry = cache_entries[i];
+        CacheEntry *entry = shard.entries[i];
         while (entry != nullptr) {
             entries_in_hash_table++;
-            if (entry->more_recent == nullptr && entry != most_recently_used) {
+            if (entry->more_recent == nullptr && entry != shard.most_recently_used) {
                 halide_print(nullptr, "cache invalid case 1\n");
                 __builtin_trap();
             }
-            if (entry->less_recent == nullptr && entry != least_recently_used) {
+            if (entry->less_recent == nullptr && entry != shard.least_recently_used) {
                 halide_print(nullptr, "cache invalid case 2\n");
                 __builtin_trap();
             }
@@ -231,13 +573,13 @@ WEAK void validate_cache() {
         }
     }
     int entries_from_mru = 0;
-    CacheEntry *mru_chain = most_recently_used;
+    CacheEntry *mru_chain = shard.most_recently_used;
     while (mru_chain != nullptr) {
         entries_from_mru++;
         mru_chain = mru_chain->less_recent;
     }
     int entries_from_lru = 0;
-    CacheEntry *lru_chain = least_recently_used;
+    CacheEntry *lru_chain = shard.least_recently_used;
     while (lru_chain != nullptr) {
         entries_from_lru++;
         lru_chain = lru_chain->more_recent;
@@ -253,69 +595,245 @@ WEAK void validate_cache() {
         halide_print(nullptr, "cache invalid case 4\n");
         __builtin_trap();
     }
-    if (current_cache_size < 0) {
+    if ((uint64_t)entries_in_hash_table != shard.num_entries) {
+        halide_print(nullptr, "cache invalid case 5\n");
+        __builtin_trap();
+    }
+    if (shard.size < 0) {
         halide_print(nullptr, "cache size is negative\n");
         __builtin_trap();
     }
 }
 #endif
 
-WEAK void prune_cache() {
+// Remove an entry from its shard's LRU list and account for its
+// size. Does not touch the hash table. The shard must be locked.
+WEAK void unlink_from_lru(CacheShard &shard, CacheEntry *entry) {
+    if (entry->more_recent != nullptr) {
+        entry->more_recent->less_recent = entry->less_recent;
+    } else {
+        halide_abort_if_false(nullptr, shard.most_recently_used == entry);
+        shard.most_recently_used = entry->less_recent;
+    }
+    if (entry->less_recent != nullptr) {
+        entry->less_recent->more_recent = entry->more_recent;
+    } else {
+        halide_abort_if_false(nullptr, shard.least_recently_used == entry);
+        shard.least_recently_used = entry->more_recent;
+    }
+    entry->more_recent = nullptr;
+    entry->less_recent = nullptr;
+
+    int64_t entry_size = 0;
+    for (uint32_t i = 0; i < entry->tuple_count; i++) {
+        entry_size += entry->buf[i].size_in_bytes();
+    }
+    adjust_cache_size(shard, -entry_size);
+    shard.num_entries--;
+}
+
+// Evict unused entries from the shard, least recently used first,
+// until the cache as a whole is within budget or the shard's size is
+// no more than keep_size. The evicted entries are returned as a list
+// linked through their next pointers. The shard must be locked.
+WEAK void prune_shard(CacheShard &shard, int64_t keep_size, CacheEntry **evicted) {
 #if CACHE_DEBUGGING
-    validate_cache();
+    validate_cache(shard);
 #endif
-    CacheEntry *prune_candidate = least_recently_used;
-    while (current_cache_size > max_cache_size &&
+    CacheEntry *prune_candidate = shard.least_recently_used;
+    while (cache_over_budget() &&
+           shard.size > keep_size &&
            prune_candidate != nullptr) {
         CacheEntry *more_recent = prune_candidate->more_recent;
 
         if (prune_candidate->in_use_count == 0) {
-            uint32_t h = prune_candidate->hash;
-            uint32_t index = h % kHashTableSize;
-
             // Remove from hash table
-            CacheEntry *prev_hash_entry = cache_entries[index];
-            if (prev_hash_entry == prune_candidate) {
-                cache_entries[index] = prune_candidate->next;
-            } else {
-                while (prev_hash_entry != nullptr && prev_hash_entry->next != prune_candidate) {
-                    prev_hash_entry = prev_hash_entry->next;
-                }
-                halide_abort_if_false(nullptr, prev_hash_entry != nullptr);
-                prev_hash_entry->next = prune_candidate->next;
+            CacheEntry **prev_ptr = &shard.entries[bucket_for_hash(prune_candidate->hash)];
+            while (*prev_ptr != nullptr && *prev_ptr != prune_candidate) {
+                prev_ptr = &(*prev_ptr)->next;
             }
+            halide_abort_if_false(nullptr, *prev_ptr != nullptr);
+            *prev_ptr = prune_candidate->next;
 
-            // Remove from less recent chain.
-            if (least_recently_used == prune_candidate) {
-                least_recently_used = more_recent;
+            unlink_from_lru(shard, prune_candidate);
+            shard.evictions++;
+
+            prune_candidate->next = *evicted;
+            *evicted = prune_candidate;
+        }
+
+        prune_candidate = more_recent;
+    }
+#if CACHE_DEBUGGING
+    validate_cache(shard);
+#endif
+}
+
+// Bring the cache back within budget. Must be called with no shard
+// locks held. Shards are locked one at a time. The first pass only
+// trims shards holding more than their fair share of the budget, so
+// that one busy shard can't flush all the others; the second pass
+// trims whatever is left.
+WEAK void prune_cache(size_t first_shard) {
+    for (int pass = 0; pass < 2 && cache_over_budget(); pass++) {
+        int64_t max;
+        Synchronization::atomic_load_relaxed(&max_cache_size, &max);
+        int64_t keep_size = pass == 0 ? max / (int64_t)kCacheShards : 0;
+        for (size_t i = 0; i < kCacheShards && cache_over_budget(); i++) {
+            CacheShard &shard = cache_shards[(first_shard + i) % kCacheShards];
+            CacheEntry *evicted = nullptr;
+            {
+                ScopedMutexLock lock(&shard.lock);
+                prune_shard(shard, keep_size, &evicted);
             }
-            if (more_recent != nullptr) {
-                more_recent->less_recent = prune_candidate->less_recent;
+            // The evicted entries are unreachable now, so they can be
+            // written to the disk tier without holding the lock.
+            while (evicted != nullptr) {
+                CacheEntry *next = evicted->next;
+                spill_to_disk(evicted);
+                evicted->destroy();
+                halide_free(nullptr, evicted);
+                evicted = next;
             }
+        }
+    }
+}
+
+// Insert the computed tuple buffers into the cache. from_disk says
+// whether they were just reloaded from the disk tier, in which case
+// there is no need to write them out again.
+WEAK int store_entry(void *user_context, const uint8_t *cache_key, int32_t size,
+                     halide_buffer_t *computed_bounds,
+                     int32_t tuple_count, halide_buffer_t **tuple_buffers,
+                     bool has_eviction_key, uint64_t eviction_key, bool from_disk) {
+    debug(user_context) << "halide_memoization_cache_store has_eviction_key: " << has_eviction_key << " eviction_key " << eviction_key << " .\n";
 
-            // Remove from more recent chain.
-            if (most_recently_used == prune_candidate) {
-                most_recently_used = prune_candidate->less_recent;
+    uint32_t h = get_pointer_to_header(tuple_buffers[0]->host)->hash;
+    CacheShard &shard = shard_for_hash(h);
+    uint32_t index = bucket_for_hash(h);
+
+    // Eviction keys are only meaningful within one process, so entries
+    // with one are never written to disk.
+    size_t disk_key_size = 0;
+    uint8_t *disk_key = nullptr;
+    if (!from_disk && !has_eviction_key && disk_tier_enabled()) {
+        disk_key = make_disk_key(cache_key, size, &disk_key_size);
+    }
+
+#if CACHE_DEBUGGING
+    debug_print_key(user_context, "halide_memoization_cache_store", cache_key, size);
+
+    debug_print_buffer(user_context, "computed_bounds", *computed_bounds);
+
+    {
+        for (int32_t i = 0; i < tuple_count; i++) {
+            halide_buffer_t *buf = tuple_buffers[i];
+            debug_print_buffer(user_context, "Allocation bounds", *buf);
+        }
+    }
+#endif
+
+    {
+        ScopedMutexLock lock(&shard.lock);
+
+        CacheEntry *entry = shard.entries[index];
+        while (entry != nullptr) {
+            if (entry->hash == h && entry->key_size == (size_t)size &&
+                keys_equal(entry->key, cache_key, size) &&
+                buffer_has_shape(computed_bounds, entry->computed_bounds) &&
+                entry->tuple_count == (uint32_t)tuple_count) {
+
+                bool all_bounds_equal = true;
+                bool no_host_pointers_equal = true;
+                {
+                    for (int32_t i = 0; all_bounds_equal && i < tuple_count; i++) {
+                        halide_buffer_t *buf = tuple_buffers[i];
+                        all_bounds_equal = buffer_has_shape(tuple_buffers[i], entry->buf[i].dim);
+                        if (entry->buf[i].host == buf->host) {
+                            no_host_pointers_equal = false;
+                        }
+                    }
+                }
+                if (all_bounds_equal) {
+                    halide_abort_if_false(user_context, no_host_pointers_equal);
+                    // This entry is still in use by the caller. Mark it as having no cache entry
+                    // so halide_memoization_cache_release can free the buffer.
+                    for (int32_t i = 0; i < tuple_count; i++) {
+                        get_pointer_to_header(tuple_buffers[i]->host)->entry = nullptr;
+                    }
+                    if (disk_key) {
+                        halide_free(user_context, disk_key);
+                    }
+                    return halide_error_code_success;
+                }
             }
-            if (prune_candidate->less_recent != nullptr) {
-                prune_candidate->less_recent = more_recent;
+            entry = entry->next;
+        }
+
+        CacheEntry *new_entry = (CacheEntry *)halide_malloc(nullptr, sizeof(CacheEntry));
+        bool inited = false;
+        if (new_entry) {
+            inited = new_entry->init(cache_key, size, h, computed_bounds, tuple_count, tuple_buffers,
+                                     has_eviction_key, eviction_key);
+        }
+        if (!inited) {
+            // This entry is still in use by the caller. Mark it as having no cache entry
+            // so halide_memoization_cache_release can free the buffer.
+            for (int32_t i = 0; i < tuple_count; i++) {
+                get_pointer_to_header(tuple_buffers[i]->host)->entry = nullptr;
             }
 
-            // Decrease cache used amount.
-            for (uint32_t i = 0; i < prune_candidate->tuple_count; i++) {
-                current_cache_size -= prune_candidate->buf[i].size_in_bytes();
+            if (new_entry) {
+                halide_free(user_context, new_entry);
             }
+            if (disk_key) {
+                halide_free(user_context, disk_key);
+            }
+            return halide_error_code_success;
+        }
+        new_entry->disk_key = disk_key;
+        new_entry->disk_key_size = disk_key_size;
+
+        uint64_t added_size = 0;
+        {
+            for (int32_t i = 0; i < tuple_count; i++) {
+                halide_buffer_t *buf = tuple_buffers[i];
+                added_size += buf->size_in_bytes();
+            }
+        }
+        adjust_cache_size(shard, added_size);
+        shard.num_entries++;
 
-            // Deallocate the entry.
-            prune_candidate->destroy();
-            halide_free(nullptr, prune_candidate);
+        new_entry->next = shard.entries[index];
+        new_entry->less_recent = shard.most_recently_used;
+        if (shard.most_recently_used != nullptr) {
+            shard.most_recently_used->more_recent = new_entry;
+        }
+        shard.most_recently_used = new_entry;
+        if (shard.least_recently_used == nullptr) {
+            shard.least_recently_used = new_entry;
+        }
+        shard.entries[index] = new_entry;
+
+        new_entry->in_use_count = tuple_count;
+
+        for (int32_t i = 0; i < tuple_count; i++) {
+            get_pointer_to_header(tuple_buffers[i]->host)->entry = new_entry;
         }
 
-        prune_candidate = more_recent;
-    }
 #if CACHE_DEBUGGING
-    validate_cache();
+        validate_cache(shard);
 #endif
+    }
+
+    // The new entry is in use, so it can't be evicted here.
+    if (cache_over_budget()) {
+        prune_cache(h % kCacheShards);
+    }
+
+    debug(user_context) << "Exiting halide_memoization_cache_store\n";
+
+    return halide_error_code_success;
 }
 
 }  // namespace Internal
@@ -329,18 +847,14 @@ WEAK void halide_memoization_cache_set_size(int64_t size) {
         size = kDefaultCacheSize;
     }
 
-    ScopedMutexLock lock(&memoization_lock);
-
-    max_cache_size = size;
-    prune_cache();
+    Synchronization::atomic_store_sequentially_consistent(&max_cache_size, &size);
+    prune_cache(0);
 }
 
 WEAK int halide_memoization_cache_lookup(void *user_context, const uint8_t *cache_key, int32_t size,
                                          halide_buffer_t *computed_bounds, int32_t tuple_count, halide_buffer_t **tuple_buffers) {
     uint32_t h = djb_hash(cache_key, size);
-    uint32_t index = h % kHashTableSize;
-
-    ScopedMutexLock lock(&memoization_lock);
+    CacheShard &shard = shard_for_hash(h);
 
 #if CACHE_DEBUGGING
     debug_print_key(user_context, "halide_memoization_cache_lookup", cache_key, size);
@@ -355,52 +869,60 @@ WEAK int halide_memoization_cache_lookup(void *user_context, const uint8_t *cach
     }
 #endif
 
-    CacheEntry *entry = cache_entries[index];
-    while (entry != nullptr) {
-        if (entry->hash == h && entry->key_size == (size_t)size &&
-            keys_equal(entry->key, cache_key, size) &&
-            buffer_has_shape(computed_bounds, entry->computed_bounds) &&
-            entry->tuple_count == (uint32_t)tuple_count) {
-
-            // Check all the tuple buffers have the same bounds (they should).
-            bool all_bounds_equal = true;
-            for (int32_t i = 0; all_bounds_equal && i < tuple_count; i++) {
-                all_bounds_equal = buffer_has_shape(tuple_buffers[i], entry->buf[i].dim);
-            }
+    {
+        ScopedMutexLock lock(&shard.lock);
 
-            if (all_bounds_equal) {
-                if (entry != most_recently_used) {
-                    halide_abort_if_false(user_context, entry->more_recent != nullptr);
-                    if (entry->less_recent != nullptr) {
-                        entry->less_recent->more_recent = entry->more_recent;
-                    } else {
-                        halide_abort_if_false(user_context, least_recently_used == entry);
-                        least_recently_used = entry->more_recent;
-                    }
-                    halide_abort_if_false(user_context, entry->more_recent != nullptr);
-                    entry->more_recent->less_recent = entry->less_recent;
+        CacheEntry *entry = shard.entries[bucket_for_hash(h)];
+        while (entry != nullptr) {
+            if (entry->hash == h && entry->key_size == (size_t)size &&
+                keys_equal(entry->key, cache_key, size) &&
+                buffer_has_shape(computed_bounds, entry->computed_bounds) &&
+                entry->tuple_count == (uint32_t)tuple_count) {
 
-                    entry->more_recent = nullptr;
-                    entry->less_recent = most_recently_used;
-                    if (most_recently_used != nullptr) {
-                        most_recently_used->more_recent = entry;
-                    }
-                    most_recently_used = entry;
+                // Check all the tuple buffers have the same bounds (they should).
+                bool all_bounds_equal = true;
+                for (int32_t i = 0; all_bounds_equal && i < tuple_count; i++) {
+                    all_bounds_equal = buffer_has_shape(tuple_buffers[i], entry->buf[i].dim);
                 }
 
-                for (int32_t i = 0; i < tuple_count; i++) {
-                    halide_buffer_t *buf = tuple_buffers[i];
-                    *buf = entry->buf[i];
-                }
+                if (all_bounds_equal) {
+                    if (entry != shard.most_recently_used) {
+                        halide_abort_if_false(user_context, entry->more_recent != nullptr);
+                        if (entry->less_recent != nullptr) {
+                            entry->less_recent->more_recent = entry->more_recent;
+                        } else {
+                            halide_abort_if_false(user_context, shard.least_recently_used == entry);
+                            shard.least_recently_used = entry->more_recent;
+                        }
+                        halide_abort_if_false(user_context, entry->more_recent != nullptr);
+                        entry->more_recent->less_recent = entry->less_recent;
+
+                        entry->more_recent = nullptr;
+                        entry->less_recent = shard.most_recently_used;
+                        if (shard.most_recently_used != nullptr) {
+                            shard.most_recently_used->more_recent = entry;
+                        }
+                        shard.most_recently_used = entry;
+                    }
+
+                    for (int32_t i = 0; i < tuple_count; i++) {
+                        halide_buffer_t *buf = tuple_buffers[i];
+                        *buf = entry->buf[i];
+                    }
 
-                entry->in_use_count += tuple_count;
+                    entry->in_use_count += tuple_count;
+                    shard.hits++;
 
-                return 0;
+                    return 0;
+                }
             }
+            entry = entry->next;
         }
-        entry = entry->next;
+
+        shard.misses++;
     }
 
+    // Allocate the storage for the result outside the shard lock.
     for (int32_t i = 0; i < tuple_count; i++) {
         halide_buffer_t *buf = tuple_buffers[i];
 
@@ -418,9 +940,12 @@ WEAK int halide_memoization_cache_lookup(void *user_context, const uint8_t *cach
         header->entry = nullptr;
     }
 
-#if CACHE_DEBUGGING
-    validate_cache();
-#endif
+    if (load_from_disk(user_context, cache_key, size, computed_bounds, tuple_count, tuple_buffers)) {
+        Synchronization::atomic_fetch_add_sequentially_consistent(&disk_hits, (uint64_t)1);
+        store_entry(user_context, cache_key, size, computed_bounds, tuple_count, tuple_buffers,
+                    false, 0, true);
+        return 0;
+    }
 
     return 1;
 }
@@ -429,112 +954,8 @@ WEAK int halide_memoization_cache_store(void *user_context, const uint8_t *cache
                                         halide_buffer_t *computed_bounds,
                                         int32_t tuple_count, halide_buffer_t **tuple_buffers,
                                         bool has_eviction_key, uint64_t eviction_key) {
-    debug(user_context) << "halide_memoization_cache_store has_eviction_key: " << has_eviction_key << " eviction_key " << eviction_key << " .\n";
-
-    uint32_t h = get_pointer_to_header(tuple_buffers[0]->host)->hash;
-
-    uint32_t index = h % kHashTableSize;
-
-    ScopedMutexLock lock(&memoization_lock);
-
-#if CACHE_DEBUGGING
-    debug_print_key(user_context, "halide_memoization_cache_store", cache_key, size);
-
-    debug_print_buffer(user_context, "computed_bounds", *computed_bounds);
-
-    {
-        for (int32_t i = 0; i < tuple_count; i++) {
-            halide_buffer_t *buf = tuple_buffers[i];
-            debug_print_buffer(user_context, "Allocation bounds", *buf);
-        }
-    }
-#endif
-
-    CacheEntry *entry = cache_entries[index];
-    while (entry != nullptr) {
-        if (entry->hash == h && entry->key_size == (size_t)size &&
-            keys_equal(entry->key, cache_key, size) &&
-            buffer_has_shape(computed_bounds, entry->computed_bounds) &&
-            entry->tuple_count == (uint32_t)tuple_count) {
-
-            bool all_bounds_equal = true;
-            bool no_host_pointers_equal = true;
-            {
-                for (int32_t i = 0; all_bounds_equal && i < tuple_count; i++) {
-                    halide_buffer_t *buf = tuple_buffers[i];
-                    all_bounds_equal = buffer_has_shape(tuple_buffers[i], entry->buf[i].dim);
-                    if (entry->buf[i].host == buf->host) {
-                        no_host_pointers_equal = false;
-                    }
-                }
-            }
-            if (all_bounds_equal) {
-                halide_abort_if_false(user_context, no_host_pointers_equal);
-                // This entry is still in use by the caller. Mark it as having no cache entry
-                // so halide_memoization_cache_release can free the buffer.
-                for (int32_t i = 0; i < tuple_count; i++) {
-                    get_pointer_to_header(tuple_buffers[i]->host)->entry = nullptr;
-                }
-                return halide_error_code_success;
-            }
-        }
-        entry = entry->next;
-    }
-
-    uint64_t added_size = 0;
-    {
-        for (int32_t i = 0; i < tuple_count; i++) {
-            halide_buffer_t *buf = tuple_buffers[i];
-            added_size += buf->size_in_bytes();
-        }
-    }
-    current_cache_size += added_size;
-    prune_cache();
-
-    CacheEntry *new_entry = (CacheEntry *)halide_malloc(nullptr, sizeof(CacheEntry));
-    bool inited = false;
-    if (new_entry) {
-        inited = new_entry->init(cache_key, size, h, computed_bounds, tuple_count, tuple_buffers,
-                                 has_eviction_key, eviction_key);
-    }
-    if (!inited) {
-        current_cache_size -= added_size;
-
-        // This entry is still in use by the caller. Mark it as having no cache entry
-        // so halide_memoization_cache_release can free the buffer.
-        for (int32_t i = 0; i < tuple_count; i++) {
-            get_pointer_to_header(tuple_buffers[i]->host)->entry = nullptr;
-        }
-
-        if (new_entry) {
-            halide_free(user_context, new_entry);
-        }
-        return halide_error_code_success;
-    }
-
-    new_entry->next = cache_entries[index];
-    new_entry->less_recent = most_recently_used;
-    if (most_recently_used != nullptr) {
-        most_recently_used->more_recent = new_entry;
-    }
-    most_recently_used = new_entry;
-    if (least_recently_used == nullptr) {
-        least_recently_used = new_entry;
-    }
-    cache_entries[index] = new_entry;
-
-    new_entry->in_use_count = tuple_count;
-
-    for (int32_t i = 0; i < tuple_count; i++) {
-        get_pointer_to_header(tuple_buffers[i]->host)->entry = new_entry;
-    }
-
-#if CACHE_DEBUGGING
-    validate_cache();
-#endif
-    debug(user_context) << "Exiting halide_memoization_cache_store\n";
-
-    return halide_error_code_success;
+    return store_entry(user_context, cache_key, size, computed_bounds, tuple_count, tuple_buffers,
+                       has_eviction_key, eviction_key, false);
 }
 
 WEAK void halide_memoization_cache_release(void *user_context, void *host) {
@@ -545,12 +966,13 @@ WEAK void halide_memoization_cache_release(void *user_context, void *host) {
     if (entry == nullptr) {
         halide_free(user_context, header);
     } else {
-        ScopedMutexLock lock(&memoization_lock);
+        CacheShard &shard = shard_for_hash(header->hash);
+        ScopedMutexLock lock(&shard.lock);
 
         halide_abort_if_false(user_context, entry->in_use_count > 0);
         entry->in_use_count--;
 #if CACHE_DEBUGGING
-        validate_cache();
+        validate_cache(shard);
 #endif
     }
 
@@ -559,42 +981,43 @@ WEAK void halide_memoization_cache_release(void *user_context, void *host) {
 
 WEAK void halide_memoization_cache_cleanup() {
     debug(nullptr) << "halide_memoization_cache_cleanup\n";
-    for (auto &entry_ref : cache_entries) {
-        CacheEntry *entry = entry_ref;
-        entry_ref = nullptr;
-        while (entry != nullptr) {
-            CacheEntry *next = entry->next;
-            entry->destroy();
-            halide_free(nullptr, entry);
-            entry = next;
+    for (auto &shard : cache_shards) {
+        for (auto &entry_ref : shard.entries) {
+            CacheEntry *entry = entry_ref;
+            entry_ref = nullptr;
+            while (entry != nullptr) {
+                CacheEntry *next = entry->next;
+                spill_to_disk(entry);
+                entry->destroy();
+                halide_free(nullptr, entry);
+                entry = next;
+            }
         }
+        shard.most_recently_used = nullptr;
+        shard.least_recently_used = nullptr;
+        shard.size = 0;
+        shard.hits = 0;
+        shard.misses = 0;
+        shard.evictions = 0;
+        shard.num_entries = 0;
     }
     current_cache_size = 0;
-    most_recently_used = nullptr;
-    least_recently_used = nullptr;
+    disk_hits = 0;
+    disk_writes = 0;
 }
 
 WEAK void halide_memoization_cache_evict(void *user_context, uint64_t eviction_key) {
-    ScopedMutexLock lock(&memoization_lock);
+    for (auto &shard : cache_shards) {
+        ScopedMutexLock lock(&shard.lock);
 
-    for (auto &entry_ref : cache_entries) {
-        CacheEntry *entry = entry_ref;
-        if (entry != nullptr) {
+        for (auto &entry_ref : shard.entries) {
             CacheEntry **prev = &entry_ref;
+            CacheEntry *entry = entry_ref;
             while (entry != nullptr) {
                 CacheEntry *next = entry->next;
                 if (entry->has_eviction_key && entry->eviction_key == eviction_key) {
                     *prev = next;
-                    if (entry->more_recent != nullptr) {
-                        entry->more_recent->less_recent = entry->less_recent;
-                    } else {
-                        most_recently_used = entry->less_recent;
-                    }
-                    if (entry->less_recent != nullptr) {
-                        entry->less_recent->more_recent = entry->more_recent;
-                    } else {
-                        least_recently_used = entry->more_recent;
-                    }
+                    unlink_from_lru(shard, entry);
                     entry->destroy();
                     halide_free(user_context, entry);
                 } else {
@@ -603,10 +1026,47 @@ WEAK void halide_memoization_cache_evict(void *user_context, uint64_t eviction_k
                 entry = next;
             }
         }
-    }
 #if CACHE_DEBUGGING
-    validate_cache();
+        validate_cache(shard);
 #endif
+    }
+}
+
+WEAK int halide_memoization_cache_set_disk_tier(void *user_context, const char *directory, uint64_t fingerprint) {
+    ScopedMutexLock lock(&disk_tier.lock);
+    bool enabled = false;
+    if (directory == nullptr) {
+        Synchronization::atomic_store_release(&disk_tier.enabled, &enabled);
+        return halide_error_code_success;
+    }
+    size_t length = strlen(directory);
+    if (length == 0 || length >= sizeof(disk_tier.directory)) {
+        error(user_context) << "Bad directory for the memoization cache: " << directory << "\n";
+        return halide_error_code_generic_error;
+    }
+    memcpy(disk_tier.directory, directory, length + 1);
+    disk_tier.fingerprint = fingerprint;
+    enabled = true;
+    Synchronization::atomic_store_release(&disk_tier.enabled, &enabled);
+    return halide_error_code_success;
+}
+
+WEAK int halide_memoization_cache_get_stats(halide_memoization_cache_stats_t *stats) {
+    *stats = {};
+    for (auto &shard : cache_shards) {
+        ScopedMutexLock lock(&shard.lock);
+        stats->hits += shard.hits;
+        stats->misses += shard.misses;
+        stats->evictions += shard.evictions;
+        stats->entries += shard.num_entries;
+        stats->bytes_held += shard.size;
+    }
+    Synchronization::atomic_load_relaxed(&disk_hits, &stats->disk_hits);
+    Synchronization::atomic_load_relaxed(&disk_writes, &stats->disk_writes);
+    int64_t max;
+    Synchronization::atomic_load_relaxed(&max_cache_size, &max);
+    stats->max_bytes = max;
+    return halide_error_code_success;
 }
 
 namespace {
@@ -0,0 +1,28 @@
+#include "HalideRuntime.h"
+
+extern "C" {
+
+WEAK int halide_numa_node_count() {
+    return 1;
+}
+
+WEAK int halide_numa_current_node() {
+    return 0;
+}
+
+WEAK int halide_numa_bind_current_thread(int node) {
+    return halide_error_code_success;
+}
+
+WEAK void halide_numa_set_local_allocations(bool local) {
+}
+
+WEAK void *halide_numa_malloc(void *user_context, size_t size) {
+    return nullptr;
+}
+
+WEAK bool halide_numa_free(void *user_context, void *ptr) {
+    return false;
+}
+
+}  // extern "C"
@@ -0,0 +1,16 @@
+#include "HalideRuntime.h"
+
+extern "C" {
+
+WEAK int *halide_perf_counters_thread_func() {
+    return nullptr;
+}
+
+WEAK bool halide_perf_counters_sample(int thread, int *func, uint64_t *deltas) {
+    return false;
+}
+
+WEAK void halide_perf_counters_close() {
+}
+
+}  // extern "C"
@@ -122,6 +122,10 @@ WEAK int halide_set_num_threads(int n) {
     return 1;
 }
 
+WEAK halide_numa_policy_t halide_set_numa_policy(halide_numa_policy_t policy) {
+    return halide_numa_policy_none;
+}
+
 WEAK halide_do_task_t halide_set_custom_do_task(halide_do_task_t f) {
     halide_do_task_t result = custom_do_task;
     custom_do_task = f;
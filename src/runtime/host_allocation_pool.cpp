@@ -0,0 +1,342 @@
+#include "HalideRuntime.h"
+#include "printer.h"
+#include "runtime_atomics.h"
+#include "scoped_mutex_lock.h"
+
+// The vulkan module includes these headers too, and both modules are
+// linked into one runtime when the target has Vulkan, so the headers'
+// out-of-line definitions must be WEAK.
+#include "internal/block_allocator.h"
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+// Host allocations of up to 1MB are rounded up to a power-of-two size
+// class and carved out of large blocks by a BlockAllocator. When freed,
+// they go onto a free list for their size class instead of back to the
+// BlockAllocator, so that the next allocation of the same class (usually
+// the next iteration of the same loop) is a pop from a list.
+constexpr int host_pool_min_class_bits = 5;
+constexpr int host_pool_max_class_bits = 20;
+constexpr int host_pool_num_classes = host_pool_max_class_bits - host_pool_min_class_bits + 1;
+constexpr size_t host_pool_block_size = 4 * 1024 * 1024;
+
+// Free lists are striped by thread. The runtime has no portable
+// thread-local storage, so the stripe is picked by hashing the address
+// of the calling thread's stack, which keeps each thread on its own
+// stripe in practice without requiring it.
+constexpr int host_pool_num_stripes = 16;
+
+// When the bytes sitting on a stripe's free lists exceed its share of
+// the high-water mark, trim them back down to half of that.
+constexpr size_t host_pool_high_water = 256 * 1024 * 1024;
+constexpr size_t host_pool_stripe_high_water = host_pool_high_water / host_pool_num_stripes;
+
+// Each pooled allocation is preceded by a header, padded out to the
+// malloc alignment. The last word of the header (i.e. the word
+// immediately before the pointer returned to the user) holds the address
+// of the header with the low bit set. halide_internal_aligned_alloc keeps
+// the original, at least 8-byte aligned, malloc pointer in that word, so
+// the low bit tells us who owns a pointer passed to halide_default_free.
+struct HostPoolChunk {
+    MemoryRegion *region;
+    HostPoolChunk *next;
+    size_t size_class;
+};
+
+struct HostPoolStripe {
+    // A test-and-set lock rather than a halide_mutex. Stripes are rarely
+    // contended, and this makes an uncontended lock and unlock a single
+    // atomic exchange and a store.
+    uintptr_t locked;
+    HostPoolChunk *free_list[host_pool_num_classes];
+    size_t cached_bytes;
+};
+
+struct ScopedStripeLock {
+    HostPoolStripe *stripe;
+
+    ALWAYS_INLINE ScopedStripeLock(HostPoolStripe *stripe)
+        : stripe(stripe) {
+        while (Synchronization::atomic_exchange_acquire(&stripe->locked, (uintptr_t)1)) {
+            halide_thread_yield();
+        }
+    }
+
+    ALWAYS_INLINE ~ScopedStripeLock() {
+        uintptr_t unlocked = 0;
+        Synchronization::atomic_store_release(&stripe->locked, &unlocked);
+    }
+};
+
+WEAK bool halide_reuse_host_allocations_flag = false;
+
+WEAK HostPoolStripe host_pool_stripes[host_pool_num_stripes];
+
+// Guards the BlockAllocator, which is only touched on a free list miss
+// or when trimming.
+WEAK halide_mutex host_pool_lock;
+WEAK BlockAllocator *host_pool_allocator = nullptr;
+
+ALWAYS_INLINE size_t host_pool_header_size() {
+    const size_t alignment = ::halide_internal_malloc_alignment();
+    return align_up(sizeof(HostPoolChunk) + sizeof(uintptr_t), alignment);
+}
+
+ALWAYS_INLINE size_t host_pool_class_size(size_t size_class) {
+    return (size_t)1 << (size_class + host_pool_min_class_bits);
+}
+
+// Returns the size class for an allocation, or -1 if it is too large to
+// be pooled.
+ALWAYS_INLINE int host_pool_size_class(size_t size) {
+    const size_t alignment = ::halide_internal_malloc_alignment();
+    size = max(size, alignment);
+    for (int c = 0; c < host_pool_num_classes; c++) {
+        if (size <= host_pool_class_size(c)) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+ALWAYS_INLINE HostPoolStripe *host_pool_current_stripe() {
+    // Stacks of different threads are far apart, while the frames of
+    // one thread that allocate are usually within a few KB of each
+    // other, so hash the address at 64KB granularity.
+    int marker = 0;
+    uint64_t sp = (uint64_t)(uintptr_t)&marker;
+    uint64_t h = (sp >> 16) * 0x9E3779B97F4A7C15ULL;
+    return &host_pool_stripes[(h >> 32) % host_pool_num_stripes];
+}
+
+ALWAYS_INLINE void *host_pool_chunk_to_ptr(HostPoolChunk *chunk) {
+    return (uint8_t *)chunk + host_pool_header_size();
+}
+
+ALWAYS_INLINE HostPoolChunk *host_pool_ptr_to_chunk(void *ptr) {
+    uintptr_t tag = ((uintptr_t *)ptr)[-1];
+    if (!(tag & 1)) {
+        return nullptr;
+    }
+    return (HostPoolChunk *)(tag & ~(uintptr_t)1);
+}
+
+ALWAYS_INLINE MemoryProperties host_pool_memory_properties() {
+    MemoryProperties properties;
+    properties.visibility = MemoryVisibility::HostOnly;
+    properties.usage = MemoryUsage::DynamicStorage;
+    properties.caching = MemoryCaching::Cached;
+    properties.alignment = ::halide_internal_malloc_alignment();
+    return properties;
+}
+
+// The BlockAllocator's own bookkeeping must not go through halide_malloc,
+// which may be this pool or a user-supplied allocator.
+WEAK void *host_pool_allocate_system(void *user_context, size_t bytes) {
+    return ::halide_internal_aligned_alloc(::halide_internal_malloc_alignment(), bytes);
+}
+
+WEAK void host_pool_deallocate_system(void *user_context, void *ptr) {
+    ::halide_internal_aligned_free(ptr);
+}
+
+WEAK int host_pool_allocate_block(void *user_context, MemoryBlock *block) {
+    // Pad the block by one alignment so that it's safe to read past the
+    // end of the last region, as halide_malloc promises.
+    const size_t alignment = block->properties.alignment;
+    block->handle = ::halide_internal_aligned_alloc(alignment, block->size + alignment);
+    return block->handle ? halide_error_code_success : halide_error_code_out_of_memory;
+}
+
+WEAK int host_pool_deallocate_block(void *user_context, MemoryBlock *block) {
+    if (block->handle) {
+        ::halide_internal_aligned_free(block->handle);
+    }
+    return halide_error_code_success;
+}
+
+WEAK int host_pool_allocate_region(void *user_context, MemoryRegion *region) {
+    RegionAllocator *region_allocator = RegionAllocator::find_allocator(user_context, region);
+    halide_abort_if_false(user_context, region_allocator != nullptr);
+    BlockResource *block_resource = region_allocator->block_resource();
+    halide_abort_if_false(user_context, block_resource != nullptr);
+    if (block_resource->memory.handle == nullptr) {
+        return halide_error_code_out_of_memory;
+    }
+    region->handle = (uint8_t *)block_resource->memory.handle + region->offset;
+    return halide_error_code_success;
+}
+
+WEAK int host_pool_deallocate_region(void *user_context, MemoryRegion *region) {
+    // The memory belongs to the block; there is nothing to free.
+    return halide_error_code_success;
+}
+
+// Carve a new chunk for the given size class out of the BlockAllocator.
+WEAK HostPoolChunk *host_pool_reserve_chunk(void *user_context, int size_class) {
+    ScopedMutexLock lock(&host_pool_lock);
+
+    if (host_pool_allocator == nullptr) {
+        BlockAllocator::MemoryAllocators allocators;
+        allocators.system = {host_pool_allocate_system, host_pool_deallocate_system};
+        allocators.block = {host_pool_allocate_block, host_pool_deallocate_block};
+        allocators.region = {host_pool_allocate_region, host_pool_deallocate_region};
+        BlockAllocator::Config config;
+        config.minimum_block_size = host_pool_block_size;
+        host_pool_allocator = BlockAllocator::create(user_context, config, allocators);
+        if (host_pool_allocator == nullptr) {
+            return nullptr;
+        }
+    }
+
+    MemoryRequest request;
+    request.size = host_pool_header_size() + host_pool_class_size(size_class);
+    request.alignment = ::halide_internal_malloc_alignment();
+    request.properties = host_pool_memory_properties();
+    MemoryRegion *region = host_pool_allocator->reserve(user_context, request);
+    if (region == nullptr || region->handle == nullptr) {
+        return nullptr;
+    }
+
+    HostPoolChunk *chunk = (HostPoolChunk *)region->handle;
+    chunk->region = region;
+    chunk->next = nullptr;
+    chunk->size_class = size_class;
+    ((uintptr_t *)host_pool_chunk_to_ptr(chunk))[-1] = (uintptr_t)chunk | 1;
+    return chunk;
+}
+
+// Return a list of chunks to the BlockAllocator, and give any blocks
+// that are now empty back to the system.
+WEAK void host_pool_reclaim_chunks(void *user_context, HostPoolChunk *chunks) {
+    if (chunks == nullptr) {
+        return;
+    }
+    ScopedMutexLock lock(&host_pool_lock);
+    halide_abort_if_false(user_context, host_pool_allocator != nullptr);
+    while (chunks) {
+        HostPoolChunk *next = chunks->next;
+        host_pool_allocator->reclaim(user_context, chunks->region);
+        chunks = next;
+    }
+    host_pool_allocator->collect(user_context);
+}
+
+// Remove cached chunks from a stripe's free lists, largest size classes
+// first, until at most target bytes remain cached. Must be called with
+// the stripe's lock held; returns the removed chunks.
+WEAK HostPoolChunk *host_pool_trim_stripe(HostPoolStripe *stripe, size_t target) {
+    HostPoolChunk *trimmed = nullptr;
+    for (int c = host_pool_num_classes - 1; c >= 0 && stripe->cached_bytes > target; c--) {
+        while (stripe->free_list[c] && stripe->cached_bytes > target) {
+            HostPoolChunk *chunk = stripe->free_list[c];
+            stripe->free_list[c] = chunk->next;
+            stripe->cached_bytes -= host_pool_class_size(c);
+            chunk->next = trimmed;
+            trimmed = chunk;
+        }
+    }
+    return trimmed;
+}
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK void *halide_host_pool_malloc(void *user_context, size_t size) {
+    using namespace Synchronization;
+
+    int size_class = host_pool_size_class(size);
+    if (size_class < 0) {
+        return nullptr;
+    }
+
+    // Try this thread's stripe first, then any other stripe that has
+    // a chunk of the right size cached.
+    HostPoolStripe *own = host_pool_current_stripe();
+    HostPoolChunk *chunk = nullptr;
+    for (int i = 0; i < host_pool_num_stripes && !chunk; i++) {
+        HostPoolStripe *stripe = &host_pool_stripes[(own - host_pool_stripes + i) % host_pool_num_stripes];
+        HostPoolChunk *head = nullptr;
+        atomic_load_relaxed(&stripe->free_list[size_class], &head);
+        if (head == nullptr) {
+            continue;
+        }
+        ScopedStripeLock lock(stripe);
+        chunk = stripe->free_list[size_class];
+        if (chunk) {
+            stripe->free_list[size_class] = chunk->next;
+            stripe->cached_bytes -= host_pool_class_size(size_class);
+        }
+    }
+
+    if (chunk == nullptr) {
+        chunk = host_pool_reserve_chunk(user_context, size_class);
+        if (chunk == nullptr) {
+            return nullptr;
+        }
+    }
+    return host_pool_chunk_to_ptr(chunk);
+}
+
+WEAK bool halide_host_pool_free(void *user_context, void *ptr) {
+    HostPoolChunk *chunk = host_pool_ptr_to_chunk(ptr);
+    if (chunk == nullptr) {
+        return false;
+    }
+
+    if (!halide_can_reuse_host_allocations(user_context)) {
+        chunk->next = nullptr;
+        host_pool_reclaim_chunks(user_context, chunk);
+        return true;
+    }
+
+    HostPoolStripe *stripe = host_pool_current_stripe();
+    HostPoolChunk *trimmed = nullptr;
+    {
+        ScopedStripeLock lock(stripe);
+        chunk->next = stripe->free_list[chunk->size_class];
+        stripe->free_list[chunk->size_class] = chunk;
+        stripe->cached_bytes += host_pool_class_size(chunk->size_class);
+        if (stripe->cached_bytes > host_pool_stripe_high_water) {
+            trimmed = host_pool_trim_stripe(stripe, host_pool_stripe_high_water / 2);
+        }
+    }
+    host_pool_reclaim_chunks(user_context, trimmed);
+    return true;
+}
+
+WEAK int halide_reuse_host_allocations(void *user_context, bool flag) {
+    halide_reuse_host_allocations_flag = flag;
+    if (!flag) {
+        for (HostPoolStripe &stripe : host_pool_stripes) {
+            HostPoolChunk *trimmed = nullptr;
+            {
+                ScopedStripeLock lock(&stripe);
+                trimmed = host_pool_trim_stripe(&stripe, 0);
+            }
+            host_pool_reclaim_chunks(user_context, trimmed);
+        }
+    }
+    return halide_error_code_success;
+}
+
+WEAK bool halide_can_reuse_host_allocations(void *user_context) {
+    return halide_reuse_host_allocations_flag;
+}
+
+WEAK __attribute__((destructor)) void halide_host_allocation_pool_cleanup() {
+    halide_reuse_host_allocations(nullptr, false);
+    ScopedMutexLock lock(&host_pool_lock);
+    if (host_pool_allocator && host_pool_allocator->block_count() == 0) {
+        BlockAllocator::destroy(nullptr, host_pool_allocator);
+        host_pool_allocator = nullptr;
+    }
+}
+}
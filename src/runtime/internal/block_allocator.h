@@ -120,7 +120,7 @@ private:
     MemoryAllocators allocators;
 };
 
-BlockAllocator *BlockAllocator::create(void *user_context, const Config &cfg, const MemoryAllocators &allocators) {
+WEAK BlockAllocator *BlockAllocator::create(void *user_context, const Config &cfg, const MemoryAllocators &allocators) {
     halide_abort_if_false(user_context, allocators.system.allocate != nullptr);
     BlockAllocator *result = reinterpret_cast<BlockAllocator *>(
         allocators.system.allocate(user_context, sizeof(BlockAllocator)));
@@ -134,7 +134,7 @@ BlockAllocator *BlockAllocator::create(void *user_context, const Config &cfg, co
     return result;
 }
 
-void BlockAllocator::destroy(void *user_context, BlockAllocator *instance) {
+WEAK void BlockAllocator::destroy(void *user_context, BlockAllocator *instance) {
     halide_abort_if_false(user_context, instance != nullptr);
     const MemoryAllocators &allocators = instance->allocators;
     instance->destroy(user_context);
@@ -142,7 +142,7 @@ void BlockAllocator::destroy(void *user_context, BlockAllocator *instance) {
     allocators.system.deallocate(user_context, instance);
 }
 
-void BlockAllocator::initialize(void *user_context, const Config &cfg, const MemoryAllocators &ma) {
+WEAK void BlockAllocator::initialize(void *user_context, const Config &cfg, const MemoryAllocators &ma) {
     config = cfg;
     allocators = ma;
     block_list.initialize(user_context,
@@ -151,7 +151,7 @@ void BlockAllocator::initialize(void *user_context, const Config &cfg, const Mem
                           allocators.system);
 }
 
-MemoryRegion *BlockAllocator::reserve(void *user_context, const MemoryRequest &request) {
+WEAK MemoryRegion *BlockAllocator::reserve(void *user_context, const MemoryRequest &request) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "BlockAllocator: Reserve ("
                         << "user_context=" << (void *)(user_context) << " "
@@ -194,7 +194,7 @@ MemoryRegion *BlockAllocator::reserve(void *user_context, const MemoryRequest &r
     return result;
 }
 
-int BlockAllocator::release(void *user_context, MemoryRegion *memory_region) {
+WEAK int BlockAllocator::release(void *user_context, MemoryRegion *memory_region) {
     if (memory_region == nullptr) {
         return halide_error_code_internal_error;
     }
@@ -205,7 +205,7 @@ int BlockAllocator::release(void *user_context, MemoryRegion *memory_region) {
     return allocator->release(user_context, memory_region);
 }
 
-int BlockAllocator::reclaim(void *user_context, MemoryRegion *memory_region) {
+WEAK int BlockAllocator::reclaim(void *user_context, MemoryRegion *memory_region) {
     if (memory_region == nullptr) {
         return halide_error_code_internal_error;
     }
@@ -216,7 +216,7 @@ int BlockAllocator::reclaim(void *user_context, MemoryRegion *memory_region) {
     return allocator->reclaim(user_context, memory_region);
 }
 
-int BlockAllocator::retain(void *user_context, MemoryRegion *memory_region) {
+WEAK int BlockAllocator::retain(void *user_context, MemoryRegion *memory_region) {
     if (memory_region == nullptr) {
         return halide_error_code_internal_error;
     }
@@ -227,7 +227,7 @@ int BlockAllocator::retain(void *user_context, MemoryRegion *memory_region) {
     return allocator->retain(user_context, memory_region);
 }
 
-bool BlockAllocator::collect(void *user_context) {
+WEAK bool BlockAllocator::collect(void *user_context) {
     bool result = false;
     BlockEntry *block_entry = block_list.back();
     while (block_entry != nullptr) {
@@ -262,7 +262,7 @@ bool BlockAllocator::collect(void *user_context) {
     return result;
 }
 
-int BlockAllocator::release(void *user_context) {
+WEAK int BlockAllocator::release(void *user_context) {
     BlockEntry *block_entry = block_list.back();
     while (block_entry != nullptr) {
         BlockEntry *prev_entry = block_entry->prev_ptr;
@@ -272,7 +272,7 @@ int BlockAllocator::release(void *user_context) {
     return 0;
 }
 
-int BlockAllocator::destroy(void *user_context) {
+WEAK int BlockAllocator::destroy(void *user_context) {
     BlockEntry *block_entry = block_list.back();
     while (block_entry != nullptr) {
         BlockEntry *prev_entry = block_entry->prev_ptr;
@@ -283,7 +283,7 @@ int BlockAllocator::destroy(void *user_context) {
     return 0;
 }
 
-MemoryRegion *BlockAllocator::reserve_memory_region(void *user_context, RegionAllocator *allocator, const MemoryRequest &request) {
+WEAK MemoryRegion *BlockAllocator::reserve_memory_region(void *user_context, RegionAllocator *allocator, const MemoryRequest &request) {
     MemoryRegion *result = allocator->reserve(user_context, request);
     if (result == nullptr) {
 #ifdef DEBUG_RUNTIME_INTERNAL
@@ -299,7 +299,7 @@ MemoryRegion *BlockAllocator::reserve_memory_region(void *user_context, RegionAl
     return result;
 }
 
-bool BlockAllocator::is_block_suitable_for_request(void *user_context, const BlockResource *block, const MemoryProperties &properties, size_t size, bool dedicated) const {
+WEAK bool BlockAllocator::is_block_suitable_for_request(void *user_context, const BlockResource *block, const MemoryProperties &properties, size_t size, bool dedicated) const {
     if (!is_compatible_block(block, properties)) {
 #ifdef DEBUG_RUNTIME_INTERNAL
         debug(user_context) << "BlockAllocator: skipping block ... incompatible properties!\n"
@@ -347,7 +347,7 @@ bool BlockAllocator::is_block_suitable_for_request(void *user_context, const Blo
     return false;
 }
 
-BlockAllocator::BlockEntry *
+WEAK BlockAllocator::BlockEntry *
 BlockAllocator::find_block_entry(void *user_context, const MemoryProperties &properties, size_t size, bool dedicated) {
     BlockEntry *block_entry = block_list.back();
     while (block_entry != nullptr) {
@@ -385,7 +385,7 @@ BlockAllocator::find_block_entry(void *user_context, const MemoryProperties &pro
     return block_entry;
 }
 
-BlockAllocator::BlockEntry *
+WEAK BlockAllocator::BlockEntry *
 BlockAllocator::reserve_block_entry(void *user_context, const MemoryProperties &properties, size_t size, bool dedicated) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "BlockAllocator: reserving block ... !\n"
@@ -417,7 +417,7 @@ BlockAllocator::reserve_block_entry(void *user_context, const MemoryProperties &
     return block_entry;
 }
 
-RegionAllocator *
+WEAK RegionAllocator *
 BlockAllocator::create_region_allocator(void *user_context, BlockResource *block) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "BlockAllocator: Creating region allocator ("
@@ -436,7 +436,7 @@ BlockAllocator::create_region_allocator(void *user_context, BlockResource *block
     return region_allocator;
 }
 
-int BlockAllocator::destroy_region_allocator(void *user_context, RegionAllocator *region_allocator) {
+WEAK int BlockAllocator::destroy_region_allocator(void *user_context, RegionAllocator *region_allocator) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "BlockAllocator: Destroying region allocator ("
                         << "user_context=" << (void *)(user_context) << " "
@@ -448,7 +448,7 @@ int BlockAllocator::destroy_region_allocator(void *user_context, RegionAllocator
     return RegionAllocator::destroy(user_context, region_allocator);
 }
 
-BlockAllocator::BlockEntry *
+WEAK BlockAllocator::BlockEntry *
 BlockAllocator::create_block_entry(void *user_context, const MemoryProperties &properties, size_t size, bool dedicated) {
     if (config.maximum_pool_size && (pool_size() >= config.maximum_pool_size)) {
         error(user_context) << "BlockAllocator: No free blocks found! Maximum pool size reached ("
@@ -488,7 +488,7 @@ BlockAllocator::create_block_entry(void *user_context, const MemoryProperties &p
     return block_entry;
 }
 
-int BlockAllocator::release_block_entry(void *user_context, BlockAllocator::BlockEntry *block_entry) {
+WEAK int BlockAllocator::release_block_entry(void *user_context, BlockAllocator::BlockEntry *block_entry) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "BlockAllocator: Releasing block entry ("
                         << "block_entry=" << (void *)(block_entry) << " "
@@ -501,7 +501,7 @@ int BlockAllocator::release_block_entry(void *user_context, BlockAllocator::Bloc
     return 0;
 }
 
-int BlockAllocator::destroy_block_entry(void *user_context, BlockAllocator::BlockEntry *block_entry) {
+WEAK int BlockAllocator::destroy_block_entry(void *user_context, BlockAllocator::BlockEntry *block_entry) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "BlockAllocator: Destroying block entry ("
                         << "block_entry=" << (void *)(block_entry) << " "
@@ -518,7 +518,7 @@ int BlockAllocator::destroy_block_entry(void *user_context, BlockAllocator::Bloc
     return 0;
 }
 
-int BlockAllocator::alloc_memory_block(void *user_context, BlockResource *block) {
+WEAK int BlockAllocator::alloc_memory_block(void *user_context, BlockResource *block) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "BlockAllocator: Allocating block (ptr=" << (void *)block << " allocator=" << (void *)allocators.block.allocate << ")...\n";
 #endif
@@ -529,7 +529,7 @@ int BlockAllocator::alloc_memory_block(void *user_context, BlockResource *block)
     return 0;
 }
 
-int BlockAllocator::free_memory_block(void *user_context, BlockResource *block) {
+WEAK int BlockAllocator::free_memory_block(void *user_context, BlockResource *block) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "BlockAllocator: Deallocating block (ptr=" << (void *)block << " allocator=" << (void *)allocators.block.deallocate << ")...\n";
 #endif
@@ -542,7 +542,7 @@ int BlockAllocator::free_memory_block(void *user_context, BlockResource *block)
     return 0;
 }
 
-size_t BlockAllocator::constrain_requested_size(size_t size) const {
+WEAK size_t BlockAllocator::constrain_requested_size(size_t size) const {
     size_t actual_size = size;
     if (config.nearest_multiple) {
         actual_size = (((actual_size + config.nearest_multiple - 1) / config.nearest_multiple) * config.nearest_multiple);
@@ -561,7 +561,7 @@ size_t BlockAllocator::constrain_requested_size(size_t size) const {
     return actual_size;
 }
 
-bool BlockAllocator::is_compatible_block(const BlockResource *block, const MemoryProperties &properties) const {
+WEAK bool BlockAllocator::is_compatible_block(const BlockResource *block, const MemoryProperties &properties) const {
     if (properties.caching != MemoryCaching::DefaultCaching) {
         if (properties.caching != block->memory.properties.caching) {
             return false;
@@ -583,24 +583,24 @@ bool BlockAllocator::is_compatible_block(const BlockResource *block, const Memor
     return true;
 }
 
-const BlockAllocator::MemoryAllocators &BlockAllocator::current_allocators() const {
+WEAK const BlockAllocator::MemoryAllocators &BlockAllocator::current_allocators() const {
     return allocators;
 }
 
-const BlockAllocator::Config &BlockAllocator::current_config() const {
+WEAK const BlockAllocator::Config &BlockAllocator::current_config() const {
     return config;
 }
 
-const BlockAllocator::Config &BlockAllocator::default_config() const {
+WEAK const BlockAllocator::Config &BlockAllocator::default_config() const {
     static Config result;
     return result;
 }
 
-size_t BlockAllocator::block_count() const {
+WEAK size_t BlockAllocator::block_count() const {
     return block_list.size();
 }
 
-size_t BlockAllocator::pool_size() const {
+WEAK size_t BlockAllocator::pool_size() const {
     size_t total_size = 0;
     BlockEntry const *block_entry = nullptr;
     for (block_entry = block_list.front(); block_entry != nullptr; block_entry = block_entry->next_ptr) {
@@ -91,7 +91,7 @@ private:
     SystemMemoryAllocatorFns allocator;
 };
 
-BlockStorage::BlockStorage(void *user_context, const Config &cfg, const SystemMemoryAllocatorFns &sma)
+WEAK BlockStorage::BlockStorage(void *user_context, const Config &cfg, const SystemMemoryAllocatorFns &sma)
     : config(cfg), allocator(sma) {
     halide_abort_if_false(user_context, config.entry_size != 0);
     halide_abort_if_false(user_context, allocator.allocate != nullptr);
@@ -101,7 +101,7 @@ BlockStorage::BlockStorage(void *user_context, const Config &cfg, const SystemMe
     }
 }
 
-BlockStorage::BlockStorage(const BlockStorage &other)
+WEAK BlockStorage::BlockStorage(const BlockStorage &other)
     : BlockStorage(nullptr, other.config, other.allocator) {
     if (other.count) {
         resize(nullptr, other.count);
@@ -109,11 +109,11 @@ BlockStorage::BlockStorage(const BlockStorage &other)
     }
 }
 
-BlockStorage::~BlockStorage() {
+WEAK BlockStorage::~BlockStorage() {
     destroy(nullptr);
 }
 
-void BlockStorage::destroy(void *user_context) {
+WEAK void BlockStorage::destroy(void *user_context) {
     halide_abort_if_false(user_context, allocator.deallocate != nullptr);
     if (ptr != nullptr) {
         allocator.deallocate(user_context, ptr);
@@ -122,7 +122,7 @@ void BlockStorage::destroy(void *user_context) {
     ptr = nullptr;
 }
 
-void BlockStorage::initialize(void *user_context, const Config &cfg, const SystemMemoryAllocatorFns &sma) {
+WEAK void BlockStorage::initialize(void *user_context, const Config &cfg, const SystemMemoryAllocatorFns &sma) {
     allocator = sma;
     config = cfg;
     capacity = count = 0;
@@ -132,7 +132,7 @@ void BlockStorage::initialize(void *user_context, const Config &cfg, const Syste
     }
 }
 
-BlockStorage &BlockStorage::operator=(const BlockStorage &other) {
+WEAK BlockStorage &BlockStorage::operator=(const BlockStorage &other) {
     if (&other != this) {
         config = other.config;
         resize(nullptr, other.count);
@@ -143,7 +143,7 @@ BlockStorage &BlockStorage::operator=(const BlockStorage &other) {
     return *this;
 }
 
-bool BlockStorage::operator==(const BlockStorage &other) const {
+WEAK bool BlockStorage::operator==(const BlockStorage &other) const {
     if (config.entry_size != other.config.entry_size) {
         return false;
     }
@@ -153,11 +153,11 @@ bool BlockStorage::operator==(const BlockStorage &other) const {
     return memcmp(this->ptr, other.ptr, this->size() * config.entry_size) == 0;
 }
 
-bool BlockStorage::operator!=(const BlockStorage &other) const {
+WEAK bool BlockStorage::operator!=(const BlockStorage &other) const {
     return !(*this == other);
 }
 
-void BlockStorage::fill(void *user_context, const void *array, size_t array_size) {
+WEAK void BlockStorage::fill(void *user_context, const void *array, size_t array_size) {
     if (array_size != 0) {
         resize(user_context, array_size);
         memcpy(this->ptr, array, array_size * config.entry_size);
@@ -165,33 +165,33 @@ void BlockStorage::fill(void *user_context, const void *array, size_t array_size
     }
 }
 
-void BlockStorage::assign(void *user_context, size_t index, const void *entry_ptr) {
+WEAK void BlockStorage::assign(void *user_context, size_t index, const void *entry_ptr) {
     replace(user_context, index, entry_ptr, 1);
 }
 
-void BlockStorage::prepend(void *user_context, const void *entry_ptr) {
+WEAK void BlockStorage::prepend(void *user_context, const void *entry_ptr) {
     insert(user_context, 0, entry_ptr, 1);
 }
 
-void BlockStorage::append(void *user_context, const void *entry_ptr) {
+WEAK void BlockStorage::append(void *user_context, const void *entry_ptr) {
     append(user_context, entry_ptr, 1);
 }
 
-void BlockStorage::pop_front(void *user_context) {
+WEAK void BlockStorage::pop_front(void *user_context) {
     halide_abort_if_false(user_context, count > 0);
     remove(user_context, 0);
 }
 
-void BlockStorage::pop_back(void *user_context) {
+WEAK void BlockStorage::pop_back(void *user_context) {
     halide_abort_if_false(user_context, count > 0);
     resize(user_context, size() - 1);
 }
 
-void BlockStorage::clear(void *user_context) {
+WEAK void BlockStorage::clear(void *user_context) {
     resize(user_context, 0);
 }
 
-void BlockStorage::reserve(void *user_context, size_t new_capacity, bool free_existing) {
+WEAK void BlockStorage::reserve(void *user_context, size_t new_capacity, bool free_existing) {
     new_capacity = max(new_capacity, count);
 
     if ((new_capacity < capacity) && !free_existing) {
@@ -201,7 +201,7 @@ void BlockStorage::reserve(void *user_context, size_t new_capacity, bool free_ex
     allocate(user_context, new_capacity);
 }
 
-void BlockStorage::resize(void *user_context, size_t entry_count, bool realloc) {
+WEAK void BlockStorage::resize(void *user_context, size_t entry_count, bool realloc) {
     size_t current_size = capacity;
     size_t requested_size = entry_count;
     size_t minimum_size = config.minimum_capacity;
@@ -228,7 +228,7 @@ void BlockStorage::resize(void *user_context, size_t entry_count, bool realloc)
     allocate(user_context, actual_size);
 }
 
-void BlockStorage::shrink_to_fit(void *user_context) {
+WEAK void BlockStorage::shrink_to_fit(void *user_context) {
     if (capacity > count) {
         void *new_ptr = nullptr;
         if (count > 0) {
@@ -242,15 +242,15 @@ void BlockStorage::shrink_to_fit(void *user_context) {
     }
 }
 
-void BlockStorage::insert(void *user_context, size_t index, const void *entry_ptr) {
+WEAK void BlockStorage::insert(void *user_context, size_t index, const void *entry_ptr) {
     insert(user_context, index, entry_ptr, 1);
 }
 
-void BlockStorage::remove(void *user_context, size_t index) {
+WEAK void BlockStorage::remove(void *user_context, size_t index) {
     remove(user_context, index, 1);
 }
 
-void BlockStorage::remove(void *user_context, size_t index, size_t entry_count) {
+WEAK void BlockStorage::remove(void *user_context, size_t index, size_t entry_count) {
     halide_abort_if_false(user_context, index < count);
     const size_t last_index = size();
     if (index < (last_index - entry_count)) {
@@ -275,7 +275,7 @@ void BlockStorage::remove(void *user_context, size_t index, size_t entry_count)
     resize(user_context, last_index - entry_count);
 }
 
-void BlockStorage::replace(void *user_context, size_t index, const void *array, size_t array_size) {
+WEAK void BlockStorage::replace(void *user_context, size_t index, const void *array, size_t array_size) {
     halide_abort_if_false(user_context, index < count);
     size_t offset = index * config.entry_size;
     size_t remaining = count - index;
@@ -297,7 +297,7 @@ void BlockStorage::replace(void *user_context, size_t index, const void *array,
     count = max(count, index + copy_count);
 }
 
-void BlockStorage::insert(void *user_context, size_t index, const void *array, size_t array_size) {
+WEAK void BlockStorage::insert(void *user_context, size_t index, const void *array, size_t array_size) {
     halide_abort_if_false(user_context, index <= count);
     const size_t last_index = size();
     resize(user_context, last_index + array_size);
@@ -312,76 +312,76 @@ void BlockStorage::insert(void *user_context, size_t index, const void *array, s
     replace(user_context, index, array, array_size);
 }
 
-void BlockStorage::prepend(void *user_context, const void *array, size_t array_size) {
+WEAK void BlockStorage::prepend(void *user_context, const void *array, size_t array_size) {
     insert(user_context, 0, array, array_size);
 }
 
-void BlockStorage::append(void *user_context, const void *array, size_t array_size) {
+WEAK void BlockStorage::append(void *user_context, const void *array, size_t array_size) {
     const size_t last_index = size();
     insert(user_context, last_index, array, array_size);
 }
 
-bool BlockStorage::empty() const {
+WEAK bool BlockStorage::empty() const {
     return count == 0;
 }
 
-bool BlockStorage::full() const {
+WEAK bool BlockStorage::full() const {
     return (count >= capacity);
 }
 
-bool BlockStorage::is_valid(size_t index) const {
+WEAK bool BlockStorage::is_valid(size_t index) const {
     return (index < capacity);
 }
 
-size_t BlockStorage::size() const {
+WEAK size_t BlockStorage::size() const {
     return count;
 }
 
-size_t BlockStorage::stride() const {
+WEAK size_t BlockStorage::stride() const {
     return config.entry_size;
 }
 
-void *BlockStorage::operator[](size_t index) {
+WEAK void *BlockStorage::operator[](size_t index) {
     halide_abort_if_false(nullptr, index < capacity);
     return offset_address(ptr, index * config.entry_size);
 }
 
-const void *BlockStorage::operator[](size_t index) const {
+WEAK const void *BlockStorage::operator[](size_t index) const {
     halide_abort_if_false(nullptr, index < capacity);
     return offset_address(ptr, index * config.entry_size);
 }
 
-void *BlockStorage::data() {
+WEAK void *BlockStorage::data() {
     return ptr;
 }
 
-void *BlockStorage::front() {
+WEAK void *BlockStorage::front() {
     halide_abort_if_false(nullptr, count > 0);
     return ptr;
 }
 
-void *BlockStorage::back() {
+WEAK void *BlockStorage::back() {
     halide_abort_if_false(nullptr, count > 0);
     size_t index = count - 1;
     return offset_address(ptr, index * config.entry_size);
 }
 
-const void *BlockStorage::data() const {
+WEAK const void *BlockStorage::data() const {
     return ptr;
 }
 
-const void *BlockStorage::front() const {
+WEAK const void *BlockStorage::front() const {
     halide_abort_if_false(nullptr, count > 0);
     return ptr;
 }
 
-const void *BlockStorage::back() const {
+WEAK const void *BlockStorage::back() const {
     halide_abort_if_false(nullptr, count > 0);
     size_t index = count - 1;
     return offset_address(ptr, index * config.entry_size);
 }
 
-void BlockStorage::allocate(void *user_context, size_t new_capacity) {
+WEAK void BlockStorage::allocate(void *user_context, size_t new_capacity) {
     if (new_capacity != capacity) {
         halide_abort_if_false(user_context, allocator.allocate != nullptr);
         size_t requested_bytes = new_capacity * config.entry_size;
@@ -409,23 +409,23 @@ void BlockStorage::allocate(void *user_context, size_t new_capacity) {
     }
 }
 
-const SystemMemoryAllocatorFns &
+WEAK const SystemMemoryAllocatorFns &
 BlockStorage::current_allocator() const {
     return this->allocator;
 }
 
-const BlockStorage::Config &
+WEAK const BlockStorage::Config &
 BlockStorage::default_config() {
     static Config default_cfg;
     return default_cfg;
 }
 
-const BlockStorage::Config &
+WEAK const BlockStorage::Config &
 BlockStorage::current_config() const {
     return this->config;
 }
 
-const SystemMemoryAllocatorFns &
+WEAK const SystemMemoryAllocatorFns &
 BlockStorage::default_allocator() {
     static SystemMemoryAllocatorFns native_allocator = {
         native_system_malloc, native_system_free};
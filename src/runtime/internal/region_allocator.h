@@ -110,7 +110,7 @@ private:
     MemoryAllocators allocators;
 };
 
-RegionAllocator *RegionAllocator::create(void *user_context, BlockResource *block_resource, const MemoryAllocators &allocators) {
+WEAK RegionAllocator *RegionAllocator::create(void *user_context, BlockResource *block_resource, const MemoryAllocators &allocators) {
     halide_abort_if_false(user_context, allocators.system.allocate != nullptr);
     RegionAllocator *result = reinterpret_cast<RegionAllocator *>(
         allocators.system.allocate(user_context, sizeof(RegionAllocator)));
@@ -123,7 +123,7 @@ RegionAllocator *RegionAllocator::create(void *user_context, BlockResource *bloc
     return result;
 }
 
-int RegionAllocator::destroy(void *user_context, RegionAllocator *instance) {
+WEAK int RegionAllocator::destroy(void *user_context, RegionAllocator *instance) {
     halide_abort_if_false(user_context, instance != nullptr);
     const MemoryAllocators &allocators = instance->allocators;
     instance->destroy(user_context);
@@ -132,7 +132,7 @@ int RegionAllocator::destroy(void *user_context, RegionAllocator *instance) {
     return 0;
 }
 
-int RegionAllocator::initialize(void *user_context, BlockResource *mb, const MemoryAllocators &ma) {
+WEAK int RegionAllocator::initialize(void *user_context, BlockResource *mb, const MemoryAllocators &ma) {
     block = mb;
     allocators = ma;
     arena = MemoryArena::create(user_context, {sizeof(BlockRegion), MemoryArena::default_capacity, 0}, allocators.system);
@@ -146,7 +146,7 @@ int RegionAllocator::initialize(void *user_context, BlockResource *mb, const Mem
     return 0;
 }
 
-MemoryRegion *RegionAllocator::reserve(void *user_context, const MemoryRequest &request) {
+WEAK MemoryRegion *RegionAllocator::reserve(void *user_context, const MemoryRequest &request) {
     halide_abort_if_false(user_context, request.size > 0);
     size_t actual_alignment = conform_alignment(request.alignment, block->memory.properties.alignment);
     size_t actual_size = conform_size(request.offset, request.size, actual_alignment, block->memory.properties.nearest_multiple);
@@ -181,7 +181,7 @@ MemoryRegion *RegionAllocator::reserve(void *user_context, const MemoryRequest &
     return reinterpret_cast<MemoryRegion *>(block_region);
 }
 
-int RegionAllocator::release(void *user_context, MemoryRegion *memory_region) {
+WEAK int RegionAllocator::release(void *user_context, MemoryRegion *memory_region) {
     BlockRegion *block_region = reinterpret_cast<BlockRegion *>(memory_region);
     halide_abort_if_false(user_context, block_region != nullptr);
     halide_abort_if_false(user_context, block_region->block_ptr == block);
@@ -191,7 +191,7 @@ int RegionAllocator::release(void *user_context, MemoryRegion *memory_region) {
     return release_block_region(user_context, block_region);
 }
 
-int RegionAllocator::reclaim(void *user_context, MemoryRegion *memory_region) {
+WEAK int RegionAllocator::reclaim(void *user_context, MemoryRegion *memory_region) {
     BlockRegion *block_region = reinterpret_cast<BlockRegion *>(memory_region);
     halide_abort_if_false(user_context, block_region != nullptr);
     halide_abort_if_false(user_context, block_region->block_ptr == block);
@@ -206,7 +206,7 @@ int RegionAllocator::reclaim(void *user_context, MemoryRegion *memory_region) {
     return 0;
 }
 
-int RegionAllocator::retain(void *user_context, MemoryRegion *memory_region) {
+WEAK int RegionAllocator::retain(void *user_context, MemoryRegion *memory_region) {
     BlockRegion *block_region = reinterpret_cast<BlockRegion *>(memory_region);
     halide_abort_if_false(user_context, block_region != nullptr);
     halide_abort_if_false(user_context, block_region->block_ptr == block);
@@ -214,7 +214,7 @@ int RegionAllocator::retain(void *user_context, MemoryRegion *memory_region) {
     return 0;
 }
 
-RegionAllocator *RegionAllocator::find_allocator(void *user_context, MemoryRegion *memory_region) {
+WEAK RegionAllocator *RegionAllocator::find_allocator(void *user_context, MemoryRegion *memory_region) {
     BlockRegion *block_region = reinterpret_cast<BlockRegion *>(memory_region);
     if (block_region == nullptr) {
         return nullptr;
@@ -225,11 +225,11 @@ RegionAllocator *RegionAllocator::find_allocator(void *user_context, MemoryRegio
     return block_region->block_ptr->allocator;
 }
 
-bool RegionAllocator::is_last_block_region(void *user_context, const BlockRegion *region) const {
+WEAK bool RegionAllocator::is_last_block_region(void *user_context, const BlockRegion *region) const {
     return ((region == nullptr) || (region == region->next_ptr) || (region->next_ptr == nullptr));
 }
 
-bool RegionAllocator::is_block_region_suitable_for_request(void *user_context, const BlockRegion *region, const MemoryRequest &request) const {
+WEAK bool RegionAllocator::is_block_region_suitable_for_request(void *user_context, const BlockRegion *region, const MemoryRequest &request) const {
     if (!is_available(region)) {
 #ifdef DEBUG_RUNTIME_INTERNAL
         debug(user_context) << "RegionAllocator: skipping block region ... not available! "
@@ -271,7 +271,7 @@ bool RegionAllocator::is_block_region_suitable_for_request(void *user_context, c
     return false;
 }
 
-BlockRegion *RegionAllocator::find_block_region(void *user_context, const MemoryRequest &request) {
+WEAK BlockRegion *RegionAllocator::find_block_region(void *user_context, const MemoryRequest &request) {
     BlockRegion *block_region = block->regions;
     while (block_region != nullptr) {
         if (is_block_region_suitable_for_request(user_context, block_region, request)) {
@@ -312,7 +312,7 @@ BlockRegion *RegionAllocator::find_block_region(void *user_context, const Memory
     return block_region;
 }
 
-bool RegionAllocator::is_available(const BlockRegion *block_region) const {
+WEAK bool RegionAllocator::is_available(const BlockRegion *block_region) const {
     if (block_region == nullptr) {
         return false;
     }
@@ -325,7 +325,7 @@ bool RegionAllocator::is_available(const BlockRegion *block_region) const {
     return true;
 }
 
-bool RegionAllocator::can_coalesce(const BlockRegion *block_region) const {
+WEAK bool RegionAllocator::can_coalesce(const BlockRegion *block_region) const {
     if (!is_available(block_region)) {
         return false;
     }
@@ -338,7 +338,7 @@ bool RegionAllocator::can_coalesce(const BlockRegion *block_region) const {
     return false;
 }
 
-BlockRegion *RegionAllocator::coalesce_block_regions(void *user_context, BlockRegion *block_region) {
+WEAK BlockRegion *RegionAllocator::coalesce_block_regions(void *user_context, BlockRegion *block_region) {
 
     if ((block_region->usage_count == 0) && (block_region->memory.handle != nullptr)) {
 #ifdef DEBUG_RUNTIME_INTERNAL
@@ -393,11 +393,11 @@ BlockRegion *RegionAllocator::coalesce_block_regions(void *user_context, BlockRe
     return block_region;
 }
 
-bool RegionAllocator::can_split(const BlockRegion *block_region, size_t size) const {
+WEAK bool RegionAllocator::can_split(const BlockRegion *block_region, size_t size) const {
     return (block_region && (block_region->memory.size > size) && (block_region->usage_count == 0));
 }
 
-BlockRegion *RegionAllocator::split_block_region(void *user_context, BlockRegion *block_region, size_t size, size_t alignment) {
+WEAK BlockRegion *RegionAllocator::split_block_region(void *user_context, BlockRegion *block_region, size_t size, size_t alignment) {
 
     if ((block_region->usage_count == 0) && (block_region->memory.handle != nullptr)) {
 #ifdef DEBUG_RUNTIME_INTERNAL
@@ -451,7 +451,7 @@ BlockRegion *RegionAllocator::split_block_region(void *user_context, BlockRegion
     return empty_region;
 }
 
-BlockRegion *RegionAllocator::create_block_region(void *user_context, const MemoryProperties &properties, size_t offset, size_t size, bool dedicated) {
+WEAK BlockRegion *RegionAllocator::create_block_region(void *user_context, const MemoryProperties &properties, size_t offset, size_t size, bool dedicated) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "RegionAllocator: Creating block region ("
                         << "user_context=" << (void *)(user_context) << " "
@@ -500,7 +500,7 @@ BlockRegion *RegionAllocator::create_block_region(void *user_context, const Memo
     return block_region;
 }
 
-int RegionAllocator::release_block_region(void *user_context, BlockRegion *block_region) {
+WEAK int RegionAllocator::release_block_region(void *user_context, BlockRegion *block_region) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "RegionAllocator: Releasing block region ("
                         << "user_context=" << (void *)(user_context) << " "
@@ -531,7 +531,7 @@ int RegionAllocator::release_block_region(void *user_context, BlockRegion *block
     return 0;
 }
 
-int RegionAllocator::destroy_block_region(void *user_context, BlockRegion *block_region) {
+WEAK int RegionAllocator::destroy_block_region(void *user_context, BlockRegion *block_region) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "RegionAllocator: Destroying block region ("
                         << "user_context=" << (void *)(user_context) << " "
@@ -545,7 +545,7 @@ int RegionAllocator::destroy_block_region(void *user_context, BlockRegion *block
     return 0;
 }
 
-int RegionAllocator::alloc_block_region(void *user_context, BlockRegion *block_region) {
+WEAK int RegionAllocator::alloc_block_region(void *user_context, BlockRegion *block_region) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "RegionAllocator: Allocating region (user_context=" << (void *)(user_context)
                         << " size=" << (int32_t)(block_region->memory.size)
@@ -586,7 +586,7 @@ int RegionAllocator::alloc_block_region(void *user_context, BlockRegion *block_r
     return error_code;
 }
 
-int RegionAllocator::free_block_region(void *user_context, BlockRegion *block_region) {
+WEAK int RegionAllocator::free_block_region(void *user_context, BlockRegion *block_region) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "RegionAllocator: Freeing block region ("
                         << "user_context=" << (void *)(user_context) << " "
@@ -606,8 +606,6 @@ int RegionAllocator::free_block_region(void *user_context, BlockRegion *block_re
         halide_abort_if_false(user_context, allocators.region.deallocate != nullptr);
         MemoryRegion *memory_region = &(block_region->memory);
         allocators.region.deallocate(user_context, memory_region);
-        block_region->memory.size = 0;
-        block_region->memory.offset = 0;
         block_region->memory.handle = nullptr;
     }
     block_region->usage_count = 0;
@@ -615,7 +613,7 @@ int RegionAllocator::free_block_region(void *user_context, BlockRegion *block_re
     return 0;
 }
 
-int RegionAllocator::release(void *user_context) {
+WEAK int RegionAllocator::release(void *user_context) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "RegionAllocator: Releasing all regions ("
                         << "user_context=" << (void *)(user_context) << ") ...\n";
@@ -632,7 +630,7 @@ int RegionAllocator::release(void *user_context) {
     return 0;
 }
 
-bool RegionAllocator::collect(void *user_context) {
+WEAK bool RegionAllocator::collect(void *user_context) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "RegionAllocator: Collecting free block regions ("
                         << "user_context=" << (void *)(user_context) << ") ...\n";
@@ -679,7 +677,7 @@ bool RegionAllocator::collect(void *user_context) {
     return has_collected;
 }
 
-int RegionAllocator::destroy(void *user_context) {
+WEAK int RegionAllocator::destroy(void *user_context) {
 #ifdef DEBUG_RUNTIME_INTERNAL
     debug(user_context) << "RegionAllocator: Destroying all block regions ("
                         << "user_context=" << (void *)(user_context) << ") ...\n";
@@ -703,7 +701,7 @@ int RegionAllocator::destroy(void *user_context) {
     return 0;
 }
 
-bool RegionAllocator::is_compatible_block_region(const BlockRegion *block_region, const MemoryProperties &properties) const {
+WEAK bool RegionAllocator::is_compatible_block_region(const BlockRegion *block_region, const MemoryProperties &properties) const {
     if (properties.caching != MemoryCaching::DefaultCaching) {
         if (properties.caching != block_region->memory.properties.caching) {
             return false;
@@ -725,7 +723,7 @@ bool RegionAllocator::is_compatible_block_region(const BlockRegion *block_region
     return true;
 }
 
-size_t RegionAllocator::region_count(void *user_context) const {
+WEAK size_t RegionAllocator::region_count(void *user_context) const {
     if (block == nullptr) {
         return 0;
     }
@@ -736,7 +734,7 @@ size_t RegionAllocator::region_count(void *user_context) const {
     return count;
 }
 
-BlockResource *RegionAllocator::block_resource() const {
+WEAK BlockResource *RegionAllocator::block_resource() const {
     return block;
 }
 
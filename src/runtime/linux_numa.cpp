@@ -0,0 +1,213 @@
+#include "HalideRuntime.h"
+#include "printer.h"
+
+extern "C" {
+
+extern int sched_getcpu();
+extern int sched_setaffinity(int pid, size_t cpusetsize, const void *mask);
+extern void *mmap(void *addr, size_t length, int prot, int flags, int fd, long offset);
+extern int munmap(void *addr, size_t length);
+extern size_t fread(void *ptr, size_t size, size_t n, void *file);
+
+}  // extern "C"
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+// The same capacity as glibc's cpu_set_t.
+constexpr int numa_max_cpus = 1024;
+constexpr int numa_max_nodes = 256;
+
+struct numa_topology_t {
+    bool initialized;
+    int nodes;
+    // The node of each logical cpu, or -1 if the cpu is not online.
+    int16_t node_of_cpu[numa_max_cpus];
+};
+
+WEAK numa_topology_t numa_topology = {};
+
+// Set while the thread pool runs with the local NUMA policy on a
+// machine with more than one node.
+WEAK bool numa_local_allocations = false;
+
+// Smaller allocations are left to malloc, which keeps them in per-thread
+// arenas that are mostly local anyway, and where they cost less than a
+// page mapping of their own.
+constexpr size_t numa_min_allocation = 64 * 1024;
+constexpr size_t numa_page_size = 4096;
+
+constexpr int numa_prot_read_write = 3;                  // PROT_READ | PROT_WRITE
+constexpr int numa_map_private_anonymous = 0x02 | 0x20;  // MAP_PRIVATE | MAP_ANONYMOUS
+
+// The word before a pointer returned by halide_numa_malloc holds the
+// address of its mapping with this tag in the low bits. The host
+// allocation pool tags its chunks with the low bit set, and
+// halide_internal_aligned_alloc stores an untagged malloc pointer.
+constexpr uintptr_t numa_allocation_tag = 2;
+
+// Read a small sysfs file into buf as a null-terminated string.
+WEAK bool numa_read_sysfs(const char *path, char *buf, size_t size) {
+    void *f = halide_fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    size_t n = fread(buf, 1, size - 1, f);
+    fclose(f);
+    buf[n] = 0;
+    return n > 0;
+}
+
+// Parse the next range of a sysfs list like "0-15,32-47". Returns the
+// position after the range, or nullptr at the end of the list.
+WEAK const char *numa_parse_range(const char *s, int *first, int *last) {
+    if (*s < '0' || *s > '9') {
+        return nullptr;
+    }
+    *first = 0;
+    while (*s >= '0' && *s <= '9') {
+        *first = *first * 10 + (*s++ - '0');
+    }
+    *last = *first;
+    if (*s == '-') {
+        s++;
+        *last = 0;
+        while (*s >= '0' && *s <= '9') {
+            *last = *last * 10 + (*s++ - '0');
+        }
+    }
+    if (*s == ',') {
+        s++;
+    }
+    return s;
+}
+
+WEAK void numa_init_topology() {
+    if (numa_topology.initialized) {
+        return;
+    }
+    numa_topology.initialized = true;
+    numa_topology.nodes = 1;
+    for (int i = 0; i < numa_max_cpus; i++) {
+        numa_topology.node_of_cpu[i] = 0;
+    }
+
+    char buf[4096];
+    if (!numa_read_sysfs("/sys/devices/system/node/online", buf, sizeof(buf))) {
+        // No NUMA support in the kernel. Treat it as one node.
+        return;
+    }
+
+    int nodes = 0;
+    const char *s = buf;
+    int first, last;
+    while ((s = numa_parse_range(s, &first, &last))) {
+        nodes = max(nodes, last + 1);
+    }
+    nodes = min(nodes, numa_max_nodes);
+    if (nodes <= 1) {
+        return;
+    }
+
+    for (int i = 0; i < numa_max_cpus; i++) {
+        numa_topology.node_of_cpu[i] = -1;
+    }
+    for (int n = 0; n < nodes; n++) {
+        StackStringStreamPrinter<64> path(nullptr);
+        path << "/sys/devices/system/node/node" << n << "/cpulist";
+        if (!numa_read_sysfs(path.str(), buf, sizeof(buf))) {
+            continue;
+        }
+        s = buf;
+        while ((s = numa_parse_range(s, &first, &last))) {
+            for (int c = first; c <= last && c < numa_max_cpus; c++) {
+                numa_topology.node_of_cpu[c] = (int16_t)n;
+            }
+        }
+    }
+    numa_topology.nodes = nodes;
+}
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK int halide_numa_node_count() {
+    numa_init_topology();
+    return numa_topology.nodes;
+}
+
+WEAK int halide_numa_current_node() {
+    int cpu = sched_getcpu();
+    if (cpu < 0 || cpu >= numa_max_cpus) {
+        return -1;
+    }
+    return numa_topology.node_of_cpu[cpu];
+}
+
+WEAK int halide_numa_bind_current_thread(int node) {
+    numa_init_topology();
+    if (node < 0 || node >= numa_topology.nodes) {
+        return halide_error_code_generic_error;
+    }
+    uint64_t mask[numa_max_cpus / 64] = {0};
+    for (int c = 0; c < numa_max_cpus; c++) {
+        if (numa_topology.node_of_cpu[c] == node) {
+            mask[c / 64] |= (uint64_t)1 << (c % 64);
+        }
+    }
+    if (sched_setaffinity(0, sizeof(mask), mask) != 0) {
+        return halide_error_code_generic_error;
+    }
+    return halide_error_code_success;
+}
+
+WEAK void halide_numa_set_local_allocations(bool local) {
+    numa_local_allocations = local;
+}
+
+WEAK void *halide_numa_malloc(void *user_context, size_t size) {
+    // Heap memory that malloc or the host allocation pool hands out
+    // again may already have been touched on another node. Freshly
+    // mapped pages are placed by the kernel on the node of the thread
+    // that first touches them, which under the local policy is the
+    // node whose slice of the loop produces (and later consumes) them.
+    if (!numa_local_allocations || size < numa_min_allocation) {
+        return nullptr;
+    }
+    const size_t alignment = ::halide_internal_malloc_alignment();
+    // The mapping starts with its length, and the word before the
+    // returned pointer is its tagged address.
+    const size_t header = align_up(2 * sizeof(uintptr_t), alignment);
+    // Pad by one alignment, since it's safe to read past the end of a
+    // halide_malloc allocation.
+    const size_t length = align_up(header + size + alignment, numa_page_size);
+    void *base = mmap(nullptr, length, numa_prot_read_write, numa_map_private_anonymous, -1, 0);
+    if (base == (void *)-1) {
+        return nullptr;
+    }
+    ((uintptr_t *)base)[0] = length;
+    void *ptr = (uint8_t *)base + header;
+    ((uintptr_t *)ptr)[-1] = (uintptr_t)base | numa_allocation_tag;
+    return ptr;
+}
+
+WEAK bool halide_numa_free(void *user_context, void *ptr) {
+    if (ptr == nullptr) {
+        return false;
+    }
+    uintptr_t tag = ((uintptr_t *)ptr)[-1];
+    if ((tag & 3) != numa_allocation_tag) {
+        return false;
+    }
+    void *base = (void *)(tag & ~(uintptr_t)3);
+    munmap(base, ((uintptr_t *)base)[0]);
+    return true;
+}
+
+}  // extern "C"
@@ -0,0 +1,298 @@
+#include "HalideRuntime.h"
+#include "runtime_atomics.h"
+#include "scoped_mutex_lock.h"
+
+// The syscall number for perf_event_open varies across platforms. This
+// module is only used on x86, like linux_clock.cpp.
+#ifndef SYS_PERF_EVENT_OPEN
+
+#ifdef BITS_64
+#define SYS_PERF_EVENT_OPEN 298
+#endif
+
+#ifdef BITS_32
+#define SYS_PERF_EVENT_OPEN 336
+#endif
+
+#endif
+
+extern "C" {
+
+extern int syscall(int num, ...);
+extern ssize_t read(int fd, void *buf, size_t count);
+
+typedef unsigned int pthread_key_t;
+
+extern int pthread_key_create(pthread_key_t *key, void (*destructor)(void *));
+extern int pthread_key_delete(pthread_key_t key);
+extern int pthread_setspecific(pthread_key_t key, const void *value);
+extern void *pthread_getspecific(pthread_key_t key);
+
+}  // extern "C"
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+// The prefix of struct perf_event_attr defined by PERF_ATTR_SIZE_VER0,
+// which every kernel with perf events accepts.
+struct perf_event_attr_v0 {
+    uint32_t type;
+    uint32_t size;
+    uint64_t config;
+    uint64_t sample_period;
+    uint64_t sample_type;
+    uint64_t read_format;
+    uint64_t flags;
+    uint32_t wakeup_events;
+    uint32_t bp_type;
+    uint64_t config1;
+};
+
+constexpr uint32_t perf_type_hardware = 0;
+constexpr uint64_t perf_format_group = 1 << 3;
+constexpr uint64_t perf_flag_exclude_kernel = 1 << 5;
+constexpr uint64_t perf_flag_exclude_hv = 1 << 6;
+constexpr unsigned long perf_flag_fd_cloexec = 1 << 3;
+
+// The events to count, in the order of the counters in
+// halide_profiler_func_stats. The first is the group leader.
+constexpr uint64_t perf_counter_events[] = {
+    0,  // PERF_COUNT_HW_CPU_CYCLES
+    1,  // PERF_COUNT_HW_INSTRUCTIONS
+    3,  // PERF_COUNT_HW_CACHE_MISSES (last-level cache)
+    5,  // PERF_COUNT_HW_BRANCH_MISSES
+};
+constexpr int num_perf_counters = sizeof(perf_counter_events) / sizeof(perf_counter_events[0]);
+
+// Slots for threads are allocated this many at a time.
+constexpr int perf_threads_per_block = 64;
+
+// The counters of one thread that has run Halide code, and the func
+// that thread is currently running. The thread itself writes func (see
+// halide_profiler_set_thread_func) and the sampling thread reads it.
+struct perf_thread_t {
+    int func;
+    bool in_use;
+    int fds[num_perf_counters];
+    uint64_t last[num_perf_counters];
+};
+
+struct perf_thread_block_t {
+    perf_thread_block_t *next;
+    perf_thread_t threads[perf_threads_per_block];
+};
+
+constexpr uint32_t perf_counters_untried = 0;
+constexpr uint32_t perf_counters_supported = 1;
+constexpr uint32_t perf_counters_unsupported = 2;
+
+// Each thread finds its slot through a pthread key, and the key's
+// destructor frees the slot when the thread exits, so that the slot can
+// be reused by a later thread. Blocks of slots are never freed, because
+// generated code keeps a pointer to the func of the slot it was given.
+struct perf_counters_t {
+    uint32_t state;
+    pthread_key_t key;
+    perf_thread_block_t *blocks;
+};
+
+WEAK perf_counters_t perf_counters = {perf_counters_untried, 0, nullptr};
+
+// Guards everything in perf_counters except the state, which is also
+// read without it, and the funcs, which are written by their threads.
+WEAK halide_mutex perf_counters_lock = {{0}};
+
+WEAK int perf_event_open(uint64_t event, int tid, int group_fd) {
+    perf_event_attr_v0 attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = perf_type_hardware;
+    attr.size = sizeof(attr);
+    attr.config = event;
+    attr.read_format = perf_format_group;
+    // Counting only user-space events keeps this usable at the default
+    // perf_event_paranoid level.
+    attr.flags = perf_flag_exclude_kernel | perf_flag_exclude_hv;
+    return syscall(SYS_PERF_EVENT_OPEN, &attr, tid, -1, group_fd, perf_flag_fd_cloexec);
+}
+
+// Close a thread's counters and free its slot. The caller must hold
+// perf_counters_lock.
+WEAK void perf_close_thread(perf_thread_t *t) {
+    for (int i = num_perf_counters - 1; i >= 0; i--) {
+        if (t->fds[i] >= 0) {
+            close(t->fds[i]);
+            t->fds[i] = -1;
+        }
+    }
+    t->func = halide_profiler_outside_of_halide;
+    t->in_use = false;
+}
+
+// The destructor of perf_counters.key.
+WEAK void perf_thread_exited(void *arg) {
+    ScopedMutexLock lock(&perf_counters_lock);
+    perf_close_thread((perf_thread_t *)arg);
+}
+
+// Find a free slot, adding a block of them if there are none. The caller
+// must hold perf_counters_lock.
+WEAK perf_thread_t *perf_free_thread_slot() {
+    perf_thread_block_t **last = &perf_counters.blocks;
+    for (perf_thread_block_t *b = perf_counters.blocks; b; b = b->next) {
+        for (int i = 0; i < perf_threads_per_block; i++) {
+            if (!b->threads[i].in_use) {
+                return &b->threads[i];
+            }
+        }
+        last = &b->next;
+    }
+    perf_thread_block_t *b = (perf_thread_block_t *)malloc(sizeof(perf_thread_block_t));
+    if (!b) {
+        return nullptr;
+    }
+    memset(b, 0, sizeof(perf_thread_block_t));
+    for (int i = 0; i < perf_threads_per_block; i++) {
+        perf_thread_t *t = &b->threads[i];
+        t->func = halide_profiler_outside_of_halide;
+        for (int j = 0; j < num_perf_counters; j++) {
+            t->fds[j] = -1;
+        }
+    }
+    // The sampling thread walks the list under the lock, so the block
+    // can be linked in before it's filled.
+    *last = b;
+    return &b->threads[0];
+}
+
+// Open a group of counters for the calling thread. Returns false if the
+// hardware or kernel doesn't support all of them.
+WEAK bool perf_open_thread(perf_thread_t *t) {
+    t->func = halide_profiler_outside_of_halide;
+    for (int i = 0; i < num_perf_counters; i++) {
+        t->fds[i] = -1;
+        t->last[i] = 0;
+    }
+    for (int i = 0; i < num_perf_counters; i++) {
+        // A pid of zero means the calling thread.
+        t->fds[i] = perf_event_open(perf_counter_events[i], 0, i == 0 ? -1 : t->fds[0]);
+        if (t->fds[i] < 0) {
+            perf_close_thread(t);
+            return false;
+        }
+    }
+    t->in_use = true;
+    return true;
+}
+
+// Read a thread's counters, and store how much each has advanced since
+// the last read in deltas.
+WEAK bool perf_read_thread(perf_thread_t *t, uint64_t *deltas) {
+    uint64_t values[1 + num_perf_counters];
+    if (read(t->fds[0], values, sizeof(values)) != (ssize_t)sizeof(values) ||
+        values[0] != num_perf_counters) {
+        return false;
+    }
+    for (int i = 0; i < num_perf_counters; i++) {
+        deltas[i] = values[i + 1] - t->last[i];
+        t->last[i] = values[i + 1];
+    }
+    return true;
+}
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK int *halide_perf_counters_thread_func() {
+    using namespace Halide::Runtime::Internal::Synchronization;
+
+    // Generated code calls this every time a thread starts a parallel
+    // task, so once a thread has a slot, finding it again is just a
+    // thread-specific data lookup.
+    uint32_t state;
+    atomic_load_acquire(&perf_counters.state, &state);
+    if (state == perf_counters_unsupported) {
+        return nullptr;
+    } else if (state == perf_counters_supported) {
+        perf_thread_t *t = (perf_thread_t *)pthread_getspecific(perf_counters.key);
+        if (t) {
+            return &t->func;
+        }
+    }
+
+    ScopedMutexLock lock(&perf_counters_lock);
+    if (perf_counters.state == perf_counters_unsupported) {
+        return nullptr;
+    }
+    if (perf_counters.state == perf_counters_untried &&
+        pthread_key_create(&perf_counters.key, perf_thread_exited) != 0) {
+        return nullptr;
+    }
+    perf_thread_t *t = perf_free_thread_slot();
+    if (!t) {
+        return nullptr;
+    }
+    bool opened = perf_open_thread(t);
+    if (perf_counters.state == perf_counters_untried) {
+        // Only try once, so that platforms without these counters (for
+        // example most virtual machines) cost one syscall.
+        uint32_t new_state = opened ? perf_counters_supported : perf_counters_unsupported;
+        if (!opened) {
+            pthread_key_delete(perf_counters.key);
+        }
+        atomic_store_release(&perf_counters.state, &new_state);
+    }
+    if (!opened) {
+        return nullptr;
+    }
+    pthread_setspecific(perf_counters.key, t);
+    return &t->func;
+}
+
+WEAK bool halide_perf_counters_sample(int thread, int *func, uint64_t *deltas) {
+    // Taking the lock keeps a thread that is exiting from closing its
+    // counters while they are being read.
+    ScopedMutexLock lock(&perf_counters_lock);
+    perf_thread_block_t *b = perf_counters.blocks;
+    for (; b && thread >= perf_threads_per_block; thread -= perf_threads_per_block) {
+        b = b->next;
+    }
+    if (!b) {
+        return false;
+    }
+    perf_thread_t *t = &b->threads[thread];
+    *func = *(volatile int *)(&t->func);
+    if (!t->in_use || !perf_read_thread(t, deltas)) {
+        *func = halide_profiler_outside_of_halide;
+    }
+    return true;
+}
+
+WEAK void halide_perf_counters_close() {
+    using namespace Halide::Runtime::Internal::Synchronization;
+
+    ScopedMutexLock lock(&perf_counters_lock);
+    if (perf_counters.state != perf_counters_supported) {
+        return;
+    }
+    // Deleting the key drops every thread's slot, so threads that run
+    // Halide code again get fresh counters. The slots themselves stay
+    // allocated for the next use of the profiler.
+    pthread_key_delete(perf_counters.key);
+    for (perf_thread_block_t *b = perf_counters.blocks; b; b = b->next) {
+        for (int i = 0; i < perf_threads_per_block; i++) {
+            if (b->threads[i].in_use) {
+                perf_close_thread(&b->threads[i]);
+            }
+        }
+    }
+    uint32_t untried = perf_counters_untried;
+    atomic_store_release(&perf_counters.state, &untried);
+}
+
+}  // extern "C"
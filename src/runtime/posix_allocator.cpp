@@ -7,11 +7,29 @@ extern void *malloc(size_t);
 extern void free(void *);
 
 WEAK void *halide_default_malloc(void *user_context, size_t x) {
+    // Under the local NUMA policy, large allocations bypass malloc and
+    // the pool, whose pages may have been touched on another node.
+    void *numa_ptr = halide_numa_malloc(user_context, x);
+    if (numa_ptr) {
+        return numa_ptr;
+    }
+    if (halide_can_reuse_host_allocations(user_context)) {
+        void *ptr = halide_host_pool_malloc(user_context, x);
+        if (ptr) {
+            return ptr;
+        }
+    }
     const size_t alignment = ::halide_internal_malloc_alignment();
     return ::halide_internal_aligned_alloc(alignment, x);
 }
 
 WEAK void halide_default_free(void *user_context, void *ptr) {
+    if (halide_numa_free(user_context, ptr)) {
+        return;
+    }
+    if (halide_host_pool_free(user_context, ptr)) {
+        return;
+    }
     ::halide_internal_aligned_free(ptr);
 }
 }
@@ -0,0 +1,40 @@
+#include "HalideRuntime.h"
+
+extern "C" {
+
+extern void *mmap(void *addr, size_t length, int prot, int flags, int fd, long offset);
+extern int munmap(void *addr, size_t length);
+extern int fseek(void *stream, long offset, int whence);
+extern long ftell(void *stream);
+
+#define PROT_READ 1
+#define MAP_PRIVATE 2
+#define SEEK_END 2
+
+WEAK void *halide_map_file(void *user_context, const char *path, size_t *size) {
+    void *f = halide_fopen(path, "rb");
+    if (!f) {
+        return nullptr;
+    }
+    void *addr = nullptr;
+    long length = -1;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        length = ftell(f);
+    }
+    if (length > 0) {
+        addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+        if (addr == (void *)-1) {
+            addr = nullptr;
+        }
+    }
+    // The mapping stays valid after the file is closed.
+    fclose(f);
+    *size = addr ? (size_t)length : 0;
+    return addr;
+}
+
+WEAK void halide_unmap_file(void *user_context, void *addr, size_t size) {
+    munmap(addr, size);
+}
+
+}  // extern "C"
@@ -25,6 +25,11 @@ namespace Halide {
 namespace Runtime {
 namespace Internal {
 
+// Set from HL_PROFILER_COUNTERS when the sampling thread starts. Not
+// supported with the timer-based profiler, because reading the counters
+// isn't safe inside a signal handler.
+WEAK bool profiler_counters_enabled = false;
+
 class LockProfiler {
     halide_profiler_state *state;
 
@@ -75,6 +80,10 @@ WEAK halide_profiler_pipeline_stats *find_or_create_pipeline(const char *pipelin
     p->num_allocs = 0;
     p->active_threads_numerator = 0;
     p->active_threads_denominator = 0;
+    p->cycles = 0;
+    p->instructions = 0;
+    p->cache_misses = 0;
+    p->branch_misses = 0;
     p->funcs = (halide_profiler_func_stats *)malloc(num_funcs * sizeof(halide_profiler_func_stats));
     if (!p->funcs) {
         free(p);
@@ -90,13 +99,18 @@ WEAK halide_profiler_pipeline_stats *find_or_create_pipeline(const char *pipelin
         p->funcs[i].stack_peak = 0;
         p->funcs[i].active_threads_numerator = 0;
         p->funcs[i].active_threads_denominator = 0;
+        p->funcs[i].cycles = 0;
+        p->funcs[i].instructions = 0;
+        p->funcs[i].cache_misses = 0;
+        p->funcs[i].branch_misses = 0;
     }
     s->first_free_id += num_funcs;
     s->pipelines = p;
     return p;
 }
 
-WEAK void bill_func(halide_profiler_state *s, int func_id, uint64_t time, int active_threads) {
+// Find the pipeline a func id belongs to, or nullptr if there isn't one.
+WEAK halide_profiler_pipeline_stats *find_pipeline(halide_profiler_state *s, int func_id) {
     halide_profiler_pipeline_stats *p_prev = nullptr;
     for (halide_profiler_pipeline_stats *p = s->pipelines; p;
          p = (halide_profiler_pipeline_stats *)(p->next)) {
@@ -107,19 +121,43 @@ WEAK void bill_func(halide_profiler_state *s, int func_id, uint64_t time, int ac
                 p->next = s->pipelines;
                 s->pipelines = p;
             }
-            halide_profiler_func_stats *f = p->funcs + func_id - p->first_func_id;
-            f->time += time;
-            f->active_threads_numerator += active_threads;
-            f->active_threads_denominator += 1;
-            p->time += time;
-            p->samples++;
-            p->active_threads_numerator += active_threads;
-            p->active_threads_denominator += 1;
-            return;
+            return p;
         }
         p_prev = p;
     }
-    // Someone must have called reset_state while a kernel was running. Do nothing.
+    return nullptr;
+}
+
+WEAK void bill_func(halide_profiler_state *s, int func_id, uint64_t time, int active_threads) {
+    halide_profiler_pipeline_stats *p = find_pipeline(s, func_id);
+    if (!p) {
+        // Someone must have called reset_state while a kernel was running. Do nothing.
+        return;
+    }
+    halide_profiler_func_stats *f = p->funcs + func_id - p->first_func_id;
+    f->time += time;
+    f->active_threads_numerator += active_threads;
+    f->active_threads_denominator += 1;
+    p->time += time;
+    p->samples++;
+    p->active_threads_numerator += active_threads;
+    p->active_threads_denominator += 1;
+}
+
+WEAK void bill_counters(halide_profiler_state *s, int func_id, const uint64_t *counters) {
+    halide_profiler_pipeline_stats *p = find_pipeline(s, func_id);
+    if (!p) {
+        return;
+    }
+    halide_profiler_func_stats *f = p->funcs + func_id - p->first_func_id;
+    f->cycles += counters[0];
+    f->instructions += counters[1];
+    f->cache_misses += counters[2];
+    f->branch_misses += counters[3];
+    p->cycles += counters[0];
+    p->instructions += counters[1];
+    p->cache_misses += counters[2];
+    p->branch_misses += counters[3];
 }
 
 extern "C" WEAK int halide_profiler_sample(struct halide_profiler_state *s, uint64_t *prev_t) {
@@ -143,6 +181,18 @@ extern "C" WEAK int halide_profiler_sample(struct halide_profiler_state *s, uint
         // the currently running func.
         bill_func(s, func, t_now - *prev_t, active_threads);
     }
+    if (profiler_counters_enabled) {
+        // Unlike time, counters are kept per thread, so each thread's
+        // events since the last sample are billed to the func that
+        // thread is running, whichever thread holds the sampling token.
+        int thread_func;
+        uint64_t counters[4];
+        for (int i = 0; halide_perf_counters_sample(i, &thread_func, counters); i++) {
+            if (thread_func >= 0) {
+                bill_counters(s, thread_func, counters);
+            }
+        }
+    }
     *prev_t = t_now;
     return s->sleep_time;
 }
@@ -191,6 +241,188 @@ void sync_compare_max_and_swap(T *ptr, T val) {
 
 }  // namespace
 
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+// Reports go to the file named by HL_PROFILER_REPORT_FILE, which is
+// appended to so that reports from many runs accumulate, or otherwise
+// to halide_print.
+class ProfilerReportSink {
+    void *user_context;
+    void *file = nullptr;
+
+public:
+    ProfilerReportSink(void *user_context)
+        : user_context(user_context) {
+        const char *path = getenv("HL_PROFILER_REPORT_FILE");
+        if (path && *path) {
+            file = halide_fopen(path, "a");
+        }
+    }
+
+    ~ProfilerReportSink() {
+        if (file) {
+            fclose(file);
+        }
+    }
+
+    void print(const char *str) {
+        if (file) {
+            fwrite(str, 1, strlen(str), file);
+        } else {
+            halide_print(user_context, str);
+        }
+    }
+};
+
+WEAK halide_profiler_report_format_t profiler_report_format_from_env() {
+    const char *format = getenv("HL_PROFILER_REPORT_FORMAT");
+    if (format && strcmp(format, "json") == 0) {
+        return halide_profiler_report_json;
+    } else if (format && strcmp(format, "csv") == 0) {
+        return halide_profiler_report_csv;
+    }
+    return halide_profiler_report_text;
+}
+
+template<uint64_t size>
+void print_quoted(StringStreamPrinter<size> &sstr, const char *str, char escape) {
+    char c[3] = {0, 0, 0};
+    sstr << "\"";
+    for (; *str; str++) {
+        // JSON escapes quotes and backslashes with a backslash, CSV
+        // doubles quotes.
+        if (*str == '"' || (escape == '\\' && *str == '\\')) {
+            c[0] = escape;
+            c[1] = *str;
+        } else {
+            c[0] = *str;
+            c[1] = 0;
+        }
+        sstr << c;
+    }
+    sstr << "\"";
+}
+
+WEAK float profiler_active_threads(uint64_t numerator, uint64_t denominator) {
+    return denominator ? (float)numerator / denominator : 0.0f;
+}
+
+// One JSON object per report, on a single line, so that a file of
+// appended reports is valid JSON Lines.
+WEAK void profiler_report_json(ProfilerReportSink &sink, halide_profiler_state *s) {
+    StringStreamPrinter<1024> sstr(nullptr);
+    sink.print("{\"pipelines\": [");
+    bool first_pipeline = true;
+    for (halide_profiler_pipeline_stats *p = s->pipelines; p;
+         p = (halide_profiler_pipeline_stats *)(p->next)) {
+        if (!p->runs) {
+            continue;
+        }
+        sstr.clear();
+        if (!first_pipeline) {
+            sstr << ", ";
+        }
+        first_pipeline = false;
+        sstr << "{\"name\": ";
+        print_quoted(sstr, p->name, '\\');
+        sstr << ", \"runs\": " << p->runs
+             << ", \"samples\": " << p->samples
+             << ", \"time_ns\": " << p->time
+             << ", \"memory_current\": " << p->memory_current
+             << ", \"memory_peak\": " << p->memory_peak
+             << ", \"memory_total\": " << p->memory_total
+             << ", \"num_allocs\": " << p->num_allocs
+             << ", \"active_threads\": " << profiler_active_threads(p->active_threads_numerator, p->active_threads_denominator)
+             << ", \"cycles\": " << p->cycles
+             << ", \"instructions\": " << p->instructions
+             << ", \"cache_misses\": " << p->cache_misses
+             << ", \"branch_misses\": " << p->branch_misses
+             << ", \"funcs\": [";
+        sink.print(sstr.str());
+        for (int i = 0; i < p->num_funcs; i++) {
+            halide_profiler_func_stats *fs = p->funcs + i;
+            sstr.clear();
+            if (i > 0) {
+                sstr << ", ";
+            }
+            sstr << "{\"name\": ";
+            print_quoted(sstr, fs->name, '\\');
+            sstr << ", \"time_ns\": " << fs->time
+                 << ", \"memory_current\": " << fs->memory_current
+                 << ", \"memory_peak\": " << fs->memory_peak
+                 << ", \"memory_total\": " << fs->memory_total
+                 << ", \"num_allocs\": " << fs->num_allocs
+                 << ", \"stack_peak\": " << fs->stack_peak
+                 << ", \"active_threads\": " << profiler_active_threads(fs->active_threads_numerator, fs->active_threads_denominator)
+                 << ", \"cycles\": " << fs->cycles
+                 << ", \"instructions\": " << fs->instructions
+                 << ", \"cache_misses\": " << fs->cache_misses
+                 << ", \"branch_misses\": " << fs->branch_misses
+                 << "}";
+            sink.print(sstr.str());
+        }
+        sink.print("]}");
+    }
+    sink.print("]}\n");
+}
+
+// One row per pipeline, with an empty func column, followed by a row
+// per func of that pipeline.
+WEAK void profiler_report_csv(ProfilerReportSink &sink, halide_profiler_state *s) {
+    StringStreamPrinter<1024> sstr(nullptr);
+    sink.print("pipeline,func,runs,samples,time_ns,memory_current,memory_peak,memory_total,"
+               "num_allocs,stack_peak,active_threads,cycles,instructions,cache_misses,branch_misses\n");
+    for (halide_profiler_pipeline_stats *p = s->pipelines; p;
+         p = (halide_profiler_pipeline_stats *)(p->next)) {
+        if (!p->runs) {
+            continue;
+        }
+        sstr.clear();
+        print_quoted(sstr, p->name, '"');
+        sstr << ",," << p->runs
+             << "," << p->samples
+             << "," << p->time
+             << "," << p->memory_current
+             << "," << p->memory_peak
+             << "," << p->memory_total
+             << "," << p->num_allocs
+             << ",0,"
+             << profiler_active_threads(p->active_threads_numerator, p->active_threads_denominator)
+             << "," << p->cycles
+             << "," << p->instructions
+             << "," << p->cache_misses
+             << "," << p->branch_misses << "\n";
+        sink.print(sstr.str());
+        for (int i = 0; i < p->num_funcs; i++) {
+            halide_profiler_func_stats *fs = p->funcs + i;
+            sstr.clear();
+            print_quoted(sstr, p->name, '"');
+            sstr << ",";
+            print_quoted(sstr, fs->name, '"');
+            sstr << "," << p->runs
+                 << ",,"
+                 << fs->time
+                 << "," << fs->memory_current
+                 << "," << fs->memory_peak
+                 << "," << fs->memory_total
+                 << "," << fs->num_allocs
+                 << "," << fs->stack_peak
+                 << "," << profiler_active_threads(fs->active_threads_numerator, fs->active_threads_denominator)
+                 << "," << fs->cycles
+                 << "," << fs->instructions
+                 << "," << fs->cache_misses
+                 << "," << fs->branch_misses << "\n";
+            sink.print(sstr.str());
+        }
+    }
+}
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
 extern "C" {
 // Returns the address of the pipeline state associated with pipeline_name.
 WEAK halide_profiler_pipeline_stats *halide_profiler_get_pipeline_state(const char *pipeline_name) {
@@ -225,6 +457,8 @@ WEAK int halide_profiler_pipeline_start(void *user_context,
         s->sampling_thread = (halide_thread *)1;
 #else
         halide_start_clock(user_context);
+        const char *counters = getenv("HL_PROFILER_COUNTERS");
+        profiler_counters_enabled = counters && atoi(counters) > 0;
         s->sampling_thread = halide_spawn_thread(sampling_profiler_thread, nullptr);
 #endif
     }
@@ -240,6 +474,14 @@ WEAK int halide_profiler_pipeline_start(void *user_context,
     return p->first_func_id;
 }
 
+// Returns where the calling thread should record the func it is
+// running, so that its hardware performance counters can be billed to
+// that func, or nullptr if counters aren't being gathered. Called on
+// each thread as it starts running a pipeline or a parallel task.
+WEAK int *halide_profiler_thread_func(halide_profiler_state *s) {
+    return profiler_counters_enabled ? halide_perf_counters_thread_func() : nullptr;
+}
+
 WEAK void halide_profiler_stack_peak_update(void *user_context,
                                             void *pipeline_state,
                                             uint64_t *f_values) {
@@ -330,8 +572,8 @@ WEAK void halide_profiler_memory_free(void *user_context,
     atomic_sub_fetch_sequentially_consistent(&f_stats->memory_current, decr);
 }
 
-WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_state *s) {
-    StringStreamPrinter<1024> sstr(user_context);
+WEAK void halide_profiler_report_text_unlocked(ProfilerReportSink &sink, halide_profiler_state *s) {
+    StringStreamPrinter<1024> sstr(nullptr);
 
     for (halide_profiler_pipeline_stats *p = s->pipelines; p;
          p = (halide_profiler_pipeline_stats *)(p->next)) {
@@ -352,7 +594,13 @@ WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_st
         }
         sstr << " heap allocations: " << p->num_allocs
              << "  peak heap usage: " << p->memory_peak << " bytes\n";
-        halide_print(user_context, sstr.str());
+        if (p->cycles) {
+            sstr << " cycles: " << p->cycles
+                 << "  instructions: " << p->instructions
+                 << "  LLC misses: " << p->cache_misses
+                 << "  branch misses: " << p->branch_misses << "\n";
+        }
+        sink.print(sstr.str());
 
         bool print_f_states = p->time || p->memory_total;
         if (!print_f_states) {
@@ -433,20 +681,54 @@ WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_st
                 if (fs->stack_peak > 0) {
                     sstr << " stack: " << fs->stack_peak;
                 }
+                if (fs->cycles) {
+                    // Instructions per cycle, and misses per thousand
+                    // instructions. A low IPC with many last-level cache
+                    // misses suggests a memory-bound Func.
+                    float kilo_instructions = fs->instructions / 1000.0f + 1e-10f;
+                    sstr << " ipc: " << (float)fs->instructions / fs->cycles;
+                    sstr.erase(4);
+                    sstr << " llc-mpki: " << fs->cache_misses / kilo_instructions;
+                    sstr.erase(4);
+                    sstr << " br-mpki: " << fs->branch_misses / kilo_instructions;
+                    sstr.erase(4);
+                }
                 sstr << "\n";
 
-                halide_print(user_context, sstr.str());
+                sink.print(sstr.str());
             }
         }
     }
 }
 
+WEAK void halide_profiler_report_as_unlocked(void *user_context, halide_profiler_state *s,
+                                             halide_profiler_report_format_t format) {
+    ProfilerReportSink sink(user_context);
+    if (format == halide_profiler_report_json) {
+        profiler_report_json(sink, s);
+    } else if (format == halide_profiler_report_csv) {
+        profiler_report_csv(sink, s);
+    } else {
+        halide_profiler_report_text_unlocked(sink, s);
+    }
+}
+
+WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_state *s) {
+    halide_profiler_report_as_unlocked(user_context, s, profiler_report_format_from_env());
+}
+
 WEAK void halide_profiler_report(void *user_context) {
     halide_profiler_state *s = halide_profiler_get_state();
     LockProfiler lock(s);
     halide_profiler_report_unlocked(user_context, s);
 }
 
+WEAK void halide_profiler_report_as(void *user_context, halide_profiler_report_format_t format) {
+    halide_profiler_state *s = halide_profiler_get_state();
+    LockProfiler lock(s);
+    halide_profiler_report_as_unlocked(user_context, s, format);
+}
+
 WEAK void halide_profiler_reset_unlocked(halide_profiler_state *s) {
     while (s->pipelines) {
         halide_profiler_pipeline_stats *p = s->pipelines;
@@ -490,6 +772,7 @@ halide_profiler_shutdown() {
     halide_join_thread(s->sampling_thread);
     s->sampling_thread = nullptr;
 #endif
+    halide_perf_counters_close();
 
     s->current_func = halide_profiler_outside_of_halide;
 
@@ -18,6 +18,22 @@ WEAK_INLINE int halide_profiler_set_current_func(halide_profiler_state *state, i
     return 0;
 }
 
+// Record the func the calling thread is running, for billing its
+// hardware performance counters. thread_func comes from
+// halide_profiler_thread_func, and is null unless counters are being
+// gathered. A negative func means the thread is idle.
+WEAK_INLINE int halide_profiler_set_thread_func(int pipeline, int func, int *thread_func) {
+    if (thread_func != nullptr) {
+        volatile int *ptr = thread_func;
+        // clang-format off
+        asm volatile ("":::);
+        *ptr = func < 0 ? func : pipeline + func;
+        asm volatile ("":::);
+        // clang-format on
+    }
+    return 0;
+}
+
 // Invariant: shared xor local, and both are either 0 or 1. 0 means acquired.
 WEAK_INLINE int halide_profiler_acquire_sampling_token(int32_t *shared, int32_t *local) {
     using namespace Halide::Runtime::Internal::Synchronization;
@@ -173,8 +173,52 @@ WEAK int halide_profiler_pipeline_start(void *user_context,
                                         const char *pipeline_name,
                                         int num_funcs,
                                         const uint64_t *func_names);
+WEAK int *halide_profiler_thread_func(struct halide_profiler_state *s);
 WEAK int halide_host_cpu_count();
 
+// NUMA support for the thread pool, provided by an OS-specific
+// module. Nodes are numbered densely from zero. On platforms without
+// NUMA support there is one node, and binding threads does nothing.
+// While local allocations are on, halide_numa_malloc serves large
+// allocations from fresh pages, which the OS places on the node of the
+// thread that first touches them; otherwise it returns nullptr, as it
+// always does on platforms without NUMA support. halide_numa_free
+// returns whether it freed ptr, i.e. whether halide_numa_malloc made it.
+WEAK int halide_numa_node_count();
+WEAK int halide_numa_current_node();
+WEAK int halide_numa_bind_current_thread(int node);
+WEAK void halide_numa_set_local_allocations(bool local);
+WEAK void *halide_numa_malloc(void *user_context, size_t size);
+WEAK bool halide_numa_free(void *user_context, void *ptr);
+
+// Hardware performance counters for the profiler, provided by an
+// OS-specific module. Counters are opened per thread, the first time
+// that thread calls halide_perf_counters_thread_func, and closed when
+// the thread exits. halide_perf_counters_thread_func returns where the
+// thread should store the id of the func it is running, or nullptr on
+// platforms without these counters. halide_perf_counters_sample stores
+// in deltas how far the cycle, instruction, last-level cache miss and
+// branch miss counters of the given thread slot (numbered from zero)
+// have advanced since the previous call, and in func what the slot's
+// thread is running, which is negative for unused slots. Returns false
+// once there are no more slots.
+WEAK int *halide_perf_counters_thread_func();
+WEAK bool halide_perf_counters_sample(int thread, int *func, uint64_t *deltas);
+WEAK void halide_perf_counters_close();
+
+// Map a whole file read-only into memory, provided by an OS-specific
+// module. Returns nullptr if the file can't be opened or mapped, or on
+// platforms without memory-mapped files.
+WEAK void *halide_map_file(void *user_context, const char *path, size_t *size);
+WEAK void halide_unmap_file(void *user_context, void *addr, size_t size);
+
+// Size-class pooling for halide_default_malloc/free, used when
+// halide_can_reuse_host_allocations() is true. halide_host_pool_malloc
+// returns nullptr if the allocation can't be pooled, and
+// halide_host_pool_free returns false if ptr didn't come from the pool.
+WEAK void *halide_host_pool_malloc(void *user_context, size_t size);
+WEAK bool halide_host_pool_free(void *user_context, void *ptr);
+
 WEAK int halide_device_and_host_malloc(void *user_context, struct halide_buffer_t *buf,
                                        const struct halide_device_interface_t *device_interface);
 WEAK int halide_device_and_host_free(void *user_context, struct halide_buffer_t *buf);
@@ -49,6 +49,9 @@ struct work {
     int next_semaphore;
     // which condition variable is the owner sleeping on. nullptr if it isn't sleeping.
     bool owner_is_sleeping;
+    // The NUMA node whose workers should prefer this job, or -1 if any
+    // thread may run it.
+    int numa_node;
 
     ALWAYS_INLINE bool make_runnable() {
         for (; next_semaphore < task.num_semaphores; next_semaphore++) {
@@ -69,6 +72,92 @@ struct work {
     ALWAYS_INLINE bool running() const {
         return task.extent || active_workers;
     }
+
+    // Simple independent loops can be split into ranges of iterations
+    // that are claimed by a single thread and then stolen from by idle
+    // threads. Jobs that need a minimum number of threads, must acquire
+    // semaphores, or must run serially are always scheduled through the
+    // shared job stack.
+    ALWAYS_INLINE bool stealable() const {
+        return !task.serial && task.min_threads == 0 && task.num_semaphores == 0 &&
+               task.schedule == halide_parallel_schedule_default;
+    }
+
+    // The number of iterations an idle thread should claim at once
+    // from a job that is not stealable. Serial jobs and jobs that must
+    // acquire semaphores for every iteration claim one at a time.
+    ALWAYS_INLINE int chunk_size(int threads) const {
+        int chunk = 1;
+        if (!task.serial && task.num_semaphores == 0) {
+            if (task.schedule == halide_parallel_schedule_dynamic) {
+                chunk = task.grain;
+            } else if (task.schedule == halide_parallel_schedule_guided) {
+                chunk = max((task.extent + threads - 1) / threads, task.grain);
+            }
+        }
+        return min(max(chunk, 1), task.extent);
+    }
+};
+
+// A contiguous range of iterations of a stealable job claimed by one
+// thread. The owning thread pops iterations off the front under the
+// deque's own lock, so it does not contend on the work queue mutex
+// while it has local work. Idle threads steal the back half of the
+// range. Deques live on the stack of the thread that owns them and are
+// linked into the work queue while they hold iterations.
+struct work_deque {
+    // Protects next and end.
+    halide_mutex mutex;
+
+    // The job the iterations belong to, and the half-open range of
+    // iterations not yet started.
+    work *job;
+    int next, end;
+
+    // Intrusive list of deques that may hold iterations. Protected by
+    // the work queue mutex.
+    work_deque *next_deque;
+
+    ALWAYS_INLINE bool pop(int *idx) {
+        halide_mutex_lock(&mutex);
+        bool result = next < end;
+        if (result) {
+            *idx = next++;
+        }
+        halide_mutex_unlock(&mutex);
+        return result;
+    }
+
+    ALWAYS_INLINE int remaining() {
+        halide_mutex_lock(&mutex);
+        int result = end - next;
+        halide_mutex_unlock(&mutex);
+        return result;
+    }
+
+    // Move the back half of the remaining iterations (rounding up) to
+    // the thief, which must not be visible to any other thread yet.
+    ALWAYS_INLINE bool steal_into(work_deque *thief) {
+        halide_mutex_lock(&mutex);
+        int count = end - next;
+        bool result = count > 0;
+        if (result) {
+            int stolen = (count + 1) / 2;
+            thief->job = job;
+            thief->next = end - stolen;
+            thief->end = end;
+            end -= stolen;
+        }
+        halide_mutex_unlock(&mutex);
+        return result;
+    }
+
+    // Drop all remaining iterations.
+    ALWAYS_INLINE void clear() {
+        halide_mutex_lock(&mutex);
+        end = next;
+        halide_mutex_unlock(&mutex);
+    }
 };
 
 ALWAYS_INLINE int clamp_num_threads(int threads) {
@@ -92,6 +181,14 @@ WEAK int default_desired_num_threads() {
                halide_host_cpu_count();
 }
 
+WEAK halide_numa_policy_t default_numa_policy() {
+    char *policy_str = getenv("HL_NUMA_POLICY");
+    if (policy_str && strcmp(policy_str, "local") == 0) {
+        return halide_numa_policy_local;
+    }
+    return halide_numa_policy_none;
+}
+
 // The work queue and thread pool is weak, so one big work queue is shared by all halide functions
 struct work_queue_t {
     // all fields are protected by this mutex.
@@ -100,6 +197,11 @@ struct work_queue_t {
     // The desired number threads doing work (HL_NUM_THREADS).
     int desired_threads_working;
 
+    // The NUMA policy (HL_NUMA_POLICY), and whether it was set
+    // explicitly via halide_set_numa_policy.
+    halide_numa_policy_t numa_policy;
+    bool numa_policy_set;
+
     // All fields after this must be zero in the initial state. See assert_zeroed
     // Field serves both to mark the offset in struct and as layout padding.
     int zero_marker;
@@ -107,9 +209,17 @@ struct work_queue_t {
     // Singly linked list for job stack
     work *jobs;
 
+    // Singly linked list of deques holding claimed iterations of
+    // stealable jobs.
+    work_deque *deques;
+
     // The number threads created
     int threads_created;
 
+    // The number of NUMA nodes that workers are spread across. Zero or
+    // one if the NUMA policy is off.
+    int numa_nodes;
+
     // Workers sleep on one of two condition variables, to make it
     // easier to wake up the right number if a small number of tasks
     // are enqueued. There are A-team workers and B-team workers. The
@@ -146,7 +256,8 @@ struct work_queue_t {
 
     // Used to check initial state is correct.
     ALWAYS_INLINE void assert_zeroed() const {
-        // Assert that all fields except the mutex and desired threads count are zeroed.
+        // Assert that all fields except the mutex, desired threads count,
+        // and NUMA policy are zeroed.
         const char *bytes = ((const char *)&this->zero_marker);
         const char *limit = ((const char *)this) + sizeof(work_queue_t);
         while (bytes < limit && *bytes == 0) {
@@ -158,7 +269,8 @@ struct work_queue_t {
     // Return the work queue to initial state. Must be called while locked
     // and queue will remain locked.
     ALWAYS_INLINE void reset() {
-        // Ensure all fields except the mutex and desired hreads count are zeroed.
+        // Ensure all fields except the mutex, desired threads count, and
+        // NUMA policy are zeroed.
         char *bytes = ((char *)&this->zero_marker);
         char *limit = ((char *)this) + sizeof(work_queue_t);
         memset(bytes, 0, limit - bytes);
@@ -200,12 +312,59 @@ WEAK void dump_job_state() {
 
 #endif
 
+WEAK void link_deque_already_locked(work_deque *deque) {
+    deque->next_deque = work_queue.deques;
+    work_queue.deques = deque;
+}
+
+WEAK void unlink_deque_already_locked(work_deque *deque) {
+    work_deque **prev_ptr = &work_queue.deques;
+    while (*prev_ptr != deque) {
+        prev_ptr = &(*prev_ptr)->next_deque;
+    }
+    *prev_ptr = deque->next_deque;
+    deque->next_deque = nullptr;
+    deque->job = nullptr;
+}
+
+// Find the deque with the most outstanding iterations and steal half
+// of them into the given (empty, unlinked) deque. If local_only is
+// true, only iterations that may run on the given NUMA node are
+// considered. Returns the job the iterations belong to, or nullptr if
+// there was nothing to steal.
+WEAK work *steal_work_already_locked(work_deque *thief, int numa_node, bool local_only) {
+    work_deque *victim = nullptr;
+    int most_remaining = 0;
+    for (work_deque *d = work_queue.deques; d != nullptr; d = d->next_deque) {
+        if (local_only && d->job->numa_node >= 0 && d->job->numa_node != numa_node) {
+            continue;
+        }
+        int r = d->remaining();
+        if (r > most_remaining) {
+            most_remaining = r;
+            victim = d;
+        }
+    }
+    if (victim && victim->steal_into(thief)) {
+        log_message("Stole " << thief->end - thief->next << " iterations of " << thief->job->task.name);
+        return thief->job;
+    }
+    return nullptr;
+}
+
 WEAK void worker_thread(void *);
 
 WEAK void worker_thread_already_locked(work *owned_job) {
     int spin_count = 0;
     const int max_spin_count = 40;
 
+    // Iterations of a stealable job claimed by this thread.
+    work_deque local = {};
+
+    // Workers are pinned to a node, so this can't change. An owner
+    // might migrate, but then it only loses some locality.
+    const int numa_node = work_queue.numa_nodes > 1 ? halide_numa_current_node() : -1;
+
     while (owned_job ? owned_job->running() : !work_queue.shutdown) {
         work *job = work_queue.jobs;
         work **prev_ptr = &work_queue.jobs;
@@ -233,6 +392,11 @@ WEAK void worker_thread_already_locked(work *owned_job) {
 
         dump_job_state();
 
+        // A runnable job whose iterations belong to some other NUMA
+        // node. Only used if there's nothing better to do.
+        work *remote_job = nullptr;
+        work **remote_prev_ptr = nullptr;
+
         // Find a job to run, prefering things near the top of the stack.
         while (job) {
             print_job(job, "", "Considering job ");
@@ -270,7 +434,13 @@ WEAK void worker_thread_already_locked(work *owned_job) {
             }
 
             if (enough_threads && can_use_this_thread_stack && can_add_worker) {
-                if (job->make_runnable()) {
+                if (job->numa_node >= 0 && job->numa_node != numa_node) {
+                    // NUMA jobs are stealable, so they're always runnable.
+                    if (!remote_job) {
+                        remote_job = job;
+                        remote_prev_ptr = prev_ptr;
+                    }
+                } else if (job->make_runnable()) {
                     break;
                 } else {
                     log_message("Cannot acquire semaphores for " << job->task.name);
@@ -280,6 +450,23 @@ WEAK void worker_thread_already_locked(work *owned_job) {
             job = job->next_job;
         }
 
+        bool stolen = false;
+        if (!job) {
+            // Nothing on the job stack for this node. Try to steal
+            // iterations another thread has claimed but not yet
+            // started. Failing that, claim iterations that belong to
+            // another node, and only then steal them.
+            job = steal_work_already_locked(&local, numa_node, true);
+            stolen = (job != nullptr);
+            if (!job && remote_job) {
+                job = remote_job;
+                prev_ptr = remote_prev_ptr;
+            } else if (!job && work_queue.numa_nodes > 1) {
+                job = steal_work_already_locked(&local, numa_node, false);
+                stolen = (job != nullptr);
+            }
+        }
+
         if (!job) {
             // There is no runnable job. Go to sleep.
             if (owned_job) {
@@ -371,11 +558,60 @@ WEAK void worker_thread_already_locked(work *owned_job) {
                 job->next_job = work_queue.jobs;
                 work_queue.jobs = job;
             }
+        } else if (job->stealable()) {
+            if (!stolen) {
+                // Claim this thread's share of the remaining
+                // iterations. Idle threads will steal some back if
+                // this thread falls behind.
+                int threads = work_queue.threads_created + 1;
+                if (job->numa_node >= 0) {
+                    threads = max(threads / work_queue.numa_nodes, 1);
+                }
+                int chunk = (job->task.extent + threads - 1) / threads;
+                local.job = job;
+                local.next = job->task.min;
+                local.end = job->task.min + chunk;
+                job->task.min += chunk;
+                job->task.extent -= chunk;
+
+                // If there were no more tasks pending for this job,
+                // remove it from the stack.
+                if (job->task.extent == 0) {
+                    *prev_ptr = job->next_job;
+                }
+            }
+            link_deque_already_locked(&local);
+
+            // Release the lock and work through the local range.
+            halide_mutex_unlock(&work_queue.mutex);
+            int idx;
+            while (result == halide_error_code_success && local.pop(&idx)) {
+                if (job->task_fn) {
+                    result = halide_do_task(job->user_context, job->task_fn,
+                                            idx, job->task.closure);
+                } else {
+                    result = halide_do_loop_task(job->user_context, job->task.fn,
+                                                 idx, 1, job->task.closure, job);
+                }
+            }
+            halide_mutex_lock(&work_queue.mutex);
+
+            unlink_deque_already_locked(&local);
+
+            if (result != halide_error_code_success) {
+                // Nobody should start any more iterations of this job.
+                for (work_deque *d = work_queue.deques; d != nullptr; d = d->next_deque) {
+                    if (d->job == job) {
+                        d->clear();
+                    }
+                }
+            }
         } else {
-            // Claim a task from it.
+            // Claim a task, or a chunk of iterations, from it.
+            int iters = job->task_fn ? 1 : job->chunk_size(work_queue.threads_created + 1);
             work myjob = *job;
-            job->task.min++;
-            job->task.extent--;
+            job->task.min += iters;
+            job->task.extent -= iters;
 
             // If there were no more tasks pending for this job, remove it
             // from the stack.
@@ -390,7 +626,7 @@ WEAK void worker_thread_already_locked(work *owned_job) {
                                         myjob.task.min, myjob.task.closure);
             } else {
                 result = halide_do_loop_task(myjob.user_context, myjob.task.fn,
-                                             myjob.task.min, 1,
+                                             myjob.task.min, iters,
                                              myjob.task.closure, job);
             }
             halide_mutex_lock(&work_queue.mutex);
@@ -443,7 +679,14 @@ WEAK void worker_thread(void *arg) {
     halide_mutex_unlock(&work_queue.mutex);
 }
 
-WEAK void enqueue_work_already_locked(int num_jobs, work *jobs, work *task_parent) {
+// Entrypoint for workers when the NUMA policy is on. The argument is
+// the node to pin the worker to.
+WEAK void numa_worker_thread(void *arg) {
+    halide_numa_bind_current_thread((int)(intptr_t)arg);
+    worker_thread(nullptr);
+}
+
+WEAK void initialize_work_queue_already_locked() {
     if (!work_queue.initialized) {
         work_queue.assert_zeroed();
 
@@ -454,8 +697,20 @@ WEAK void enqueue_work_already_locked(int num_jobs, work *jobs, work *task_paren
             work_queue.desired_threads_working = default_desired_num_threads();
         }
         work_queue.desired_threads_working = clamp_num_threads(work_queue.desired_threads_working);
+
+        if (!work_queue.numa_policy_set) {
+            work_queue.numa_policy = default_numa_policy();
+        }
+        if (work_queue.numa_policy == halide_numa_policy_local) {
+            work_queue.numa_nodes = halide_numa_node_count();
+        }
+        halide_numa_set_local_allocations(work_queue.numa_nodes > 1);
         work_queue.initialized = true;
     }
+}
+
+WEAK void enqueue_work_already_locked(int num_jobs, work *jobs, work *task_parent) {
+    initialize_work_queue_already_locked();
 
     // Gather some information about the work.
 
@@ -513,8 +768,14 @@ WEAK void enqueue_work_already_locked(int num_jobs, work *jobs, work *task_paren
             // We might need to make some new threads, if work_queue.desired_threads_working has
             // increased, or if there aren't enough threads to complete this new task.
             work_queue.a_team_size++;
-            work_queue.threads[work_queue.threads_created++] =
-                halide_spawn_thread(worker_thread, nullptr);
+            if (work_queue.numa_nodes > 1) {
+                int node = work_queue.threads_created % work_queue.numa_nodes;
+                work_queue.threads[work_queue.threads_created++] =
+                    halide_spawn_thread(numa_worker_thread, (void *)(intptr_t)node);
+            } else {
+                work_queue.threads[work_queue.threads_created++] =
+                    halide_spawn_thread(worker_thread, nullptr);
+            }
         }
         log_message("enqueue_work_already_locked top level job " << jobs[0].task.name << " with min_threads " << min_threads << " work_queue.threads_created " << work_queue.threads_created << " work_queue.threads_reserved " << work_queue.threads_reserved);
         if (job_has_acquires || job_may_block) {
@@ -610,30 +871,54 @@ WEAK int halide_default_do_par_for(void *user_context, halide_task_t f,
         return halide_error_code_success;
     }
 
-    work job;
-    job.task.fn = nullptr;
-    job.task.min = min;
-    job.task.extent = size;
-    job.task.serial = false;
-    job.task.semaphores = nullptr;
-    job.task.num_semaphores = 0;
-    job.task.closure = closure;
-    job.task.min_threads = 0;
-    job.task.name = nullptr;
-    job.task_fn = f;
-    job.user_context = user_context;
-    job.exit_status = halide_error_code_success;
-    job.active_workers = 0;
-    job.next_semaphore = 0;
-    job.owner_is_sleeping = false;
-    job.siblings = &job;  // guarantees no other job points to the same siblings.
-    job.sibling_count = 0;
-    job.parent_job = nullptr;
     halide_mutex_lock(&work_queue.mutex);
-    enqueue_work_already_locked(1, &job, nullptr);
-    worker_thread_already_locked(&job);
+    initialize_work_queue_already_locked();
+
+    // Under a NUMA policy, split the loop into one contiguous slice
+    // per node. The slices always land on the same nodes, so
+    // successive loops over the same range touch the same memory from
+    // the same node.
+    int num_jobs = 1;
+    if (work_queue.numa_nodes > 1) {
+        num_jobs = work_queue.numa_nodes < size ? work_queue.numa_nodes : size;
+    }
+
+    work *jobs = (work *)__builtin_alloca(sizeof(work) * num_jobs);
+    for (int i = 0; i < num_jobs; i++) {
+        int slice_begin = (int)(((int64_t)size * i) / num_jobs);
+        int slice_end = (int)(((int64_t)size * (i + 1)) / num_jobs);
+        work &job = jobs[i];
+        job.task.fn = nullptr;
+        job.task.min = min + slice_begin;
+        job.task.extent = slice_end - slice_begin;
+        job.task.serial = false;
+        job.task.schedule = halide_parallel_schedule_default;
+        job.task.grain = 1;
+        job.task.semaphores = nullptr;
+        job.task.num_semaphores = 0;
+        job.task.closure = closure;
+        job.task.min_threads = 0;
+        job.task.name = nullptr;
+        job.task_fn = f;
+        job.user_context = user_context;
+        job.exit_status = halide_error_code_success;
+        job.active_workers = 0;
+        job.next_semaphore = 0;
+        job.owner_is_sleeping = false;
+        job.numa_node = num_jobs > 1 ? i : -1;
+        job.parent_job = nullptr;
+    }
+
+    enqueue_work_already_locked(num_jobs, jobs, nullptr);
+    int exit_status = halide_error_code_success;
+    for (int i = 0; i < num_jobs; i++) {
+        worker_thread_already_locked(jobs + i);
+        if (jobs[i].exit_status != halide_error_code_success) {
+            exit_status = jobs[i].exit_status;
+        }
+    }
     halide_mutex_unlock(&work_queue.mutex);
-    return job.exit_status;
+    return exit_status;
 }
 
 WEAK int halide_default_do_parallel_tasks(void *user_context, int num_tasks,
@@ -654,6 +939,7 @@ WEAK int halide_default_do_parallel_tasks(void *user_context, int num_tasks,
         jobs[i].active_workers = 0;
         jobs[i].next_semaphore = 0;
         jobs[i].owner_is_sleeping = false;
+        jobs[i].numa_node = -1;
         jobs[i].parent_job = (work *)task_parent;
     }
 
@@ -693,6 +979,15 @@ WEAK int halide_set_num_threads(int n) {
     return old;
 }
 
+WEAK halide_numa_policy_t halide_set_numa_policy(halide_numa_policy_t policy) {
+    halide_mutex_lock(&work_queue.mutex);
+    halide_numa_policy_t old = work_queue.numa_policy_set ? work_queue.numa_policy : default_numa_policy();
+    work_queue.numa_policy = policy;
+    work_queue.numa_policy_set = true;
+    halide_mutex_unlock(&work_queue.mutex);
+    return old;
+}
+
 WEAK void halide_shutdown_thread_pool() {
     if (work_queue.initialized) {
         // Wake everyone up and tell them the party's over and it's time
@@ -169,6 +169,377 @@ WEAK ScopedSpinLock::AtomicFlag halide_trace_file_lock = 0;
 WEAK bool halide_trace_file_initialized = false;
 WEAK void *halide_trace_file_internally_opened = nullptr;
 
+// In ring-buffer mode (HL_TRACE_MODE=ring), events are not packed into
+// the shared TraceBuffer above. Instead each thread claims one of a
+// fixed set of slots with a single uncontended exchange, and appends a
+// delta-compressed record to that slot's current chunk. Full chunks are
+// handed to a background thread that writes them to the trace file, so
+// the only lock, which guards the queue of chunks, is taken once per
+// chunk rather than once per event. Loads and stores can optionally be
+// sampled (HL_TRACE_SAMPLE=n keeps one in every n per slot); all other
+// events are always recorded.
+//
+// The stream is a sequence of chunks. Each chunk is a header of four
+// uint32_t values:
+//
+//   magic, payload size in bytes, number of records, sample rate
+//
+// followed by the records. Within a record, integers are LEB128
+// varints, and signed ones are zigzag-encoded first:
+//
+//   id              signed delta from the previous record's id
+//   event, type.code, type.bits
+//                   one byte each
+//   type.lanes, value_index, dimensions
+//   parent_id       signed delta from this record's id
+//   coordinates     each a signed delta from the same coordinate of
+//                   the previous record (from zero beyond the first
+//                   trace_ring_delta_coords)
+//   value           type.lanes * type.bytes() raw bytes
+//   func            zero if the same as the previous record, otherwise
+//                   the length plus one, followed by the characters
+//   trace_tag       the length, followed by the characters
+//
+// The delta state resets at the start of every chunk, so chunks can be
+// decoded independently. Events from one thread appear in order, but
+// chunks from different slots are interleaved in the order they fill
+// up. The magic has its low bit set, so it can't be mistaken for the
+// size of an ordinary packet, which is always a multiple of four; the
+// reader in util/HalideTraceUtils.cpp accepts either.
+const static uint32_t trace_chunk_magic = 0x544c487f;  // "\x7fHLT"
+const static uint32_t trace_chunk_header_bytes = 4 * sizeof(uint32_t);
+const static uint32_t trace_chunk_bytes = 64 * 1024;
+const static int trace_ring_slots = 64;
+const static int trace_ring_delta_coords = 16;
+
+// Writers wait for the background thread rather than allocate more
+// chunks than this.
+const static int max_trace_chunks = 4 * trace_ring_slots;
+
+struct TraceChunk {
+    TraceChunk *next;
+    uint32_t cursor, records;
+    uint8_t data[trace_chunk_bytes];
+};
+
+struct TraceRing {
+    uint32_t busy;
+    uint32_t sample_counter;
+    TraceChunk *chunk;
+
+    // The previous record in the current chunk. The previous func name
+    // is the copy most recently written into the chunk, which stays valid
+    // for as long as the chunk does, unlike the event's own pointer.
+    int32_t last_id;
+    uint32_t last_func_offset, last_func_bytes;
+    int32_t last_coords[trace_ring_delta_coords];
+};
+
+struct TraceRingState {
+    TraceRing rings[trace_ring_slots];
+
+    // Protects everything below.
+    halide_mutex lock;
+    halide_cond chunk_queued, chunk_freed;
+    TraceChunk *queue_head, *queue_tail, *free_chunks;
+    int allocated_chunks;
+    bool shutdown;
+
+    // Null if threads are unavailable, in which case chunks are written
+    // synchronously by whoever fills them.
+    halide_thread *flusher;
+
+    uint32_t sample_rate;
+};
+
+WEAK TraceRingState *halide_trace_ring = nullptr;
+WEAK uint32_t halide_trace_ring_checked = 0;
+
+ALWAYS_INLINE uint8_t *put_varint(uint8_t *dst, uint32_t value) {
+    while (value >= 0x80) {
+        *dst++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *dst++ = (uint8_t)value;
+    return dst;
+}
+
+ALWAYS_INLINE uint8_t *put_signed_varint(uint8_t *dst, uint32_t value) {
+    return put_varint(dst, (value << 1) ^ (uint32_t)((int32_t)value >> 31));
+}
+
+WEAK void write_trace_chunk(TraceRingState *s, TraceChunk *c) {
+    // Chunks can be decoded independently, so each goes to whatever the
+    // trace file is when it's written, even if halide_set_trace_file has
+    // been called since its records were made.
+    int fd = halide_get_trace_file(nullptr);
+    if (fd <= 0) {
+        return;
+    }
+    uint32_t header[] = {trace_chunk_magic, c->cursor - trace_chunk_header_bytes, c->records, s->sample_rate};
+    memcpy(c->data, header, sizeof(header));
+    bool success = (c->cursor == (uint32_t)write(fd, c->data, c->cursor));
+    halide_abort_if_false(nullptr, success && "Could not write to trace file");
+}
+
+WEAK void trace_ring_flusher(void *) {
+    TraceRingState *s = halide_trace_ring;
+    halide_mutex_lock(&s->lock);
+    while (true) {
+        while (!s->queue_head && !s->shutdown) {
+            halide_cond_wait(&s->chunk_queued, &s->lock);
+        }
+        TraceChunk *c = s->queue_head;
+        if (!c) {
+            break;
+        }
+        s->queue_head = c->next;
+        if (!s->queue_head) {
+            s->queue_tail = nullptr;
+        }
+        // There's only one flusher, so chunks are written in the order
+        // they were queued even though the lock is dropped here.
+        halide_mutex_unlock(&s->lock);
+        write_trace_chunk(s, c);
+        halide_mutex_lock(&s->lock);
+        c->next = s->free_chunks;
+        s->free_chunks = c;
+        halide_cond_broadcast(&s->chunk_freed);
+    }
+    halide_mutex_unlock(&s->lock);
+}
+
+// Hand a slot's chunk to the flusher. The caller must hold the slot.
+WEAK void retire_trace_chunk(TraceRingState *s, TraceRing *r) {
+    TraceChunk *c = r->chunk;
+    if (!c || !c->records) {
+        return;
+    }
+    r->chunk = nullptr;
+    c->next = nullptr;
+    halide_mutex_lock(&s->lock);
+    if (s->flusher) {
+        if (s->queue_tail) {
+            s->queue_tail->next = c;
+        } else {
+            s->queue_head = c;
+        }
+        s->queue_tail = c;
+        halide_cond_signal(&s->chunk_queued);
+    } else {
+        write_trace_chunk(s, c);
+        c->next = s->free_chunks;
+        s->free_chunks = c;
+    }
+    halide_mutex_unlock(&s->lock);
+}
+
+// Give a slot an empty chunk. The caller must hold the slot.
+WEAK void acquire_trace_chunk(void *user_context, TraceRingState *s, TraceRing *r) {
+    halide_mutex_lock(&s->lock);
+    while (!s->free_chunks && s->allocated_chunks >= max_trace_chunks && s->flusher) {
+        halide_cond_wait(&s->chunk_freed, &s->lock);
+    }
+    TraceChunk *c = s->free_chunks;
+    if (c) {
+        s->free_chunks = c->next;
+    } else {
+        c = (TraceChunk *)malloc(sizeof(TraceChunk));
+        s->allocated_chunks++;
+    }
+    halide_mutex_unlock(&s->lock);
+    halide_abort_if_false(user_context, c && "Could not allocate trace chunk");
+
+    c->next = nullptr;
+    c->cursor = trace_chunk_header_bytes;
+    c->records = 0;
+    r->chunk = c;
+    r->last_id = 0;
+    r->last_func_offset = 0;
+    r->last_func_bytes = 0;
+    memset(r->last_coords, 0, sizeof(r->last_coords));
+}
+
+ALWAYS_INLINE TraceRing *claim_trace_ring(TraceRingState *s) {
+    using namespace Halide::Runtime::Internal::Synchronization;
+
+    // Threads run on disjoint stacks, so the address of a local spreads
+    // them over the slots without needing thread-local storage, and
+    // tends to give a thread the same slot every time.
+    int stack_marker = 0;
+    uint32_t idx = ((uint32_t)((uintptr_t)&stack_marker >> 16) * 0x9e3779b1U) >> 26;
+    static_assert(trace_ring_slots == 64, "Slot hash assumes 64 slots");
+    while (true) {
+        TraceRing *r = s->rings + idx;
+        if (atomic_exchange_acquire(&r->busy, (uint32_t)1) == 0) {
+            return r;
+        }
+        idx = (idx + 1) & (trace_ring_slots - 1);
+    }
+}
+
+ALWAYS_INLINE void release_trace_ring(TraceRing *r) {
+    using namespace Halide::Runtime::Internal::Synchronization;
+
+    uint32_t zero = 0;
+    atomic_store_release(&r->busy, &zero);
+}
+
+// Queue the partially-filled chunks of every slot not currently in use
+// (or of every slot, if wait is true).
+WEAK void flush_trace_rings(TraceRingState *s, bool wait) {
+    using namespace Halide::Runtime::Internal::Synchronization;
+
+    for (int i = 0; i < trace_ring_slots; i++) {
+        TraceRing *r = s->rings + i;
+        while (atomic_exchange_acquire(&r->busy, (uint32_t)1) != 0) {
+            if (!wait) {
+                r = nullptr;
+                break;
+            }
+        }
+        if (r) {
+            retire_trace_chunk(s, r);
+            release_trace_ring(r);
+        }
+    }
+}
+
+WEAK void record_trace_event(void *user_context, TraceRingState *s, const halide_trace_event_t *e, int32_t id) {
+    TraceRing *r = claim_trace_ring(s);
+
+    if (s->sample_rate > 1 &&
+        (e->event == halide_trace_load || e->event == halide_trace_store) &&
+        (r->sample_counter++ % s->sample_rate) != 0) {
+        release_trace_ring(r);
+        return;
+    }
+
+    // An upper bound on the encoded size of the record.
+    uint32_t value_bytes = (uint32_t)(e->type.lanes * e->type.bytes());
+    uint32_t name_bytes = strlen(e->func);
+    uint32_t trace_tag_bytes = e->trace_tag ? strlen(e->trace_tag) : 0;
+    uint32_t max_size = 3 + 7 * 5 + e->dimensions * 5 + value_bytes + name_bytes + trace_tag_bytes;
+    halide_abort_if_false(user_context, max_size <= trace_chunk_bytes - trace_chunk_header_bytes && "Trace event too large");
+
+    if (r->chunk && r->chunk->cursor + max_size > trace_chunk_bytes) {
+        retire_trace_chunk(s, r);
+    }
+    if (!r->chunk) {
+        acquire_trace_chunk(user_context, s, r);
+    }
+
+    TraceChunk *c = r->chunk;
+    uint8_t *dst = c->data + c->cursor;
+    dst = put_signed_varint(dst, (uint32_t)id - (uint32_t)r->last_id);
+    r->last_id = id;
+    *dst++ = (uint8_t)e->event;
+    *dst++ = e->type.code;
+    *dst++ = e->type.bits;
+    dst = put_varint(dst, e->type.lanes);
+    dst = put_varint(dst, (uint32_t)e->value_index);
+    dst = put_varint(dst, (uint32_t)e->dimensions);
+    dst = put_signed_varint(dst, (uint32_t)e->parent_id - (uint32_t)id);
+    for (int i = 0; i < e->dimensions; i++) {
+        int32_t coord = e->coordinates ? e->coordinates[i] : 0;
+        if (i < trace_ring_delta_coords) {
+            dst = put_signed_varint(dst, (uint32_t)coord - (uint32_t)r->last_coords[i]);
+            r->last_coords[i] = coord;
+        } else {
+            dst = put_signed_varint(dst, (uint32_t)coord);
+        }
+    }
+    if (e->value) {
+        memcpy(dst, e->value, value_bytes);
+    } else {
+        memset(dst, 0, value_bytes);
+    }
+    dst += value_bytes;
+    if (r->last_func_offset &&
+        name_bytes == r->last_func_bytes &&
+        memcmp(c->data + r->last_func_offset, e->func, name_bytes) == 0) {
+        dst = put_varint(dst, 0);
+    } else {
+        dst = put_varint(dst, name_bytes + 1);
+        memcpy(dst, e->func, name_bytes);
+        r->last_func_offset = (uint32_t)(dst - c->data);
+        r->last_func_bytes = name_bytes;
+        dst += name_bytes;
+    }
+    dst = put_varint(dst, trace_tag_bytes);
+    if (trace_tag_bytes) {
+        memcpy(dst, e->trace_tag, trace_tag_bytes);
+        dst += trace_tag_bytes;
+    }
+    c->cursor = (uint32_t)(dst - c->data);
+    c->records++;
+
+    release_trace_ring(r);
+
+    // Make sure the end of a pipeline reaches the file reasonably
+    // promptly, without waiting for any thread that is still tracing.
+    if (e->event == halide_trace_end_pipeline) {
+        flush_trace_rings(s, false);
+    }
+}
+
+// Returns the ring-buffer state if HL_TRACE_MODE selects it, creating
+// it on first use, and nullptr otherwise.
+WEAK TraceRingState *get_trace_ring() {
+    using namespace Halide::Runtime::Internal::Synchronization;
+
+    uint32_t checked = 0;
+    atomic_load_acquire(&halide_trace_ring_checked, &checked);
+    if (checked) {
+        return halide_trace_ring;
+    }
+
+    ScopedSpinLock lock(&halide_trace_file_lock);
+    if (!halide_trace_ring_checked) {
+        const char *mode = getenv("HL_TRACE_MODE");
+        if (mode && strcmp(mode, "ring") == 0) {
+            TraceRingState *s = (TraceRingState *)malloc(sizeof(TraceRingState));
+            halide_abort_if_false(nullptr, s && "Could not allocate trace ring buffers");
+            memset(s, 0, sizeof(TraceRingState));
+            s->sample_rate = 1;
+            const char *sample = getenv("HL_TRACE_SAMPLE");
+            if (sample && atoi(sample) > 1) {
+                s->sample_rate = (uint32_t)atoi(sample);
+            }
+            halide_trace_ring = s;
+            s->flusher = halide_spawn_thread(trace_ring_flusher, nullptr);
+        }
+        uint32_t one = 1;
+        atomic_store_release(&halide_trace_ring_checked, &one);
+    }
+    return halide_trace_ring;
+}
+
+// Write out everything still buffered, stop the flusher, and release
+// the ring-buffer state.
+WEAK void shutdown_trace_ring() {
+    TraceRingState *s = halide_trace_ring;
+    if (!s) {
+        return;
+    }
+    flush_trace_rings(s, true);
+    halide_mutex_lock(&s->lock);
+    s->shutdown = true;
+    halide_cond_broadcast(&s->chunk_queued);
+    halide_mutex_unlock(&s->lock);
+    if (s->flusher) {
+        halide_join_thread(s->flusher);
+    }
+    while (s->free_chunks) {
+        TraceChunk *c = s->free_chunks;
+        s->free_chunks = c->next;
+        free(c);
+    }
+    free(s);
+    halide_trace_ring = nullptr;
+    halide_trace_ring_checked = 0;
+}
+
 }  // namespace Internal
 }  // namespace Runtime
 }  // namespace Halide
@@ -184,7 +555,10 @@ WEAK int32_t halide_default_trace(void *user_context, const halide_trace_event_t
 
     // If we're dumping to a file, use a binary format
     int fd = halide_get_trace_file(user_context);
-    if (fd > 0) {
+    TraceRingState *ring = fd > 0 ? get_trace_ring() : nullptr;
+    if (ring) {
+        record_trace_event(user_context, ring, e, my_id);
+    } else if (fd > 0) {
         // Compute the total packet size
         uint32_t value_bytes = (uint32_t)(e->type.lanes * e->type.bytes());
         uint32_t header_bytes = (uint32_t)sizeof(halide_trace_packet_t);
@@ -387,6 +761,7 @@ WEAK int32_t halide_trace(void *user_context, const halide_trace_event_t *e) {
 }
 
 WEAK int halide_shutdown_trace() {
+    shutdown_trace_ring();
     if (halide_trace_file_internally_opened) {
         int ret = fclose(halide_trace_file_internally_opened);
         halide_trace_file = 0;
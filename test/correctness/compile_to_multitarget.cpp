@@ -222,6 +222,76 @@ void test_compile_to_everything(Func j, bool do_object) {
     }
 }
 
+std::vector<char> read_file(const std::string &path) {
+    std::vector<char> data;
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) {
+        return data;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        data.insert(data.end(), buf, buf + n);
+    }
+    fclose(f);
+    return data;
+}
+
+void test_parallel_compile_is_deterministic(Func j) {
+    const char *o = get_host_target().os == Target::Windows ? ".obj" : ".o";
+
+    std::vector<std::string> target_strings = {
+        "host-profile-no_bounds_query",
+        "host-no_asserts",
+        "host-profile",
+        "host",
+    };
+
+    std::vector<Target> targets;
+    for (auto s : target_strings) {
+        targets.emplace_back(s);
+    }
+
+    auto args = j.infer_arguments();
+    auto module_producer = [&j, &args](const std::string &name, const Target &target) -> Module {
+        // Lower directly rather than through j.compile_to_module(), which
+        // caches the Module in j and so can't be called concurrently.
+        return Internal::lower({j.function()}, name, target, args, LinkageType::ExternalPlusMetadata);
+    };
+
+    // Compile with one thread, then with several, starting each time
+    // from the same unique_name counters, as two runs of a Generator
+    // would.
+    const Internal::UniqueNameCounters initial_counters;
+    std::vector<std::string> prefixes;
+    for (int num_threads : {1, 4}) {
+        std::string filename_prefix = get_output_path_prefix("c7_" + std::to_string(num_threads));
+        prefixes.push_back(filename_prefix);
+        std::map<OutputFileType, std::string> outputs = {
+            {OutputFileType::c_header, filename_prefix + ".h"},
+            {OutputFileType::object, filename_prefix + o},
+        };
+        Internal::UniqueNameCounters counters = initial_counters;
+        Internal::ScopedUniqueNameCounters scoped_counters(counters);
+        compile_multitarget("c7", outputs, targets, target_strings, module_producer, nullptr, num_threads);
+    }
+
+    std::vector<std::string> suffixes = {"_runtime", "_wrapper"};
+    for (const auto &s : target_strings) {
+        suffixes.push_back("-" + s);
+    }
+    for (const auto &suffix : suffixes) {
+        std::string serial = prefixes[0] + suffix + o;
+        std::string parallel = prefixes[1] + suffix + o;
+        Internal::assert_file_exists(serial);
+        Internal::assert_file_exists(parallel);
+        if (read_file(serial) != read_file(parallel)) {
+            printf("%s and %s differ\n", serial.c_str(), parallel.c_str());
+            exit(1);
+        }
+    }
+}
+
 int main(int argc, char **argv) {
     Param<float> factor("factor");
     Func f, g, h, j;
@@ -242,6 +312,13 @@ int main(int argc, char **argv) {
     test_compile_to_everything(j, /*do_object*/ true);
     test_compile_to_everything(j, /*do_object*/ false);
 
+    // Parallel loops make closures with generated names, which appear
+    // in the object files.
+    Func k;
+    k(x, y) = j(x, y) + 1;
+    k.parallel(y).vectorize(x, 8);
+    test_parallel_compile_is_deterministic(k);
+
     printf("Success!\n");
     return 0;
 }
@@ -0,0 +1,113 @@
+#include "Halide.h"
+#include "halide_test_dirs.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Halide;
+
+// The key-value pairs of one entry in the "compilation_passes" list of
+// a JSONCompilerLogger report, with strings unquoted.
+typedef std::map<std::string, std::string> Entry;
+
+std::vector<Entry> parse_passes(const std::string &json) {
+    std::vector<Entry> entries;
+    std::istringstream in(json.substr(json.find("\"compilation_passes\"")));
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        size_t start = line.find_first_not_of(' ');
+        if (start == std::string::npos || line[start] == ']') {
+            break;
+        } else if (line[start] == '{') {
+            entries.emplace_back();
+        } else if (line[start] == '"') {
+            size_t key_end = line.find('"', start + 1);
+            std::string value = line.substr(line.find(" : ", key_end) + 3);
+            if (value.back() == ',') {
+                value.pop_back();
+            }
+            if (value.front() == '"') {
+                value = value.substr(1, value.size() - 2);
+            }
+            entries.back()[line.substr(start + 1, key_end - start - 1)] = value;
+        }
+    }
+    return entries;
+}
+
+const Entry *find_pass(const std::vector<Entry> &entries, const std::string &phase, const std::string &name) {
+    for (const auto &e : entries) {
+        if (e.at("phase") == phase && e.at("name") == name) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_host_target();
+
+    Var x("x"), y("y");
+    Func blur_x("blur_x"), blur_y("blur_y");
+    ImageParam input(Float(32), 2, "input");
+    blur_x(x, y) = input(x, y) + input(x + 1, y) + input(x + 2, y);
+    blur_y(x, y) = blur_x(x, y) + blur_x(x, y + 1) + blur_x(x, y + 2);
+    blur_y.split(y, y, y, 8).parallel(y).vectorize(x, 8);
+    blur_x.compute_at(blur_y, y).vectorize(x, 8);
+
+    Internal::set_compiler_logger(std::make_unique<Internal::JSONCompilerLogger>(
+        "generator_name", "blur", "", target, "", false));
+    const std::string o = target.os == Target::Windows ? ".obj" : ".o";
+    blur_y.compile_to_object(Internal::get_test_tmp_dir() + "compiler_logger_passes" + o, {input}, "blur", target);
+
+    std::ostringstream report;
+    Internal::get_compiler_logger()->emit_to_stream(report);
+    Internal::set_compiler_logger(nullptr);
+
+    std::vector<Entry> entries = parse_passes(report.str());
+    if (entries.empty()) {
+        printf("No passes in compiler log:\n%s\n", report.str().c_str());
+        return 1;
+    }
+
+    // Sorted by time, most expensive first.
+    for (size_t i = 1; i < entries.size(); i++) {
+        if (std::atof(entries[i].at("time").c_str()) > std::atof(entries[i - 1].at("time").c_str())) {
+            printf("Passes are not sorted by time:\n%s\n", report.str().c_str());
+            return 1;
+        }
+    }
+
+    const Entry *loop_nests = find_pass(entries, "halide_lowering", "creating initial loop nests");
+    const Entry *flattening = find_pass(entries, "halide_lowering", "storage flattening");
+    if (!loop_nests || !flattening) {
+        printf("Missing lowering passes in compiler log:\n%s\n", report.str().c_str());
+        return 1;
+    }
+    if (std::atoi(loop_nests->at("order").c_str()) >= std::atoi(flattening->at("order").c_str())) {
+        printf("Lowering passes are out of order:\n%s\n", report.str().c_str());
+        return 1;
+    }
+    if (loop_nests->at("ir_nodes_before") != "0" ||
+        std::atoi(loop_nests->at("ir_nodes_after").c_str()) <= 0 ||
+        std::atoi(flattening->at("ir_nodes_after").c_str()) <= 0) {
+        printf("Bad IR node counts in compiler log:\n%s\n", report.str().c_str());
+        return 1;
+    }
+
+    for (const char *name : {"generating LLVM IR", "InstCombinePass", "emitting object code"}) {
+        const Entry *e = find_pass(entries, "llvm", name);
+        if (!e || e->count("ir_nodes_before")) {
+            printf("Missing or bad LLVM pass %s in compiler log:\n%s\n", name, report.str().c_str());
+            return 1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "Halide.h"
+#include <atomic>
+#include <stdio.h>
+
+using namespace Halide;
+
+std::atomic<int> malloc_count{0};
+std::atomic<size_t> max_malloc_size{0};
+
+void *my_malloc(JITUserContext *user_context, size_t x) {
+    malloc_count++;
+    size_t old_max = max_malloc_size;
+    while (x > old_max && !max_malloc_size.compare_exchange_weak(old_max, x)) {
+    }
+    void *orig = malloc(x + 32);
+    void *ptr = (void *)((((size_t)orig + 32) >> 5) << 5);
+    ((void **)ptr)[-1] = orig;
+    return ptr;
+}
+
+void my_free(JITUserContext *user_context, void *ptr) {
+    free(((void **)ptr)[-1]);
+}
+
+// Run a pipeline in which g is computed per tile of f, if it's used at
+// all, with g's storage hoisted out as far as the given schedule says,
+// and return the number of heap allocations it made.
+int run(int width, int height, bool parallel, bool hoist_root, bool use_g = true) {
+    Func f("f"), g("g");
+    Var x("x"), y("y"), xo("xo"), xi("xi");
+    Param<bool> g_used;
+
+    g(x, y) = x * 3 + y;
+    f(x, y) = select(g_used, g(x - 1, y) + g(x, y) * 2 + g(x + 1, y), 0);
+
+    f.split(x, xo, xi, 16, TailStrategy::GuardWithIf);
+    g.compute_at(f, xo).store_in(MemoryType::Heap);
+    if (parallel) {
+        f.parallel(y);
+        g.hoist_storage(f, y);
+    } else if (hoist_root) {
+        g.hoist_storage_root();
+    }
+
+    f.jit_handlers().custom_malloc = my_malloc;
+    f.jit_handlers().custom_free = my_free;
+
+    malloc_count = 0;
+    g_used.set(use_g);
+    Buffer<int> out = f.realize({width, height});
+    for (int j = 0; j < height; j++) {
+        for (int i = 0; i < width; i++) {
+            int correct = use_g ? (i - 1) * 3 + j + (i * 3 + j) * 2 + (i + 1) * 3 + j : 0;
+            if (out(i, j) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n", i, j, out(i, j), correct);
+                exit(1);
+            }
+        }
+    }
+    return malloc_count;
+}
+
+// Run a pipeline in which g is computed per row of h, and the width of
+// h needed grows with the row of out it is computed for, with g's
+// storage hoisted out of the loop over those rows. Return the number
+// of heap allocations it made, and the size of the largest.
+int run_varying_extent(int width, int height, size_t &max_size) {
+    Func g("g"), h("h"), out("out");
+    Var x("x"), y("y");
+
+    g(x, y) = x * 3 + y;
+    h(x, y) = g(x, y) + g(x + 1, y);
+    out(x, y) = h(x * y, y);
+
+    h.compute_at(out, y).store_in(MemoryType::Stack);
+    g.compute_at(h, y).store_in(MemoryType::Heap).hoist_storage_root();
+
+    out.jit_handlers().custom_malloc = my_malloc;
+    out.jit_handlers().custom_free = my_free;
+
+    malloc_count = 0;
+    max_malloc_size = 0;
+    Buffer<int> result = out.realize({width, height});
+    for (int j = 0; j < height; j++) {
+        for (int i = 0; i < width; i++) {
+            int correct = (i * j) * 3 + j + (i * j + 1) * 3 + j;
+            if (result(i, j) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n", i, j, result(i, j), correct);
+                exit(1);
+            }
+        }
+    }
+    max_size = max_malloc_size;
+    return malloc_count;
+}
+
+int main(int argc, char **argv) {
+    if (get_jit_target_from_environment().arch == Target::WebAssembly) {
+        printf("[SKIP] WebAssembly JIT does not support custom allocators.\n");
+        return 0;
+    }
+
+    // Without hoisting, there's an allocation of g per tile.
+    int tiles = run(100, 10, false, false);
+    if (tiles != 7 * 10) {
+        printf("Expected %d allocations without hoisting, got %d\n", 7 * 10, tiles);
+        return 1;
+    }
+
+    // Hoisted to the root, there's just one, large enough for the
+    // full tiles even though the last tile in each row is smaller.
+    int hoisted = run(100, 10, false, true);
+    if (hoisted != 1) {
+        printf("Expected 1 allocation with storage hoisted to the root, got %d\n", hoisted);
+        return 1;
+    }
+
+    // The hoisted allocation is skipped when none of the realizations
+    // it replaces are needed.
+    int unused = run(100, 10, false, true, false);
+    if (unused != 0) {
+        printf("Expected no allocations of an unused Func with hoisted storage, got %d\n", unused);
+        return 1;
+    }
+
+    // Hoisting to a parallel loop is fine, as long as the parallel
+    // loop is outside the allocation.
+    int per_row = run(100, 10, true, false);
+    if (per_row != 10) {
+        printf("Expected %d allocations with storage hoisted to a parallel loop, got %d\n", 10, per_row);
+        return 1;
+    }
+
+    // The extent of g grows with the row of out, so the hoisted
+    // allocation must be large enough for the last row.
+    size_t max_size = 0;
+    int varying = run_varying_extent(20, 10, max_size);
+    size_t last_row = ((20 - 1) * (10 - 1) + 2) * sizeof(int);
+    if (varying != 1 || max_size < last_row) {
+        printf("Expected 1 allocation of at least %d bytes with an extent that varies "
+               "over the hoisted loop, got %d allocations of at most %d bytes\n",
+               (int)last_row, varying, (int)max_size);
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include "Halide.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+using namespace Halide;
+
+std::set<std::string> list_dir(const std::string &dir) {
+    std::set<std::string> result;
+#ifndef _WIN32
+    DIR *d = opendir(dir.c_str());
+    if (d) {
+        while (dirent *e = readdir(d)) {
+            std::string name = e->d_name;
+            if (name != "." && name != "..") {
+                result.insert(name);
+            }
+        }
+        closedir(d);
+    }
+#endif
+    return result;
+}
+
+// Each call starts from the same unique_name counters, so that
+// identical pipelines lower to identical IR, as they would in a fresh
+// process.
+bool run(const Internal::UniqueNameCounters &initial_counters, const Buffer<float> &lut, float scale,
+         float offset = 0.0f) {
+    Internal::UniqueNameCounters counters = initial_counters;
+    Internal::ScopedUniqueNameCounters scoped_counters(counters);
+
+    Param<float> p("p");
+    Var x("x"), y("y");
+    Func f("f");
+    f(x, y) = lut(x % lut.width()) * scale + cast<float>(y) + p;
+    f.parallel(y).vectorize(x, 8);
+    p.set(offset);
+    Buffer<float> out = f.realize({64, 16});
+
+    for (int y = 0; y < out.height(); y++) {
+        for (int x = 0; x < out.width(); x++) {
+            float correct = lut(x % lut.width()) * scale + (float)y + offset;
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] The JIT code cache is not used for WebAssembly.\n");
+        return 0;
+    }
+#ifdef _WIN32
+    printf("[SKIP] This test lists directories with POSIX APIs.\n");
+    return 0;
+#endif
+
+    const std::string dir = Internal::dir_make_temp();
+    static std::string env = "HL_JIT_CACHE_DIR=" + dir;
+    putenv(&env[0]);
+
+    const Internal::UniqueNameCounters initial_counters;
+    Buffer<float> lut(16, "lut");
+    lut.for_each_element([&](int x) { lut(x) = std::sqrt((float)x); });
+
+    // A miss stores one entry.
+    if (!run(initial_counters, lut, 0.5f)) {
+        return 1;
+    }
+    std::set<std::string> entries = list_dir(dir);
+    if (entries.size() != 1) {
+        printf("Expected one cache entry, found %d\n", (int)entries.size());
+        return 1;
+    }
+    const std::string entry = dir + "/" + *entries.begin();
+    const std::vector<char> contents = Internal::read_entire_file(entry);
+
+    // The same pipeline hits it, and leaves it alone, even with a
+    // different value for its Param.
+    if (!run(initial_counters, lut, 0.5f, 3.0f)) {
+        return 1;
+    }
+    if (list_dir(dir) != entries || Internal::read_entire_file(entry) != contents) {
+        printf("Compiling the same pipeline again changed the cache\n");
+        return 1;
+    }
+
+    // Changing a constant in the least significant bit, or the contents
+    // of an embedded buffer, makes a different entry.
+    if (!run(initial_counters, lut, std::nextafter(0.5f, 1.0f))) {
+        return 1;
+    }
+    Buffer<float> other_lut = lut.copy();
+    other_lut(3) = 42.0f;
+    if (!run(initial_counters, other_lut, 0.5f)) {
+        return 1;
+    }
+    if (list_dir(dir).size() != 3) {
+        printf("Expected three cache entries, found %d\n", (int)list_dir(dir).size());
+        return 1;
+    }
+
+    // A damaged entry is a miss, and gets replaced.
+    Internal::write_entire_file(entry, contents.data(), contents.size() / 2);
+    if (!run(initial_counters, lut, 0.5f)) {
+        return 1;
+    }
+    if (Internal::read_entire_file(entry) != contents) {
+        printf("Damaged cache entry was not replaced\n");
+        return 1;
+    }
+
+    for (const std::string &name : list_dir(dir)) {
+        Internal::file_unlink(dir + "/" + name);
+    }
+    Internal::dir_rmdir(dir);
+
+    printf("Success!\n");
+    return 0;
+}
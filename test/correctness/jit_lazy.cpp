@@ -0,0 +1,106 @@
+#include "Halide.h"
+
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+bool error_occurred = false;
+
+void my_error(JITUserContext *ctx, const char *msg) {
+    error_occurred = true;
+}
+
+// A pipeline with several specializations, a parallel loop, a
+// producer that only runs for some values of the parameter, and a
+// requirement on the parameter.
+Pipeline make_pipeline(Param<int> p) {
+    Var x("x"), y("y");
+    Func f("f"), g("g"), h("h");
+    f(x, y) = cast<float>(x * y) + 0.5f;
+    g(x, y) = select(p > 2, f(x, y) * 2.0f, f(x, y) - 1.0f);
+    h(x, y) = g(x, y) + cast<float>(p);
+
+    h.specialize(p == 0).vectorize(x, 4);
+    h.specialize(p == 1).parallel(y);
+    h.specialize(p == 2).vectorize(x, 8).parallel(y);
+    h.specialize(p == 3).vectorize(x, 16);
+    f.compute_at(h, y).specialize(p > 2).vectorize(x, 4);
+    g.compute_at(h, y);
+
+    Pipeline pipeline(h);
+    pipeline.add_requirement(p < 100, "p is too large:", p);
+    pipeline.jit_handlers().custom_error = my_error;
+    return pipeline;
+}
+
+Buffer<float> run(int mode, const Target &t) {
+    Param<int> p("p");
+    Pipeline pipeline = make_pipeline(p);
+    p.set(mode);
+    return pipeline.realize({64, 32}, t);
+}
+
+int main(int argc, char **argv) {
+    const Target eager = get_jit_target_from_environment();
+    const Target lazy = eager.with_feature(Target::LazyJIT);
+
+    for (int mode = 0; mode < 5; mode++) {
+        Buffer<float> expected = run(mode, eager);
+        Buffer<float> actual = run(mode, lazy);
+        for (int y = 0; y < expected.height(); y++) {
+            for (int x = 0; x < expected.width(); x++) {
+                if (actual(x, y) != expected(x, y)) {
+                    printf("Mode %d: actual(%d, %d) = %f instead of %f\n",
+                           mode, x, y, actual(x, y), expected(x, y));
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // Specializations, parallel loops and error messages aren't
+    // compiled until they run.
+    if (jit_compiles_lazily(lazy)) {
+        Param<int> p("p");
+        Pipeline pipeline = make_pipeline(p);
+        p.set(0);
+        pipeline.realize({64, 32}, lazy);
+        int compiled = JITModule::num_lazily_compiled_functions();
+        pipeline.realize({64, 32}, lazy);
+        if (JITModule::num_lazily_compiled_functions() != compiled) {
+            printf("Running the same code again compiled more functions\n");
+            return 1;
+        }
+
+        p.set(3);
+        pipeline.realize({64, 32}, lazy);
+        if (JITModule::num_lazily_compiled_functions() == compiled) {
+            printf("A specialization was compiled before it ran\n");
+            return 1;
+        }
+        compiled = JITModule::num_lazily_compiled_functions();
+
+        p.set(1);
+        pipeline.realize({64, 32}, lazy);
+        if (JITModule::num_lazily_compiled_functions() == compiled) {
+            printf("A specialization with a parallel loop was compiled before it ran\n");
+            return 1;
+        }
+        compiled = JITModule::num_lazily_compiled_functions();
+
+        p.set(100);
+        pipeline.realize({64, 32}, lazy);
+        if (!error_occurred) {
+            printf("There should have been an error\n");
+            return 1;
+        }
+        if (JITModule::num_lazily_compiled_functions() == compiled) {
+            printf("An error message was compiled before it was needed\n");
+            return 1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -373,6 +373,7 @@ int main(int argc, char **argv) {
         Func g;
         g(x, y) = f(x, y) + f(x - 1, y) + f(x + 1, y);
         Internal::JITSharedRuntime::memoization_cache_set_size(1000000);
+        halide_memoization_cache_stats_t before = Internal::JITSharedRuntime::memoization_cache_get_stats();
 
         for (int v = 0; v < 1000; v++) {
             int r = rand() % 256;
@@ -388,6 +389,13 @@ int main(int argc, char **argv) {
         // TODO work out an assertion on call count here.
         printf("Call count is %d.\n", call_count_with_arg);
 
+        // Every realization does one lookup, and every miss calls the extern stage.
+        halide_memoization_cache_stats_t after = Internal::JITSharedRuntime::memoization_cache_get_stats();
+        assert(after.misses - before.misses == (uint64_t)call_count_with_arg);
+        assert(after.hits - before.hits == (uint64_t)(1000 - call_count_with_arg));
+        assert(after.evictions > before.evictions);
+        assert(after.bytes_held <= after.max_bytes && after.max_bytes == 1000000);
+
         // Return cache size to default.
         Internal::JITSharedRuntime::memoization_cache_set_size(0);
     }
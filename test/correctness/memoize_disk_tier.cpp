@@ -0,0 +1,92 @@
+#include "Halide.h"
+#include "HalideRuntime.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int call_count = 0;
+
+extern "C" HALIDE_EXPORT_SYMBOL int count_calls_disk_tier(int32_t val, halide_buffer_t *out) {
+    if (!out->is_bounds_query()) {
+        call_count++;
+        Halide::Runtime::Buffer<int32_t> buf(*out);
+        buf.for_each_element([&](int x, int y) { buf(x, y) = val * 1000 + x + y; });
+    }
+    return 0;
+}
+
+int realize_all(Pipeline &p, Param<int32_t> &val) {
+    for (int v = 0; v < 10; v++) {
+        val.set(v);
+        Buffer<int32_t> out = p.realize({100, 100});
+        for (int y = 0; y < 100; y++) {
+            for (int x = 0; x < 100; x++) {
+                if (out(x, y) != v * 1000 + x + y + 1) {
+                    printf("out(%d, %d) = %d instead of %d\n", x, y, out(x, y), v * 1000 + x + y + 1);
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] The disk tier needs memory-mapped files.\n");
+        return 0;
+    }
+
+    Param<int32_t> val;
+    Func f, g;
+    Var x, y;
+    f.define_extern("count_calls_disk_tier", {val}, Int(32), 2);
+    f.compute_root().memoize();
+    g(x, y) = f(x, y) + 1;
+    Pipeline p(g);
+
+    std::string dir = Internal::dir_make_temp();
+    Internal::JITSharedRuntime::memoization_cache_set_disk_tier(dir, 1);
+
+    if (realize_all(p, val)) {
+        return 1;
+    }
+    if (call_count != 10) {
+        printf("call_count = %d instead of 10\n", call_count);
+        return 1;
+    }
+
+    // Releasing the runtime cleans up the cache, which writes all of
+    // its entries to disk. This is as good as restarting the process.
+    p.invalidate_cache();
+    Internal::JITSharedRuntime::release_all();
+
+    if (realize_all(p, val)) {
+        return 1;
+    }
+    halide_memoization_cache_stats_t stats = Internal::JITSharedRuntime::memoization_cache_get_stats();
+    if (call_count != 10 || stats.disk_hits != 10) {
+        printf("call_count = %d and disk_hits = %d after restart, instead of 10 and 10\n",
+               call_count, (int)stats.disk_hits);
+        return 1;
+    }
+
+    // Entries written with a different fingerprint must be ignored.
+    p.invalidate_cache();
+    Internal::JITSharedRuntime::release_all();
+    Internal::JITSharedRuntime::memoization_cache_set_disk_tier(dir, 2);
+
+    if (realize_all(p, val)) {
+        return 1;
+    }
+    if (call_count != 20) {
+        printf("call_count = %d instead of 20 with a new fingerprint\n", call_count);
+        return 1;
+    }
+
+    Internal::JITSharedRuntime::memoization_cache_set_disk_tier("", 0);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Record the schedules of the parallel loops whose names start with a
+// given prefix.
+class RecordSchedules : public IRMutator {
+    using IRMutator::visit;
+
+    Stmt visit(const For *op) override {
+        if (op->for_type == ForType::Parallel && starts_with(op->name, prefix)) {
+            const int64_t *grain = as_const_int(op->parallel_grain);
+            schedules.push_back({op->parallel_schedule, grain ? (int)*grain : 0});
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    struct Schedule {
+        ParallelSchedule schedule;
+        int grain;
+    };
+    std::string prefix;
+    std::vector<Schedule> schedules;
+    RecordSchedules(const std::string &prefix)
+        : prefix(prefix) {
+    }
+};
+
+// Realize f, check that out(x, y) = a * (x + y), and return the
+// schedules of its parallel loops named with the given prefix.
+std::vector<RecordSchedules::Schedule> run(Func f, int a, const std::string &prefix) {
+    RecordSchedules recorder(prefix);
+    f.add_custom_lowering_pass(&recorder, []() {});
+    Buffer<int> out = f.realize({32, 32});
+    for (int y = 0; y < out.height(); y++) {
+        for (int x = 0; x < out.width(); x++) {
+            if (out(x, y) != a * (x + y)) {
+                printf("out(%d, %d) = %d instead of %d\n", x, y, out(x, y), a * (x + y));
+                exit(1);
+            }
+        }
+    }
+    return recorder.schedules;
+}
+
+bool check(const std::vector<RecordSchedules::Schedule> &actual,
+           const std::vector<RecordSchedules::Schedule> &expected,
+           const char *name) {
+    bool ok = actual.size() == expected.size();
+    for (size_t i = 0; ok && i < actual.size(); i++) {
+        ok = (actual[i].schedule == expected[i].schedule &&
+              actual[i].grain == expected[i].grain);
+    }
+    if (!ok) {
+        printf("%s: wrong schedules on the parallel loops:\n", name);
+        for (const auto &s : actual) {
+            printf("  %d (grain %d)\n", (int)s.schedule, s.grain);
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    Var x("x"), y("y"), yo("yo"), yi("yi");
+
+    {
+        // Each specialization keeps its own schedule for a loop of the
+        // same name.
+        Func f("f");
+        Param<bool> p("p");
+        f(x, y) = x + y;
+        f.parallel(y, ParallelSchedule::Dynamic, 4);
+        f.specialize(p).parallel(y, ParallelSchedule::Guided, 2);
+
+        p.set(true);
+        if (!check(run(f, 1, "f.s0.y"),
+                   {{ParallelSchedule::Guided, 2}, {ParallelSchedule::Dynamic, 4}},
+                   "Specializations")) {
+            return 1;
+        }
+    }
+
+    {
+        // The schedule follows a loop that is split and renamed.
+        Func f("f");
+        f(x, y) = x + y;
+        f.split(y, yo, yi, 8).parallel(yo, ParallelSchedule::Dynamic, 3);
+
+        if (!check(run(f, 1, "f.s0.y.yo"),
+                   {{ParallelSchedule::Dynamic, 3}},
+                   "Split loop")) {
+            return 1;
+        }
+    }
+
+    {
+        // The schedule follows a loop fused with another Func's loop by
+        // compute_with.
+        Func f("f"), g("g"), h("h");
+        f(x, y) = x + y;
+        g(x, y) = 2 * (x + y);
+        h(x, y) = f(x, y) + g(x, y);
+        f.compute_root().parallel(y, ParallelSchedule::Guided, 5);
+        g.compute_root().parallel(y);
+        g.compute_with(f, y);
+
+        if (!check(run(h, 3, "f.s0.fused.y"),
+                   {{ParallelSchedule::Guided, 5}},
+                   "Fused loop")) {
+            return 1;
+        }
+    }
+
+    {
+        // A later plain parallel() replaces an earlier schedule.
+        Func f("f");
+        f(x, y) = x + y;
+        f.parallel(y, ParallelSchedule::Dynamic, 4);
+        f.parallel(y);
+
+        if (!check(run(f, 1, "f.s0.y"),
+                   {{ParallelSchedule::Default, 0}},
+                   "Plain parallel after a schedule")) {
+            return 1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the loops over a given var, including the prologues and
+// epilogues made by loop partitioning.
+class CountLoops : public IRMutator {
+    using IRMutator::visit;
+
+    Stmt visit(const For *op) override {
+        if (starts_with(op->name, name)) {
+            count++;
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    std::string name;
+    int count = 0;
+    CountLoops(const std::string &name)
+        : name(name) {
+    }
+};
+
+int count_x_loops(Partition x_policy, Partition y_policy) {
+    Buffer<int> input(64, 48);
+    input.fill([](int x, int y) { return x * 3 + y * 5; });
+
+    Func clamped = BoundaryConditions::repeat_edge(input);
+    Func f("f");
+    Var x("x"), y("y");
+    f(x, y) = clamped(x - 1, y - 1) + clamped(x + 1, y + 1);
+    f.partition(x, x_policy).partition(y, y_policy);
+
+    CountLoops counter("f.s0.x");
+    f.add_custom_lowering_pass(&counter, []() {});
+    Buffer<int> out = f.realize({64, 48});
+
+    for (int y = 0; y < out.height(); y++) {
+        for (int x = 0; x < out.width(); x++) {
+            int correct = (input(std::max(x - 1, 0), std::max(y - 1, 0)) +
+                           input(std::min(x + 1, 63), std::min(y + 1, 47)));
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n", x, y, out(x, y), correct);
+                exit(1);
+            }
+        }
+    }
+
+    return counter.count;
+}
+
+int main(int argc, char **argv) {
+    // Never partitioning anything gives a single loop over x.
+    int never = count_x_loops(Partition::Never, Partition::Never);
+    if (never != 1) {
+        printf("With Partition::Never there were %d loops over x instead of 1\n", never);
+        return 1;
+    }
+
+    // By default, the loop over x is partitioned in the steady state of
+    // the loop over y, but not in its prologue and epilogue.
+    int automatic = count_x_loops(Partition::Auto, Partition::Auto);
+    if (automatic <= never) {
+        printf("Loop partitioning didn't split the loop over x\n");
+        return 1;
+    }
+
+    // Turning off partitioning of y leaves just one x loop to partition.
+    int only_x = count_x_loops(Partition::Auto, Partition::Never);
+    if (only_x >= automatic) {
+        printf("Partition::Never on y didn't reduce the number of loops over x (%d vs %d)\n",
+               only_x, automatic);
+        return 1;
+    }
+
+    // Partition::Always on x partitions it in the prologue and epilogue
+    // of y as well.
+    int always = count_x_loops(Partition::Always, Partition::Auto);
+    if (always <= automatic) {
+        printf("Partition::Always on x didn't partition the loops over x in the "
+               "prologue and epilogue of y (%d vs %d loops)\n",
+               always, automatic);
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+bool error_occurred = false;
+
+void my_error(JITUserContext *ctx, const char *msg) {
+    printf("Expected: %s\n", msg);
+    error_occurred = true;
+}
+
+// Check that out(x, y, c) = a * (x + y * 10 + c * 1000) + b.
+bool check(const Buffer<int> &out, int a, int b, const char *name) {
+    for (int c = 0; c < out.channels(); c++) {
+        for (int y = 0; y < out.height(); y++) {
+            for (int x = 0; x < out.width(); x++) {
+                int correct = a * (x + y * 10 + c * 1000) + b;
+                if (out(x, y, c) != correct) {
+                    printf("%s: out(%d, %d, %d) = %d instead of %d\n",
+                           name, x, y, c, out(x, y, c), correct);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (get_jit_target_from_environment().arch == Target::WebAssembly) {
+        printf("[SKIP] WebAssembly does not support async() yet.\n");
+        return 0;
+    }
+
+    Var x("x"), y("y"), c("c");
+
+    {
+        // Three slots, used in turn by the iterations of two loops
+        // (over c and y) whose total count isn't a multiple of three,
+        // so the slots wrap around mid-row and across channels.
+        Func g("g"), f("f");
+        g(x, y, c) = x + y * 10 + c * 1000;
+        f(x, y, c) = g(x, y, c) + g(x + 1, y, c) - g(x + 1, y, c) * 2 + g(x, y, c);
+
+        g.compute_at(f, y).hoist_storage_root().async().ring_buffer(3);
+
+        Buffer<int> out = f.realize({16, 7, 5});
+        if (!check(out, 1, -1, "Constant ring buffer")) {
+            return 1;
+        }
+    }
+
+    {
+        // A number of slots given by a Param, including a single slot,
+        // which makes the producer wait for the consumer every time.
+        for (int buffers : {1, 2, 5}) {
+            Func g("g"), f("f");
+            Param<int> slots("slots");
+            g(x, y, c) = x + y * 10 + c * 1000;
+            f(x, y, c) = g(x, y, c) * 3;
+
+            g.compute_at(f, y).hoist_storage_root().async().ring_buffer(slots);
+
+            slots.set(buffers);
+            Buffer<int> out = f.realize({9, 11, 2});
+            if (!check(out, 3, 0, "Param ring buffer")) {
+                return 1;
+            }
+        }
+    }
+
+    {
+        // The consumer is specialized, so the producer is realized
+        // once per specialization, and all the realizations share the
+        // hoisted slots.
+        Func g("g"), f("f");
+        Param<bool> vectorized("vectorized");
+        g(x, y, c) = x + y * 10 + c * 1000;
+        f(x, y, c) = g(x, y, c) * 2 + 5;
+
+        f.specialize(vectorized).vectorize(x, 8);
+        g.compute_at(f, y).hoist_storage_root().async().ring_buffer(4);
+
+        for (bool v : {false, true}) {
+            vectorized.set(v);
+            Buffer<int> out = f.realize({32, 9, 3});
+            if (!check(out, 2, 5, v ? "Vectorized specialization" : "Scalar specialization")) {
+                return 1;
+            }
+        }
+    }
+
+    {
+        // A number of slots that turns out to be zero is an error when
+        // the pipeline runs.
+        Func g("g"), f("f");
+        Param<int> slots("slots");
+        g(x, y) = x + y;
+        f(x, y) = g(x, y) * 2;
+
+        g.compute_at(f, y).hoist_storage_root().async().ring_buffer(slots);
+
+        slots.set(0);
+        f.jit_handlers().custom_error = my_error;
+        f.realize({8, 8});
+        if (!error_occurred) {
+            printf("There was supposed to be an error with zero slots\n");
+            return 1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -1681,7 +1681,7 @@ void check_boolean() {
 
     // A for loop is also an if statement that the extent is greater than zero
     Stmt body = AssertStmt::make(y == z, y);
-    Stmt loop = For::make("t", 0, x, ForType::Serial, DeviceAPI::None, body);
+    Stmt loop = For::make("t", 0, x, ForType::Serial, Partition::Auto, DeviceAPI::None, body);
     check(IfThenElse::make(0 < x, loop), loop);
 
     // A for loop where the extent is exactly one is just the body
@@ -2105,6 +2105,36 @@ void check_invariant() {
     }
 }
 
+void check_shared_subexpressions() {
+    // Each level of these Exprs uses the level below twice, so they
+    // are small graphs but huge trees. The simplifier must visit each
+    // node once, not once per path to it, and must return the same
+    // graph when there's nothing to simplify.
+    Expr x = Var("x"), y = Var("y"), z = Var("z");
+    Expr e = x;
+    for (int i = 0; i < 48; i++) {
+        e = e * e + 1;
+    }
+    internal_assert(simplify(e).same_as(e))
+        << "Simplifying a graph with shared subexpressions changed it\n";
+
+    // A let var used only through shared subexpressions must still be
+    // counted as used.
+    Expr body = y;
+    for (int i = 0; i < 12; i++) {
+        body = body * body + 1;
+    }
+    Expr let = Let::make("y", x * z, body);
+    internal_assert(simplify(let).same_as(let))
+        << "Simplifying a let over a graph with shared subexpressions changed it\n";
+
+    // Nor may what's known about a shared subexpression inside a let
+    // leak out of it.
+    Expr shared = y * z;
+    check(Call::make(Int(32), "f", {Let::make("y", 3, shared), shared}, Call::Extern),
+          Call::make(Int(32), "f", {z * 3, y * z}, Call::Extern));
+}
+
 void check_unreachable() {
     Var x("x"), y("y");
 
@@ -2127,9 +2157,9 @@ void check_unreachable() {
     check(Call::make(Int(32), Call::if_then_else, {x != 0, y, unreachable()}, Call::PureIntrinsic), y);
     check(Call::make(Int(32), Call::if_then_else, {x != 0, unreachable(), y}, Call::PureIntrinsic), y);
 
-    check(Block::make(not_no_op(y), For::make("i", 0, 1, ForType::Serial, DeviceAPI::None, Evaluate::make(unreachable()))),
+    check(Block::make(not_no_op(y), For::make("i", 0, 1, ForType::Serial, Partition::Auto, DeviceAPI::None, Evaluate::make(unreachable()))),
           Evaluate::make(unreachable()));
-    check(For::make("i", 0, x, ForType::Serial, DeviceAPI::None, Evaluate::make(unreachable())),
+    check(For::make("i", 0, x, ForType::Serial, Partition::Auto, DeviceAPI::None, Evaluate::make(unreachable())),
           Evaluate::make(0));
 }
 
@@ -2144,6 +2174,7 @@ int main(int argc, char **argv) {
     check_overflow();
     check_bitwise();
     check_lets();
+    check_shared_subexpressions();
     check_unreachable();
 
     // Miscellaneous cases that don't fit into one of the categories above.
@@ -2364,7 +2395,7 @@ int main(int argc, char **argv) {
 
     {
         Stmt body = AssertStmt::make(x > 0, y);
-        check(For::make("t", 0, x, ForType::Serial, DeviceAPI::None, body),
+        check(For::make("t", 0, x, ForType::Serial, Partition::Auto, DeviceAPI::None, body),
               Evaluate::make(0));
     }
 
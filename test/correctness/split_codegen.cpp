@@ -0,0 +1,62 @@
+#include "Halide.h"
+#include "halide_test_dirs.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+using namespace Halide;
+
+std::string read_file(const std::string &filename) {
+    std::ifstream f(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+// Compile a pipeline with several parallel loops, some of them nested,
+// to a static library, and return its contents.
+std::string compile(const std::string &name) {
+    Var x("x"), y("y"), c("c");
+    ImageParam input(Float(32), 3, "input");
+
+    Func f("f"), g("g"), h("h");
+    f(x, y, c) = input(x, y, c) * 2.0f;
+    g(x, y, c) = f(x, y, c) + f(x + 1, y, c);
+    h(x, y, c) = g(x, y, c) - g(x, y + 1, c);
+
+    f.compute_root().parallel(y).vectorize(x, 8);
+    g.compute_at(h, c).parallel(y).vectorize(x, 8);
+    h.parallel(c).parallel(y);
+
+    std::string prefix = Internal::get_test_tmp_dir() + name;
+    const char *a = get_host_target().os == Target::Windows ? ".lib" : ".a";
+    Internal::ensure_no_file_exists(prefix + a);
+    h.compile_to_static_library(prefix, {input}, name);
+    Internal::assert_file_exists(prefix + a);
+    return read_file(prefix + a);
+}
+
+int main(int argc, char **argv) {
+    static std::string split = "HL_SPLIT_CODEGEN=1";
+    static std::string one_thread = "HL_COMPILE_THREADS=1";
+    static std::string four_threads = "HL_COMPILE_THREADS=4";
+    putenv(&split[0]);
+
+    // The library doesn't depend on the number of threads.
+    putenv(&one_thread[0]);
+    std::string serial = compile("split_codegen");
+    putenv(&four_threads[0]);
+    std::string parallel = compile("split_codegen");
+    if (serial != parallel) {
+        printf("Library compiled on four threads differs from the one compiled on one\n");
+        return 1;
+    }
+
+    // The closures went into objects of their own.
+    if (serial.find("split_codegen_1") == std::string::npos) {
+        printf("Library was not split into several objects\n");
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int malloc_count = 0;
+size_t malloc_bytes = 0;
+
+void *my_malloc(JITUserContext *user_context, size_t x) {
+    malloc_count++;
+    malloc_bytes += x;
+    void *orig = malloc(x + 128);
+    void *ptr = (void *)((((size_t)orig + 128) >> 7) << 7);
+    ((void **)ptr)[-1] = orig;
+    return ptr;
+}
+
+void my_free(JITUserContext *user_context, void *ptr) {
+    free(((void **)ptr)[-1]);
+}
+
+int main(int argc, char **argv) {
+    if (get_jit_target_from_environment().arch == Target::WebAssembly) {
+        printf("[SKIP] WebAssembly JIT does not support custom allocators.\n");
+        return 0;
+    }
+
+    const int W = 256, H = 64, stages = 6;
+
+    // A chain of compute_root stages, each of which is only needed
+    // until the next one has been computed.
+    Var x, y;
+    Func prev;
+    prev(x, y) = x * 3 + y;
+    std::vector<Func> chain;
+    for (int i = 0; i < stages; i++) {
+        Func f;
+        f(x, y) = prev(x - 1, y) + prev(x + 1, y) * (i + 1);
+        f.compute_root();
+        chain.push_back(f);
+        prev = f;
+    }
+    Func out;
+    out(x, y) = prev(x, y);
+    out.bound(x, 0, W).bound(y, 0, H);
+
+    out.jit_handlers().custom_malloc = my_malloc;
+    out.jit_handlers().custom_free = my_free;
+
+    // Without planning, each stage is allocated separately.
+    Target t = get_jit_target_from_environment();
+    malloc_count = 0;
+    malloc_bytes = 0;
+    Buffer<int> reference = out.realize({W, H}, t);
+    int unplanned_count = malloc_count;
+    size_t unplanned_bytes = malloc_bytes;
+
+    // With planning, the stages share one arena, and stages with
+    // disjoint lifetimes share memory.
+    malloc_count = 0;
+    malloc_bytes = 0;
+    Buffer<int> result = out.realize({W, H}, t.with_feature(Target::StaticMemoryPlan));
+
+    printf("Without planning: %d allocations, %d bytes\n", unplanned_count, (int)unplanned_bytes);
+    printf("With planning: %d allocations, %d bytes\n", malloc_count, (int)malloc_bytes);
+
+    if (unplanned_count != stages) {
+        printf("Expected %d allocations without planning\n", stages);
+        return 1;
+    }
+
+    if (malloc_count != 1) {
+        printf("Expected a single arena allocation\n");
+        return 1;
+    }
+
+    if (malloc_bytes >= unplanned_bytes / 2) {
+        printf("The arena should have reused the memory of dead stages\n");
+        return 1;
+    }
+
+    for (int j = 0; j < H; j++) {
+        for (int i = 0; i < W; i++) {
+            if (result(i, j) != reference(i, j)) {
+                printf("result(%d, %d) = %d instead of %d\n", i, j, result(i, j), reference(i, j));
+                return 1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Var x("x"), y("y"), c("c"), xi("xi"), yi("yi");
+
+    {
+        // A 2D blocked layout, with extents that aren't a multiple of
+        // the block size, read transposed and at offsets.
+        Func g("g"), f("f");
+        g(x, y) = x * 3 + y * 1000;
+        f(x, y) = g(y, x) + g(x + 1, y + 2);
+
+        g.compute_root().tile(x, y, xi, yi, 8, 8).tile_storage(x, y, 8, 8);
+        f.tile(x, y, xi, yi, 8, 8);
+
+        Buffer<int> out = f.realize({37, 29});
+        for (int y = 0; y < out.height(); y++) {
+            for (int x = 0; x < out.width(); x++) {
+                int correct = (y * 3 + x * 1000) + ((x + 1) * 3 + (y + 2) * 1000);
+                if (out(x, y) != correct) {
+                    printf("2D tiles: out(%d, %d) = %d instead of %d\n",
+                           x, y, out(x, y), correct);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    {
+        // Channels stored in groups of 4 (like NCHWc), with a number of
+        // channels that isn't a multiple of 4.
+        Func g("g"), f("f");
+        g(x, y, c) = x + y * 100 + c * 10000;
+        f(x, y, c) = g(x, y, c) + g(x, y, 5 - c);
+
+        g.compute_root().tile_storage(c, 4);
+
+        Buffer<int> out = f.realize({10, 7, 6});
+        for (int c = 0; c < out.channels(); c++) {
+            for (int y = 0; y < out.height(); y++) {
+                for (int x = 0; x < out.width(); x++) {
+                    int correct = 2 * (x + y * 100) + c * 10000 + (5 - c) * 10000;
+                    if (out(x, y, c) != correct) {
+                        printf("Channel blocks: out(%d, %d, %d) = %d instead of %d\n",
+                               x, y, c, out(x, y, c), correct);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    {
+        // Tiled storage combined with reorder_storage, computed per row
+        // of the consumer, so the mins of the realization aren't zero.
+        Func g("g"), f("f");
+        g(x, y) = x * 7 + y * 13;
+        f(x, y) = g(x - 1, y - 1) + g(x + 1, y + 1);
+
+        g.compute_at(f, y).reorder_storage(y, x).tile_storage(x, 4);
+
+        Buffer<int> out = f.realize({23, 11});
+        for (int y = 0; y < out.height(); y++) {
+            for (int x = 0; x < out.width(); x++) {
+                int correct = ((x - 1) * 7 + (y - 1) * 13) + ((x + 1) * 7 + (y + 1) * 13);
+                if (out(x, y) != correct) {
+                    printf("Reordered storage: out(%d, %d) = %d instead of %d\n",
+                           x, y, out(x, y), correct);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    {
+        // A vectorized update of a tiled Func.
+        Func g("g"), f("f");
+        g(x, y) = cast<float>(x + y);
+        g(x, y) += cast<float>(x * y);
+        f(x, y) = g(x, y) * 2.0f;
+
+        g.compute_root().tile_storage(x, y, 16, 2).vectorize(x, 8);
+        g.update().vectorize(x, 8);
+        f.vectorize(x, 8);
+
+        Buffer<float> out = f.realize({40, 9});
+        for (int y = 0; y < out.height(); y++) {
+            for (int x = 0; x < out.width(); x++) {
+                float correct = (x + y + x * y) * 2.0f;
+                if (out(x, y) != correct) {
+                    printf("Vectorized update: out(%d, %d) = %f instead of %f\n",
+                           x, y, out(x, y), correct);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,20 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Var x, y;
+
+    Func f;
+
+    // There are no boundary conditions here, so there is nothing to
+    // partition the loop over x by.
+    f(x, y) = x + y;
+    f.partition(x, Partition::Always);
+
+    Buffer<int> im = f.realize({100, 100});
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,19 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Var x, y;
+
+    Func f, g;
+
+    f(x, y) = x;
+    g(x, y) = f(x, y) * 2;
+    f.compute_at(g, y).hoist_storage_root().async().ring_buffer(0);
+
+    Buffer<int> im = g.realize({100, 100});
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+
+#include "scratch_arena.function_info.h"
+#include "scratch_arena.h"
+
+using namespace Halide::Runtime;
+
+const int kSize = 128;
+
+int malloc_count = 0;
+
+void *my_halide_malloc(void *user_context, size_t x) {
+    malloc_count++;
+    void *orig = malloc(x + 128);
+    void *ptr = (void *)((((size_t)orig + 128) >> 7) << 7);
+    ((void **)ptr)[-1] = orig;
+    return ptr;
+}
+
+void my_halide_free(void *user_context, void *ptr) {
+    free(((void **)ptr)[-1]);
+}
+
+int64_t scratch_bytes_from_metadata() {
+    const halide_filter_metadata_t *md = scratch_arena_metadata();
+    for (int i = 0; i < md->num_arguments; i++) {
+        const halide_filter_argument_t &arg = md->arguments[i];
+        if (!strcmp(arg.name, "__scratch")) {
+            if (arg.kind != halide_argument_kind_input_buffer || arg.dimensions != 1 ||
+                !arg.buffer_estimates || !arg.buffer_estimates[1]) {
+                fprintf(stderr, "Unexpected metadata for the scratch argument\n");
+                exit(1);
+            }
+            return *arg.buffer_estimates[1];
+        }
+    }
+    fprintf(stderr, "No scratch argument in the metadata\n");
+    exit(1);
+}
+
+bool run(halide_buffer_t *scratch, Buffer<int32_t, 2> &input, const Buffer<int32_t, 2> &reference,
+         int expected_mallocs) {
+    Buffer<int32_t, 2> output(kSize, kSize);
+    malloc_count = 0;
+    int result = scratch_arena(input, output, scratch);
+    if (result != 0) {
+        fprintf(stderr, "Result: %d\n", result);
+        return false;
+    }
+    if (malloc_count != expected_mallocs) {
+        fprintf(stderr, "Expected %d calls to halide_malloc, got %d\n", expected_mallocs, malloc_count);
+        return false;
+    }
+    for (int y = 0; y < kSize; y++) {
+        for (int x = 0; x < kSize; x++) {
+            if (output(x, y) != reference(x, y)) {
+                fprintf(stderr, "output(%d, %d) = %d instead of %d\n", x, y, output(x, y), reference(x, y));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    halide_set_custom_malloc(&my_halide_malloc);
+    halide_set_custom_free(&my_halide_free);
+
+    const int64_t scratch_bytes = scratch_bytes_from_metadata();
+    if (scratch_bytes != scratch_arena_scratch_bytes()) {
+        fprintf(stderr, "Metadata and function info disagree on the scratch size: %d vs %d\n",
+                (int)scratch_bytes, (int)scratch_arena_scratch_bytes());
+        return 1;
+    }
+    printf("Scratch required: %d bytes\n", (int)scratch_bytes);
+
+    Buffer<int32_t, 2> input(kSize, kSize);
+    input.for_each_element([&](int x, int y) {
+        input(x, y) = x * 7 + y * 3;
+    });
+
+    // Without a scratch buffer, the arena comes from halide_malloc.
+    Buffer<int32_t, 2> reference(kSize, kSize);
+    malloc_count = 0;
+    if (scratch_arena(input, reference, nullptr) != 0 || malloc_count != 1) {
+        fprintf(stderr, "Expected a single arena allocation without a scratch buffer\n");
+        return 1;
+    }
+
+    // A large enough scratch buffer means no calls to halide_malloc,
+    // however it's aligned.
+    Buffer<uint8_t, 1> scratch((int)scratch_bytes + 1);
+    if (!run(scratch, input, reference, 0)) {
+        return 1;
+    }
+    Buffer<uint8_t, 1> misaligned = scratch.cropped(0, 1, (int)scratch_bytes);
+    if (!run(misaligned, input, reference, 0)) {
+        return 1;
+    }
+
+    // A scratch buffer that is too small falls back to the heap.
+    Buffer<uint8_t, 1> small(16);
+    if (!run(small, input, reference, 1)) {
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include "Halide.h"
+
+namespace {
+
+class ScratchArena : public Halide::Generator<ScratchArena> {
+public:
+    Input<Buffer<int32_t, 2>> input{"input"};
+    Output<Buffer<int32_t, 2>> output{"output"};
+
+    void generate() {
+        const int size = 128;
+        Var x, y;
+
+        // A chain of compute_root stages whose sizes are known at
+        // compile time, so all of them are carved from the arena.
+        Func prev = Halide::BoundaryConditions::repeat_edge(input, {{0, size}, {0, size}});
+        for (int i = 0; i < 4; i++) {
+            Func f("stage_" + std::to_string(i));
+            f(x, y) = prev(x - 1, y) + prev(x + 1, y) * 2 + i;
+            f.compute_root();
+            prev = f;
+        }
+        output(x, y) = prev(x, y);
+        output.bound(x, 0, size).bound(y, 0, size);
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(ScratchArena, scratch_arena)
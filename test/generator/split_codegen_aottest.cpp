@@ -0,0 +1,48 @@
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+
+#include <stdio.h>
+
+#include "split_codegen.h"
+#include "split_codegen_split.h"
+
+using namespace Halide::Runtime;
+
+// split_codegen_split is the same pipeline as split_codegen, compiled
+// with HL_SPLIT_CODEGEN=1, so each of its parallel loop bodies was
+// generated in a separate object. The two must compute the same thing.
+
+const int W = 64, H = 48, C = 3;
+
+int main(int argc, char **argv) {
+    Buffer<float, 3> input(W, H, C);
+    input.for_each_element([&](int x, int y, int c) {
+        input(x, y, c) = ((x * 7 + y * 13 + c * 31) % 101) / 100.0f;
+    });
+
+    for (float gain : {0.5f, 1.0f}) {
+        Buffer<float, 3> expected(W, H, C), actual(W, H, C);
+        if (split_codegen(input, gain, expected) != 0) {
+            printf("split_codegen failed\n");
+            return 1;
+        }
+        if (split_codegen_split(input, gain, actual) != 0) {
+            printf("split_codegen_split failed\n");
+            return 1;
+        }
+        for (int c = 0; c < C; c++) {
+            for (int y = 0; y < H; y++) {
+                for (int x = 0; x < W; x++) {
+                    if (actual(x, y, c) != expected(x, y, c)) {
+                        printf("actual(%d, %d, %d) = %f instead of %f (gain = %f)\n",
+                               x, y, c, actual(x, y, c), expected(x, y, c), gain);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
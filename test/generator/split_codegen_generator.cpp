@@ -0,0 +1,47 @@
+#include "Halide.h"
+
+#include <cmath>
+
+namespace {
+
+class SplitCodegen : public Halide::Generator<SplitCodegen> {
+public:
+    Input<Buffer<float, 3>> input{"input"};
+    Input<float> gain{"gain"};
+    Output<Buffer<float, 3>> output{"output"};
+
+    void generate() {
+        // A lookup table embedded in the pipeline, read by several of
+        // the parallel loop bodies, so the closures compiled separately
+        // all refer to the same global.
+        Buffer<float> table(256, "sqrt_table");
+        for (int i = 0; i < 256; i++) {
+            table(i) = std::sqrt(i / 255.0f);
+        }
+
+        Func clamped = Halide::BoundaryConditions::repeat_edge(input, {{0, input.width()}, {0, input.height()}});
+
+        lookup(x, y, c) = table(clamp(cast<int>(clamped(x, y, c) * 255.0f), 0, 255)) * gain;
+        blur_x(x, y, c) = (lookup(x - 1, y, c) + lookup(x, y, c) + lookup(x + 1, y, c)) / 3.0f;
+        blur_y(x, y, c) = (blur_x(x, y - 1, c) + blur_x(x, y, c) + blur_x(x, y + 1, c)) / 3.0f;
+        output(x, y, c) = (blur_y(x, y, c) +
+                           table(clamp(cast<int>(blur_y(x, y, c) * 255.0f), 0, 255)) +
+                           exp(-lookup(x, y, c)));
+    }
+
+    void schedule() {
+        // Every stage gets a parallel loop of its own, and blur_x's is
+        // nested inside output's outer one.
+        lookup.compute_root().parallel(y).vectorize(x, 8);
+        blur_x.compute_at(output, c).parallel(y).vectorize(x, 8);
+        output.parallel(c).parallel(y).vectorize(x, 8);
+    }
+
+private:
+    Var x{"x"}, y{"y"}, c{"c"};
+    Func lookup{"lookup"}, blur_x{"blur_x"}, blur_y{"blur_y"};
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(SplitCodegen, split_codegen)
@@ -0,0 +1,88 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+#define W 256
+#define H 256
+
+enum Schedule {
+    Serial,
+    AsyncFolded,
+    AsyncRingBuffer,
+};
+
+// A producer and a consumer of rows whose costs vary out of phase: the
+// producer is expensive for the first half of each block of 32 rows,
+// and the consumer for the second half.
+Func make_pipeline(Schedule schedule) {
+    Func producer("producer"), consumer("consumer"), out("out");
+    Var x("x"), y("y");
+
+    RDom rp(0, 64);
+    rp.where(rp < select(y % 32 < 16, 64, 2));
+    producer(x, y) = cast<float>(x + y);
+    producer(x, y) = sin(producer(x, y) + cast<float>(rp));
+
+    RDom rc(0, 64);
+    rc.where(rc < select(y % 32 < 16, 2, 64));
+    consumer(x, y) = producer(x, y);
+    consumer(x, y) = cos(consumer(x, y) + cast<float>(rc));
+
+    out(x, y) = consumer(x, y);
+
+    consumer.compute_at(out, y);
+    producer.compute_at(out, y);
+    switch (schedule) {
+    case Serial:
+        break;
+    case AsyncFolded:
+        // The producer can run at most one row ahead.
+        producer.store_root().fold_storage(y, 2).async();
+        break;
+    case AsyncRingBuffer:
+        // The producer can run up to 16 rows ahead.
+        producer.hoist_storage_root().async().ring_buffer(16);
+        break;
+    }
+    return out;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    Buffer<float> correct = make_pipeline(Serial).realize({W, H});
+
+    double times[3];
+    const char *names[3] = {"serial", "async with folded storage", "async with a ring buffer"};
+    for (Schedule s : {Serial, AsyncFolded, AsyncRingBuffer}) {
+        Func out = make_pipeline(s);
+        out.compile_jit();
+        Buffer<float> result(W, H);
+        times[s] = benchmark([&]() { out.realize(result); });
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                if (result(x, y) != correct(x, y)) {
+                    printf("%s: result(%d, %d) = %f instead of %f\n",
+                           names[s], x, y, result(x, y), correct(x, y));
+                    return 1;
+                }
+            }
+        }
+        printf("%s: %f ms\n", names[s], times[s] * 1e3);
+    }
+
+    if (times[AsyncRingBuffer] > times[AsyncFolded] * 0.9) {
+        fprintf(stderr, "WARNING: A ring buffer should let the producer run further ahead than folded storage\n");
+        return 0;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include "halide_test_dirs.h"
+
+#include <cstdio>
+#include <thread>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Measure how long it takes to build multitarget object files for a few
+// pipelines resembling those in apps/, compiling one target at a time
+// and then all targets at once.
+
+// A separable blur, scheduled like apps/blur.
+Func make_blur() {
+    ImageParam input(UInt(16), 2, "input");
+    Var x("x"), y("y"), xi("xi"), yi("yi");
+    Func blur_x("blur_x"), blur_y("blur_y");
+    blur_x(x, y) = (input(x, y) + input(x + 1, y) + input(x + 2, y)) / 3;
+    blur_y(x, y) = (blur_x(x, y) + blur_x(x, y + 1) + blur_x(x, y + 2)) / 3;
+    blur_y.split(y, y, yi, 8).parallel(y).vectorize(x, 8);
+    blur_x.store_at(blur_y, y).compute_at(blur_y, yi).vectorize(x, 8);
+    return blur_y;
+}
+
+// A Laplacian pyramid, like a much simplified apps/local_laplacian.
+Func make_pyramid() {
+    const int levels = 6;
+    ImageParam input(Float(32), 2, "input");
+    Var x("x"), y("y");
+
+    Func clamped = BoundaryConditions::repeat_edge(input);
+    Func gaussian[levels], laplacian[levels], output[levels];
+    gaussian[0](x, y) = clamped(x, y);
+    for (int j = 1; j < levels; j++) {
+        Func down_x;
+        down_x(x, y) = (gaussian[j - 1](2 * x - 1, y) + 2.0f * gaussian[j - 1](2 * x, y) + gaussian[j - 1](2 * x + 1, y)) / 4;
+        gaussian[j](x, y) = (down_x(x, 2 * y - 1) + 2.0f * down_x(x, 2 * y) + down_x(x, 2 * y + 1)) / 4;
+    }
+    output[levels - 1](x, y) = gaussian[levels - 1](x, y);
+    for (int j = levels - 2; j >= 0; j--) {
+        Func up;
+        up(x, y) = (gaussian[j + 1](x / 2, y / 2) + gaussian[j + 1]((x + 1) / 2, (y + 1) / 2)) / 2;
+        laplacian[j](x, y) = gaussian[j](x, y) - up(x, y);
+        Func up_out;
+        up_out(x, y) = (output[j + 1](x / 2, y / 2) + output[j + 1]((x + 1) / 2, (y + 1) / 2)) / 2;
+        output[j](x, y) = up_out(x, y) + 1.5f * laplacian[j](x, y);
+    }
+    for (int j = 0; j < levels; j++) {
+        gaussian[j].compute_root().parallel(y, 8).vectorize(x, 8);
+        output[j].compute_root().parallel(y, 8).vectorize(x, 8);
+    }
+    return output[0];
+}
+
+// A matrix multiply, scheduled like apps/linear_algebra.
+Func make_matmul() {
+    ImageParam A(Float(32), 2, "A"), B(Float(32), 2, "B");
+    Var x("x"), y("y"), xi("xi"), yi("yi"), xo("xo"), yo("yo");
+    RDom k(0, A.dim(0).extent());
+    Func prod("prod"), out("out");
+    prod(x, y) += A(k, y) * B(x, k);
+    out(x, y) = prod(x, y);
+    out.tile(x, y, xo, yo, xi, yi, 32, 8).parallel(yo).vectorize(xi, 8);
+    prod.compute_at(out, xo).vectorize(x, 8).unroll(y);
+    prod.update().reorder(x, y, k).vectorize(x, 8).unroll(y);
+    return out;
+}
+
+double time_compile(Func f, const std::string &name, const std::vector<Target> &targets, int num_threads) {
+    const char *o = get_host_target().os == Target::Windows ? ".obj" : ".o";
+    std::string prefix = Internal::get_test_tmp_dir() + "halide_test_performance_compile_multitarget_" + name;
+    std::map<OutputFileType, std::string> outputs = {
+        {OutputFileType::c_header, prefix + ".h"},
+        {OutputFileType::object, prefix + o},
+    };
+    auto args = f.infer_arguments();
+    auto module_producer = [&](const std::string &fn_name, const Target &target) -> Module {
+        return Internal::lower({f.function()}, fn_name, target, args, LinkageType::ExternalPlusMetadata);
+    };
+    auto start = benchmark_now();
+    compile_multitarget(name, outputs, targets, {}, module_producer, nullptr, num_threads);
+    return benchmark_duration_seconds(start, benchmark_now());
+}
+
+int main(int argc, char **argv) {
+    Target host = get_host_target();
+    if (host.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    // Feature variants, with the baseline last.
+    std::vector<Target> targets = {
+        host.with_feature(Target::NoAsserts).with_feature(Target::NoBoundsQuery),
+        host.with_feature(Target::NoBoundsQuery),
+        host.with_feature(Target::NoAsserts),
+        host,
+    };
+
+    const int num_threads = (int)std::thread::hardware_concurrency();
+    double serial_total = 0, parallel_total = 0;
+    for (auto &p : {std::make_pair(std::string("blur"), make_blur()),
+                    std::make_pair(std::string("pyramid"), make_pyramid()),
+                    std::make_pair(std::string("matmul"), make_matmul())}) {
+        double serial = time_compile(p.second, p.first, targets, 1);
+        double parallel = time_compile(p.second, p.first, targets, num_threads);
+        printf("%s: %d targets in %f s on one thread, %f s on %d threads\n",
+               p.first.c_str(), (int)targets.size(), serial, parallel, num_threads);
+        serial_total += serial;
+        parallel_total += parallel;
+    }
+
+    printf("Speedup from compiling targets in parallel: %f\n", serial_total / parallel_total);
+
+    if (num_threads >= (int)targets.size() && parallel_total > serial_total) {
+        printf("Compiling targets in parallel should not be slower than compiling them one at a time\n");
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Internal;
+using namespace Halide::Tools;
+
+// Measure how long it takes to compute the bounds on the values of the
+// Funcs of a pipeline with many stages when they can be reused from an
+// earlier lowering of it, compared to computing them from scratch.
+
+Func make_pipeline(int n) {
+    ImageParam input(Float(32), 2, "input");
+    Var x("x"), y("y");
+
+    Func f = BoundaryConditions::repeat_edge(input);
+    for (int i = 0; i < n; i++) {
+        Func g("stage_" + std::to_string(i));
+        if (i % 2) {
+            g(x, y) = clamp((f(x - 1, y) + 2 * f(x, y) + f(x + 1, y)) / 4, 0.0f, 1.0f);
+        } else {
+            g(x, y) = clamp((f(x, y - 1) + 2 * f(x, y) + f(x, y + 1)) / 4, 0.0f, 1.0f);
+        }
+        f = g;
+    }
+    return f;
+}
+
+bool same_bounds(const FuncValueBounds &a, const FuncValueBounds &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (const auto &it : a) {
+        auto b_it = b.find(it.first);
+        if (b_it == b.end() ||
+            !equal(it.second.min, b_it->second.min) ||
+            !equal(it.second.max, b_it->second.max)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check that the saved value bounds are the ones that would be
+// computed, including after the range of a Param they use changed.
+bool check_value_bounds_cache() {
+    Param<int> p("p");
+    p.set_range(0, 10);
+    Var x("x");
+    Func g("g"), h("h");
+    g(x) = p * 2;
+    h(x) = g(x) + 1;
+
+    std::map<std::string, Function> env = {{g.name(), g.function()},
+                                           {h.name(), h.function()}};
+    std::vector<std::string> order = {g.name(), h.name()};
+
+    compute_function_value_bounds(order, env, true);
+    if (!same_bounds(compute_function_value_bounds(order, env, true),
+                     compute_function_value_bounds(order, env))) {
+        printf("Cached value bounds differ from freshly computed ones\n");
+        return false;
+    }
+
+    p.set_range(0, 100);
+    if (!same_bounds(compute_function_value_bounds(order, env, true),
+                     compute_function_value_bounds(order, env))) {
+        printf("Value bounds differ from freshly computed ones after changing the range of a Param\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!check_value_bounds_cache()) {
+        return 1;
+    }
+
+    Func output = make_pipeline(50);
+    std::map<std::string, Function> env = find_transitive_calls(output.function());
+    std::vector<std::string> order = realization_order({output.function()}, env).first;
+
+    // Fill the cache.
+    FuncValueBounds expected = compute_function_value_bounds(order, env, true);
+
+    FuncValueBounds actual;
+    double t_cached = benchmark(3, 1, [&]() {
+        actual = compute_function_value_bounds(order, env, true);
+    });
+
+    double t_fresh = benchmark(3, 1, [&]() {
+        compute_function_value_bounds(order, env);
+    });
+
+    printf("Value bounds reused from the cache: %f ms\n"
+           "Value bounds computed from scratch: %f ms\n",
+           t_cached * 1e3, t_fresh * 1e3);
+
+    if (!same_bounds(actual, expected)) {
+        printf("Cached value bounds differ from the ones saved\n");
+        return 1;
+    }
+
+    if (t_cached > t_fresh) {
+        printf("Reusing value bounds should be faster than computing them from scratch\n");
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
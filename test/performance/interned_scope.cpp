@@ -0,0 +1,147 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace Halide;
+using namespace Halide::Internal;
+using namespace Halide::Tools;
+
+// Measure the cost of the Scope lookups a lowering pass does on every
+// Variable it visits, with names keyed by std::string and by
+// InternedName, and the time to lower a whole pipeline with the
+// simplifier's scopes keyed each way.
+
+// Names like the ones lowering makes for a pipeline with many stages.
+std::vector<std::string> make_names(int funcs) {
+    std::vector<std::string> names;
+    for (int f = 0; f < funcs; f++) {
+        const std::string func = "local_laplacian_level_" + std::to_string(f);
+        for (const char *var : {"x", "y", "c"}) {
+            for (const char *suffix : {".min", ".max", ".extent", ".loop_min", ".loop_extent"}) {
+                names.push_back(func + ".s0." + var + suffix);
+            }
+        }
+    }
+    return names;
+}
+
+// Bind every name, look each one up several times as a pass would on
+// visiting the Variables that refer to it, and unbind them again.
+template<typename ScopeT, typename Name>
+int walk(ScopeT &scope, const std::vector<Name> &names) {
+    int sum = 0;
+    for (size_t i = 0; i < names.size(); i++) {
+        scope.push(names[i], (int)i);
+    }
+    for (int rep = 0; rep < 8; rep++) {
+        for (const Name &n : names) {
+            if (scope.contains(n)) {
+                sum += scope.get(n);
+            }
+        }
+    }
+    for (size_t i = names.size(); i > 0; i--) {
+        scope.pop(names[i - 1]);
+    }
+    return sum;
+}
+
+Func make_pyramid(int levels) {
+    ImageParam input(Float(32), 2, "input");
+    Var x("x"), y("y");
+
+    Func clamped = BoundaryConditions::repeat_edge(input);
+    std::vector<Func> gaussian(levels), output(levels);
+    gaussian[0](x, y) = clamped(x, y);
+    for (int j = 1; j < levels; j++) {
+        Func down_x;
+        down_x(x, y) = (gaussian[j - 1](2 * x - 1, y) + 2.0f * gaussian[j - 1](2 * x, y) + gaussian[j - 1](2 * x + 1, y)) / 4;
+        gaussian[j](x, y) = (down_x(x, 2 * y - 1) + 2.0f * down_x(x, 2 * y) + down_x(x, 2 * y + 1)) / 4;
+    }
+    output[levels - 1](x, y) = gaussian[levels - 1](x, y);
+    for (int j = levels - 2; j >= 0; j--) {
+        Func up;
+        up(x, y) = (output[j + 1](x / 2, y / 2) + output[j + 1]((x + 1) / 2, (y + 1) / 2)) / 2;
+        output[j](x, y) = up(x, y) + gaussian[j](x, y) - gaussian[j + 1](x / 2, y / 2);
+    }
+    for (int j = 0; j < levels; j++) {
+        gaussian[j].compute_root().parallel(y, 8).vectorize(x, 8);
+        output[j].compute_root().parallel(y, 8).vectorize(x, 8);
+    }
+    return output[0];
+}
+
+void set_intern_names(bool enabled) {
+#ifdef _WIN32
+    _putenv_s("HL_INTERN_NAMES", enabled ? "1" : "0");
+#else
+    setenv("HL_INTERN_NAMES", enabled ? "1" : "0", 1);
+#endif
+}
+
+double time_lowering(bool intern_names) {
+    set_intern_names(intern_names);
+    Func pyramid = make_pyramid(8);
+    double t = benchmark(3, 1, [&]() {
+        Pipeline p(pyramid);
+        p.compile_to_module(p.infer_arguments(), "pyramid", get_host_target());
+    });
+    set_intern_names(true);
+    return t;
+}
+
+int main(int argc, char **argv) {
+    const std::vector<std::string> names = make_names(64);
+    const std::vector<InternedName> interned(names.begin(), names.end());
+
+    Scope<int> string_scope;
+    InternedScope<int> interned_scope;
+    int string_sum = 0, interned_sum = 0;
+    double t_string = benchmark([&]() { string_sum = walk(string_scope, names); });
+    double t_interned = benchmark([&]() { interned_sum = walk(interned_scope, interned); });
+    if (string_sum != interned_sum) {
+        printf("Scopes disagree: %d vs %d\n", string_sum, interned_sum);
+        return 1;
+    }
+    printf("Scope lookups with std::string names:  %f ms\n"
+           "Scope lookups with InternedName names: %f ms\n",
+           t_string * 1e3, t_interned * 1e3);
+
+    // Lower a whole pipeline with the simplifier's scopes keyed by
+    // std::string, and by interned names.
+    double t_lower_string = time_lowering(false);
+    double t_lower_interned = time_lowering(true);
+    printf("Lowering with std::string names:       %f ms\n"
+           "Lowering with InternedName names:      %f ms\n",
+           t_lower_string * 1e3, t_lower_interned * 1e3);
+
+    // Names are dropped from the table once nothing refers to them, so
+    // lowering a pipeline and throwing it away doesn't grow it.
+    size_t names_before = InternedName::table_size();
+    {
+        Func pyramid = make_pyramid(8);
+        pyramid.compile_to_module(pyramid.infer_arguments(), "pyramid", get_host_target());
+    }
+    size_t names_after = InternedName::table_size();
+    if (names_after > names_before) {
+        printf("The intern table grew from %d to %d names\n", (int)names_before, (int)names_after);
+        return 1;
+    }
+
+    if (t_interned > t_string) {
+        printf("Lookups with InternedName names should be faster\n");
+        return 1;
+    }
+
+    if (t_lower_interned > t_lower_string) {
+        fprintf(stderr, "WARNING: Lowering with InternedName names should be faster\n");
+        return 0;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
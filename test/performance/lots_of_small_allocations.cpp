@@ -12,10 +12,11 @@ int main(int argc, char **argv) {
 
     Param<int> p;
 
-    const char *names[3] = {"heap", "pseudostack", "stack"};
+    const char *names[4] = {"heap", "pooled heap", "pseudostack", "stack"};
+    enum { Heap, PooledHeap, Pseudostack, Stack };
 
-    double t[3];
-    for (int i = 0; i < 3; i++) {
+    double t[4];
+    for (int i = 0; i < 4; i++) {
         Var x("x");
 
         Func in;
@@ -35,10 +36,10 @@ int main(int argc, char **argv) {
         chain.back().split(x, xo, xi, p, TailStrategy::RoundUp);
         for (size_t j = 0; j < chain.size() - 1; j++) {
             chain[j].compute_at(chain.back(), xo);
-            if (i != 0) {
+            if (i == Pseudostack || i == Stack) {
                 chain[j].store_in(MemoryType::Stack);
             }
-            if (i == 2) {
+            if (i == Stack) {
                 chain[j].bound_extent(x, p);
             }
             // Vectorize. Otherwise llvm autovectorizes the stack version, confusing the results
@@ -48,7 +49,7 @@ int main(int argc, char **argv) {
         // they can serialize in the allocator, so we should
         // parallelize things too.
         Var xoo;
-        if (i == 2) {
+        if (i == Stack) {
             chain.back().specialize(p == 200).split(xo, xoo, xo, 100, TailStrategy::RoundUp).parallel(xoo);
             chain.back().specialize_fail("Expected p == 200");
         } else {
@@ -61,13 +62,21 @@ int main(int argc, char **argv) {
         // pseudostack, not stack to register.
         p.set(200);
 
+        // The pooled heap keeps freed allocations on free lists in
+        // the runtime, so that each tile reuses the previous tile's
+        // memory instead of going back to malloc.
+        chain.back().compile_jit();
+        Internal::JITSharedRuntime::reuse_host_allocations(i == PooledHeap);
+
         Buffer<int> out(16 * 1000 * 1000);
         t[i] = Halide::Tools::benchmark([&] { chain.back().realize(out); });
 
         printf("Time using %s: %f\n", names[i], t[i]);
     }
 
-    if (t[0] < t[1]) {
+    Internal::JITSharedRuntime::reuse_host_allocations(false);
+
+    if (t[Heap] < t[Pseudostack]) {
         printf("Heap allocation was faster than pseudostack!\n");
         return 1;
     }
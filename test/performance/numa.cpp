@@ -0,0 +1,87 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+void set_numa_policy(const char *policy) {
+    static char buf[32];
+    snprintf(buf, sizeof(buf), "HL_NUMA_POLICY=%s", policy);
+    putenv(buf);
+    Halide::Internal::JITSharedRuntime::release_all();
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    // A bandwidth-bound pipeline in the style of apps/local_laplacian:
+    // a chain of cheap stencils over large compute_root intermediates,
+    // each produced and consumed by parallel loops over the same rows.
+    const int W = 4096, H = 4096, stages = 8;
+
+    ImageParam input(Float(32), 2);
+    Var x, y;
+
+    std::vector<Func> chain;
+    Func clamped = BoundaryConditions::repeat_edge(input);
+    chain.push_back(clamped);
+    for (int i = 0; i < stages; i++) {
+        Func prev = chain.back();
+        Func f("stage_" + std::to_string(i));
+        if (i % 2 == 0) {
+            f(x, y) = (prev(x - 1, y) + 2 * prev(x, y) + prev(x + 1, y)) * 0.25f;
+        } else {
+            f(x, y) = (prev(x, y - 1) + 2 * prev(x, y) + prev(x, y + 1)) * 0.25f;
+        }
+        f.compute_root().parallel(y, 16).vectorize(x, 8);
+        chain.push_back(f);
+    }
+    Func output;
+    output(x, y) = chain.back()(x, y) - clamped(x, y);
+    output.parallel(y, 16).vectorize(x, 8);
+
+    Buffer<float> in(W, H);
+    for (int j = 0; j < H; j++) {
+        for (int i = 0; i < W; i++) {
+            in(i, j) = (float)((i * 17 + j * 13) % 256);
+        }
+    }
+    input.set(in);
+
+    Pipeline p(output);
+    Buffer<float> out(W, H), reference;
+
+    const char *policies[] = {"none", "local"};
+    double times[2];
+    for (int i = 0; i < 2; i++) {
+        set_numa_policy(policies[i]);
+        p.invalidate_cache();
+        p.compile_jit();
+        times[i] = benchmark([&]() { p.realize(out); });
+        printf("HL_NUMA_POLICY=%s: %f ms (%f GB/s)\n", policies[i], times[i] * 1e3,
+               (stages + 2) * 2.0 * W * H * sizeof(float) / times[i] * 1e-9);
+
+        if (i == 0) {
+            reference = out.copy();
+        } else {
+            for (int y = 0; y < H; y++) {
+                for (int x = 0; x < W; x++) {
+                    if (out(x, y) != reference(x, y)) {
+                        printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), reference(x, y));
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("Speedup from NUMA-local placement: %f\n", times[0] / times[1]);
+
+    printf("Success!\n");
+    return 0;
+}
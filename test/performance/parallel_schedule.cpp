@@ -0,0 +1,72 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+#define W 64
+#define H 2048
+
+// A pipeline whose rows vary wildly in cost: every 256th block of 32
+// rows is 64 times more expensive than the rest, so an even division
+// of the rows among threads leaves most of them idle.
+Func make_pipeline(ParallelSchedule schedule, int grain) {
+    Func f("f");
+    Var x("x"), y("y");
+
+    RDom r(0, 256);
+    r.where(r < select(y % 256 < 32, 256, 4));
+    f(x, y) = cast<float>(x + y);
+    f(x, y) = sin(f(x, y) + cast<float>(r));
+
+    f.parallel(y, schedule, grain);
+    f.update().parallel(y, schedule, grain);
+    return f;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    Buffer<float> correct = make_pipeline(ParallelSchedule::Default, 1).realize({W, H});
+
+    struct {
+        const char *name;
+        ParallelSchedule schedule;
+        int grain;
+        double time;
+    } tests[] = {
+        {"default", ParallelSchedule::Default, 1, 0},
+        {"dynamic", ParallelSchedule::Dynamic, 4, 0},
+        {"guided", ParallelSchedule::Guided, 2, 0},
+    };
+
+    for (auto &t : tests) {
+        Func f = make_pipeline(t.schedule, t.grain);
+        f.compile_jit();
+        Buffer<float> result(W, H);
+        t.time = benchmark([&]() { f.realize(result); });
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                if (result(x, y) != correct(x, y)) {
+                    printf("%s: result(%d, %d) = %f instead of %f\n",
+                           t.name, x, y, result(x, y), correct(x, y));
+                    return 1;
+                }
+            }
+        }
+        printf("%s: %f ms\n", t.name, t.time * 1e3);
+    }
+
+    if (tests[1].time > tests[0].time || tests[2].time > tests[0].time) {
+        fprintf(stderr, "WARNING: Dynamic and guided schedules should balance the load better than the default\n");
+        return 0;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
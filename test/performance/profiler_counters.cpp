@@ -0,0 +1,96 @@
+#include "Halide.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace Halide;
+
+float compute_ipc = -1, compute_mpki = -1;
+float gather_ipc = -1, gather_mpki = -1;
+
+void my_print(JITUserContext *, const char *msg) {
+    // Per-Func lines end with e.g. "ipc: 1.52 llc-mpki: 0.03 br-mpki: 0.01"
+    const char *counters = strstr(msg, " ipc: ");
+    if (!counters) {
+        return;
+    }
+    float ipc, mpki;
+    if (sscanf(counters, " ipc: %f llc-mpki: %f", &ipc, &mpki) != 2) {
+        return;
+    }
+    if (strstr(msg, " compute_bound: ")) {
+        compute_ipc = ipc;
+        compute_mpki = mpki;
+    } else if (strstr(msg, " memory_bound: ")) {
+        gather_ipc = ipc;
+        gather_mpki = mpki;
+    }
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+    if (target.os != Target::Linux || target.arch != Target::X86) {
+        printf("[SKIP] Hardware performance counters are only supported on x86 Linux.\n");
+        return 0;
+    }
+
+    // Must be set before the first profiled pipeline starts the
+    // sampling thread.
+    static char env[] = "HL_PROFILER_COUNTERS=1";
+    putenv(env);
+
+    // A table much larger than the last-level cache.
+    const int table_size = 1 << 24;
+    Buffer<int> table(table_size);
+    table.fill(1);
+
+    const int N = 1 << 22;
+    Var x;
+
+    // Lots of arithmetic on values in registers.
+    Func compute_bound("compute_bound");
+    Expr e = cast<float>(x);
+    for (int i = 0; i < 100; i++) {
+        e = e * 0.999f + 1.0f;
+    }
+    compute_bound(x) = cast<int>(e);
+    compute_bound.compute_root().vectorize(x, 8).parallel(x, 1 << 16);
+
+    // Random accesses into the table.
+    Func memory_bound("memory_bound");
+    Expr idx = cast<uint32_t>(x) * Internal::make_const(UInt(32), 2654435761U);
+    memory_bound(x) = table(cast<int>(idx % table_size));
+    memory_bound.compute_root().parallel(x, 1 << 16);
+
+    // Both are computed by all the threads of the thread pool, so each
+    // worker's counters must be billed to the Func that worker runs,
+    // not just those of the thread holding the sampling token.
+    Func out;
+    out(x) = compute_bound(x) + memory_bound(x);
+    out.jit_handlers().custom_print = my_print;
+
+    out.realize({N}, target.with_feature(Target::Profile));
+
+    if (compute_ipc < 0 || gather_ipc < 0) {
+        printf("[SKIP] Hardware performance counters are not available.\n");
+        return 0;
+    }
+
+    printf("compute_bound: ipc %f, LLC misses per 1000 instructions %f\n", compute_ipc, compute_mpki);
+    printf("memory_bound: ipc %f, LLC misses per 1000 instructions %f\n", gather_ipc, gather_mpki);
+
+    if (gather_mpki <= compute_mpki) {
+        printf("The random gather should miss in the cache more often than the arithmetic\n");
+        return 1;
+    }
+    if (gather_ipc >= compute_ipc) {
+        printf("The random gather should retire fewer instructions per cycle than the arithmetic\n");
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
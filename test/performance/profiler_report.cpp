@@ -0,0 +1,116 @@
+#include "Halide.h"
+#include "halide_profile_report.h"
+#include <cstdio>
+#include <string>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// The report may be printed in several pieces, so accumulate them.
+std::string report;
+void my_print(JITUserContext *, const char *msg) {
+    report += msg;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    Var x, y;
+    Func cheap("cheap"), expensive("expensive"), out("out");
+    cheap(x, y) = cast<float>(x + y);
+    Expr e = cheap(x, y);
+    for (int i = 0; i < 200; i++) {
+        e = sin(e);
+    }
+    expensive(x, y) = e;
+    out(x, y) = expensive(x, y) + cheap(x, y);
+    cheap.compute_root();
+    expensive.compute_root().parallel(y);
+    out.jit_handlers().custom_print = my_print;
+
+    Pipeline p(out);
+    p.compile_jit(target.with_feature(Target::Profile));
+
+    // The format is read each time a report is printed.
+    static char json_env[] = "HL_PROFILER_REPORT_FORMAT=json";
+    putenv(json_env);
+    p.realize({1000, 1000});
+
+    ProfileReport base;
+    if (!parse_profile_report(report, &base)) {
+        printf("Could not parse JSON profiler report:\n%s\n", report.c_str());
+        return 1;
+    }
+    if (base.pipelines.size() != 1 || base.pipelines[0].runs != 1) {
+        printf("Expected a report of one pipeline run once:\n%s\n", report.c_str());
+        return 1;
+    }
+    const ProfilePipelineStats &ps = base.pipelines[0];
+    const ProfileFuncStats *cheap_stats = ps.find_func("cheap");
+    const ProfileFuncStats *expensive_stats = ps.find_func("expensive");
+    if (!cheap_stats || !expensive_stats) {
+        printf("Report is missing Funcs:\n%s\n", report.c_str());
+        return 1;
+    }
+    printf("cheap: %llu ns, expensive: %llu ns, pipeline: %llu ns\n",
+           (unsigned long long)cheap_stats->time_ns,
+           (unsigned long long)expensive_stats->time_ns,
+           (unsigned long long)ps.time_ns);
+    if (expensive_stats->time_ns <= cheap_stats->time_ns ||
+        expensive_stats->time_ns > ps.time_ns) {
+        printf("Unexpected times in report:\n%s\n", report.c_str());
+        return 1;
+    }
+    if (cheap_stats->memory_peak < 1000 * 1000 * sizeof(float) ||
+        cheap_stats->num_allocs != 1) {
+        printf("Unexpected allocations in report:\n%s\n", report.c_str());
+        return 1;
+    }
+
+    // A report doesn't differ from itself, but does from a copy in
+    // which one Func got twice as slow.
+    if (!diff_profiles(base, base).empty()) {
+        printf("Diffing a report against itself found changes\n");
+        return 1;
+    }
+    ProfileReport slower = base;
+    for (auto &f : slower.pipelines[0].funcs) {
+        if (f.name == "expensive") {
+            slower.pipelines[0].time_ns += f.time_ns;
+            f.time_ns *= 2;
+        }
+    }
+    bool found_regression = false;
+    for (const auto &c : diff_profiles(base, slower)) {
+        if (!c.is_regression()) {
+            printf("Unexpected improvement in %s %s\n", c.func.c_str(), c.metric.c_str());
+            return 1;
+        }
+        found_regression |= (c.func == "expensive" && c.metric == "time_per_run_ns");
+    }
+    if (!found_regression) {
+        printf("Diff did not find the regression in expensive\n");
+        return 1;
+    }
+
+    static char csv_env[] = "HL_PROFILER_REPORT_FORMAT=csv";
+    putenv(csv_env);
+    report.clear();
+    p.realize({1000, 1000});
+    int lines = 0;
+    for (char c : report) {
+        lines += (c == '\n');
+    }
+    // A header, a row for the pipeline, and a row per Func.
+    if (report.rfind("pipeline,func,", 0) != 0 || lines != 2 + (int)ps.funcs.size()) {
+        printf("Unexpected CSV profiler report:\n%s\n", report.c_str());
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+
+// The generators from two of the apps with the largest lowered IR.
+#include "../../apps/camera_pipe/camera_pipe_generator.cpp"
+#include "../../apps/local_laplacian/local_laplacian_generator.cpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace Halide;
+using namespace Halide::Internal;
+using namespace Halide::Tools;
+
+// Measure the time to lower the camera_pipe and local_laplacian
+// generators with and without the simplifier's memoization of shared
+// subexpressions.
+
+void set_simplify_memo(bool enabled) {
+#ifdef _WIN32
+    _putenv_s("HL_SIMPLIFY_MEMO", enabled ? "1" : "0");
+#else
+    setenv("HL_SIMPLIFY_MEMO", enabled ? "1" : "0", 1);
+#endif
+}
+
+double time_lowering(const std::string &generator, bool memo) {
+    set_simplify_memo(memo);
+    const GeneratorContext context(get_host_target());
+    double t = benchmark(3, 1, [&]() {
+        auto gen = GeneratorRegistry::create(generator, context);
+        gen->build_module(generator);
+    });
+    set_simplify_memo(true);
+    return t;
+}
+
+int main(int argc, char **argv) {
+    bool faster = true;
+    for (const char *generator : {"camera_pipe", "local_laplacian"}) {
+        double t_without = time_lowering(generator, false);
+        double t_with = time_lowering(generator, true);
+        printf("%s: %f ms without the simplifier memo, %f ms with it\n",
+               generator, t_without * 1e3, t_with * 1e3);
+        faster = faster && t_with <= t_without;
+    }
+
+    if (!faster) {
+        fprintf(stderr, "WARNING: Memoizing shared subexpressions should make lowering faster\n");
+        return 0;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Must match MAX_THREADS in src/runtime/posix_threads.cpp
+const int max_threads = 256;
+
+void set_num_threads(int t) {
+    static char buf[32];
+    snprintf(buf, sizeof(buf), "HL_NUM_THREADS=%d", t);
+    putenv(buf);
+    Halide::Internal::JITSharedRuntime::release_all();
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    const int W = 256, H = 4096;
+
+    // A flat parallel loop with many cheap iterations. This stresses
+    // the cost of handing out iterations to workers.
+    Func flat;
+    Var x, y, yo, yi;
+    flat(x, y) = sqrt(cast<float>(x * y));
+    flat.parallel(y);
+
+    // Nested parallel loops of uneven cost. Workers that finish their
+    // share of the outer loop early must find work elsewhere.
+    Func nested, cost;
+    Expr math = cast<float>(x + y);
+    for (int i = 0; i < 10; i++) {
+        math = sin(math) * select(y % 8 == 0, 2.0f, 1.0f);
+    }
+    cost(x, y) = math;
+    nested(x, y) = cost(x, y) + cost(x + 1, y);
+    nested.split(y, yo, yi, 64).parallel(yo);
+    cost.compute_at(nested, yo).parallel(y);
+
+    Pipeline flat_p(flat), nested_p(nested);
+    Buffer<float> flat_out(W, H), nested_out(W, H);
+    Buffer<float> flat_ref, nested_ref;
+
+    printf("threads  flat (Mpix/s)  nested (Mpix/s)\n");
+    for (int t = 1; t <= max_threads; t *= 2) {
+        set_num_threads(t);
+        flat_p.invalidate_cache();
+        nested_p.invalidate_cache();
+        flat_p.compile_jit();
+        nested_p.compile_jit();
+
+        double flat_time = benchmark([&]() { flat_p.realize(flat_out); });
+        double nested_time = benchmark([&]() { nested_p.realize(nested_out); });
+
+        printf("%7d  %13.2f  %15.2f\n", t,
+               W * H / flat_time * 1e-6,
+               W * H / nested_time * 1e-6);
+
+        // The output must not depend on the number of threads.
+        if (t == 1) {
+            flat_ref = flat_out.copy();
+            nested_ref = nested_out.copy();
+        } else {
+            for (int j = 0; j < H; j++) {
+                for (int i = 0; i < W; i++) {
+                    if (flat_out(i, j) != flat_ref(i, j) ||
+                        nested_out(i, j) != nested_ref(i, j)) {
+                        printf("Output mismatch at %d, %d with %d threads\n", i, j, t);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+#define W 4096
+#define H 4096
+
+// A large intermediate that is produced in tiles and consumed
+// transposed, one tile at a time. With the default strided layout,
+// each tile of the intermediate touches a different page per row.
+Func make_pipeline(bool tiled) {
+    Func g("g"), f("f");
+    Var x("x"), y("y"), xi("xi"), yi("yi");
+
+    g(x, y) = sqrt(cast<float>(x * 3 + y));
+    f(x, y) = g(y, x) * 2.0f + 1.0f;
+
+    f.tile(x, y, xi, yi, 32, 32).vectorize(xi, 8).parallel(y);
+    g.compute_root()
+        .align_bounds(x, 32)
+        .align_bounds(y, 32)
+        .tile(x, y, xi, yi, 32, 32)
+        .vectorize(xi, 8)
+        .parallel(y);
+    if (tiled) {
+        g.tile_storage(x, y, 32, 32);
+    }
+    return f;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    double times[2];
+    Buffer<float> results[2];
+    for (int tiled = 0; tiled < 2; tiled++) {
+        Func f = make_pipeline(tiled);
+        f.compile_jit();
+        results[tiled] = Buffer<float>(W, H);
+        times[tiled] = benchmark([&]() { f.realize(results[tiled]); });
+        printf("%s storage: %f ms\n", tiled ? "tiled" : "strided", times[tiled] * 1e3);
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (results[0](x, y) != results[1](x, y)) {
+                printf("results differ at (%d, %d): %f vs %f\n",
+                       x, y, results[0](x, y), results[1](x, y));
+                return 1;
+            }
+        }
+    }
+
+    if (times[1] > times[0]) {
+        fprintf(stderr, "WARNING: Tiled storage should be faster than strided storage for tiled, transposed access\n");
+        return 0;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include "halide_test_dirs.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Tracing settings are read once per runtime, so drop the JIT runtime
+// (which also flushes and closes any open trace file) after changing
+// them.
+void set_trace_env(const char *file, const char *mode) {
+    static char file_buf[1024], mode_buf[32];
+    snprintf(file_buf, sizeof(file_buf), "HL_TRACE_FILE=%s", file);
+    snprintf(mode_buf, sizeof(mode_buf), "HL_TRACE_MODE=%s", mode);
+    putenv(file_buf);
+    putenv(mode_buf);
+    Halide::Internal::JITSharedRuntime::release_all();
+}
+
+std::vector<uint8_t> read_file(const std::string &name) {
+    std::vector<uint8_t> data;
+    FILE *f = fopen(name.c_str(), "rb");
+    if (!f) {
+        return data;
+    }
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        data.insert(data.end(), buf, buf + n);
+    }
+    fclose(f);
+    return data;
+}
+
+uint32_t read_u32(const std::vector<uint8_t> &data, size_t pos) {
+    uint32_t v;
+    memcpy(&v, data.data() + pos, sizeof(v));
+    return v;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    const int W = 1024, H = 1024;
+
+    Var x, y;
+    Func f("f"), g("g");
+    f(x, y) = x * 3 + y;
+    f.compute_root().parallel(y);
+    g(x, y) = f(x, y) + f(x + 1, y);
+    g.parallel(y);
+    f.trace_stores().trace_realizations();
+    g.trace_stores().trace_realizations();
+
+    Pipeline p(g);
+    Buffer<int> out(W, H);
+
+    std::string packet_file = Internal::get_test_tmp_dir() + "tracing_ring_buffer_packets.bin";
+    std::string ring_file = Internal::get_test_tmp_dir() + "tracing_ring_buffer_ring.bin";
+    Internal::ensure_no_file_exists(packet_file);
+    Internal::ensure_no_file_exists(ring_file);
+
+    set_trace_env(packet_file.c_str(), "packet");
+    p.compile_jit();
+    double packet_time = benchmark(1, 1, [&]() { p.realize(out); });
+
+    set_trace_env(ring_file.c_str(), "ring");
+    p.invalidate_cache();
+    p.compile_jit();
+    double ring_time = benchmark(1, 1, [&]() { p.realize(out); });
+    Halide::Internal::JITSharedRuntime::release_all();
+
+    std::vector<uint8_t> packets = read_file(packet_file);
+    std::vector<uint8_t> ring = read_file(ring_file);
+
+    // Count the events in each file. Ordinary packets start with their
+    // size; ring-buffer chunks start with a magic number, their payload
+    // size, and their record count.
+    size_t packet_count = 0, record_count = 0;
+    for (size_t pos = 0; pos + 4 <= packets.size(); pos += read_u32(packets, pos)) {
+        packet_count++;
+    }
+    for (size_t pos = 0; pos + 16 <= ring.size(); pos += 16 + read_u32(ring, pos + 4)) {
+        if (read_u32(ring, pos) != 0x544c487f) {
+            printf("Bad chunk header at offset %d in ring-buffer trace\n", (int)pos);
+            return 1;
+        }
+        record_count += read_u32(ring, pos + 8);
+    }
+
+    printf("Packet trace: %f ms, %d bytes, %d events\n", packet_time * 1e3, (int)packets.size(), (int)packet_count);
+    printf("Ring-buffer trace: %f ms, %d bytes, %d events\n", ring_time * 1e3, (int)ring.size(), (int)record_count);
+
+    if (packet_count == 0 || record_count != packet_count) {
+        printf("Expected both traces to contain the same events\n");
+        return 1;
+    }
+
+    if (ring.size() >= packets.size()) {
+        printf("Ring-buffer trace should be smaller than the packet trace\n");
+        return 1;
+    }
+
+    printf("Speedup from ring-buffer tracing: %f\n", packet_time / ring_time);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -130,6 +130,51 @@ int main(int argc, char **argv) {
         HALIDE_CHECK(user_context, get_allocated_system_memory() == 0);
     }
 
+    // reclaimed regions keep their bounds
+    {
+        BlockAllocator::Config config = {0};
+        config.minimum_block_size = 1024;
+
+        BlockAllocator::MemoryAllocators allocators = {system_allocator, block_allocator, region_allocator};
+        BlockAllocator *instance = BlockAllocator::create(user_context, config, allocators);
+
+        MemoryRequest request = {0};
+        request.size = 256;
+        request.alignment = sizeof(int);
+        request.properties.alignment = sizeof(int);
+        request.properties.visibility = MemoryVisibility::DefaultVisibility;
+        request.properties.caching = MemoryCaching::DefaultCaching;
+        request.properties.usage = MemoryUsage::DefaultUsage;
+
+        MemoryRegion *r1 = instance->reserve(user_context, request);
+        MemoryRegion *r2 = instance->reserve(user_context, request);
+        MemoryRegion *r3 = instance->reserve(user_context, request);
+        HALIDE_CHECK(user_context, r1 != nullptr && r2 != nullptr && r3 != nullptr);
+        HALIDE_CHECK(user_context, allocated_block_memory == config.minimum_block_size);
+        size_t r2_offset = r2->offset;
+
+        // Reserving again after freeing the middle region must reuse the
+        // same range, rather than losing it or overlapping r1 or r3.
+        instance->reclaim(user_context, r2);
+        MemoryRegion *r4 = instance->reserve(user_context, request);
+        HALIDE_CHECK(user_context, r4 != nullptr);
+        HALIDE_CHECK(user_context, allocated_block_memory == config.minimum_block_size);
+        HALIDE_CHECK(user_context, r4->offset == r2_offset);
+        HALIDE_CHECK(user_context, r4->offset >= r1->offset + r1->size);
+        HALIDE_CHECK(user_context, r4->offset + r4->size <= r3->offset);
+
+        instance->reclaim(user_context, r1);
+        instance->reclaim(user_context, r3);
+        instance->reclaim(user_context, r4);
+        HALIDE_CHECK(user_context, allocated_region_memory == 0);
+
+        instance->destroy(user_context);
+        HALIDE_CHECK(user_context, allocated_block_memory == 0);
+
+        BlockAllocator::destroy(user_context, instance);
+        HALIDE_CHECK(user_context, get_allocated_system_memory() == 0);
+    }
+
     // allocation stress test
     {
         BlockAllocator::Config config = {0};
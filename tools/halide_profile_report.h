@@ -0,0 +1,400 @@
+#ifndef HALIDE_PROFILE_REPORT_H
+#define HALIDE_PROFILE_REPORT_H
+
+/** \file
+ * Utilities for working with the structured reports produced by the
+ * Halide profiler: reading the JSON format written when
+ * HL_PROFILER_REPORT_FORMAT=json, taking a snapshot of the live
+ * profiler state of an AOT-compiled program, and diffing two
+ * reports to find regressions.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "HalideRuntime.h"
+
+namespace Halide {
+namespace Tools {
+
+/** The statistics common to a pipeline and to each of its Funcs. */
+struct ProfileStats {
+    std::string name;
+    uint64_t time_ns = 0;
+    uint64_t memory_current = 0;
+    uint64_t memory_peak = 0;
+    uint64_t memory_total = 0;
+    uint64_t num_allocs = 0;
+    double active_threads = 0;
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cache_misses = 0;
+    uint64_t branch_misses = 0;
+};
+
+/** The statistics for one Func, as in halide_profiler_func_stats. */
+struct ProfileFuncStats : public ProfileStats {
+    uint64_t stack_peak = 0;
+};
+
+/** The statistics for one pipeline, as in
+ * halide_profiler_pipeline_stats. */
+struct ProfilePipelineStats : public ProfileStats {
+    uint64_t runs = 0;
+    uint64_t samples = 0;
+    std::vector<ProfileFuncStats> funcs;
+
+    const ProfileFuncStats *find_func(const std::string &func_name) const {
+        for (const auto &f : funcs) {
+            if (f.name == func_name) {
+                return &f;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/** Everything the profiler knew about at the time of one report. */
+struct ProfileReport {
+    std::vector<ProfilePipelineStats> pipelines;
+
+    const ProfilePipelineStats *find_pipeline(const std::string &pipeline_name) const {
+        for (const auto &p : pipelines) {
+            if (p.name == pipeline_name) {
+                return &p;
+            }
+        }
+        return nullptr;
+    }
+};
+
+namespace Internal {
+
+/** Just enough of a JSON reader to read the reports written by the
+ * runtime. Unknown keys are skipped, so that fields can be added to
+ * the format without breaking older readers. */
+class ProfileReportParser {
+    const char *p, *end;
+
+    void skip_space() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            p++;
+        }
+    }
+
+    bool consume(char c) {
+        skip_space();
+        if (p < end && *p == c) {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    bool parse_string(std::string *out) {
+        if (!consume('"')) {
+            return false;
+        }
+        out->clear();
+        while (p < end && *p != '"') {
+            if (*p == '\\') {
+                if (++p == end) {
+                    return false;
+                }
+                switch (*p) {
+                case 'n':
+                    *out += '\n';
+                    break;
+                case 't':
+                    *out += '\t';
+                    break;
+                default:
+                    *out += *p;
+                }
+            } else {
+                *out += *p;
+            }
+            p++;
+        }
+        return consume('"');
+    }
+
+    bool parse_number(uint64_t *u, double *d) {
+        skip_space();
+        const char *start = p;
+        while (p < end && ((*p && strchr("+-.eE", *p)) || (*p >= '0' && *p <= '9'))) {
+            p++;
+        }
+        if (p == start) {
+            return false;
+        }
+        std::string token(start, p);
+        *d = strtod(token.c_str(), nullptr);
+        if (token.find_first_of("-.eE") == std::string::npos) {
+            *u = strtoull(token.c_str(), nullptr, 10);
+        } else {
+            *u = *d > 0 ? (uint64_t)*d : 0;
+        }
+        return true;
+    }
+
+    bool skip_value() {
+        skip_space();
+        if (p == end) {
+            return false;
+        } else if (*p == '"') {
+            std::string ignored;
+            return parse_string(&ignored);
+        } else if (*p == '{') {
+            return parse_object([&](const std::string &) { return skip_value(); });
+        } else if (*p == '[') {
+            return parse_array([&]() { return skip_value(); });
+        } else if (*p == 't' || *p == 'f' || *p == 'n') {
+            while (p < end && *p >= 'a' && *p <= 'z') {
+                p++;
+            }
+            return true;
+        } else {
+            uint64_t u;
+            double d;
+            return parse_number(&u, &d);
+        }
+    }
+
+    bool parse_object(const std::function<bool(const std::string &)> &parse_member) {
+        if (!consume('{')) {
+            return false;
+        }
+        if (consume('}')) {
+            return true;
+        }
+        do {
+            std::string key;
+            if (!parse_string(&key) || !consume(':') || !parse_member(key)) {
+                return false;
+            }
+        } while (consume(','));
+        return consume('}');
+    }
+
+    bool parse_array(const std::function<bool()> &parse_element) {
+        if (!consume('[')) {
+            return false;
+        }
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            if (!parse_element()) {
+                return false;
+            }
+        } while (consume(','));
+        return consume(']');
+    }
+
+    bool parse_stats_member(const std::string &key, ProfileStats *s, uint64_t *other) {
+        if (key == "name") {
+            return parse_string(&s->name);
+        }
+        uint64_t u = 0;
+        double d = 0;
+        uint64_t *fields[] = {&s->time_ns, &s->memory_current, &s->memory_peak, &s->memory_total,
+                              &s->num_allocs, &s->cycles, &s->instructions, &s->cache_misses,
+                              &s->branch_misses};
+        const char *names[] = {"time_ns", "memory_current", "memory_peak", "memory_total",
+                               "num_allocs", "cycles", "instructions", "cache_misses",
+                               "branch_misses"};
+        skip_space();
+        if (p == end || (*p != '-' && (*p < '0' || *p > '9'))) {
+            return skip_value();
+        }
+        if (!parse_number(&u, &d)) {
+            return false;
+        }
+        if (key == "active_threads") {
+            s->active_threads = d;
+        } else {
+            for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+                if (key == names[i]) {
+                    *fields[i] = u;
+                    return true;
+                }
+            }
+            if (other) {
+                *other = u;
+            }
+        }
+        return true;
+    }
+
+    bool parse_func(ProfileFuncStats *f) {
+        return parse_object([&](const std::string &key) {
+            return parse_stats_member(key, f, key == "stack_peak" ? &f->stack_peak : nullptr);
+        });
+    }
+
+    bool parse_pipeline(ProfilePipelineStats *ps) {
+        return parse_object([&](const std::string &key) {
+            if (key == "funcs") {
+                return parse_array([&]() {
+                    ps->funcs.emplace_back();
+                    return parse_func(&ps->funcs.back());
+                });
+            }
+            uint64_t *other = key == "runs"    ? &ps->runs :
+                              key == "samples" ? &ps->samples :
+                                                 nullptr;
+            return parse_stats_member(key, ps, other);
+        });
+    }
+
+public:
+    ProfileReportParser(const char *begin, const char *end)
+        : p(begin), end(end) {
+    }
+
+    bool parse(ProfileReport *report) {
+        bool ok = parse_object([&](const std::string &key) {
+            if (key == "pipelines") {
+                return parse_array([&]() {
+                    report->pipelines.emplace_back();
+                    return parse_pipeline(&report->pipelines.back());
+                });
+            }
+            return skip_value();
+        });
+        skip_space();
+        return ok && p == end;
+    }
+};
+
+}  // namespace Internal
+
+/** Parse one report in the format written by the profiler when
+ * HL_PROFILER_REPORT_FORMAT=json (one line of a report file). Returns
+ * false if the text is not a well-formed report. */
+inline bool parse_profile_report(const std::string &json, ProfileReport *report) {
+    *report = ProfileReport();
+    Internal::ProfileReportParser parser(json.data(), json.data() + json.size());
+    return parser.parse(report);
+}
+
+/** Copy the statistics out of the profiler state of the runtime this
+ * program is linked against. Only meaningful in programs that link
+ * AOT-compiled pipelines built with the profile feature; under JIT
+ * compilation the profiler state lives in the JIT runtime, so set
+ * HL_PROFILER_REPORT_FORMAT=json and parse the printed report
+ * instead. */
+inline ProfileReport profile_snapshot() {
+    ProfileReport report;
+    halide_profiler_state *s = halide_profiler_get_state();
+    halide_mutex_lock(&s->lock);
+    for (halide_profiler_pipeline_stats *p = s->pipelines; p;
+         p = (halide_profiler_pipeline_stats *)p->next) {
+        if (!p->runs) {
+            continue;
+        }
+        auto copy_stats = [](const auto *from, ProfileStats *to) {
+            to->name = from->name;
+            to->time_ns = from->time;
+            to->memory_current = from->memory_current;
+            to->memory_peak = from->memory_peak;
+            to->memory_total = from->memory_total;
+            to->num_allocs = from->num_allocs;
+            to->active_threads = from->active_threads_denominator ?
+                                     (double)from->active_threads_numerator / from->active_threads_denominator :
+                                     0.0;
+            to->cycles = from->cycles;
+            to->instructions = from->instructions;
+            to->cache_misses = from->cache_misses;
+            to->branch_misses = from->branch_misses;
+        };
+        ProfilePipelineStats ps;
+        copy_stats(p, &ps);
+        ps.runs = p->runs;
+        ps.samples = p->samples;
+        for (int i = 0; i < p->num_funcs; i++) {
+            ProfileFuncStats fs;
+            copy_stats(p->funcs + i, &fs);
+            fs.stack_peak = p->funcs[i].stack_peak;
+            ps.funcs.push_back(fs);
+        }
+        report.pipelines.push_back(ps);
+    }
+    halide_mutex_unlock(&s->lock);
+    return report;
+}
+
+/** A metric that changed by more than the threshold given to
+ * diff_profiles. */
+struct ProfileChange {
+    std::string pipeline;
+    /** Empty for a change in the pipeline as a whole. */
+    std::string func;
+    /** "time_per_run_ns" or "memory_peak". */
+    std::string metric;
+    double base = 0, current = 0;
+
+    bool is_regression() const {
+        return current > base;
+    }
+};
+
+/** Compare every pipeline and Func present in both reports. Time is
+ * compared per run, so reports covering different numbers of runs
+ * can be compared. A metric is reported if it changed by more than
+ * the given fraction of its base value. Times below min_time_ns in
+ * both reports are ignored, because the sampling profiler cannot
+ * measure them reliably. */
+inline std::vector<ProfileChange> diff_profiles(const ProfileReport &base,
+                                                const ProfileReport &current,
+                                                double threshold = 0.1,
+                                                double min_time_ns = 0) {
+    std::vector<ProfileChange> changes;
+    auto compare = [&](const std::string &pipeline, const std::string &func,
+                       const char *metric, double b, double c, double floor) {
+        if (b < floor && c < floor) {
+            return;
+        }
+        double delta = c > b ? c - b : b - c;
+        if (delta > b * threshold && delta > 0) {
+            ProfileChange change;
+            change.pipeline = pipeline;
+            change.func = func;
+            change.metric = metric;
+            change.base = b;
+            change.current = c;
+            changes.push_back(change);
+        }
+    };
+    for (const auto &cp : current.pipelines) {
+        const ProfilePipelineStats *bp = base.find_pipeline(cp.name);
+        if (!bp || !bp->runs || !cp.runs) {
+            continue;
+        }
+        compare(cp.name, "", "time_per_run_ns",
+                (double)bp->time_ns / bp->runs, (double)cp.time_ns / cp.runs, min_time_ns);
+        compare(cp.name, "", "memory_peak",
+                (double)bp->memory_peak, (double)cp.memory_peak, 0);
+        for (const auto &cf : cp.funcs) {
+            const ProfileFuncStats *bf = bp->find_func(cf.name);
+            if (!bf) {
+                continue;
+            }
+            compare(cp.name, cf.name, "time_per_run_ns",
+                    (double)bf->time_ns / bp->runs, (double)cf.time_ns / cp.runs, min_time_ns);
+            compare(cp.name, cf.name, "memory_peak",
+                    (double)bf->memory_peak, (double)cf.memory_peak, 0);
+        }
+    }
+    return changes;
+}
+
+}  // namespace Tools
+}  // namespace Halide
+
+#endif  // HALIDE_PROFILE_REPORT_H
@@ -0,0 +1,249 @@
+#include "halide_profile_report.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** \file
+ *
+ * A tool which merges the JSON reports written by the Halide profiler
+ * (with HL_PROFILER_REPORT_FORMAT=json, usually appended to a file
+ * named by HL_PROFILER_REPORT_FILE) from many runs, and possibly many
+ * machines, and prints percentiles of each statistic for every
+ * pipeline and Func. It can also diff two reports and exit with a
+ * nonzero status if anything regressed, for use in continuous
+ * integration.
+ */
+
+using namespace Halide::Tools;
+
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+// The statistics aggregated for each pipeline and Func, in output
+// order.
+const char *const metric_names[] = {
+    "time_per_run_ns",
+    "memory_peak",
+    "num_allocs_per_run",
+    "stack_peak",
+    "active_threads",
+};
+constexpr int num_metrics = sizeof(metric_names) / sizeof(metric_names[0]);
+
+struct Samples {
+    vector<double> values[num_metrics];
+};
+
+void add_samples(Samples *s, const ProfileStats &stats, uint64_t runs, uint64_t stack_peak) {
+    s->values[0].push_back((double)stats.time_ns / runs);
+    s->values[1].push_back((double)stats.memory_peak);
+    s->values[2].push_back((double)stats.num_allocs / runs);
+    s->values[3].push_back((double)stack_peak);
+    s->values[4].push_back(stats.active_threads);
+}
+
+// Nearest-rank percentile of sorted values.
+double percentile(const vector<double> &sorted, double p) {
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+bool read_reports(const string &filename, vector<ProfileReport> *reports) {
+    std::ifstream in(filename);
+    if (!in) {
+        fprintf(stderr, "Error: could not open %s\n", filename.c_str());
+        return false;
+    }
+    string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        if (line.empty()) {
+            continue;
+        }
+        ProfileReport report;
+        if (!parse_profile_report(line, &report)) {
+            fprintf(stderr, "Error: %s:%d is not a profiler report\n", filename.c_str(), line_number);
+            return false;
+        }
+        reports->push_back(std::move(report));
+    }
+    return true;
+}
+
+template<typename T>
+T *find_or_add(vector<T> *v, const string &name) {
+    for (auto &t : *v) {
+        if (t.name == name) {
+            return &t;
+        }
+    }
+    v->emplace_back();
+    v->back().name = name;
+    return &v->back();
+}
+
+// Sum several reports into one, as if the runs they describe had all
+// happened in a single process.
+ProfileReport merge_reports(const vector<ProfileReport> &reports) {
+    ProfileReport merged;
+    auto add_stats = [](ProfileStats *to, const ProfileStats &from) {
+        to->time_ns += from.time_ns;
+        to->memory_peak = std::max(to->memory_peak, from.memory_peak);
+        to->memory_total += from.memory_total;
+        to->num_allocs += from.num_allocs;
+    };
+    for (const auto &r : reports) {
+        for (const auto &p : r.pipelines) {
+            ProfilePipelineStats *mp = find_or_add(&merged.pipelines, p.name);
+            add_stats(mp, p);
+            mp->runs += p.runs;
+            mp->samples += p.samples;
+            for (const auto &f : p.funcs) {
+                ProfileFuncStats *mf = find_or_add(&mp->funcs, f.name);
+                add_stats(mf, f);
+                mf->stack_peak = std::max(mf->stack_peak, f.stack_peak);
+            }
+        }
+    }
+    return merged;
+}
+
+int diff(const string &base_file, const string &current_file, double threshold, double min_time_ns) {
+    vector<ProfileReport> base, current;
+    if (!read_reports(base_file, &base) || !read_reports(current_file, &current)) {
+        return 2;
+    }
+    vector<ProfileChange> changes =
+        diff_profiles(merge_reports(base), merge_reports(current), threshold, min_time_ns);
+    int regressions = 0;
+    for (const auto &c : changes) {
+        printf("%s %s%s%s %s: %.0f -> %.0f (%+.1f%%)\n",
+               c.is_regression() ? "REGRESSION" : "improvement",
+               c.pipeline.c_str(), c.func.empty() ? "" : "/", c.func.c_str(),
+               c.metric.c_str(), c.base, c.current,
+               c.base > 0 ? 100.0 * (c.current - c.base) / c.base : 100.0);
+        regressions += c.is_regression();
+    }
+    return regressions ? 1 : 0;
+}
+
+void usage(char *const *argv) {
+    const string usage =
+        "Usage: " + string(argv[0]) + " [-json] report_file...\n"
+        "       " + string(argv[0]) + " -diff base_file new_file [-threshold fraction] [-min_time ns]\n"
+        "\n"
+        "Reads reports written by the Halide profiler with HL_PROFILER_REPORT_FORMAT=json,\n"
+        "one per line. With a list of files, prints the count, min, p50, p90, p99 and max\n"
+        "over all reports of each statistic of every pipeline and Func, as CSV or JSON.\n"
+        "Times and allocation counts are per run.\n"
+        "\n"
+        "With -diff, sums the reports in each file and prints every statistic that changed\n"
+        "by more than the threshold (default 0.1), ignoring times below min_time (default\n"
+        "1000000 ns). Exits with status 1 if any statistic got worse.\n";
+    fprintf(stderr, "%s\n", usage.c_str());
+    exit(2);
+}
+
+}  // namespace
+
+int main(int argc, char *const *argv) {
+    bool json = false;
+    bool diff_mode = false;
+    double threshold = 0.1, min_time_ns = 1e6;
+    vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-json") {
+            json = true;
+        } else if (arg == "-diff") {
+            diff_mode = true;
+        } else if (arg == "-threshold" && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (arg == "-min_time" && i + 1 < argc) {
+            min_time_ns = atof(argv[++i]);
+        } else if (!arg.empty() && arg[0] == '-') {
+            usage(argv);
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (diff_mode) {
+        if (files.size() != 2) {
+            usage(argv);
+        }
+        return diff(files[0], files[1], threshold, min_time_ns);
+    }
+
+    if (files.empty()) {
+        usage(argv);
+    }
+
+    // Keyed by (pipeline, func), with an empty func for the pipeline
+    // as a whole.
+    map<pair<string, string>, Samples> samples;
+    for (const auto &file : files) {
+        vector<ProfileReport> reports;
+        if (!read_reports(file, &reports)) {
+            return 2;
+        }
+        for (const auto &r : reports) {
+            for (const auto &p : r.pipelines) {
+                if (!p.runs) {
+                    continue;
+                }
+                add_samples(&samples[{p.name, ""}], p, p.runs, 0);
+                for (const auto &f : p.funcs) {
+                    add_samples(&samples[{p.name, f.name}], f, p.runs, f.stack_peak);
+                }
+            }
+        }
+    }
+
+    const double percentiles[] = {50, 90, 99};
+    if (json) {
+        printf("[");
+    } else {
+        printf("pipeline,func,metric,count,min,p50,p90,p99,max\n");
+    }
+    bool first = true;
+    for (auto &it : samples) {
+        for (int m = 0; m < num_metrics; m++) {
+            vector<double> &v = it.second.values[m];
+            std::sort(v.begin(), v.end());
+            if (json) {
+                printf("%s\n{\"pipeline\": \"%s\", \"func\": \"%s\", \"metric\": \"%s\", \"count\": %d, \"min\": %g",
+                       first ? "" : ",", it.first.first.c_str(), it.first.second.c_str(),
+                       metric_names[m], (int)v.size(), v.front());
+                for (double p : percentiles) {
+                    printf(", \"p%d\": %g", (int)p, percentile(v, p));
+                }
+                printf(", \"max\": %g}", v.back());
+            } else {
+                printf("\"%s\",\"%s\",%s,%d,%g", it.first.first.c_str(), it.first.second.c_str(),
+                       metric_names[m], (int)v.size(), v.front());
+                for (double p : percentiles) {
+                    printf(",%g", percentile(v, p));
+                }
+                printf(",%g\n", v.back());
+            }
+            first = false;
+        }
+    }
+    if (json) {
+        printf("\n]\n");
+    }
+    return 0;
+}
@@ -277,7 +277,9 @@ void usage(char *const *argv) {
         "Funcs into individual image files in the current directory.\n"
         "To generate a suitable binary trace, use Func::trace_stores(), or the\n"
         "target features trace_stores and trace_realizations, and run with\n"
-        "HL_TRACE_FILE=<filename>.\n";
+        "HL_TRACE_FILE=<filename>. Traces written with HL_TRACE_MODE=ring\n"
+        "are also accepted; if they were sampled with HL_TRACE_SAMPLE, the\n"
+        "dumped images will only contain the sampled pixels.\n";
     fprintf(stderr, "%s\n", usage.c_str());
     exit(1);
 }
@@ -332,9 +334,10 @@ int main(int argc, char *const *argv) {
 
     printf("[INFO] First pass...\n");
 
+    PacketReader reader(file_desc);
     for (;;) {
         Packet p;
-        if (!p.read_from_filedesc(file_desc)) {
+        if (!reader.read(p)) {
             printf("[INFO] Finished pass 1 after %d packets.\n", packet_count);
             break;
         }
@@ -361,6 +364,7 @@ int main(int argc, char *const *argv) {
         fprintf(stderr, "Error: couldn't seek back to beginning of trace file. Aborting.\n");
         exit(1);
     }
+    reader.reset();
 
     for (auto &pair : func_info) {
         pair.second.allocate();
@@ -368,7 +372,7 @@ int main(int argc, char *const *argv) {
 
     for (;;) {
         Packet p;
-        if (!p.read_from_filedesc(file_desc)) {
+        if (!reader.read(p)) {
             printf("[INFO] Finished pass 2 after %d packets.\n", packet_count);
             if (file_desc != nullptr) {
                 fclose(file_desc);
@@ -7,29 +7,160 @@
 namespace Halide {
 namespace Internal {
 
-bool Packet::read_from_stdin() {
-    return read_from_filedesc(stdin);
+namespace {
+
+// Must match the ring-buffer chunk format in src/runtime/tracing.cpp.
+constexpr uint32_t trace_chunk_magic = 0x544c487f;
+constexpr int trace_ring_delta_coords = 16;
+
+[[noreturn]] void corrupt_chunk() {
+    fprintf(stderr, "Corrupt ring-buffer chunk in trace stream\n");
+    abort();
 }
 
-bool Packet::read_from_filedesc(FILE *fdesc) {
-    size_t header_size = sizeof(halide_trace_packet_t);
-    if (!Packet::read(this, header_size, fdesc)) {
-        return false;
+}  // namespace
+
+bool PacketReader::read(Packet &p) {
+    while (!records_left) {
+        uint32_t size_or_magic;
+        if (!read_bytes(&size_or_magic, sizeof(size_or_magic))) {
+            return false;
+        }
+        if (size_or_magic == trace_chunk_magic) {
+            if (!read_chunk()) {
+                fprintf(stderr, "Unexpected EOF mid-chunk");
+                return false;
+            }
+            continue;
+        }
+
+        // An ordinary packet.
+        size_t header_size = sizeof(halide_trace_packet_t);
+        p.size = size_or_magic;
+        if (!read_bytes((uint8_t *)&p + sizeof(uint32_t), header_size - sizeof(uint32_t))) {
+            fprintf(stderr, "Unexpected EOF mid-packet");
+            return false;
+        }
+        size_t payload_size = p.size - header_size;
+        if (payload_size > sizeof(p.payload)) {
+            fprintf(stderr, "Payload larger than %d bytes in trace stream (%d)\n", (int)sizeof(p.payload), (int)payload_size);
+            abort();
+            return false;
+        }
+        if (!read_bytes(p.payload, payload_size)) {
+            fprintf(stderr, "Unexpected EOF mid-packet");
+            return false;
+        }
+        return true;
     }
-    size_t payload_size = size - header_size;
-    if (payload_size > sizeof(payload)) {
-        fprintf(stderr, "Payload larger than %d bytes in trace stream (%d)\n", (int)sizeof(payload), (int)payload_size);
-        abort();
+    expand_record(p);
+    return true;
+}
+
+void PacketReader::reset() {
+    chunk.clear();
+    cursor = 0;
+    records_left = 0;
+}
+
+bool PacketReader::read_chunk() {
+    uint32_t header[3];
+    if (!read_bytes(header, sizeof(header))) {
         return false;
     }
-    if (!Packet::read(payload, payload_size, fdesc)) {
-        fprintf(stderr, "Unexpected EOF mid-packet");
+    chunk.resize(header[0]);
+    if (!read_bytes(chunk.data(), chunk.size())) {
         return false;
     }
+    cursor = 0;
+    records_left = header[1];
+    sample = header[2];
+    last_id = 0;
+    last_func.clear();
+    memset(last_coords, 0, sizeof(last_coords));
     return true;
 }
 
-bool Packet::read(void *d, size_t size, FILE *fdesc) {
+void PacketReader::expand_record(Packet &p) {
+    auto get_byte = [&]() -> uint8_t {
+        if (cursor >= chunk.size()) {
+            corrupt_chunk();
+        }
+        return chunk[cursor++];
+    };
+    auto get_varint = [&]() -> uint32_t {
+        uint32_t result = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t b = get_byte();
+            result |= (uint32_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return result;
+            }
+        }
+        corrupt_chunk();
+    };
+    auto get_signed_varint = [&]() -> uint32_t {
+        uint32_t v = get_varint();
+        return (v >> 1) ^ (0 - (v & 1));
+    };
+    auto get_bytes = [&](void *dst, size_t size, size_t limit) {
+        if (size > limit || cursor + size > chunk.size()) {
+            corrupt_chunk();
+        }
+        memcpy(dst, chunk.data() + cursor, size);
+        cursor += size;
+    };
+
+    records_left--;
+    p.id = last_id = (int32_t)((uint32_t)last_id + get_signed_varint());
+    p.event = (halide_trace_event_code_t)get_byte();
+    p.type.code = (halide_type_code_t)get_byte();
+    p.type.bits = get_byte();
+    p.type.lanes = (uint16_t)get_varint();
+    p.value_index = (int32_t)get_varint();
+    p.dimensions = (int32_t)get_varint();
+    p.parent_id = (int32_t)((uint32_t)p.id + get_signed_varint());
+
+    uint8_t *end = p.payload + sizeof(p.payload);
+    if (p.dimensions < 0 || (size_t)p.dimensions * sizeof(int32_t) > sizeof(p.payload)) {
+        corrupt_chunk();
+    }
+    int *coords = p.coordinates();
+    for (int i = 0; i < p.dimensions; i++) {
+        uint32_t delta = get_signed_varint();
+        if (i < trace_ring_delta_coords) {
+            coords[i] = last_coords[i] = (int32_t)((uint32_t)last_coords[i] + delta);
+        } else {
+            coords[i] = (int32_t)delta;
+        }
+    }
+    size_t value_bytes = (size_t)p.type.lanes * p.type.bytes();
+    get_bytes(p.value(), value_bytes, end - (uint8_t *)p.value());
+
+    uint32_t name_bytes = get_varint();
+    if (name_bytes) {
+        last_func.resize(name_bytes - 1);
+        get_bytes(&last_func[0], name_bytes - 1, sizeof(p.payload));
+    }
+    char *func = p.func();
+    if ((uint8_t *)func + last_func.size() + 1 > end) {
+        corrupt_chunk();
+    }
+    memcpy(func, last_func.c_str(), last_func.size() + 1);
+
+    char *trace_tag = func + last_func.size() + 1;
+    uint32_t trace_tag_bytes = get_varint();
+    if ((uint8_t *)trace_tag + trace_tag_bytes + 1 > end) {
+        corrupt_chunk();
+    }
+    get_bytes(trace_tag, trace_tag_bytes, trace_tag_bytes);
+    trace_tag[trace_tag_bytes] = 0;
+
+    size_t total_size = (uint8_t *)(trace_tag + trace_tag_bytes + 1) - (uint8_t *)&p;
+    p.size = (uint32_t)((total_size + 3) & ~3);
+}
+
+bool PacketReader::read_bytes(void *d, size_t size) {
     uint8_t *dst = (uint8_t *)d;
     if (!size) {
         return true;
@@ -4,6 +4,8 @@
 #include "HalideRuntime.h"
 #include <cstdio>
 #include <cstring>
+#include <string>
+#include <vector>
 
 namespace Halide {
 namespace Internal {
@@ -82,16 +84,49 @@ struct Packet : public halide_trace_packet_t {
         memcpy(&aligned_value, val, type.bits / 8);
         return value_as<T>(type, aligned_value);
     }
+};
+
+// Reads the packets of a binary trace file. Both the packet stream
+// written by halide_default_trace and the delta-compressed chunks it
+// writes in ring-buffer mode (HL_TRACE_MODE=ring) are accepted, and
+// the two may be mixed in one file. Chunks are expanded back into
+// ordinary packets.
+class PacketReader {
+public:
+    explicit PacketReader(FILE *fdesc)
+        : fdesc(fdesc) {
+    }
+
+    // Grab the next packet. Returns false when the end is reached.
+    bool read(Packet &p);
 
-    // Grab a packet from stdin. Returns false when stdin closes.
-    bool read_from_stdin();
+    // Discard any partially-expanded chunk. Call this after seeking
+    // the underlying file.
+    void reset();
 
-    // Grab a packet from a particular fctl file descriptor. Returns false when end is reached.
-    bool read_from_filedesc(FILE *fdesc);
+    // Loads and stores in the most recent chunk were recorded one in
+    // every sample_rate(). Always 1 for the ordinary packet stream.
+    uint32_t sample_rate() const {
+        return sample;
+    }
 
 private:
-    // Do a blocking read of some number of bytes from a unistd file descriptor.
-    bool read(void *d, size_t size, FILE *fdesc);
+    // Do a blocking read of some number of bytes from the file.
+    bool read_bytes(void *d, size_t size);
+
+    bool read_chunk();
+    void expand_record(Packet &p);
+
+    FILE *fdesc;
+
+    // The chunk currently being expanded, and the state its records
+    // are delta-encoded against.
+    std::vector<uint8_t> chunk;
+    size_t cursor = 0;
+    uint32_t records_left = 0, sample = 1;
+    int32_t last_id = 0;
+    std::string last_func;
+    int32_t last_coords[16] = {0};
 };
 
 }  // namespace Internal